@@ -0,0 +1,157 @@
+#include "analytics.h"
+
+#include "config.h"
+
+AlertPolicy AlertPolicy::firmware() {
+    AlertPolicy policy;
+    policy.yellow[(size_t)AlertInput::Temperature] = TEMP_YELLOW;
+    policy.red[(size_t)AlertInput::Temperature] = TEMP_RED;
+    policy.yellow[(size_t)AlertInput::Humidity] = HUMIDITY_YELLOW;
+    policy.red[(size_t)AlertInput::Humidity] = HUMIDITY_RED;
+    policy.yellow[(size_t)AlertInput::VibPeak] = ACCEL_YELLOW;
+    policy.red[(size_t)AlertInput::VibPeak] = ACCEL_RED;
+    policy.yellow[(size_t)AlertInput::VibRms] = VIB_RMS_YELLOW;
+    policy.red[(size_t)AlertInput::VibRms] = VIB_RMS_RED;
+    policy.hysteresis = ALERT_HYSTERESIS;
+    policy.clearMs = ALERT_CLEAR_MS;
+    return policy;
+}
+
+Moments Analytics::moments(const float* x, size_t n) const {
+    std::vector<Moments> parts(exec.chunks(n));
+    exec.run(n, [&](size_t chunk, size_t begin, size_t end) {
+        k.moments(x + begin, end - begin, parts[chunk]);
+    });
+    Moments total;
+    for (const Moments& part : parts) {
+        total.merge(part);
+    }
+    return total;
+}
+
+CoMoments Analytics::coMoments(const float* x, const float* y, size_t n) const {
+    std::vector<CoMoments> parts(exec.chunks(n));
+    exec.run(n, [&](size_t chunk, size_t begin, size_t end) {
+        k.coMoments(x + begin, y + begin, end - begin, parts[chunk]);
+    });
+    CoMoments total;
+    for (const CoMoments& part : parts) {
+        total.merge(part);
+    }
+    return total;
+}
+
+void Analytics::rolling(const float* x, size_t n, size_t window, float* mean, float* stddev) const {
+    window = window ? window : 1;
+    exec.run(n, [&](size_t, size_t begin, size_t end) {
+        // Cada bloco refaz as somas desde window - 1 linhas antes dele, o
+        // que o torna independente dos anteriores
+        size_t from = begin >= window - 1 ? begin - (window - 1) : 0;
+        size_t span = end - from;
+        thread_local std::vector<double> s, s2, c;
+        s.resize(span + 1);
+        s2.resize(span + 1);
+        c.resize(span + 1);
+        k.prefix(x + from, span, s.data(), s2.data(), c.data());
+        k.window(s.data(), s2.data(), c.data(), begin - from, end - begin, window, mean + begin,
+                 stddev + begin);
+    });
+}
+
+AlertSummary Analytics::alertDurations(const int64_t* t, const uint8_t* level, size_t n,
+                                       int64_t maxGapMs) const {
+    AlertSummary summary;
+    summary.rows = n;
+    if (n == 0) {
+        return summary;
+    }
+    // Fronteiras por bloco (cada um olha a linha anterior ao seu início)
+    std::vector<std::vector<uint32_t>> parts(exec.chunks(n));
+    exec.run(n, [&](size_t chunk, size_t begin, size_t end) {
+        size_t base = begin > 0 ? begin - 1 : 0;
+        std::vector<uint32_t>& found = parts[chunk];
+        found.resize(end - base);
+        found.resize(k.boundaries(level + base, t + base, end - base, maxGapMs, found.data()));
+        for (uint32_t& position : found) {
+            position += (uint32_t)base;
+        }
+    });
+
+    // Os trechos entre fronteiras, em ordem
+    size_t start = 0;
+    auto close = [&](size_t next) {
+        int64_t endMs = t[next - 1];
+        if (next < n) {
+            if (t[next] - t[next - 1] > maxGapMs) {
+                summary.gaps++;
+            } else {
+                endMs = t[next];
+            }
+        }
+        LevelSummary& s = summary.levels[level[start] < 3 ? level[start] : 2];
+        int64_t duration = endMs - t[start];
+        s.episodes++;
+        s.totalMs += duration;
+        s.longestMs = duration > s.longestMs ? duration : s.longestMs;
+        summary.coveredMs += duration;
+        start = next;
+    };
+    for (const std::vector<uint32_t>& part : parts) {
+        for (uint32_t position : part) {
+            close(position);
+        }
+    }
+    close(n);
+    return summary;
+}
+
+void Analytics::replayAlerts(const TelemetryTable& table, const AlertPolicy& policy, uint8_t* out) const {
+    size_t n = table.rows();
+    const float* inputs[ALERT_INPUTS] = {
+        table.channel(Channel::Temperature), table.channel(Channel::Humidity),
+        table.channel(Channel::VibPeak), table.channel(Channel::VibRms),
+    };
+    float holdYellow[ALERT_INPUTS];
+    float holdRed[ALERT_INPUTS];
+    for (size_t i = 0; i < ALERT_INPUTS; i++) {
+        holdYellow[i] = policy.yellow[i] * (1.0f - policy.hysteresis);
+        holdRed[i] = policy.red[i] * (1.0f - policy.hysteresis);
+    }
+
+    // Nível para subir (limiares cheios) e para manter (reduzidos), em blocos
+    std::vector<uint8_t> hold(n);
+    exec.run(n, [&](size_t, size_t begin, size_t end) {
+        const float* rows[ALERT_INPUTS];
+        for (size_t i = 0; i < ALERT_INPUTS; i++) {
+            rows[i] = inputs[i] + begin;
+        }
+        k.levels(rows, end - begin, policy.yellow, policy.red, out + begin);
+        k.levels(rows, end - begin, holdYellow, holdRed, hold.data() + begin);
+    });
+
+    // A máquina de estados do AlertEvaluator depende da linha anterior:
+    // sequencial, mas só compara bytes
+    const int64_t* t = table.timestampMs.data();
+    uint8_t current = 0;
+    bool clearing = false;
+    int64_t clearSinceMs = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t raise = out[i];
+        if (raise >= current) {
+            current = raise;
+            clearing = false;
+        } else if (hold[i] >= current) {
+            clearing = false;
+        } else {
+            if (!clearing) {
+                clearing = true;
+                clearSinceMs = t[i];
+            }
+            if (t[i] - clearSinceMs >= policy.clearMs) {
+                current = hold[i];
+                clearing = false;
+            }
+        }
+        out[i] = current;
+    }
+}
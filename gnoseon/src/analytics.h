@@ -0,0 +1,64 @@
+#pragma once
+
+// Análises sobre uma TelemetryTable: estatísticas por canal, correlações,
+// estatísticas móveis, duração dos alertas e reprodução dos alertas com
+// outros limiares. Cada análise divide as linhas em blocos (executor.h) e
+// roda os kernels (kernels.h) em cada um.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "executor.h"
+#include "kernels.h"
+#include "telemetry_table.h"
+
+struct LevelSummary {
+    uint64_t episodes = 0;
+    int64_t totalMs = 0;
+    int64_t longestMs = 0;
+};
+
+struct AlertSummary {
+    LevelSummary levels[3];     // AlertLevel do firmware
+    uint64_t rows = 0;
+    uint64_t gaps = 0;          // Lacunas maiores que maxGapMs
+    int64_t coveredMs = 0;      // Tempo com leituras (sem as lacunas)
+};
+
+// Limiares como no firmware (config.h): vermelho/amarelo por entrada,
+// histerese para descer e tempo abaixo dela antes de baixar o nível
+struct AlertPolicy {
+    float yellow[ALERT_INPUTS];
+    float red[ALERT_INPUTS];
+    float hysteresis;
+    uint32_t clearMs;
+
+    static AlertPolicy firmware();
+};
+
+class Analytics {
+public:
+    Analytics(const Kernels& kernels, const Executor& executor) : k(kernels), exec(executor) {}
+
+    Moments moments(const float* x, size_t n) const;
+    CoMoments coMoments(const float* x, const float* y, size_t n) const;
+
+    // Média e desvio padrão das janelas das últimas window linhas
+    void rolling(const float* x, size_t n, size_t window, float* mean, float* stddev) const;
+
+    // Episódios por nível: trechos contínuos no mesmo nível, interrompidos
+    // por lacunas de mais de maxGapMs. Cada linha dura até a seguinte
+    AlertSummary alertDurations(const int64_t* timestampMs, const uint8_t* level, size_t n,
+                                int64_t maxGapMs) const;
+
+    // Nível de alerta que o avaliador do firmware daria às leituras com a
+    // política dada (só limiares fixos; o motor de anomalias e as bandas
+    // espectrais não estão nos registros)
+    void replayAlerts(const TelemetryTable& table, const AlertPolicy& policy, uint8_t* out) const;
+
+private:
+    const Kernels& k;
+    const Executor& exec;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+// Execução em blocos de linhas: as threads pegam o próximo bloco de um
+// contador atômico, então blocos mais lentos não seguram as demais. O
+// resultado de cada bloco vai para a posição dele, e a combinação é feita
+// em ordem por quem chamou, de modo que o resultado não depende do número
+// de threads (a não ser pela ordem das somas em ponto flutuante).
+
+#include <stddef.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+constexpr size_t DEFAULT_CHUNK_ROWS = 64 * 1024;
+
+class Executor {
+public:
+    // threads = 0: uma por núcleo
+    explicit Executor(unsigned threads = 0, size_t chunkRows = DEFAULT_CHUNK_ROWS)
+        : workers(threads ? threads : defaultThreads()), rowsPerChunk(chunkRows ? chunkRows : 1) {}
+
+    unsigned threads() const { return workers; }
+    size_t chunkRows() const { return rowsPerChunk; }
+    size_t chunks(size_t rows) const { return (rows + rowsPerChunk - 1) / rowsPerChunk; }
+
+    // fn(chunk, begin, end) para cada bloco de [0, rows)
+    template <typename Fn>
+    void run(size_t rows, Fn fn) const {
+        size_t total = chunks(rows);
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t chunk = next++; chunk < total; chunk = next++) {
+                size_t begin = chunk * rowsPerChunk;
+                size_t end = begin + rowsPerChunk < rows ? begin + rowsPerChunk : rows;
+                fn(chunk, begin, end);
+            }
+        };
+        unsigned extra = (unsigned)(total < workers ? total : workers);
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < extra; t++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+    }
+
+    static unsigned defaultThreads() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+private:
+    unsigned workers;
+    size_t rowsPerChunk;
+};
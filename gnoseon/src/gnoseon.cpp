@@ -0,0 +1,435 @@
+// gnoseon: análise offline da telemetria histórica.
+//
+//   gnoseon stats   [comuns] ENTRADA
+//   gnoseon corr    [comuns] ENTRADA
+//   gnoseon rolling [comuns] --column CANAL --window N [--every N] ENTRADA
+//   gnoseon alerts  [comuns] [--max-gap-s N] ENTRADA
+//   gnoseon whatif  [comuns] [--max-gap-s N] [limiares] ENTRADA
+//   gnoseon bench   [--rows N] [--threads N]
+//
+// ENTRADA é um arquivo de linhas JSON de sendJSONData() ("-" para a
+// entrada padrão) ou a raiz de um armazenamento do katabase-ingest.
+// Comuns: --threads N (padrão: uma por núcleo), --scalar (sem AVX2),
+// --device NOME (armazenamento com vários dispositivos).
+//
+// Limiares do whatif, padrão config.h do firmware: --temp-yellow/--temp-red,
+// --humidity-yellow/--humidity-red, --accel-yellow/--accel-red (pico),
+// --vib-yellow/--vib-red (RMS), --hysteresis F, --clear-ms N.
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "alert_level.h"
+#include "analytics.h"
+
+namespace {
+
+struct Options {
+    const char* command = nullptr;
+    const char* input = nullptr;
+    const char* device = nullptr;
+    unsigned threads = 0;
+    bool scalar = false;
+    Channel column = Channel::Count;
+    size_t window = 60;
+    size_t every = 1;
+    double maxGapS = 60;
+    size_t benchRows = 4u << 20;
+    AlertPolicy policy = AlertPolicy::firmware();
+};
+
+double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+bool loadInput(const Options& options, TelemetryTable& table) {
+    std::string error;
+    struct stat st;
+    bool ok = strcmp(options.input, "-") != 0 && stat(options.input, &st) == 0 && S_ISDIR(st.st_mode)
+                  ? loadKatabaseStore(options.input, options.device, table, error)
+                  : loadJsonLines(options.input, table, error);
+    if (!ok) {
+        fprintf(stderr, "%s\n", error.c_str());
+    } else if (table.rows() == 0) {
+        fprintf(stderr, "%s: nenhum registro\n", options.input);
+        ok = false;
+    }
+    return ok;
+}
+
+void printStats(const Analytics& analytics, const TelemetryTable& table) {
+    printf("%-12s %10s %12s %12s %12s %12s\n", "canal", "n", "média", "desvio", "mín", "máx");
+    for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+        Moments m = analytics.moments(table.channels[c].data(), table.rows());
+        if (m.count == 0) {
+            continue;
+        }
+        printf("%-12s %10llu %12.4f %12.4f %12.4f %12.4f\n", CHANNEL_NAMES[c],
+               (unsigned long long)m.count, m.mean(), m.stddev(), m.min, m.max);
+    }
+}
+
+void printCorrelations(const Analytics& analytics, const TelemetryTable& table) {
+    std::vector<size_t> present;
+    for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+        if (analytics.moments(table.channels[c].data(), table.rows()).count > 0) {
+            present.push_back(c);
+        }
+    }
+    printf("%-12s", "");
+    for (size_t c : present) {
+        printf(" %11s", CHANNEL_NAMES[c]);
+    }
+    printf("\n");
+    for (size_t a : present) {
+        printf("%-12s", CHANNEL_NAMES[a]);
+        for (size_t b : present) {
+            double r = a == b ? 1.0 : analytics.coMoments(table.channels[a].data(),
+                                                          table.channels[b].data(), table.rows()).correlation();
+            printf(" %11.3f", r);
+        }
+        printf("\n");
+    }
+}
+
+void printRolling(const Analytics& analytics, const TelemetryTable& table, const Options& options) {
+    std::vector<float> mean(table.rows());
+    std::vector<float> stddev(table.rows());
+    analytics.rolling(table.channel(options.column), table.rows(), options.window, mean.data(),
+                      stddev.data());
+    printf("timestamp_ms,%s,mean,stddev\n", CHANNEL_NAMES[(size_t)options.column]);
+    const float* x = table.channel(options.column);
+    for (size_t i = 0; i < table.rows(); i += options.every) {
+        printf("%lld,%g,%g,%g\n", (long long)table.timestampMs[i], x[i], mean[i], stddev[i]);
+    }
+}
+
+void printAlertColumns(const char* const titles[], const AlertSummary summaries[], size_t count) {
+    printf("%-22s", "");
+    for (size_t i = 0; i < count; i++) {
+        printf(" %18s", titles[i]);
+    }
+    printf("\n");
+    for (size_t l = 0; l < (size_t)AlertLevel::Count; l++) {
+        const char* name = alertLevelName((AlertLevel)l);
+        char label[32];
+        snprintf(label, sizeof(label), "%s: tempo", name);
+        printf("%-22s", label);
+        for (size_t i = 0; i < count; i++) {
+            const AlertSummary& s = summaries[i];
+            double share = s.coveredMs ? 100.0 * s.levels[l].totalMs / s.coveredMs : 0;
+            printf(" %9.1f h %5.1f%%", s.levels[l].totalMs / 3.6e6, share);
+        }
+        printf("\n");
+        snprintf(label, sizeof(label), "%s: episódios", name);
+        printf("%-23s", label);
+        for (size_t i = 0; i < count; i++) {
+            printf(" %18llu", (unsigned long long)summaries[i].levels[l].episodes);
+        }
+        printf("\n");
+        snprintf(label, sizeof(label), "%s: mais longo", name);
+        printf("%-22s", label);
+        for (size_t i = 0; i < count; i++) {
+            printf(" %16.1f s", summaries[i].levels[l].longestMs / 1e3);
+        }
+        printf("\n");
+    }
+    printf("%-22s", "lacunas");
+    for (size_t i = 0; i < count; i++) {
+        printf(" %18llu", (unsigned long long)summaries[i].gaps);
+    }
+    printf("\n");
+}
+
+void printWhatIf(const Analytics& analytics, const TelemetryTable& table, const Options& options) {
+    size_t n = table.rows();
+    int64_t maxGapMs = (int64_t)(options.maxGapS * 1000);
+    std::vector<uint8_t> firmware(n);
+    std::vector<uint8_t> proposed(n);
+    analytics.replayAlerts(table, AlertPolicy::firmware(), firmware.data());
+    analytics.replayAlerts(table, options.policy, proposed.data());
+    const int64_t* t = table.timestampMs.data();
+    AlertSummary summaries[] = {
+        analytics.alertDurations(t, table.alertLevel.data(), n, maxGapMs),
+        analytics.alertDurations(t, firmware.data(), n, maxGapMs),
+        analytics.alertDurations(t, proposed.data(), n, maxGapMs),
+    };
+    const char* const titles[] = {"registrado", "limiares atuais", "proposta"};
+    printAlertColumns(titles, summaries, 3);
+
+    size_t changed = 0;
+    for (size_t i = 0; i < n; i++) {
+        changed += proposed[i] != firmware[i];
+    }
+    printf("linhas com nível diferente do atual: %zu (%.2f%%)\n", changed, 100.0 * changed / n);
+}
+
+// Operações do benchmark: cada uma processa a tabela inteira
+struct BenchResult {
+    Moments stats[CHANNEL_COUNT];
+    double correlation = 0;
+    std::vector<float> mean;
+    std::vector<float> stddev;
+    AlertSummary alerts;
+    std::vector<uint8_t> replay;
+};
+
+const char* const BENCH_OPS[] = {"stats", "corr", "rolling", "alerts", "whatif"};
+constexpr size_t BENCH_OP_COUNT = sizeof(BENCH_OPS) / sizeof(BENCH_OPS[0]);
+
+void runBenchOp(size_t op, const Analytics& analytics, const TelemetryTable& table, BenchResult& out) {
+    size_t n = table.rows();
+    switch (op) {
+    case 0:
+        for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+            out.stats[c] = analytics.moments(table.channels[c].data(), n);
+        }
+        break;
+    case 1:
+        out.correlation = analytics.coMoments(table.channel(Channel::Temperature),
+                                              table.channel(Channel::Humidity), n).correlation();
+        break;
+    case 2:
+        out.mean.resize(n);
+        out.stddev.resize(n);
+        analytics.rolling(table.channel(Channel::Temperature), n, 600, out.mean.data(), out.stddev.data());
+        break;
+    case 3:
+        out.alerts = analytics.alertDurations(table.timestampMs.data(), table.alertLevel.data(), n, 60000);
+        break;
+    default:
+        out.replay.resize(n);
+        analytics.replayAlerts(table, AlertPolicy::firmware(), out.replay.data());
+        break;
+    }
+}
+
+// Melhor de três, em linhas por segundo
+double measure(size_t op, const Kernels& kernels, unsigned threads, const TelemetryTable& table,
+               BenchResult& out) {
+    Executor executor(threads);
+    Analytics analytics(kernels, executor);
+    double best = INFINITY;
+    for (int run = 0; run < 3; run++) {
+        double start = nowSeconds();
+        runBenchOp(op, analytics, table, out);
+        double elapsed = nowSeconds() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return table.rows() / best;
+}
+
+bool close(double a, double b, double tolerance) {
+    return (isnan(a) && isnan(b)) || fabs(a - b) <= tolerance * (1 + fabs(a) + fabs(b));
+}
+
+bool sameResult(size_t op, const BenchResult& a, const BenchResult& b) {
+    switch (op) {
+    case 0:
+        for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+            if (a.stats[c].count != b.stats[c].count || a.stats[c].min != b.stats[c].min ||
+                a.stats[c].max != b.stats[c].max || !close(a.stats[c].sum, b.stats[c].sum, 1e-9) ||
+                !close(a.stats[c].sumSq, b.stats[c].sumSq, 1e-9)) {
+                return false;
+            }
+        }
+        return true;
+    case 1:
+        return close(a.correlation, b.correlation, 1e-9);
+    case 2:
+        for (size_t i = 0; i < a.mean.size(); i++) {
+            if (!close(a.mean[i], b.mean[i], 1e-5) || fabs(a.stddev[i] - b.stddev[i]) > 1e-3) {
+                return false;
+            }
+        }
+        return true;
+    case 3:
+        for (size_t l = 0; l < 3; l++) {
+            if (a.alerts.levels[l].episodes != b.alerts.levels[l].episodes ||
+                a.alerts.levels[l].totalMs != b.alerts.levels[l].totalMs ||
+                a.alerts.levels[l].longestMs != b.alerts.levels[l].longestMs) {
+                return false;
+            }
+        }
+        return a.alerts.gaps == b.alerts.gaps;
+    default:
+        return a.replay == b.replay;
+    }
+}
+
+int bench(const Options& options) {
+    TelemetryTable table;
+    double start = nowSeconds();
+    generateTelemetry(options.benchRows, 12345, table);
+    // Uma lacuna de uma hora para o resumo de alertas ter o que cortar
+    for (size_t i = table.rows() / 2; i < table.rows(); i++) {
+        table.timestampMs[i] += 3600 * 1000;
+    }
+    const Kernels* simd = avx2Kernels();
+    unsigned maxThreads = options.threads ? options.threads : Executor::defaultThreads();
+    printf("%zu linhas sintéticas (%.1f s para gerar), %s, até %u threads (%u núcleos)\n",
+           table.rows(), nowSeconds() - start, simd ? "AVX2 disponível" : "sem AVX2", maxThreads,
+           Executor::defaultThreads());
+
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+    const Kernels& best = simd ? *simd : scalarKernels();
+
+    printf("\nmilhões de linhas/s; um núcleo: escalar e %s; depois %s por número de threads\n",
+           best.name, best.name);
+    printf("%-9s %9s %9s %6s |", "operação", "escalar", best.name, "ganho");
+    for (unsigned t : counts) {
+        printf(" %6u t", t);
+    }
+    printf(" | eficiência\n");
+
+    bool ok = true;
+    for (size_t op = 0; op < BENCH_OP_COUNT; op++) {
+        BenchResult reference;
+        BenchResult result;
+        double scalarRate = measure(op, scalarKernels(), 1, table, reference);
+        double simdRate = measure(op, best, 1, table, result);
+        bool same = sameResult(op, reference, result);
+        printf("%-8s %9.1f %9.1f %5.1fx |", BENCH_OPS[op], scalarRate / 1e6, simdRate / 1e6,
+               simdRate / scalarRate);
+        double last = simdRate;
+        for (unsigned t : counts) {
+            last = t == 1 ? simdRate : measure(op, best, t, table, result);
+            same = same && sameResult(op, reference, result);
+            printf(" %8.1f", last / 1e6);
+        }
+        printf(" | %5.0f%%%s\n", 100.0 * last / (simdRate * counts.back()), same ? "" : "  DIVERGE");
+        ok = ok && same;
+    }
+    printf("%s\n", ok ? "OK" : "FALHA: resultados diferentes entre as versões");
+    return ok ? 0 : 1;
+}
+
+bool parseFloat(const char* name, const char* flag, const char* value, float& out) {
+    if (strcmp(name, flag) != 0) {
+        return false;
+    }
+    out = strtof(value, nullptr);
+    return true;
+}
+
+void usage(const char* program) {
+    fprintf(stderr,
+            "uso: %s stats|corr|alerts [comuns] ENTRADA\n"
+            "     %s rolling [comuns] --column CANAL --window N [--every N] ENTRADA\n"
+            "     %s whatif [comuns] [--max-gap-s N] [--temp-yellow F] [--temp-red F] "
+            "[--humidity-yellow F] [--humidity-red F] [--accel-yellow F] [--accel-red F] "
+            "[--vib-yellow F] [--vib-red F] [--hysteresis F] [--clear-ms N] ENTRADA\n"
+            "     %s bench [--rows N] [--threads N]\n"
+            "comuns: [--threads N] [--scalar] [--device NOME]\n",
+            program, program, program, program);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    options.command = argv[1];
+    AlertPolicy& p = options.policy;
+    for (int i = 2; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--scalar") == 0) {
+            options.scalar = true;
+        } else if (value == nullptr || arg[0] != '-' || arg[1] != '-') {
+            if (options.input != nullptr) {
+                usage(argv[0]);
+                return 2;
+            }
+            options.input = arg;
+        } else if (strcmp(arg, "--threads") == 0) {
+            options.threads = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(arg, "--device") == 0) {
+            options.device = argv[++i];
+        } else if (strcmp(arg, "--column") == 0) {
+            options.column = channelByName(argv[++i]);
+        } else if (strcmp(arg, "--window") == 0) {
+            options.window = (size_t)atol(argv[++i]);
+        } else if (strcmp(arg, "--every") == 0) {
+            options.every = (size_t)atol(argv[++i]);
+        } else if (strcmp(arg, "--max-gap-s") == 0) {
+            options.maxGapS = atof(argv[++i]);
+        } else if (strcmp(arg, "--rows") == 0) {
+            options.benchRows = (size_t)atol(argv[++i]);
+        } else if (strcmp(arg, "--hysteresis") == 0) {
+            p.hysteresis = strtof(argv[++i], nullptr);
+        } else if (strcmp(arg, "--clear-ms") == 0) {
+            p.clearMs = (uint32_t)atol(argv[++i]);
+        } else if (parseFloat(arg, "--temp-yellow", value, p.yellow[(size_t)AlertInput::Temperature]) ||
+                   parseFloat(arg, "--temp-red", value, p.red[(size_t)AlertInput::Temperature]) ||
+                   parseFloat(arg, "--humidity-yellow", value, p.yellow[(size_t)AlertInput::Humidity]) ||
+                   parseFloat(arg, "--humidity-red", value, p.red[(size_t)AlertInput::Humidity]) ||
+                   parseFloat(arg, "--accel-yellow", value, p.yellow[(size_t)AlertInput::VibPeak]) ||
+                   parseFloat(arg, "--accel-red", value, p.red[(size_t)AlertInput::VibPeak]) ||
+                   parseFloat(arg, "--vib-yellow", value, p.yellow[(size_t)AlertInput::VibRms]) ||
+                   parseFloat(arg, "--vib-red", value, p.red[(size_t)AlertInput::VibRms])) {
+            i++;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (strcmp(options.command, "bench") == 0) {
+        if (options.input != nullptr || options.benchRows == 0) {
+            usage(argv[0]);
+            return 2;
+        }
+        return bench(options);
+    }
+    bool rolling = strcmp(options.command, "rolling") == 0;
+    if (options.input == nullptr || (rolling && options.column == Channel::Count) ||
+        options.window == 0 || options.every == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    TelemetryTable table;
+    if (!loadInput(options, table)) {
+        return 1;
+    }
+    Executor executor(options.threads);
+    Analytics analytics(selectKernels(!options.scalar), executor);
+    int64_t maxGapMs = (int64_t)(options.maxGapS * 1000);
+
+    if (strcmp(options.command, "stats") == 0) {
+        printStats(analytics, table);
+    } else if (strcmp(options.command, "corr") == 0) {
+        printCorrelations(analytics, table);
+    } else if (rolling) {
+        printRolling(analytics, table, options);
+    } else if (strcmp(options.command, "alerts") == 0) {
+        AlertSummary summary = analytics.alertDurations(table.timestampMs.data(), table.alertLevel.data(),
+                                                        table.rows(), maxGapMs);
+        const char* const titles[] = {"registrado"};
+        printAlertColumns(titles, &summary, 1);
+    } else if (strcmp(options.command, "whatif") == 0) {
+        printWhatIf(analytics, table, options);
+    } else {
+        usage(argv[0]);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "kernels.h"
+
+void Moments::merge(const Moments& other) {
+    count += other.count;
+    sum += other.sum;
+    sumSq += other.sumSq;
+    min = other.min < min ? other.min : min;
+    max = other.max > max ? other.max : max;
+}
+
+double Moments::stddev() const {
+    if (count == 0) {
+        return NAN;
+    }
+    double m = sum / count;
+    double variance = sumSq / count - m * m;
+    return variance > 0 ? sqrt(variance) : 0;
+}
+
+void CoMoments::merge(const CoMoments& other) {
+    count += other.count;
+    sumX += other.sumX;
+    sumY += other.sumY;
+    sumXX += other.sumXX;
+    sumYY += other.sumYY;
+    sumXY += other.sumXY;
+}
+
+double CoMoments::correlation() const {
+    if (count < 2) {
+        return NAN;
+    }
+    double n = (double)count;
+    double covariance = sumXY - sumX * sumY / n;
+    double varX = sumXX - sumX * sumX / n;
+    double varY = sumYY - sumY * sumY / n;
+    if (varX <= 0 || varY <= 0) {
+        return NAN;
+    }
+    return covariance / sqrt(varX * varY);
+}
+
+namespace {
+
+void momentsScalar(const float* x, size_t n, Moments& out) {
+    Moments m;
+    for (size_t i = 0; i < n; i++) {
+        double v = x[i];
+        if (isnan(v)) {
+            continue;
+        }
+        m.count++;
+        m.sum += v;
+        m.sumSq += v * v;
+        m.min = v < m.min ? v : m.min;
+        m.max = v > m.max ? v : m.max;
+    }
+    out.merge(m);
+}
+
+void coMomentsScalar(const float* x, const float* y, size_t n, CoMoments& out) {
+    CoMoments m;
+    for (size_t i = 0; i < n; i++) {
+        double a = x[i];
+        double b = y[i];
+        if (isnan(a) || isnan(b)) {
+            continue;
+        }
+        m.count++;
+        m.sumX += a;
+        m.sumY += b;
+        m.sumXX += a * a;
+        m.sumYY += b * b;
+        m.sumXY += a * b;
+    }
+    out.merge(m);
+}
+
+void prefixScalar(const float* x, size_t n, double* s, double* s2, double* c) {
+    s[0] = s2[0] = c[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        double v = x[i];
+        bool present = !isnan(v);
+        v = present ? v : 0;
+        s[i + 1] = s[i] + v;
+        s2[i + 1] = s2[i] + v * v;
+        c[i + 1] = c[i] + (present ? 1 : 0);
+    }
+}
+
+void windowScalar(const double* s, const double* s2, const double* c, size_t first, size_t count,
+                  size_t w, float* mean, float* stddev) {
+    for (size_t j = 0; j < count; j++) {
+        size_t hi = first + j + 1;
+        size_t lo = hi > w ? hi - w : 0;
+        double n = c[hi] - c[lo];
+        if (n <= 0) {
+            mean[j] = stddev[j] = NAN;
+            continue;
+        }
+        double m = (s[hi] - s[lo]) / n;
+        double variance = (s2[hi] - s2[lo]) / n - m * m;
+        mean[j] = (float)m;
+        stddev[j] = (float)(variance > 0 ? sqrt(variance) : 0);
+    }
+}
+
+void levelsScalar(const float* const inputs[ALERT_INPUTS], size_t n, const float yellow[ALERT_INPUTS],
+                  const float red[ALERT_INPUTS], uint8_t* out) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t level = 0;
+        for (size_t k = 0; k < ALERT_INPUTS; k++) {
+            float v = inputs[k][i];
+            if (v >= red[k]) {
+                level = 2;
+                break;
+            }
+            if (v >= yellow[k]) {
+                level = 1;
+            }
+        }
+        out[i] = level;
+    }
+}
+
+size_t boundariesScalar(const uint8_t* level, const int64_t* timestampMs, size_t n,
+                        int64_t maxGapMs, uint32_t* out) {
+    size_t found = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (level[i] != level[i - 1] || timestampMs[i] - timestampMs[i - 1] > maxGapMs) {
+            out[found++] = (uint32_t)i;
+        }
+    }
+    return found;
+}
+
+const Kernels SCALAR = {
+    "escalar", momentsScalar, coMomentsScalar, prefixScalar, windowScalar, levelsScalar,
+    boundariesScalar,
+};
+
+}  // namespace
+
+const Kernels& scalarKernels() {
+    return SCALAR;
+}
+
+#ifdef GNOSEON_HAVE_AVX2
+const Kernels& avx2KernelTable();
+#endif
+
+const Kernels* avx2Kernels() {
+#ifdef GNOSEON_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return &avx2KernelTable();
+    }
+#endif
+    return nullptr;
+}
+
+const Kernels& selectKernels(bool allowSimd) {
+    const Kernels* simd = allowSimd ? avx2Kernels() : nullptr;
+    return simd != nullptr ? *simd : SCALAR;
+}
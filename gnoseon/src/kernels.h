@@ -0,0 +1,85 @@
+#pragma once
+
+// Kernels sobre colunas contíguas, em duas implementações com a mesma
+// semântica: escalar (referência, qualquer CPU) e AVX2 (kernels_avx2.cpp,
+// o único arquivo compilado com -mavx2). A escolha é feita em tempo de
+// execução pela CPU; --scalar força a referência.
+//
+// NaN é leitura ausente: fica fora de contagens, somas, mínimo e máximo.
+// Os acumuladores são double nas duas versões; as somas diferem só pela
+// ordem das parcelas.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct Moments {
+    uint64_t count = 0;
+    double sum = 0;
+    double sumSq = 0;
+    double min = INFINITY;
+    double max = -INFINITY;
+
+    void merge(const Moments& other);
+    double mean() const { return count ? sum / count : NAN; }
+    double stddev() const;
+};
+
+struct CoMoments {
+    uint64_t count = 0;     // Pares com os dois valores presentes
+    double sumX = 0;
+    double sumY = 0;
+    double sumXX = 0;
+    double sumYY = 0;
+    double sumXY = 0;
+
+    void merge(const CoMoments& other);
+    double correlation() const;     // Pearson; NaN sem variância
+};
+
+// Entradas dos limiares de alerta do firmware (alerts.cpp)
+enum class AlertInput : uint8_t {
+    Temperature,
+    Humidity,
+    VibPeak,        // ACCEL_YELLOW/RED, magnitude de pico
+    VibRms,
+    Count
+};
+
+constexpr size_t ALERT_INPUTS = (size_t)AlertInput::Count;
+
+struct Kernels {
+    const char* name;
+
+    // Acumula em out os valores de x
+    void (*moments)(const float* x, size_t n, Moments& out);
+    void (*coMoments)(const float* x, const float* y, size_t n, CoMoments& out);
+
+    // Somas prefixadas: s[0] = 0 e s[i + 1] = s[i] + x[i]; idem para x² em
+    // s2 e para a contagem de valores presentes em c (n + 1 posições)
+    void (*prefix)(const float* x, size_t n, double* s, double* s2, double* c);
+
+    // Média e desvio padrão das janelas de até w linhas terminando em k,
+    // para k em [first, first + count), a partir das somas prefixadas;
+    // NaN numa janela sem valores
+    void (*window)(const double* s, const double* s2, const double* c, size_t first,
+                   size_t count, size_t w, float* mean, float* stddev);
+
+    // Nível por linha (0 normal, 1 amarelo, 2 vermelho): vermelho se alguma
+    // entrada >= red, amarelo se alguma >= yellow
+    void (*levels)(const float* const inputs[ALERT_INPUTS], size_t n,
+                   const float yellow[ALERT_INPUTS], const float red[ALERT_INPUTS], uint8_t* out);
+
+    // Posições i em [1, n) onde o nível muda ou há uma lacuna de mais de
+    // maxGapMs desde a linha anterior; devolve quantas escreveu em out
+    size_t (*boundaries)(const uint8_t* level, const int64_t* timestampMs, size_t n,
+                         int64_t maxGapMs, uint32_t* out);
+};
+
+const Kernels& scalarKernels();
+
+// nullptr se o binário não tem a versão AVX2 ou a CPU não suporta
+const Kernels* avx2Kernels();
+
+// A melhor disponível, ou a escalar com allowSimd = false
+const Kernels& selectKernels(bool allowSimd);
@@ -0,0 +1,257 @@
+// Versões AVX2 dos kernels (kernels.h). Compilado com -mavx2 -mfma e só
+// chamado depois de avx2Kernels() conferir a CPU; as caudas que não enchem
+// um vetor usam a versão escalar com a mesma semântica.
+
+#include <immintrin.h>
+
+#include "kernels.h"
+
+namespace {
+
+// Soma horizontal dos 4 lanes
+double horizontalSum(__m256d v) {
+    __m128d low = _mm256_castpd256_pd128(v);
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    low = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+double horizontalMin(__m256d v) {
+    __m128d low = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+double horizontalMax(__m256d v) {
+    __m128d low = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+// Acumuladores de 4 lanes de Moments, para 4 floats convertidos em double
+struct MomentLanes {
+    __m256d count = _mm256_setzero_pd();
+    __m256d sum = _mm256_setzero_pd();
+    __m256d sumSq = _mm256_setzero_pd();
+    __m256d min = _mm256_set1_pd(INFINITY);
+    __m256d max = _mm256_set1_pd(-INFINITY);
+
+    void add(__m128 x) {
+        const __m256d one = _mm256_set1_pd(1.0);
+        __m256d v = _mm256_cvtps_pd(x);
+        __m256d present = _mm256_cmp_pd(v, v, _CMP_ORD_Q);
+        __m256d zeroed = _mm256_and_pd(v, present);
+        count = _mm256_add_pd(count, _mm256_and_pd(one, present));
+        sum = _mm256_add_pd(sum, zeroed);
+        sumSq = _mm256_fmadd_pd(zeroed, zeroed, sumSq);
+        min = _mm256_min_pd(_mm256_blendv_pd(_mm256_set1_pd(INFINITY), v, present), min);
+        max = _mm256_max_pd(_mm256_blendv_pd(_mm256_set1_pd(-INFINITY), v, present), max);
+    }
+
+    void store(Moments& out) const {
+        Moments m;
+        m.count = (uint64_t)horizontalSum(count);
+        m.sum = horizontalSum(sum);
+        m.sumSq = horizontalSum(sumSq);
+        m.min = horizontalMin(min);
+        m.max = horizontalMax(max);
+        out.merge(m);
+    }
+};
+
+void momentsAvx2(const float* x, size_t n, Moments& out) {
+    // Dois conjuntos de acumuladores para não encadear todas as somas
+    MomentLanes a;
+    MomentLanes b;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        a.add(_mm256_castps256_ps128(v));
+        b.add(_mm256_extractf128_ps(v, 1));
+    }
+    a.store(out);
+    b.store(out);
+    scalarKernels().moments(x + i, n - i, out);
+}
+
+void coMomentsAvx2(const float* x, const float* y, size_t n, CoMoments& out) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d count = _mm256_setzero_pd();
+    __m256d sumX = _mm256_setzero_pd();
+    __m256d sumY = _mm256_setzero_pd();
+    __m256d sumXX = _mm256_setzero_pd();
+    __m256d sumYY = _mm256_setzero_pd();
+    __m256d sumXY = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d a = _mm256_cvtps_pd(_mm_loadu_ps(x + i));
+        __m256d b = _mm256_cvtps_pd(_mm_loadu_ps(y + i));
+        __m256d present = _mm256_and_pd(_mm256_cmp_pd(a, a, _CMP_ORD_Q), _mm256_cmp_pd(b, b, _CMP_ORD_Q));
+        a = _mm256_and_pd(a, present);
+        b = _mm256_and_pd(b, present);
+        count = _mm256_add_pd(count, _mm256_and_pd(one, present));
+        sumX = _mm256_add_pd(sumX, a);
+        sumY = _mm256_add_pd(sumY, b);
+        sumXX = _mm256_fmadd_pd(a, a, sumXX);
+        sumYY = _mm256_fmadd_pd(b, b, sumYY);
+        sumXY = _mm256_fmadd_pd(a, b, sumXY);
+    }
+    CoMoments m;
+    m.count = (uint64_t)horizontalSum(count);
+    m.sumX = horizontalSum(sumX);
+    m.sumY = horizontalSum(sumY);
+    m.sumXX = horizontalSum(sumXX);
+    m.sumYY = horizontalSum(sumYY);
+    m.sumXY = horizontalSum(sumXY);
+    out.merge(m);
+    scalarKernels().coMoments(x + i, y + i, n - i, out);
+}
+
+// Soma prefixada inclusiva dentro do vetor: [a, a+b, a+b+c, a+b+c+d]
+__m256d scanLanes(__m256d v) {
+    const __m256d zero = _mm256_setzero_pd();
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0b0001));
+    v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0b0011));
+    return v;
+}
+
+void prefixAvx2(const float* x, size_t n, double* s, double* s2, double* c) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    s[0] = s2[0] = c[0] = 0;
+    __m256d carryS = _mm256_setzero_pd();
+    __m256d carryS2 = _mm256_setzero_pd();
+    __m256d carryC = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_cvtps_pd(_mm_loadu_ps(x + i));
+        __m256d present = _mm256_cmp_pd(v, v, _CMP_ORD_Q);
+        v = _mm256_and_pd(v, present);
+        __m256d ps = _mm256_add_pd(scanLanes(v), carryS);
+        __m256d ps2 = _mm256_add_pd(scanLanes(_mm256_mul_pd(v, v)), carryS2);
+        __m256d pc = _mm256_add_pd(scanLanes(_mm256_and_pd(one, present)), carryC);
+        _mm256_storeu_pd(s + i + 1, ps);
+        _mm256_storeu_pd(s2 + i + 1, ps2);
+        _mm256_storeu_pd(c + i + 1, pc);
+        carryS = _mm256_permute4x64_pd(ps, _MM_SHUFFLE(3, 3, 3, 3));
+        carryS2 = _mm256_permute4x64_pd(ps2, _MM_SHUFFLE(3, 3, 3, 3));
+        carryC = _mm256_permute4x64_pd(pc, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    for (; i < n; i++) {
+        double v = x[i];
+        bool present = !isnan(v);
+        v = present ? v : 0;
+        s[i + 1] = s[i] + v;
+        s2[i + 1] = s2[i] + v * v;
+        c[i + 1] = c[i] + (present ? 1 : 0);
+    }
+}
+
+void windowAvx2(const double* s, const double* s2, const double* c, size_t first, size_t count,
+                size_t w, float* mean, float* stddev) {
+    // Janelas ainda incompletas (início da série): escalar
+    size_t head = first + 1 < w ? w - 1 - first : 0;
+    head = head < count ? head : count;
+    scalarKernels().window(s, s2, c, first, head, w, mean, stddev);
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d nan = _mm256_set1_pd(NAN);
+    size_t j = head;
+    for (; j + 4 <= count; j += 4) {
+        size_t hi = first + j + 1;
+        size_t lo = hi - w;
+        __m256d n = _mm256_sub_pd(_mm256_loadu_pd(c + hi), _mm256_loadu_pd(c + lo));
+        __m256d sum = _mm256_sub_pd(_mm256_loadu_pd(s + hi), _mm256_loadu_pd(s + lo));
+        __m256d sumSq = _mm256_sub_pd(_mm256_loadu_pd(s2 + hi), _mm256_loadu_pd(s2 + lo));
+        __m256d m = _mm256_div_pd(sum, n);
+        __m256d variance = _mm256_fnmadd_pd(m, m, _mm256_div_pd(sumSq, n));
+        __m256d sd = _mm256_sqrt_pd(_mm256_max_pd(variance, zero));
+        __m256d empty = _mm256_cmp_pd(n, zero, _CMP_LE_OQ);
+        _mm_storeu_ps(mean + j, _mm256_cvtpd_ps(_mm256_blendv_pd(m, nan, empty)));
+        _mm_storeu_ps(stddev + j, _mm256_cvtpd_ps(_mm256_blendv_pd(sd, nan, empty)));
+    }
+    scalarKernels().window(s, s2, c, first + j, count - j, w, mean + j, stddev + j);
+}
+
+// Nível de 8 linhas em int32 (0, 1 ou 2)
+__m256i levels8(const float* const inputs[ALERT_INPUTS], size_t i, const __m256 yellow[ALERT_INPUTS],
+                const __m256 red[ALERT_INPUTS]) {
+    __m256 isRed = _mm256_setzero_ps();
+    __m256 isYellow = _mm256_setzero_ps();
+    for (size_t k = 0; k < ALERT_INPUTS; k++) {
+        __m256 v = _mm256_loadu_ps(inputs[k] + i);
+        isRed = _mm256_or_ps(isRed, _mm256_cmp_ps(v, red[k], _CMP_GE_OQ));
+        isYellow = _mm256_or_ps(isYellow, _mm256_cmp_ps(v, yellow[k], _CMP_GE_OQ));
+    }
+    __m256i redBits = _mm256_and_si256(_mm256_castps_si256(isRed), _mm256_set1_epi32(2));
+    __m256i yellowBits = _mm256_andnot_si256(_mm256_castps_si256(isRed),
+                                             _mm256_and_si256(_mm256_castps_si256(isYellow), _mm256_set1_epi32(1)));
+    return _mm256_or_si256(redBits, yellowBits);
+}
+
+void levelsAvx2(const float* const inputs[ALERT_INPUTS], size_t n, const float yellow[ALERT_INPUTS],
+                const float red[ALERT_INPUTS], uint8_t* out) {
+    __m256 y[ALERT_INPUTS];
+    __m256 r[ALERT_INPUTS];
+    for (size_t k = 0; k < ALERT_INPUTS; k++) {
+        y[k] = _mm256_set1_ps(yellow[k]);
+        r[k] = _mm256_set1_ps(red[k]);
+    }
+    // 32 linhas por volta: 4 x 8 int32 empacotados em 32 bytes; os packs
+    // trabalham por metade de 128 bits, a permutação final restaura a ordem
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = levels8(inputs, i, y, r);
+        __m256i b = levels8(inputs, i + 8, y, r);
+        __m256i c = levels8(inputs, i + 16, y, r);
+        __m256i d = levels8(inputs, i + 24, y, r);
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    const float* rest[ALERT_INPUTS];
+    for (size_t k = 0; k < ALERT_INPUTS; k++) {
+        rest[k] = inputs[k] + i;
+    }
+    scalarKernels().levels(rest, n - i, yellow, red, out + i);
+}
+
+size_t boundariesAvx2(const uint8_t* level, const int64_t* timestampMs, size_t n, int64_t maxGapMs,
+                      uint32_t* out) {
+    const __m256i gap = _mm256_set1_epi64x(maxGapMs);
+    size_t found = 0;
+    size_t i = 1;
+    // 32 linhas por volta: mudança de nível por bytes e lacunas por int64
+    for (; i + 32 <= n; i += 32) {
+        __m256i current = _mm256_loadu_si256((const __m256i*)(level + i));
+        __m256i previous = _mm256_loadu_si256((const __m256i*)(level + i - 1));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(current, previous));
+        for (size_t k = 0; k < 8; k++) {
+            __m256i t = _mm256_loadu_si256((const __m256i*)(timestampMs + i + 4 * k));
+            __m256i before = _mm256_loadu_si256((const __m256i*)(timestampMs + i + 4 * k - 1));
+            __m256i late = _mm256_cmpgt_epi64(_mm256_sub_epi64(t, before), gap);
+            mask |= (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(late)) << (4 * k);
+        }
+        while (mask != 0) {
+            out[found++] = (uint32_t)(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    // Cauda: a referência a partir de i - 1, com as posições deslocadas
+    if (i < n) {
+        size_t tail = scalarKernels().boundaries(level + i - 1, timestampMs + i - 1, n - i + 1,
+                                                 maxGapMs, out + found);
+        for (size_t k = 0; k < tail; k++) {
+            out[found + k] += (uint32_t)(i - 1);
+        }
+        found += tail;
+    }
+    return found;
+}
+
+const Kernels AVX2 = {
+    "avx2", momentsAvx2, coMomentsAvx2, prefixAvx2, windowAvx2, levelsAvx2, boundariesAvx2,
+};
+
+}  // namespace
+
+const Kernels& avx2KernelTable() {
+    return AVX2;
+}
@@ -0,0 +1,239 @@
+#include "telemetry_table.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alert_level.h"
+#include "column_reader.h"
+#include "config.h"
+
+Channel channelByName(const char* name) {
+    for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+        if (strcmp(CHANNEL_NAMES[c], name) == 0) {
+            return (Channel)c;
+        }
+    }
+    return Channel::Count;
+}
+
+void TelemetryTable::reserve(size_t rows) {
+    timestampMs.reserve(rows);
+    for (std::vector<float>& channel : channels) {
+        channel.reserve(rows);
+    }
+    alertLevel.reserve(rows);
+}
+
+void TelemetryTable::clear() {
+    timestampMs.clear();
+    for (std::vector<float>& channel : channels) {
+        channel.clear();
+    }
+    alertLevel.clear();
+}
+
+// Número depois de "chave": na linha; NaN se ausente
+static float jsonNumber(const char* line, const char* key) {
+    const char* p = strstr(line, key);
+    if (p == nullptr) {
+        return NAN;
+    }
+    char* end;
+    float value = strtof(p + strlen(key), &end);
+    return end == p + strlen(key) ? NAN : value;
+}
+
+static bool parseIsoTimestamp(const char* text, int64_t& ms) {
+    struct tm tm = {};
+    if (sscanf(text, "%4d-%2d-%2dT%2d:%2d:%2d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    ms = (int64_t)timegm(&tm) * 1000;
+    return true;
+}
+
+bool loadJsonLines(const char* path, TelemetryTable& table, std::string& error) {
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (file == nullptr) {
+        error = std::string(path) + ": " + strerror(errno);
+        return false;
+    }
+    static const char* const KEYS[CHANNEL_COUNT] = {
+        "\"temperature\":", "\"humidity\":", "\"lux\":", "\"accelX\":", "\"accelY\":",
+        "\"accelZ\":", "\"rms\":", "\"peak\":",
+    };
+    static char line[4096];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        const char* stamp = strstr(line, "\"timestamp\":\"");
+        const char* level = strstr(line, "\"alert_level\":\"");
+        int64_t ms;
+        if (stamp == nullptr || level == nullptr || !parseIsoTimestamp(stamp + 13, ms)) {
+            continue;
+        }
+        uint8_t alert = (uint8_t)AlertLevel::Normal;
+        for (size_t l = 0; l < (size_t)AlertLevel::Count; l++) {
+            const char* name = alertLevelName((AlertLevel)l);
+            size_t len = strlen(name);
+            if (strncmp(level + 15, name, len) == 0 && level[15 + len] == '"') {
+                alert = (uint8_t)l;
+            }
+        }
+        table.timestampMs.push_back(ms);
+        for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+            table.channels[c].push_back(jsonNumber(line, KEYS[c]));
+        }
+        table.alertLevel.push_back(alert);
+    }
+    bool ok = !ferror(file);
+    if (!ok) {
+        error = std::string(path) + ": erro de leitura";
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+    return ok;
+}
+
+bool loadKatabaseStore(const char* root, const char* device, TelemetryTable& table,
+                       std::string& error) {
+    // Ids de "devices" ("<id> <nome>" por linha)
+    std::vector<std::string> names;
+    FILE* file = fopen((std::string(root) + "/devices").c_str(), "r");
+    if (file != nullptr) {
+        char line[128];
+        char name[96];
+        unsigned id;
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (sscanf(line, "%u %95s", &id, name) == 2 && id == names.size()) {
+                names.push_back(name);
+            }
+        }
+        fclose(file);
+    }
+    long wanted = names.size() == 1 && device == nullptr ? 0 : -1;
+    for (size_t i = 0; device != nullptr && i < names.size(); i++) {
+        if (names[i] == device) {
+            wanted = (long)i;
+        }
+    }
+    if (wanted < 0) {
+        error = device ? std::string("dispositivo desconhecido: ") + device
+                       : std::string("o armazenamento tem ") + std::to_string(names.size()) +
+                             " dispositivos; escolha um com --device";
+        return false;
+    }
+
+    TableReader reader;
+    if (!reader.open(root, "environment", ENV_COLUMNS, (size_t)EnvColumn::Count)) {
+        error = std::string(root) + "/environment: " + strerror(errno);
+        return false;
+    }
+    // Na ordem de Channel; os eixos não existem na tabela environment
+    static const char* const SOURCES[CHANNEL_COUNT] = {
+        "temperature", "humidity", "lux", nullptr, nullptr, nullptr, "vib_rms", "vib_peak",
+    };
+    ColumnReader time, deviceColumn, level, columns[CHANNEL_COUNT];
+    bool ok = reader.openColumn("received_ms", time) && reader.openColumn("device", deviceColumn) &&
+              reader.openColumn("alert_level", level);
+    for (size_t c = 0; ok && c < CHANNEL_COUNT; c++) {
+        ok = SOURCES[c] == nullptr || reader.openColumn(SOURCES[c], columns[c]);
+    }
+    if (!ok) {
+        error = std::string(root) + "/environment: " + strerror(errno);
+        return false;
+    }
+
+    table.reserve(reader.rows());
+    std::vector<uint8_t> times, devices, levels, values[CHANNEL_COUNT];
+    for (size_t b = 0; b < time.blocks(); b++) {
+        bool decoded = time.decode(b, times) && deviceColumn.decode(b, devices) && level.decode(b, levels);
+        for (size_t c = 0; decoded && c < CHANNEL_COUNT; c++) {
+            decoded = SOURCES[c] == nullptr || columns[c].decode(b, values[c]);
+        }
+        if (!decoded) {
+            error = std::string(root) + "/environment: bloco corrompido";
+            return false;
+        }
+        for (size_t i = 0; i < time.block(b).rows; i++) {
+            uint16_t id;
+            memcpy(&id, &devices[i * 2], 2);
+            if (id != wanted) {
+                continue;
+            }
+            uint64_t ms;
+            memcpy(&ms, &times[i * 8], 8);
+            table.timestampMs.push_back((int64_t)ms);
+            for (size_t c = 0; c < CHANNEL_COUNT; c++) {
+                float value = NAN;
+                if (SOURCES[c] != nullptr) {
+                    memcpy(&value, &values[c][i * 4], 4);
+                }
+                table.channels[c].push_back(value);
+            }
+            table.alertLevel.push_back(levels[i]);
+        }
+    }
+    return true;
+}
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Uniforme em [-1, 1)
+static float noise(uint32_t& state) {
+    return (float)(nextRandom(state) >> 8) / (1u << 23) - 1.0f;
+}
+
+void generateTelemetry(size_t rows, uint32_t seed, TelemetryTable& table) {
+    table.clear();
+    table.reserve(rows);
+    uint32_t rng = seed | 1;
+    const int64_t baseMs = 1767225600000LL;     // 2026-01-01 00:00 UTC
+    float heat = 0;                             // Episódio de aquecimento em curso
+    float burst = 0;                            // Rajada de vibração em curso
+    for (size_t i = 0; i < rows; i++) {
+        double day = (i % 86400) / 86400.0;
+        if (nextRandom(rng) % 20000 == 0) {
+            heat = 12 + 14 * (noise(rng) + 1) / 2;
+        }
+        if (nextRandom(rng) % 5000 == 0) {
+            burst = 0.2f + 0.5f * (noise(rng) + 1) / 2;
+        }
+        heat *= 0.999f;
+        burst *= 0.995f;
+
+        float temperature = roundf((24 + 3 * sin(2 * M_PI * day) + heat + 0.3f * noise(rng)) * 10) / 10;
+        float humidity = roundf((60 - 8 * sin(2 * M_PI * day) + heat + 0.5f * noise(rng)) * 10) / 10;
+        double light = sin(2 * M_PI * (day - 0.25));
+        float lux = light > 0 ? roundf(400 * light + 3 * noise(rng)) : 0;
+        float vibRms = 0.03f + burst + 0.005f * noise(rng);
+        float vibPeak = 1.0f + 2.5f * burst + 0.02f * noise(rng);
+
+        table.timestampMs.push_back(baseMs + (int64_t)i * 1000);
+        table.channels[(size_t)Channel::Temperature].push_back(temperature);
+        table.channels[(size_t)Channel::Humidity].push_back(humidity);
+        table.channels[(size_t)Channel::Lux].push_back(lux);
+        table.channels[(size_t)Channel::AccelX].push_back(0.02f * noise(rng));
+        table.channels[(size_t)Channel::AccelY].push_back(0.02f * noise(rng));
+        table.channels[(size_t)Channel::AccelZ].push_back(1.0f + 0.02f * noise(rng) + burst * noise(rng));
+        table.channels[(size_t)Channel::VibRms].push_back(vibRms);
+        table.channels[(size_t)Channel::VibPeak].push_back(vibPeak);
+        // Nível registrado: limiares fixos do firmware, sem histerese
+        uint8_t level = temperature >= TEMP_RED || humidity >= HUMIDITY_RED || vibRms >= VIB_RMS_RED ||
+                        vibPeak >= ACCEL_RED ? 2 :
+                        temperature >= TEMP_YELLOW || humidity >= HUMIDITY_YELLOW ||
+                        vibRms >= VIB_RMS_YELLOW || vibPeak >= ACCEL_YELLOW ? 1 : 0;
+        table.alertLevel.push_back(level);
+    }
+}
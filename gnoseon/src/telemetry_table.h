@@ -0,0 +1,61 @@
+#pragma once
+
+// Registros de telemetria em colunas contíguas (uma por grandeza), como os
+// kernels (kernels.h) os consomem. Os campos são os de sendJSONData() no
+// firmware; o que a fonte não traz fica NaN.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+enum class Channel : uint8_t {
+    Temperature,    // °C (dht22)
+    Humidity,       // % (dht22)
+    Lux,            // ldr
+    AccelX,         // g (mpu6050)
+    AccelY,
+    AccelZ,
+    VibRms,         // g, RMS dinâmico da janela de vibração
+    VibPeak,        // g, maior magnitude da janela
+    Count
+};
+
+constexpr const char* CHANNEL_NAMES[] = {
+    "temperature", "humidity", "lux", "accel_x", "accel_y", "accel_z", "vib_rms", "vib_peak",
+};
+
+static_assert(sizeof(CHANNEL_NAMES) / sizeof(CHANNEL_NAMES[0]) == (size_t)Channel::Count,
+              "CHANNEL_NAMES deve cobrir todos os canais");
+
+constexpr size_t CHANNEL_COUNT = (size_t)Channel::Count;
+
+// Canal pelo nome; Channel::Count se não existir
+Channel channelByName(const char* name);
+
+struct TelemetryTable {
+    std::vector<int64_t> timestampMs;
+    std::vector<float> channels[CHANNEL_COUNT];
+    std::vector<uint8_t> alertLevel;        // AlertLevel do firmware
+
+    size_t rows() const { return timestampMs.size(); }
+    const float* channel(Channel c) const { return channels[(size_t)c].data(); }
+
+    void reserve(size_t rows);
+    void clear();
+};
+
+// Linhas JSON de sendJSONData() (serial no modo JSON ou o firmware nativo);
+// linhas que não são registros são ignoradas. "-" lê a entrada padrão
+bool loadJsonLines(const char* path, TelemetryTable& table, std::string& error);
+
+// Tabela environment do armazenamento do katabase-ingest, de um
+// dispositivo (obrigatório se houver mais de um). Os eixos do acelerômetro
+// ficam na tabela accel, em kHz, e não entram aqui
+bool loadKatabaseStore(const char* root, const char* device, TelemetryTable& table,
+                       std::string& error);
+
+// Dados sintéticos para os benchmarks: uma leitura por segundo com ciclo
+// diário, vibração com rajadas e episódios de alerta
+void generateTelemetry(size_t rows, uint32_t seed, TelemetryTable& table);
@@ -0,0 +1,248 @@
+#include "column_codec.h"
+
+#include <string.h>
+
+namespace {
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    // Até 64 bits, do mais significativo para o menos
+    void put(uint64_t value, unsigned bits) {
+        while (bits > 0) {
+            if (used == 0) {
+                out.push_back(0);
+            }
+            unsigned take = bits < 8 - used ? bits : 8 - used;
+            uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+            out.back() |= (uint8_t)(chunk << (8 - used - take));
+            used = (used + take) % 8;
+            bits -= take;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    unsigned used = 0;      // Bits ocupados no último byte
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t bytes) : data(data), bits(bytes * 8) {}
+
+    uint64_t get(unsigned count) {
+        if (pos + count > bits) {
+            overrun = true;
+            pos = bits;
+            return 0;
+        }
+        uint64_t value = 0;
+        while (count > 0) {
+            unsigned offset = pos % 8;
+            unsigned take = count < 8 - offset ? count : 8 - offset;
+            uint8_t chunk = (uint8_t)(data[pos / 8] >> (8 - offset - take)) & ((1u << take) - 1);
+            value = (value << take) | chunk;
+            pos += take;
+            count -= take;
+        }
+        return value;
+    }
+
+    bool ok() const { return !overrun; }
+
+private:
+    const uint8_t* data;
+    size_t bits;
+    size_t pos = 0;
+    bool overrun = false;
+};
+
+uint64_t loadInteger(ColumnType type, const uint8_t* p) {
+    switch (type) {
+    case ColumnType::U8: return *p;
+    case ColumnType::U16: { uint16_t v; memcpy(&v, p, 2); return v; }
+    case ColumnType::I16: { int16_t v; memcpy(&v, p, 2); return (uint64_t)(int64_t)v; }
+    case ColumnType::U64: { uint64_t v; memcpy(&v, p, 8); return v; }
+    default: { uint32_t v; memcpy(&v, p, 4); return v; }
+    }
+}
+
+void storeInteger(ColumnType type, uint64_t value, uint8_t* p) {
+    switch (type) {
+    case ColumnType::U8: *p = (uint8_t)value; break;
+    case ColumnType::U16:
+    case ColumnType::I16: { uint16_t v = (uint16_t)value; memcpy(p, &v, 2); break; }
+    case ColumnType::U64: memcpy(p, &value, 8); break;
+    default: { uint32_t v = (uint32_t)value; memcpy(p, &v, 4); break; }
+    }
+}
+
+int64_t signExtend(uint64_t value, unsigned bits) {
+    uint64_t sign = 1ull << (bits - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+// Aritmética em módulo 2^64: deltas de u64 não estouram
+void encodeDeltaOfDelta(ColumnType type, const uint8_t* values, size_t rows, BitWriter& bits) {
+    size_t width = columnWidth(type);
+    uint64_t previous = loadInteger(type, values);
+    uint64_t previousDelta = 0;
+    bits.put(previous, 64);
+    for (size_t i = 1; i < rows; i++) {
+        uint64_t value = loadInteger(type, values + i * width);
+        uint64_t delta = value - previous;
+        int64_t dod = (int64_t)(delta - previousDelta);
+        if (dod == 0) {
+            bits.put(0, 1);
+        } else if (dod >= -64 && dod <= 63) {
+            bits.put(0b10, 2);
+            bits.put((uint64_t)dod, 7);
+        } else if (dod >= -256 && dod <= 255) {
+            bits.put(0b110, 3);
+            bits.put((uint64_t)dod, 9);
+        } else if (dod >= -2048 && dod <= 2047) {
+            bits.put(0b1110, 4);
+            bits.put((uint64_t)dod, 12);
+        } else if (dod >= INT32_MIN && dod <= INT32_MAX) {
+            bits.put(0b11110, 5);
+            bits.put((uint64_t)dod, 32);
+        } else {
+            bits.put(0b11111, 5);
+            bits.put((uint64_t)dod, 64);
+        }
+        previous = value;
+        previousDelta = delta;
+    }
+}
+
+bool decodeDeltaOfDelta(ColumnType type, BitReader& bits, size_t rows, uint8_t* values) {
+    size_t width = columnWidth(type);
+    uint64_t value = bits.get(64);
+    uint64_t delta = 0;
+    storeInteger(type, value, values);
+    for (size_t i = 1; i < rows && bits.ok(); i++) {
+        unsigned ones = 0;
+        while (ones < 5 && bits.get(1) == 1) {
+            ones++;
+        }
+        static const unsigned WIDTHS[] = {0, 7, 9, 12, 32, 64};
+        unsigned size = WIDTHS[ones];
+        if (size > 0) {
+            uint64_t raw = bits.get(size);
+            delta += size == 64 ? raw : (uint64_t)signExtend(raw, size);
+        }
+        value += delta;
+        storeInteger(type, value, values + i * width);
+    }
+    return bits.ok();
+}
+
+unsigned leadingZeros(uint32_t v) { return v == 0 ? 32 : __builtin_clz(v); }
+unsigned trailingZeros(uint32_t v) { return v == 0 ? 32 : __builtin_ctz(v); }
+
+void encodeGorilla(const uint8_t* values, size_t rows, BitWriter& bits) {
+    uint32_t previous;
+    memcpy(&previous, values, 4);
+    bits.put(previous, 32);
+    unsigned windowLeading = 33;    // Sem janela ainda
+    unsigned windowTrailing = 0;
+    for (size_t i = 1; i < rows; i++) {
+        uint32_t value;
+        memcpy(&value, values + i * 4, 4);
+        uint32_t x = value ^ previous;
+        previous = value;
+        if (x == 0) {
+            bits.put(0, 1);
+            continue;
+        }
+        unsigned leading = leadingZeros(x);
+        unsigned trailing = trailingZeros(x);
+        if (leading > 31) {
+            leading = 31;
+        }
+        if (windowLeading <= 32 && leading >= windowLeading && trailing >= windowTrailing) {
+            bits.put(0b10, 2);
+            bits.put(x >> windowTrailing, 32 - windowLeading - windowTrailing);
+            continue;
+        }
+        unsigned length = 32 - leading - trailing;
+        bits.put(0b11, 2);
+        bits.put(leading, 5);
+        bits.put(length - 1, 5);
+        bits.put(x >> trailing, length);
+        windowLeading = leading;
+        windowTrailing = trailing;
+    }
+}
+
+bool decodeGorilla(BitReader& bits, size_t rows, uint8_t* values) {
+    uint32_t value = (uint32_t)bits.get(32);
+    memcpy(values, &value, 4);
+    unsigned windowLeading = 0;
+    unsigned windowTrailing = 0;
+    for (size_t i = 1; i < rows && bits.ok(); i++) {
+        if (bits.get(1) == 1) {
+            if (bits.get(1) == 1) {
+                windowLeading = (unsigned)bits.get(5);
+                unsigned length = (unsigned)bits.get(5) + 1;
+                if (windowLeading + length > 32) {
+                    return false;
+                }
+                windowTrailing = 32 - windowLeading - length;
+            }
+            unsigned length = 32 - windowLeading - windowTrailing;
+            value ^= (uint32_t)bits.get(length) << windowTrailing;
+        }
+        memcpy(values + i * 4, &value, 4);
+    }
+    return bits.ok();
+}
+
+}  // namespace
+
+double columnValue(ColumnType type, const uint8_t* value) {
+    if (type == ColumnType::F32) {
+        float v;
+        memcpy(&v, value, 4);
+        return v;
+    }
+    if (type == ColumnType::I16) {
+        return (double)(int64_t)loadInteger(type, value);
+    }
+    return (double)loadInteger(type, value);
+}
+
+void encodeColumnBlock(ColumnType type, ColumnCodec codec, const uint8_t* values, size_t rows,
+                       std::vector<uint8_t>& out) {
+    if (rows == 0) {
+        return;
+    }
+    BitWriter bits(out);
+    if (codec == ColumnCodec::DeltaOfDelta && type != ColumnType::F32) {
+        encodeDeltaOfDelta(type, values, rows, bits);
+    } else if (codec == ColumnCodec::Gorilla && type == ColumnType::F32) {
+        encodeGorilla(values, rows, bits);
+    } else {
+        out.insert(out.end(), values, values + rows * columnWidth(type));
+    }
+}
+
+bool decodeColumnBlock(ColumnType type, ColumnCodec codec, const uint8_t* data, size_t bytes,
+                       size_t rows, uint8_t* values) {
+    if (rows == 0) {
+        return true;
+    }
+    BitReader bits(data, bytes);
+    if (codec == ColumnCodec::DeltaOfDelta && type != ColumnType::F32) {
+        return decodeDeltaOfDelta(type, bits, rows, values);
+    }
+    if (codec == ColumnCodec::Gorilla && type == ColumnType::F32) {
+        return decodeGorilla(bits, rows, values);
+    }
+    if (bytes < rows * columnWidth(type)) {
+        return false;
+    }
+    memcpy(values, data, rows * columnWidth(type));
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+// Compressão dos blocos de coluna do armazenamento (column_store.h), no
+// estilo do Gorilla (Pelkonen et al., VLDB 2015), em fluxo de bits:
+//
+// DeltaOfDelta (inteiros e instantes): primeiro valor em 64 bits; depois a
+// diferença entre deltas consecutivos, com prefixo de tamanho:
+//   0                 dod = 0
+//   10   + 7 bits     [-64, 63]
+//   110  + 9 bits     [-256, 255]
+//   1110 + 12 bits    [-2048, 2047]
+//   11110 + 32 bits
+//   11111 + 64 bits
+// Séries periódicas (relógio, índice de amostra, valores constantes) caem
+// quase todas em 1 bit por linha.
+//
+// Gorilla (f32): primeiro valor em 32 bits; depois o XOR com o anterior:
+//   0                               igual ao anterior
+//   10 + bits significativos        mesma janela de zeros do XOR anterior
+//   11 + 5 bits de zeros à esquerda + 5 bits de (tamanho - 1) + bits
+//
+// Os blocos são independentes: cada um recomeça do primeiro valor.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+enum class ColumnType : uint8_t {
+    U8,
+    U16,
+    U32,
+    U64,
+    I16,
+    F32
+};
+
+enum class ColumnCodec : uint8_t {
+    Raw,
+    DeltaOfDelta,
+    Gorilla
+};
+
+constexpr size_t columnWidth(ColumnType type) {
+    return type == ColumnType::U8 ? 1 :
+           type == ColumnType::U16 || type == ColumnType::I16 ? 2 :
+           type == ColumnType::U64 ? 8 : 4;
+}
+
+// Valor de largura fixa como número (inteiros sem perda até 2^53)
+double columnValue(ColumnType type, const uint8_t* value);
+
+// Acrescenta a out o bloco de rows valores de largura fixa
+void encodeColumnBlock(ColumnType type, ColumnCodec codec, const uint8_t* values, size_t rows,
+                       std::vector<uint8_t>& out);
+
+// Decodifica rows valores em values (rows * columnWidth(type) bytes); false
+// se o bloco terminar antes
+bool decodeColumnBlock(ColumnType type, ColumnCodec codec, const uint8_t* data, size_t bytes,
+                       size_t rows, uint8_t* values);
@@ -0,0 +1,176 @@
+#include "column_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() {
+    if (base != nullptr) {
+        munmap((void*)base, length);
+    }
+    base = nullptr;
+    length = 0;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    // Arquivo vazio: nada a mapear
+    if (st.st_size > 0) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        base = (const uint8_t*)p;
+        length = (size_t)st.st_size;
+    }
+    ::close(fd);
+    return true;
+}
+
+bool ColumnReader::open(const std::string& dir, const ColumnSpec& spec, uint64_t rows) {
+    columnSpec = spec;
+    std::string path = dir + "/" + spec.name;
+    if (!data.open(path) || !indexFile.open(path + ".idx")) {
+        return false;
+    }
+    index = (const BlockIndex*)indexFile.data();
+    size_t stored = indexFile.size() / sizeof(BlockIndex);
+    uint64_t covered = 0;
+    blockCount = 0;
+    while (blockCount < stored && covered < rows) {
+        const BlockIndex& entry = index[blockCount];
+        if (entry.firstRow != covered || entry.offset + entry.bytes > data.size()) {
+            break;
+        }
+        covered += entry.rows;
+        blockCount++;
+    }
+    if (covered != rows) {
+        fprintf(stderr, "%s: índice cobre %llu de %llu linhas\n", path.c_str(),
+                (unsigned long long)covered, (unsigned long long)rows);
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+bool ColumnReader::decode(size_t i, std::vector<uint8_t>& values) const {
+    const BlockIndex& entry = index[i];
+    values.resize((size_t)entry.rows * columnWidth(columnSpec.type));
+    return decodeColumnBlock(columnSpec.type, (ColumnCodec)entry.codec, data.data() + entry.offset,
+                             entry.bytes, entry.rows, values.data());
+}
+
+bool TableReader::open(const std::string& root, const char* name, const ColumnSpec* specs,
+                       size_t count) {
+    dir = root + "/" + name;
+    this->specs = specs;
+    specCount = count;
+    committed = 0;
+    int fd = ::open((dir + "/batches").c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    off_t whole = st.st_size - st.st_size % 8;
+    bool ok = whole == 0 || pread(fd, &committed, 8, whole - 8) == 8;
+    ::close(fd);
+    return ok;
+}
+
+const ColumnSpec* TableReader::find(const char* column) const {
+    for (size_t i = 0; i < specCount; i++) {
+        if (strcmp(specs[i].name, column) == 0) {
+            return &specs[i];
+        }
+    }
+    return nullptr;
+}
+
+bool TableReader::openColumn(const char* column, ColumnReader& reader) const {
+    const ColumnSpec* spec = find(column);
+    if (spec == nullptr) {
+        errno = ENOENT;
+        return false;
+    }
+    return reader.open(dir, *spec, committed);
+}
+
+bool aggregateRange(const ColumnReader& time, const ColumnReader& value, double from, double to,
+                    RangeAggregate& out) {
+    out = RangeAggregate();
+    out.min = INFINITY;
+    out.max = -INFINITY;
+    if (time.blocks() != value.blocks()) {
+        return false;
+    }
+    std::vector<uint8_t> times;
+    std::vector<uint8_t> values;
+    size_t timeWidth = columnWidth(time.spec().type);
+    size_t valueWidth = columnWidth(value.spec().type);
+    for (size_t b = 0; b < time.blocks(); b++) {
+        const BlockIndex& t = time.block(b);
+        const BlockIndex& v = value.block(b);
+        if (t.firstRow != v.firstRow || t.rows != v.rows) {
+            return false;
+        }
+        if (t.count == 0 || t.max < from || t.min >= to) {
+            out.blocksSkipped++;
+            continue;
+        }
+        // Bloco inteiro no intervalo: o índice da grandeza responde
+        if (t.count == t.rows && t.min >= from && t.max < to) {
+            out.blocksFromIndex++;
+            if (v.count > 0) {
+                out.count += v.count;
+                out.sum += v.sum;
+                out.min = v.min < out.min ? v.min : out.min;
+                out.max = v.max > out.max ? v.max : out.max;
+            }
+            continue;
+        }
+        out.blocksDecoded++;
+        if (!time.decode(b, times) || !value.decode(b, values)) {
+            return false;
+        }
+        for (size_t i = 0; i < t.rows; i++) {
+            double at = columnValue(time.spec().type, &times[i * timeWidth]);
+            if (!(at >= from && at < to)) {
+                continue;
+            }
+            double x = columnValue(value.spec().type, &values[i * valueWidth]);
+            if (isnan(x)) {
+                continue;
+            }
+            out.count++;
+            out.sum += x;
+            out.min = x < out.min ? x : out.min;
+            out.max = x > out.max ? x : out.max;
+        }
+    }
+    if (out.count == 0) {
+        out.min = out.max = 0;
+    }
+    return true;
+}
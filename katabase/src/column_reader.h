@@ -0,0 +1,117 @@
+#pragma once
+
+// Leitura do armazenamento colunar (column_store.h) por mmap.
+//
+// Uma tabela aberta só lê "batches"; cada coluna é mapeada quando pedida,
+// então agregar uma grandeza num intervalo toca apenas a coluna de tempo e
+// a dela. Blocos inteiramente dentro do intervalo são agregados só pelo
+// índice; apenas os das bordas são descomprimidos. Pode ser aberta com o
+// katabase-ingest escrevendo: vê os lotes confirmados até a abertura.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "column_store.h"
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool open(const std::string& path);
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    void close();
+
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+};
+
+class ColumnReader {
+public:
+    // Mapeia dir/<coluna> e o índice, até a linha rows
+    bool open(const std::string& dir, const ColumnSpec& spec, uint64_t rows);
+
+    const ColumnSpec& spec() const { return columnSpec; }
+    size_t blocks() const { return blockCount; }
+    const BlockIndex& block(size_t i) const { return index[i]; }
+    uint64_t storedBytes() const { return data.size(); }
+
+    // Valores do bloco i em largura fixa (block(i).rows * columnWidth)
+    bool decode(size_t i, std::vector<uint8_t>& values) const;
+
+private:
+    ColumnSpec columnSpec = {};
+    MappedFile data;
+    MappedFile indexFile;
+    const BlockIndex* index = nullptr;
+    size_t blockCount = 0;
+};
+
+class TableReader {
+public:
+    bool open(const std::string& root, const char* name, const ColumnSpec* specs, size_t count);
+
+    uint64_t rows() const { return committed; }
+    const ColumnSpec* find(const char* column) const;
+    bool openColumn(const char* column, ColumnReader& reader) const;
+
+private:
+    std::string dir;
+    const ColumnSpec* specs = nullptr;
+    size_t specCount = 0;
+    uint64_t committed = 0;
+};
+
+struct RangeAggregate {
+    uint64_t count = 0;     // Valores válidos (sem NaN)
+    double min = 0;
+    double max = 0;
+    double sum = 0;
+    size_t blocksFromIndex = 0;
+    size_t blocksDecoded = 0;
+    size_t blocksSkipped = 0;
+
+    double mean() const { return count > 0 ? sum / count : 0; }
+};
+
+// Linhas com from <= tempo < to. Colunas da mesma tabela (blocos alinhados)
+bool aggregateRange(const ColumnReader& time, const ColumnReader& value, double from, double to,
+                    RangeAggregate& out);
+
+// Chama fn(tempo, valor) para cada linha com from <= tempo < to, na ordem
+// do armazenamento (por lote, agrupada por dispositivo)
+template <typename Fn>
+bool scanRange(const ColumnReader& time, const ColumnReader& value, double from, double to, Fn fn) {
+    if (time.blocks() != value.blocks()) {
+        return false;
+    }
+    std::vector<uint8_t> times;
+    std::vector<uint8_t> values;
+    size_t timeWidth = columnWidth(time.spec().type);
+    size_t valueWidth = columnWidth(value.spec().type);
+    for (size_t b = 0; b < time.blocks(); b++) {
+        const BlockIndex& t = time.block(b);
+        if (t.count == 0 || t.max < from || t.min >= to) {
+            continue;
+        }
+        if (!time.decode(b, times) || !value.decode(b, values)) {
+            return false;
+        }
+        for (size_t i = 0; i < t.rows; i++) {
+            double at = columnValue(time.spec().type, &times[i * timeWidth]);
+            if (at >= from && at < to) {
+                fn(at, columnValue(value.spec().type, &values[i * valueWidth]));
+            }
+        }
+    }
+    return true;
+}
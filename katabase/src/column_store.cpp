@@ -0,0 +1,292 @@
+#include "column_store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+static bool makeDirectory(const std::string& path) {
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+ColumnTable::~ColumnTable() {
+    close();
+}
+
+void ColumnTable::close() {
+    for (Column& column : columns) {
+        if (column.fd >= 0) {
+            ::close(column.fd);
+        }
+        if (column.indexFd >= 0) {
+            ::close(column.indexFd);
+        }
+    }
+    columns.clear();
+    if (batchesFd >= 0) {
+        ::close(batchesFd);
+        batchesFd = -1;
+    }
+}
+
+bool ColumnTable::open(const std::string& root, const char* name, const ColumnSpec* specs,
+                       size_t count, size_t batchRows, size_t groupBy) {
+    close();
+    std::string dir = root + "/" + name;
+    if (!makeDirectory(dir)) {
+        return false;
+    }
+
+    // Último lote confirmado; um total escrito pela metade é descartado
+    batchesFd = ::open((dir + "/batches").c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    struct stat st;
+    if (batchesFd < 0 || fstat(batchesFd, &st) != 0) {
+        return false;
+    }
+    off_t whole = st.st_size - st.st_size % 8;
+    committed = 0;
+    if (whole > 0 && pread(batchesFd, &committed, 8, whole - 8) != 8) {
+        return false;
+    }
+    if (whole != st.st_size && ftruncate(batchesFd, whole) != 0) {
+        return false;
+    }
+
+    capacity = batchRows;
+    pendingRows = 0;
+    groupColumn = groupBy < count ? groupBy : NO_GROUPING;
+    for (size_t i = 0; i < count; i++) {
+        Column column = {specs[i], -1, -1, 0, {}};
+        std::string path = dir + "/" + specs[i].name;
+        column.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        column.indexFd = ::open((path + ".idx").c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        columns.push_back(column);
+        if (column.fd < 0 || column.indexFd < 0 || !recover(dir, columns.back())) {
+            return false;
+        }
+        columns.back().buffer.resize(batchRows * columnWidth(specs[i].type));
+    }
+    return true;
+}
+
+// Descarta os blocos além do último lote confirmado
+bool ColumnTable::recover(const std::string& dir, Column& column) {
+    struct stat st;
+    if (fstat(column.indexFd, &st) != 0) {
+        return false;
+    }
+    size_t stored = (size_t)st.st_size / sizeof(BlockIndex);
+    uint64_t rows = 0;
+    uint64_t end = 0;
+    size_t kept = 0;
+    BlockIndex entry;
+    while (kept < stored && rows < committed) {
+        if (pread(column.indexFd, &entry, sizeof(entry), (off_t)(kept * sizeof(entry))) !=
+            (ssize_t)sizeof(entry)) {
+            return false;
+        }
+        if (entry.firstRow != rows || rows + entry.rows > committed) {
+            break;
+        }
+        rows += entry.rows;
+        end = entry.offset + entry.bytes;
+        kept++;
+    }
+    if (fstat(column.fd, &st) != 0) {
+        return false;
+    }
+    if (rows != committed || (uint64_t)st.st_size < end) {
+        fprintf(stderr, "%s/%s: %llu linhas em %zu blocos, esperado %llu\n", dir.c_str(),
+                column.spec.name, (unsigned long long)rows, kept, (unsigned long long)committed);
+        errno = EINVAL;
+        return false;
+    }
+    if (kept < stored && ftruncate(column.indexFd, (off_t)(kept * sizeof(entry))) != 0) {
+        return false;
+    }
+    if ((uint64_t)st.st_size > end && ftruncate(column.fd, (off_t)end) != 0) {
+        return false;
+    }
+    column.size = end;
+    return true;
+}
+
+uint64_t ColumnTable::storedBytes() const {
+    uint64_t total = 0;
+    for (const Column& column : columns) {
+        total += column.size;
+    }
+    return total;
+}
+
+bool ColumnTable::writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Ordenação estável pelo valor do grupo, aplicada a todas as colunas
+void ColumnTable::group() {
+    const Column& key = columns[groupColumn];
+    ColumnType type = key.spec.type;
+    size_t keyWidth = columnWidth(type);
+    order.resize(pendingRows);
+    for (size_t i = 0; i < pendingRows; i++) {
+        order[i] = (uint32_t)i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return columnValue(type, &key.buffer[a * keyWidth]) < columnValue(type, &key.buffer[b * keyWidth]);
+    });
+    for (Column& column : columns) {
+        size_t width = columnWidth(column.spec.type);
+        scratch.resize(pendingRows * width);
+        for (size_t i = 0; i < pendingRows; i++) {
+            memcpy(&scratch[i * width], &column.buffer[order[i] * width], width);
+        }
+        memcpy(column.buffer.data(), scratch.data(), scratch.size());
+    }
+}
+
+bool ColumnTable::flush(bool sync) {
+    if (pendingRows == 0) {
+        return true;
+    }
+    if (groupColumn != NO_GROUPING) {
+        group();
+    }
+    for (Column& column : columns) {
+        size_t width = columnWidth(column.spec.type);
+        encoded.clear();
+        entries.clear();
+        for (size_t first = 0; first < pendingRows; first += STORE_BLOCK_ROWS) {
+            size_t rows = pendingRows - first < STORE_BLOCK_ROWS ? pendingRows - first : STORE_BLOCK_ROWS;
+            const uint8_t* values = &column.buffer[first * width];
+            BlockIndex entry = {};
+            entry.firstRow = committed + first;
+            entry.offset = column.size + encoded.size();
+            entry.rows = (uint32_t)rows;
+            entry.codec = (uint8_t)column.spec.codec;
+            entry.min = INFINITY;
+            entry.max = -INFINITY;
+            for (size_t i = 0; i < rows; i++) {
+                double v = columnValue(column.spec.type, values + i * width);
+                if (isnan(v)) {
+                    continue;
+                }
+                entry.count++;
+                entry.min = v < entry.min ? v : entry.min;
+                entry.max = v > entry.max ? v : entry.max;
+                entry.sum += v;
+            }
+            size_t before = encoded.size();
+            encodeColumnBlock(column.spec.type, column.spec.codec, values, rows, encoded);
+            entry.bytes = (uint32_t)(encoded.size() - before);
+            entries.push_back(entry);
+        }
+        // Dados antes do índice: um índice nunca aponta além dos dados
+        if (!writeAll(column.fd, encoded.data(), encoded.size()) ||
+            !writeAll(column.indexFd, (const uint8_t*)entries.data(), entries.size() * sizeof(BlockIndex)) ||
+            (sync && (fdatasync(column.fd) != 0 || fdatasync(column.indexFd) != 0))) {
+            return false;
+        }
+        column.size += encoded.size();
+    }
+    uint64_t total = committed + pendingRows;
+    if (!writeAll(batchesFd, (const uint8_t*)&total, sizeof(total)) ||
+        (sync && fdatasync(batchesFd) != 0)) {
+        return false;
+    }
+    committed = total;
+    pendingRows = 0;
+    return true;
+}
+
+bool TelemetryStore::open(const std::string& root, size_t envBatchRows, size_t accelBatchRows) {
+    this->root = root;
+    if (!makeDirectory(root)) {
+        return false;
+    }
+    names.clear();
+    FILE* file = fopen((root + "/devices").c_str(), "r");
+    if (file != nullptr) {
+        char line[128];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            char name[96];
+            unsigned id;
+            if (sscanf(line, "%u %95s", &id, name) == 2 && id == names.size()) {
+                names.push_back(name);
+            }
+        }
+        fclose(file);
+    }
+    return environment.open(root, "environment", ENV_COLUMNS, (size_t)EnvColumn::Count, envBatchRows,
+                            (size_t)EnvColumn::Device) &&
+           accel.open(root, "accel", ACCEL_COLUMNS, (size_t)AccelColumn::Count, accelBatchRows,
+                      (size_t)AccelColumn::Device);
+}
+
+uint16_t TelemetryStore::device(const char* name) {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) {
+            return (uint16_t)i;
+        }
+    }
+    if (names.size() >= 0xFFFF) {
+        return 0xFFFF;
+    }
+    FILE* file = fopen((root + "/devices").c_str(), "a");
+    if (file == nullptr) {
+        return 0xFFFF;
+    }
+    fprintf(file, "%zu %s\n", names.size(), name);
+    fclose(file);
+    names.push_back(name);
+    return (uint16_t)(names.size() - 1);
+}
+
+void TelemetryStore::appendEnvironment(uint16_t device, uint16_t seq, uint64_t receivedMs,
+                                       const EnvironmentRecord& r) {
+    size_t row = environment.append();
+    environment.set((size_t)EnvColumn::ReceivedMs, row, receivedMs);
+    environment.set((size_t)EnvColumn::Device, row, device);
+    environment.set((size_t)EnvColumn::Seq, row, seq);
+    environment.set((size_t)EnvColumn::DeviceMs, row, r.timestampMs);
+    environment.set((size_t)EnvColumn::Temperature, row, r.temperature);
+    environment.set((size_t)EnvColumn::Humidity, row, r.humidity);
+    environment.set((size_t)EnvColumn::Lux, row, r.lux);
+    environment.set((size_t)EnvColumn::LdrRaw, row, r.ldrRaw);
+    environment.set((size_t)EnvColumn::AlertLevel, row, r.alertLevel);
+    environment.set((size_t)EnvColumn::Scenario, row, r.scenario);
+    environment.set((size_t)EnvColumn::Step, row, r.step);
+    environment.set((size_t)EnvColumn::VibRms, row, r.vibrationRms);
+    environment.set((size_t)EnvColumn::VibPeak, row, r.peakMagnitude);
+}
+
+void TelemetryStore::appendAccel(uint16_t device, const AccelBlock& block) {
+    for (uint16_t i = 0; i < block.count; i++) {
+        size_t row = accel.append();
+        accel.set((size_t)AccelColumn::Device, row, device);
+        accel.set((size_t)AccelColumn::SampleIndex, row, block.firstIndex + i);
+        accel.set((size_t)AccelColumn::DeviceMs, row, block.timestampMs);
+        accel.set((size_t)AccelColumn::X, row, block.samples[i].x);
+        accel.set((size_t)AccelColumn::Y, row, block.samples[i].y);
+        accel.set((size_t)AccelColumn::Z, row, block.samples[i].z);
+    }
+}
+
+bool TelemetryStore::flush(bool sync) {
+    return environment.flush(sync) && accel.flush(sync);
+}
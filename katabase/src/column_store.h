@@ -0,0 +1,200 @@
+#pragma once
+
+// Armazenamento colunar comprimido, só de acréscimo, da telemetria coletada.
+//
+// Cada tabela é um diretório com dois arquivos por coluna e o arquivo
+// "batches", com o total acumulado de linhas (u64) ao fim de cada lote. As
+// linhas de um lote são reagrupadas pela coluna de agrupamento (o
+// dispositivo), preservando a ordem de chegada dentro do grupo, para que os
+// codecs vejam séries contínuas e não leituras intercaladas da frota. O
+// lote é então dividido em blocos de até STORE_BLOCK_ROWS linhas, alinhados entre
+// as colunas (o bloco i cobre as mesmas linhas em todas); cada bloco é
+// comprimido pelo codec da coluna (column_codec.h) e acrescentado a
+// <coluna>, e sua entrada de índice (BlockIndex: linhas, posição, mínimo,
+// máximo e soma) a <coluna>.idx. Só depois o lote entra em "batches"; na
+// abertura, blocos além do último total (lote interrompido) são truncados.
+//
+// Ler uma grandeza é ler os dois arquivos dela, sem tocar nas demais, e o
+// índice basta para agregar os blocos inteiros num intervalo
+// (column_reader.h).
+//
+//   <raiz>/devices                     "<id> <nome>" por linha
+//   <raiz>/environment/<coluna>[.idx]  uma linha por leitura ambiental
+//   <raiz>/accel/<coluna>[.idx]        uma linha por amostra do acelerômetro
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "column_codec.h"
+#include "telemetry_frame.h"
+
+constexpr size_t STORE_BLOCK_ROWS = 4096;
+
+struct ColumnSpec {
+    const char* name;
+    ColumnType type;
+    ColumnCodec codec;
+};
+
+// Entrada de <coluna>.idx, little-endian como os dados. Estatísticas
+// ignoram NaN (count é o número de valores válidos)
+struct BlockIndex {
+    uint64_t firstRow;
+    uint64_t offset;        // Em <coluna>
+    uint32_t rows;
+    uint32_t bytes;
+    uint32_t count;
+    uint8_t codec;          // ColumnCodec
+    uint8_t reserved[3];
+    double min;
+    double max;
+    double sum;
+};
+
+static_assert(sizeof(BlockIndex) == 56, "BlockIndex faz parte do formato em disco");
+
+enum class EnvColumn : uint8_t {
+    ReceivedMs,     // u64, relógio do coletor (ms desde a época Unix)
+    Device,         // u16, id em "devices"
+    Seq,            // u16
+    DeviceMs,       // u32, relógio do dispositivo
+    Temperature,    // f32
+    Humidity,       // f32
+    Lux,            // f32
+    LdrRaw,         // u16
+    AlertLevel,     // u8
+    Scenario,       // u8
+    Step,           // u8
+    VibRms,         // f32
+    VibPeak,        // f32
+    Count
+};
+
+constexpr ColumnCodec DOD = ColumnCodec::DeltaOfDelta;
+constexpr ColumnCodec XOR = ColumnCodec::Gorilla;
+
+constexpr ColumnSpec ENV_COLUMNS[] = {
+    {"received_ms", ColumnType::U64, DOD}, {"device", ColumnType::U16, DOD},
+    {"seq", ColumnType::U16, DOD}, {"device_ms", ColumnType::U32, DOD},
+    {"temperature", ColumnType::F32, XOR}, {"humidity", ColumnType::F32, XOR},
+    {"lux", ColumnType::F32, XOR}, {"ldr_raw", ColumnType::U16, DOD},
+    {"alert_level", ColumnType::U8, DOD}, {"scenario", ColumnType::U8, DOD},
+    {"step", ColumnType::U8, DOD}, {"vib_rms", ColumnType::F32, XOR},
+    {"vib_peak", ColumnType::F32, XOR},
+};
+
+static_assert(sizeof(ENV_COLUMNS) / sizeof(ENV_COLUMNS[0]) == (size_t)EnvColumn::Count,
+              "ENV_COLUMNS deve cobrir todas as colunas");
+
+enum class AccelColumn : uint8_t {
+    Device,         // u16
+    SampleIndex,    // u32, desde o boot do dispositivo
+    DeviceMs,       // u32, instante do bloco
+    X,              // i16, 16384 LSB/g
+    Y,
+    Z,
+    Count
+};
+
+constexpr ColumnSpec ACCEL_COLUMNS[] = {
+    {"device", ColumnType::U16, DOD}, {"sample_index", ColumnType::U32, DOD},
+    {"device_ms", ColumnType::U32, DOD}, {"x", ColumnType::I16, DOD},
+    {"y", ColumnType::I16, DOD}, {"z", ColumnType::I16, DOD},
+};
+
+static_assert(sizeof(ACCEL_COLUMNS) / sizeof(ACCEL_COLUMNS[0]) == (size_t)AccelColumn::Count,
+              "ACCEL_COLUMNS deve cobrir todas as colunas");
+
+class ColumnTable {
+public:
+    ColumnTable() = default;
+    ColumnTable(const ColumnTable&) = delete;
+    ColumnTable& operator=(const ColumnTable&) = delete;
+    ~ColumnTable();
+
+    // Cria ou reabre root/name com lotes de até batchRows linhas,
+    // agrupados pela coluna groupBy (nenhuma com NO_GROUPING); false com
+    // errno em caso de erro
+    bool open(const std::string& root, const char* name, const ColumnSpec* specs,
+              size_t count, size_t batchRows, size_t groupBy);
+
+    static constexpr size_t NO_GROUPING = SIZE_MAX;
+
+    // Nova linha no lote (só com room(1)); os valores vêm por set()
+    size_t append() { return pendingRows++; }
+
+    template <typename T>
+    void set(size_t column, size_t row, T value) {
+        assert(sizeof(T) == columnWidth(columns[column].spec.type));
+        memcpy(&columns[column].buffer[row * sizeof(T)], &value, sizeof(T));
+    }
+
+    bool room(size_t rows) const { return pendingRows + rows <= capacity; }
+    size_t pending() const { return pendingRows; }
+
+    // Escreve o lote pendente; sync: fdatasync antes de confirmar o lote
+    bool flush(bool sync);
+
+    uint64_t rows() const { return committed; }
+    // Bytes comprimidos nos arquivos de dados
+    uint64_t storedBytes() const;
+
+private:
+    struct Column {
+        ColumnSpec spec;
+        int fd;
+        int indexFd;
+        uint64_t size;                  // Bytes em <coluna>
+        std::vector<uint8_t> buffer;    // Lote pendente, largura fixa
+    };
+
+    bool recover(const std::string& dir, Column& column);
+    void group();
+    bool writeAll(int fd, const uint8_t* data, size_t len);
+    void close();
+
+    std::vector<Column> columns;
+    int batchesFd = -1;
+    size_t capacity = 0;
+    size_t pendingRows = 0;
+    uint64_t committed = 0;
+    size_t groupColumn = NO_GROUPING;
+    // Reaproveitados a cada lote
+    std::vector<uint32_t> order;
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> encoded;
+    std::vector<BlockIndex> entries;
+};
+
+class TelemetryStore {
+public:
+    bool open(const std::string& root, size_t envBatchRows, size_t accelBatchRows);
+
+    // Id persistente do dispositivo, registrado na primeira vez; 0xFFFF se
+    // o limite de ids foi atingido
+    uint16_t device(const char* name);
+
+    // Só com !full(): o chamador decide quando esvaziar os lotes
+    void appendEnvironment(uint16_t device, uint16_t seq, uint64_t receivedMs,
+                           const EnvironmentRecord& record);
+    void appendAccel(uint16_t device, const AccelBlock& block);
+
+    // Sem espaço para mais um quadro de qualquer tipo
+    bool full() const { return !environment.room(1) || !accel.room(ACCEL_BLOCK_SAMPLES); }
+    bool flush(bool sync);
+
+    const ColumnTable& environmentTable() const { return environment; }
+    const ColumnTable& accelTable() const { return accel; }
+    size_t devices() const { return names.size(); }
+
+private:
+    std::string root;
+    std::vector<std::string> names;
+    ColumnTable environment;
+    ColumnTable accel;
+};
@@ -0,0 +1,42 @@
+#include "frame_stream.h"
+
+bool FrameStream::frame(size_t len) {
+    size_t n = len > 0 ? cobsDecode(encoded, len, payload) : 0;
+    if (n == 0 || !decodeFrame(payload, n, decoded)) {
+        counters.badFrames++;
+        return false;
+    }
+
+    counters.frames++;
+    // Reinício: a sequência volta a 0 fora da virada de 0xFFFF, ou o
+    // first_index anda para trás. As referências são refeitas sem contar
+    // quadros ou amostras perdidos (uma lacuna que termine exatamente no 0
+    // também conta como reinício).
+    bool seqRestart = haveSeq && decoded.seq == 0 && lastSeq != 0xFFFF;
+    bool indexRestart = decoded.type == FrameType::AccelBlock && haveIndex &&
+                        (int32_t)(decoded.accel.firstIndex - nextIndex) < 0;
+    if (seqRestart || indexRestart) {
+        counters.restarts++;
+        haveSeq = false;
+        haveIndex = false;
+    }
+    if (haveSeq && decoded.seq != (uint16_t)(lastSeq + 1)) {
+        counters.seqGaps += (uint16_t)(decoded.seq - lastSeq - 1);
+    }
+    haveSeq = true;
+    lastSeq = decoded.seq;
+
+    if (decoded.type == FrameType::AccelBlock) {
+        const AccelBlock& block = decoded.accel;
+        counters.accelFrames++;
+        counters.accelSamples += block.count;
+        if (haveIndex && block.firstIndex != nextIndex) {
+            counters.lostSamples += block.firstIndex - nextIndex;
+        }
+        haveIndex = true;
+        nextIndex = block.firstIndex + block.count;
+    } else {
+        counters.envFrames++;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// Separação e validação dos quadros binários de um fluxo de bytes (ver
+// mnemon/include/telemetry_frame.h): delimitadores 0x00, COBS, CRC-32,
+// lacunas de sequência e de índice das amostras. Um dispositivo que reinicia
+// recomeça sequência e first_index do zero; isso é contado como reinício e
+// não como perda. O estado de um fluxo tem
+// tamanho fixo e nada é alocado por quadro; o katabase-decode usa um fluxo,
+// o katabase-ingest um por dispositivo conectado.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "telemetry_frame.h"
+
+struct StreamStats {
+    uint64_t frames = 0;
+    uint64_t accelFrames = 0;
+    uint64_t accelSamples = 0;
+    uint64_t envFrames = 0;
+    uint64_t badFrames = 0;       // COBS inválido, CRC ou tamanho incorreto
+    uint64_t seqGaps = 0;         // Quadros perdidos segundo a sequência
+    uint64_t lostSamples = 0;     // Amostras perdidas segundo first_index
+    uint64_t restarts = 0;        // Dispositivo reiniciado: sequência ou first_index recomeçou
+};
+
+class FrameStream {
+public:
+    // Chama onFrame(const DecodedFrame&) para cada quadro válido; o quadro
+    // só vale durante a chamada
+    template <typename Handler>
+    void feed(const uint8_t* data, size_t len, Handler&& onFrame) {
+        for (size_t i = 0; i < len; i++) {
+            if (data[i] != 0) {
+                // Quadro maior que o máximo: descarta até o próximo delimitador
+                if (length < sizeof(encoded)) {
+                    encoded[length] = data[i];
+                }
+                length++;
+                continue;
+            }
+            if (length > 0 && frame(length <= sizeof(encoded) ? length : 0)) {
+                onFrame(decoded);
+            }
+            length = 0;
+        }
+    }
+
+    const StreamStats& stats() const { return counters; }
+
+private:
+    bool frame(size_t len);
+
+    uint8_t encoded[FRAME_MAX_ENCODED];
+    uint8_t payload[FRAME_MAX_ENCODED];
+    size_t length = 0;
+    DecodedFrame decoded;
+    StreamStats counters;
+    bool haveSeq = false;
+    uint16_t lastSeq = 0;
+    bool haveIndex = false;
+    uint32_t nextIndex = 0;
+};
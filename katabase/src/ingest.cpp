@@ -0,0 +1,915 @@
+// katabase-ingest: recebe a telemetria binária de muitos dispositivos ao
+// mesmo tempo e grava em lotes no armazenamento colunar (column_store.h).
+//
+//   katabase-ingest [--store DIR] [--port N] [--serial PORTA=NOME]... [--baud N]
+//                   [--flush-ms N] [--sync] [--max-devices N] [--stats-s N]
+//   katabase-ingest --check-uplink
+//
+// Um único laço de eventos (epoll) atende o socket de escuta, as conexões
+// TCP, as portas seriais, o timer de lotes e os sinais. Cada dispositivo tem
+// um FrameStream de tamanho fixo; os quadros vão direto para os buffers do
+// lote, sem alocação por registro.
+//
+// Protocolo TCP: a primeira linha identifica a conexão e o resto é o mesmo
+// fluxo de quadros COBS da serial (mnemon --binary):
+//   "KATABASE <dispositivo>\n" + quadros
+//   "KATABASE <dispositivo> BATCH <boot>\n" + lotes do uplink (uplink_batch.h)
+//   "STATS\n"                    uma linha JSON com os contadores, e fecha
+//
+// Cada lote do uplink é conferido (CRC, gzip), seus quadros entram no lote
+// aberto do armazenamento e o "ACK <id>" sai depois que esse lote estiver
+// gravado. Um lote reenviado (ACK perdido) traz registros já gravados: os
+// que não forem posteriores ao último registro do dispositivo no mesmo boot
+// são descartados e contados.
+//
+// Latência de ingestão: da leitura do socket que completou o quadro até o
+// lote que o contém estar escrito (e sincronizado, com --sync).
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "column_store.h"
+#include "crc32.h"
+#include "frame_stream.h"
+#include "gzip.h"
+#include "serial_port.h"
+#include "uplink_batch.h"
+
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t wallMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Histograma log-linear em µs: quatro sub-faixas por potência de 2, como o
+// StageHistogram do firmware (percentis até 25% acima do valor real)
+class LatencyHistogram {
+public:
+    void record(uint64_t us) {
+        counts[bucketOf(us)]++;
+        total++;
+        if (us > maxUs) maxUs = us;
+    }
+
+    uint64_t percentile(double p) const {
+        uint64_t target = (uint64_t)(p * total);
+        uint64_t seen = 0;
+        for (uint32_t b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen > target) {
+                uint64_t upper = bucketUpper(b);
+                return upper < maxUs ? upper : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxUs; }
+
+private:
+    static const uint32_t SUB = 4;
+    static const uint32_t BUCKETS = SUB + 40 * SUB;
+
+    static uint32_t bucketOf(uint64_t us) {
+        if (us < SUB) {
+            return (uint32_t)us;
+        }
+        uint32_t exponent = 63 - __builtin_clzll(us);
+        uint32_t sub = (us >> (exponent - 2)) & (SUB - 1);
+        uint32_t bucket = SUB + (exponent - 2) * SUB + sub;
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+
+    static uint64_t bucketUpper(uint32_t bucket) {
+        if (bucket < SUB) {
+            return bucket;
+        }
+        uint32_t exponent = (bucket - SUB) / SUB + 2;
+        uint32_t sub = (bucket - SUB) % SUB;
+        return ((uint64_t)(SUB + sub + 1) << (exponent - 2)) - 1;
+    }
+
+    uint64_t counts[BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t maxUs = 0;
+};
+
+enum class ConnectionState : uint8_t {
+    Free,
+    Hello,      // Esperando a linha de identificação
+    Frames,
+    Batches     // Lotes do uplink
+};
+
+struct Connection {
+    int fd = -1;
+    ConnectionState state = ConnectionState::Free;
+    bool serial = false;
+    uint16_t device = 0;
+    char hello[112];
+    size_t helloLength = 0;
+    FrameStream stream;
+    std::vector<uint8_t> batch;         // Cabeçalho + corpo em montagem
+    size_t batchUsed = 0;
+    uint32_t ackId = 0;                 // Último lote no lote aberto do armazenamento
+    bool ackPending = false;
+};
+
+// Deduplicação dos lotes reenviados, por dispositivo
+struct UplinkDevice {
+    uint32_t boot = 0;
+    bool haveLast = false;
+    uint32_t lastMs = 0;                // Último registro ambiental gravado
+};
+
+struct IngestOptions {
+    std::string store = "katabase-data";
+    int port = 7878;
+    std::vector<std::string> serials;   // PORTA=NOME
+    long baud = 115200;
+    uint32_t flushMs = 250;
+    bool sync = false;
+    size_t maxDevices = 1024;
+    uint32_t statsSeconds = 10;
+    size_t envBatchRows = 8192;
+    size_t accelBatchRows = 262144;
+};
+
+// Marcas no epoll_event.data além dos índices de conexão
+const uint64_t EVENT_LISTEN = UINT64_MAX;
+const uint64_t EVENT_TIMER = UINT64_MAX - 1;
+const uint64_t EVENT_SIGNAL = UINT64_MAX - 2;
+
+class IngestServer {
+public:
+    explicit IngestServer(const IngestOptions& options) : options(options) {}
+
+    bool begin();
+    int run();
+    int checkUplink();
+
+private:
+    bool prepare();
+    bool addSerial(const std::string& spec);
+    void acceptAll();
+    size_t attach(int fd);
+    void readable(Connection& connection);
+    bool hello(Connection& connection, const uint8_t* data, size_t len, size_t& used);
+    void frames(Connection& connection, const uint8_t* data, size_t len, uint64_t arrivalNs);
+    bool uplinkData(Connection& connection, const uint8_t* data, size_t len, uint64_t arrivalNs);
+    bool storeBatch(Connection& connection, const BatchHeader& header, uint64_t arrivalNs);
+    bool append(Connection& connection, const DecodedFrame& frame, uint64_t receivedMs, uint64_t arrivalNs);
+    void close(Connection& connection);
+    bool writeBatch();
+    void flush();
+    void acknowledge();
+    void tick();
+    StreamStats totals() const;
+    size_t writeStats(char* out, size_t size) const;
+    void printStats(const char* prefix);
+
+    IngestOptions options;
+    TelemetryStore store;
+    int epollFd = -1;
+    int listenFd = -1;
+    int timerFd = -1;
+    int signalFd = -1;
+    std::vector<Connection> connections;
+    std::vector<size_t> freeSlots;
+    std::vector<uint64_t> pendingArrivalNs;     // Um por quadro no lote aberto
+    std::vector<size_t> ackSlots;               // Conexões com ACK a enviar após a gravação
+    std::vector<UplinkDevice> uplinkDevices;
+    LatencyHistogram latency;
+    StreamStats closedTotals;
+    uint64_t startNs = 0;
+    uint64_t lastStatsNs = 0;
+    uint64_t lastStatsFrames = 0;
+    uint64_t lastStatsSamples = 0;
+    uint64_t connectionsTotal = 0;
+    uint64_t rejected = 0;                      // Acima de --max-devices ou identificação inválida
+    uint64_t batches = 0;
+    uint64_t writeErrors = 0;
+    uint64_t dropped = 0;                       // Quadros descartados com o lote cheio
+    uint64_t uplinkBatches = 0;
+    uint64_t uplinkDuplicates = 0;              // Registros de lotes reenviados já gravados
+    uint64_t badBatches = 0;                    // Cabeçalho, CRC ou gzip inválido (conexão fechada)
+    size_t active = 0;
+    bool stopping = false;
+    uint32_t failWrites = 0;                    // --check-uplink: gravações que falham
+};
+
+static bool validDeviceName(const char* name) {
+    if (*name == '\0' || strlen(name) > 63) {
+        return false;
+    }
+    for (const char* c = name; *c; c++) {
+        bool ok = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') ||
+                  *c == '-' || *c == '_' || *c == '.';
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Armazenamento, tabela de conexões e epoll
+bool IngestServer::prepare() {
+    if (!store.open(options.store, options.envBatchRows, options.accelBatchRows)) {
+        fprintf(stderr, "%s: %s\n", options.store.c_str(), strerror(errno));
+        return false;
+    }
+    // Pior caso de um lote: um quadro por linha
+    pendingArrivalNs.reserve(options.envBatchRows + options.accelBatchRows);
+
+    connections.resize(options.maxDevices + options.serials.size());
+    for (size_t i = connections.size(); i > 0; i--) {
+        freeSlots.push_back(i - 1);
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    return true;
+}
+
+bool IngestServer::begin() {
+    if (!prepare()) {
+        return false;
+    }
+
+    // IPv6 com IPv4 mapeado; só IPv4 se o kernel não tiver IPv6
+    listenFd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    bool ipv6 = listenFd >= 0;
+    if (!ipv6) {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    if (epollFd < 0 || listenFd < 0) {
+        perror("socket");
+        return false;
+    }
+    int on = 1, off = 0;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    int bound;
+    if (ipv6) {
+        setsockopt(listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        struct sockaddr_in6 addr = {};
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = htons(options.port);
+        bound = bind(listenFd, (struct sockaddr*)&addr, sizeof(addr));
+    } else {
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(options.port);
+        bound = bind(listenFd, (struct sockaddr*)&addr, sizeof(addr));
+    }
+    if (bound != 0 || listen(listenFd, 1024) != 0) {
+        fprintf(stderr, "porta %d: %s\n", options.port, strerror(errno));
+        return false;
+    }
+
+    // Timer dos lotes e sinais de parada entram no mesmo laço
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    struct itimerspec period = {};
+    period.it_interval.tv_sec = options.flushMs / 1000;
+    period.it_interval.tv_nsec = (long)(options.flushMs % 1000) * 1000000;
+    period.it_value = period.it_interval;
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+    signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (timerFd < 0 || signalFd < 0 || timerfd_settime(timerFd, 0, &period, nullptr) != 0) {
+        perror("timerfd/signalfd");
+        return false;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = EVENT_LISTEN;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.u64 = EVENT_TIMER;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+    event.data.u64 = EVENT_SIGNAL;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+
+    for (const std::string& spec : options.serials) {
+        if (!addSerial(spec)) {
+            return false;
+        }
+    }
+    startNs = lastStatsNs = monotonicNs();
+    return true;
+}
+
+bool IngestServer::addSerial(const std::string& spec) {
+    size_t equals = spec.find('=');
+    std::string path = spec.substr(0, equals);
+    std::string name = equals == std::string::npos ? path.substr(path.rfind('/') + 1)
+                                                   : spec.substr(equals + 1);
+    if (!validDeviceName(name.c_str())) {
+        fprintf(stderr, "nome de dispositivo inválido: %s\n", name.c_str());
+        return false;
+    }
+    int fd = open(path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0 || (isatty(fd) && !configureSerial(fd, options.baud))) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    size_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    Connection& connection = connections[slot];
+    connection.fd = fd;
+    connection.serial = true;
+    connection.state = ConnectionState::Frames;
+    connection.device = store.device(name.c_str());
+    connection.stream = FrameStream();
+    active++;
+    connectionsTotal++;
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = slot;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void IngestServer::acceptAll() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;     // EAGAIN, ou erro transitório (EMFILE etc.)
+        }
+        if (freeSlots.empty()) {
+            rejected++;
+            ::close(fd);
+            continue;
+        }
+        attach(fd);
+    }
+}
+
+// Conexão TCP nova, esperando a identificação; retorna a vaga
+size_t IngestServer::attach(int fd) {
+    size_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    Connection& connection = connections[slot];
+    connection.fd = fd;
+    connection.serial = false;
+    connection.state = ConnectionState::Hello;
+    connection.helloLength = 0;
+    connection.stream = FrameStream();
+    connection.batchUsed = 0;
+    connection.ackPending = false;
+    active++;
+    connectionsTotal++;
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = slot;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    return slot;
+}
+
+void IngestServer::close(Connection& connection) {
+    const StreamStats& s = connection.stream.stats();
+    closedTotals.frames += s.frames;
+    closedTotals.accelFrames += s.accelFrames;
+    closedTotals.accelSamples += s.accelSamples;
+    closedTotals.envFrames += s.envFrames;
+    closedTotals.badFrames += s.badFrames;
+    closedTotals.seqGaps += s.seqGaps;
+    closedTotals.lostSamples += s.lostSamples;
+    closedTotals.restarts += s.restarts;
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    connection.fd = -1;
+    connection.state = ConnectionState::Free;
+    connection.ackPending = false;
+    freeSlots.push_back(&connection - connections.data());
+    active--;
+}
+
+// Consome a linha de identificação; false se a conexão deve ser fechada
+bool IngestServer::hello(Connection& connection, const uint8_t* data, size_t len, size_t& used) {
+    used = 0;
+    while (used < len) {
+        char c = (char)data[used++];
+        if (c != '\n') {
+            if (connection.helloLength == sizeof(connection.hello) - 1) {
+                rejected++;
+                return false;
+            }
+            connection.hello[connection.helloLength++] = c;
+            continue;
+        }
+        while (connection.helloLength > 0 && connection.hello[connection.helloLength - 1] == '\r') {
+            connection.helloLength--;
+        }
+        connection.hello[connection.helloLength] = '\0';
+
+        if (strcmp(connection.hello, "STATS") == 0) {
+            char line[1024];
+            size_t n = writeStats(line, sizeof(line));
+            if (write(connection.fd, line, n) < 0) {
+                // A resposta é de melhor esforço
+            }
+            return false;
+        }
+        const char* name = connection.hello + 9;
+        char* batchMode = strstr(connection.hello, " BATCH ");
+        unsigned long boot = 0;
+        if (batchMode != nullptr) {
+            char* end;
+            boot = strtoul(batchMode + 7, &end, 16);
+            if (end == batchMode + 7 || *end != '\0') {
+                rejected++;
+                return false;
+            }
+            *batchMode = '\0';
+        }
+        if (strncmp(connection.hello, "KATABASE ", 9) != 0 || !validDeviceName(name)) {
+            rejected++;
+            return false;
+        }
+        connection.device = store.device(name);
+        if (connection.device == 0xFFFF) {
+            rejected++;
+            return false;
+        }
+        connection.state = ConnectionState::Frames;
+        if (batchMode != nullptr) {
+            // Outro boot: o relógio persistente pode ter voltado (lote do
+            // log perdido no corte de energia)
+            if (uplinkDevices.size() <= connection.device) {
+                uplinkDevices.resize(connection.device + 1);
+            }
+            UplinkDevice& device = uplinkDevices[connection.device];
+            if (device.boot != boot) {
+                device.boot = boot;
+                device.haveLast = false;
+            }
+            connection.state = ConnectionState::Batches;
+        }
+        return true;
+    }
+    return true;
+}
+
+// false se o quadro foi descartado
+bool IngestServer::append(Connection& connection, const DecodedFrame& frame, uint64_t receivedMs,
+                          uint64_t arrivalNs) {
+    if (store.full()) {
+        flush();
+    }
+    if (store.full()) {
+        dropped++;      // Disco falhando: os lotes não esvaziam
+        return false;
+    }
+    if (frame.type == FrameType::AccelBlock) {
+        store.appendAccel(connection.device, frame.accel);
+    } else {
+        store.appendEnvironment(connection.device, frame.seq, receivedMs, frame.environment);
+    }
+    pendingArrivalNs.push_back(arrivalNs);
+    return true;
+}
+
+void IngestServer::frames(Connection& connection, const uint8_t* data, size_t len, uint64_t arrivalNs) {
+    uint64_t receivedMs = wallMs();
+    connection.stream.feed(data, len, [&](const DecodedFrame& frame) {
+        append(connection, frame, receivedMs, arrivalNs);
+    });
+}
+
+// Monta cabeçalho e corpo de cada lote; false se a conexão deve ser fechada
+bool IngestServer::uplinkData(Connection& connection, const uint8_t* data, size_t len, uint64_t arrivalNs) {
+    BatchHeader header;
+    while (len > 0) {
+        bool haveHeader = connection.batchUsed >= BATCH_HEADER_SIZE;
+        if (haveHeader) {
+            decodeBatchHeader(connection.batch.data(), header);
+        }
+        size_t need = haveHeader ? BATCH_HEADER_SIZE + header.length : BATCH_HEADER_SIZE;
+        if (connection.batch.size() < need) {
+            connection.batch.resize(need);
+        }
+        size_t take = need - connection.batchUsed < len ? need - connection.batchUsed : len;
+        memcpy(connection.batch.data() + connection.batchUsed, data, take);
+        connection.batchUsed += take;
+        data += take;
+        len -= take;
+        if (connection.batchUsed < need) {
+            break;
+        }
+        if (!haveHeader) {
+            if (!decodeBatchHeader(connection.batch.data(), header)) {
+                badBatches++;
+                return false;
+            }
+            if (header.length > 0) {
+                continue;
+            }
+        }
+        if (!storeBatch(connection, header, arrivalNs)) {
+            return false;
+        }
+        connection.batchUsed = 0;
+    }
+    return true;
+}
+
+bool IngestServer::storeBatch(Connection& connection, const BatchHeader& header, uint64_t arrivalNs) {
+    static uint8_t decoded[BATCH_MAX_BODY];
+    static GzipDecoder decoder;
+    const uint8_t* body = connection.batch.data() + BATCH_HEADER_SIZE;
+    size_t length = header.length;
+    if (crc32(body, length) != header.crc) {
+        badBatches++;
+        return false;
+    }
+    if (header.encoding == BatchEncoding::Gzip) {
+        if (!decoder.decode(body, header.length, decoded, sizeof(decoded), length)) {
+            badBatches++;
+            return false;
+        }
+        body = decoded;
+    }
+
+    UplinkDevice& device = uplinkDevices[connection.device];
+    uint64_t receivedMs = wallMs();
+    bool stored = true;
+    connection.stream.feed(body, length, [&](const DecodedFrame& frame) {
+        if (!stored) {
+            return;     // O resto do lote volta no reenvio
+        }
+        bool environment = frame.type == FrameType::Environment;
+        if (environment && device.haveLast && frame.timestampMs <= device.lastMs) {
+            uplinkDuplicates++;
+            return;
+        }
+        // A referência da deduplicação só avança com o registro no lote:
+        // um registro descartado aqui não pode ser tomado por duplicata
+        if (!append(connection, frame, receivedMs, arrivalNs)) {
+            stored = false;
+            return;
+        }
+        if (environment) {
+            device.haveLast = true;
+            device.lastMs = frame.timestampMs;
+        }
+    });
+    if (!stored) {
+        return false;   // Sem ACK: o dispositivo reenvia o lote
+    }
+    uplinkBatches++;
+    connection.ackId = header.id;
+    if (!connection.ackPending) {
+        connection.ackPending = true;
+        ackSlots.push_back(&connection - connections.data());
+    }
+    return true;
+}
+
+void IngestServer::readable(Connection& connection) {
+    static uint8_t buffer[65536];
+    ssize_t n = read(connection.fd, buffer, sizeof(buffer));
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (n <= 0) {
+        close(connection);
+        return;
+    }
+    uint64_t arrivalNs = monotonicNs();
+
+    size_t used = 0;
+    if (connection.state == ConnectionState::Hello) {
+        if (!hello(connection, buffer, n, used)) {
+            close(connection);
+            return;
+        }
+    }
+    if (connection.state == ConnectionState::Frames && used < (size_t)n) {
+        frames(connection, buffer + used, n - used, arrivalNs);
+    } else if (connection.state == ConnectionState::Batches && used < (size_t)n &&
+               !uplinkData(connection, buffer + used, n - used, arrivalNs)) {
+        close(connection);
+    }
+}
+
+// Grava o lote aberto; --check-uplink simula falhas do disco
+bool IngestServer::writeBatch() {
+    if (failWrites > 0) {
+        failWrites--;
+        errno = EIO;
+        return false;
+    }
+    return store.flush(options.sync);
+}
+
+void IngestServer::flush() {
+    if (!pendingArrivalNs.empty()) {
+        if (!writeBatch()) {
+            // Lote mantido nos buffers: nova tentativa no próximo timer
+            writeErrors++;
+            perror("gravação do lote");
+            return;
+        }
+        uint64_t now = monotonicNs();
+        for (uint64_t arrival : pendingArrivalNs) {
+            latency.record((now - arrival) / 1000);
+        }
+        pendingArrivalNs.clear();
+        batches++;
+    }
+    acknowledge();
+}
+
+// Tudo o que chegou está gravado: confirma os lotes do uplink
+void IngestServer::acknowledge() {
+    for (size_t slot : ackSlots) {
+        Connection& connection = connections[slot];
+        if (!connection.ackPending) {
+            continue;   // Fechada (ou reaproveitada) depois do lote
+        }
+        connection.ackPending = false;
+        char line[24];
+        int n = snprintf(line, sizeof(line), "ACK %u\n", connection.ackId);
+        if (write(connection.fd, line, n) != n) {
+            // Sem espaço para uma linha: o laço fecha a conexão e o
+            // dispositivo reenvia o lote
+            shutdown(connection.fd, SHUT_RDWR);
+        }
+    }
+    ackSlots.clear();
+}
+
+StreamStats IngestServer::totals() const {
+    StreamStats t = closedTotals;
+    for (const Connection& connection : connections) {
+        if (connection.state == ConnectionState::Free) {
+            continue;
+        }
+        const StreamStats& s = connection.stream.stats();
+        t.frames += s.frames;
+        t.accelFrames += s.accelFrames;
+        t.accelSamples += s.accelSamples;
+        t.envFrames += s.envFrames;
+        t.badFrames += s.badFrames;
+        t.seqGaps += s.seqGaps;
+        t.lostSamples += s.lostSamples;
+        t.restarts += s.restarts;
+    }
+    return t;
+}
+
+size_t IngestServer::writeStats(char* out, size_t size) const {
+    StreamStats t = totals();
+    int n = snprintf(out, size,
+        "{\"uptime_s\":%.1f,\"connections\":%zu,\"connections_total\":%llu,\"rejected\":%llu,"
+        "\"devices\":%zu,\"frames\":%llu,\"env_records\":%llu,\"accel_frames\":%llu,"
+        "\"accel_samples\":%llu,\"bad_frames\":%llu,\"seq_gaps\":%llu,\"lost_samples\":%llu,\"restarts\":%llu,"
+        "\"batches\":%llu,\"write_errors\":%llu,\"dropped\":%llu,\"stored_env\":%llu,\"stored_accel\":%llu,"
+        "\"uplink_batches\":%llu,\"uplink_duplicates\":%llu,\"bad_batches\":%llu,"
+        "\"latency_us\":{\"count\":%llu,\"p50\":%llu,\"p99\":%llu,\"max\":%llu}}\n",
+        (monotonicNs() - startNs) / 1e9, active, (unsigned long long)connectionsTotal,
+        (unsigned long long)rejected, store.devices(), (unsigned long long)t.frames,
+        (unsigned long long)t.envFrames, (unsigned long long)t.accelFrames,
+        (unsigned long long)t.accelSamples, (unsigned long long)t.badFrames,
+        (unsigned long long)t.seqGaps, (unsigned long long)t.lostSamples,
+        (unsigned long long)t.restarts, (unsigned long long)batches, (unsigned long long)writeErrors, (unsigned long long)dropped,
+        (unsigned long long)store.environmentTable().rows(), (unsigned long long)store.accelTable().rows(),
+        (unsigned long long)uplinkBatches, (unsigned long long)uplinkDuplicates, (unsigned long long)badBatches,
+        (unsigned long long)latency.count(), (unsigned long long)latency.percentile(0.5),
+        (unsigned long long)latency.percentile(0.99), (unsigned long long)latency.max());
+    return n < 0 ? 0 : (size_t)n < size ? (size_t)n : size - 1;
+}
+
+void IngestServer::printStats(const char* prefix) {
+    uint64_t now = monotonicNs();
+    StreamStats t = totals();
+    double seconds = (now - lastStatsNs) / 1e9;
+    fprintf(stderr, "%s: %zu conexões, %.0f quadros/s, %.0f amostras/s; gravados %llu ambientais e "
+            "%llu amostras em %llu lotes; latência p50 %.1f ms, p99 %.1f ms, máx %.1f ms; "
+            "inválidos %llu, lacunas %llu\n",
+            prefix, active, (t.frames - lastStatsFrames) / seconds,
+            (t.accelSamples - lastStatsSamples) / seconds,
+            (unsigned long long)store.environmentTable().rows(),
+            (unsigned long long)store.accelTable().rows(), (unsigned long long)batches,
+            latency.percentile(0.5) / 1000.0, latency.percentile(0.99) / 1000.0, latency.max() / 1000.0,
+            (unsigned long long)t.badFrames, (unsigned long long)t.seqGaps);
+    lastStatsNs = now;
+    lastStatsFrames = t.frames;
+    lastStatsSamples = t.accelSamples;
+}
+
+void IngestServer::tick() {
+    uint64_t expirations;
+    if (read(timerFd, &expirations, sizeof(expirations)) < 0) {
+        return;
+    }
+    flush();
+    if (options.statsSeconds > 0 && monotonicNs() - lastStatsNs >= options.statsSeconds * 1000000000ULL) {
+        printStats("ingest");
+    }
+}
+
+int IngestServer::run() {
+    fprintf(stderr, "ingest: porta %d, %zu portas seriais, armazenamento em %s (%zu dispositivos conhecidos)\n",
+            options.port, options.serials.size(), options.store.c_str(), store.devices());
+    struct epoll_event events[256];
+    while (!stopping) {
+        int n = epoll_wait(epollFd, events, 256, -1);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == EVENT_LISTEN) {
+                acceptAll();
+            } else if (tag == EVENT_TIMER) {
+                tick();
+            } else if (tag == EVENT_SIGNAL) {
+                stopping = true;
+            } else if (connections[tag].state != ConnectionState::Free) {
+                readable(connections[tag]);
+            }
+        }
+    }
+    flush();
+    printStats("ingest: fim");
+    return writeErrors == 0 ? 0 : 1;
+}
+
+// --check-uplink: o caminho dos lotes do uplink de ponta a ponta, com os
+// dispositivos em socketpairs e o laço de eventos chamado à mão. Com o
+// armazenamento cheio e a gravação falhando uma vez, o lote é recusado
+// (sem ACK) e o reenvio precisa ser gravado inteiro; depois um reenvio de
+// verdade (ACK perdido) precisa virar duplicata.
+int IngestServer::checkUplink() {
+    const uint32_t NEIGHBOR_RECORDS = 40;
+    const uint32_t BATCH_RECORDS = 30;
+    char dir[] = "/tmp/katabase-check-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    options.store = dir;
+    options.envBatchRows = NEIGHBOR_RECORDS;    // O vizinho enche o lote
+    options.maxDevices = 4;
+    signal(SIGPIPE, SIG_IGN);
+    if (!prepare()) {
+        return 1;
+    }
+
+    // Conecta um dispositivo, envia a identificação e os dados; retorna o
+    // lado do dispositivo
+    auto connect = [&](const char* hello, const std::vector<uint8_t>& data) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+            perror("socketpair");
+            exit(1);
+        }
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        size_t slot = attach(fds[0]);
+        std::vector<uint8_t> message(hello, hello + strlen(hello));
+        message.insert(message.end(), data.begin(), data.end());
+        if (write(fds[1], message.data(), message.size()) != (ssize_t)message.size()) {
+            perror("write");
+            exit(1);
+        }
+        readable(connections[slot]);
+        return fds[1];
+    };
+    auto frames = [](uint32_t firstMs, uint32_t count) {
+        std::vector<uint8_t> out;
+        uint8_t frame[ENVIRONMENT_FRAME_ENCODED];
+        for (uint32_t i = 0; i < count; i++) {
+            EnvironmentRecord record = {};
+            record.timestampMs = firstMs + i * 2000;
+            record.temperature = 24.5f;
+            record.humidity = 55.0f;
+            size_t n = encodeEnvironmentFrame((uint16_t)i, record, frame);
+            out.insert(out.end(), frame, frame + n);
+        }
+        return out;
+    };
+    auto batch = [](uint32_t id, const std::vector<uint8_t>& body) {
+        BatchHeader header = {id, (uint16_t)BATCH_RECORDS, BatchEncoding::Frames,
+                              (uint32_t)body.size(), crc32(body.data(), body.size())};
+        std::vector<uint8_t> out(BATCH_HEADER_SIZE);
+        encodeBatchHeader(header, out.data());
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    };
+    auto reply = [](int fd) {
+        char line[64];
+        ssize_t n = read(fd, line, sizeof(line) - 1);
+        line[n > 0 ? n : 0] = '\0';
+        ::close(fd);
+        return std::string(line);
+    };
+
+    std::vector<uint8_t> body = frames(2000, BATCH_RECORDS);
+    int neighbor = connect("KATABASE vizinho\n", frames(2000, NEIGHBOR_RECORDS));
+
+    // Lote aberto cheio e a gravação falha: o lote do uplink é recusado
+    failWrites = 1;
+    std::string refused = reply(connect("KATABASE bancada BATCH 0000beef\n", batch(1, body)));
+    uint64_t droppedOnFailure = dropped;
+
+    // Reconexão e reenvio: a gravação volta, o lote entra e é confirmado
+    int device = connect("KATABASE bancada BATCH 0000beef\n", batch(1, body));
+    flush();
+    uint64_t storedAfterResend = store.environmentTable().rows();
+    uint64_t duplicatesAfterResend = uplinkDuplicates;
+
+    // ACK perdido: o mesmo lote de novo, já gravado
+    int again = connect("KATABASE bancada BATCH 0000beef\n", batch(1, body));
+    flush();
+    std::string resent = reply(device);
+    std::string duplicate = reply(again);
+    ::close(neighbor);
+    std::filesystem::remove_all(dir);
+
+    bool ok = refused.empty() && droppedOnFailure > 0 &&
+              storedAfterResend == NEIGHBOR_RECORDS + BATCH_RECORDS && duplicatesAfterResend == 0 &&
+              resent == "ACK 1\n" && duplicate == "ACK 1\n" &&
+              uplinkDuplicates == BATCH_RECORDS &&
+              store.environmentTable().rows() == NEIGHBOR_RECORDS + BATCH_RECORDS;
+    fprintf(stderr, "check-uplink: gravação falhando com o lote cheio: %s, %llu quadros descartados\n",
+            refused.empty() ? "lote recusado sem ACK" : "ACK indevido",
+            (unsigned long long)droppedOnFailure);
+    fprintf(stderr, "check-uplink: reenvio: %llu de %u registros gravados, %llu duplicatas; "
+            "ACK perdido: %llu duplicatas descartadas\n",
+            (unsigned long long)(storedAfterResend - NEIGHBOR_RECORDS), BATCH_RECORDS,
+            (unsigned long long)duplicatesAfterResend,
+            (unsigned long long)(uplinkDuplicates - duplicatesAfterResend));
+    fprintf(stderr, "%s\n", ok ? "OK" : "FALHA: registros do lote recusado perdidos ou duplicados");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    IngestOptions options;
+    if (argc == 2 && strcmp(argv[1], "--check-uplink") == 0) {
+        static IngestServer server(options);
+        return server.checkUplink();
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            options.store = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc) {
+            options.serials.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            options.baud = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--flush-ms") == 0 && i + 1 < argc) {
+            options.flushMs = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sync") == 0) {
+            options.sync = true;
+        } else if (strcmp(argv[i], "--max-devices") == 0 && i + 1 < argc) {
+            options.maxDevices = (size_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--stats-s") == 0 && i + 1 < argc) {
+            options.statsSeconds = (uint32_t)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "uso: %s [--store DIR] [--port N] [--serial PORTA=NOME]... [--baud N] "
+                    "[--flush-ms N] [--sync] [--max-devices N] [--stats-s N]\n"
+                    "     %s --check-uplink\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (options.flushMs == 0) {
+        options.flushMs = 1;
+    }
+
+    static IngestServer server(options);
+    if (!server.begin()) {
+        return 1;
+    }
+    return server.run();
+}
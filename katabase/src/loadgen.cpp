@@ -0,0 +1,337 @@
+// katabase-loadgen: simula uma frota de dispositivos enviando telemetria
+// binária ao katabase-ingest pelo TCP e mede a vazão sustentada.
+//
+//   katabase-loadgen [--host IP] [--port N] [--devices N] [--seconds N]
+//                    [--env-hz F] [--accel-hz N] [--prefix NOME]
+//
+// Cada dispositivo é uma conexão com o mesmo fluxo da serial do firmware
+// (quadros do telemetry_frame.h): leituras ambientais a --env-hz e blocos de
+// 64 amostras do acelerômetro a --accel-hz amostras/s. Os quadros são
+// gerados no ritmo do relógio; um dispositivo cujo socket não esvazia
+// descarta quadros, como o firmware faria com a fila cheia.
+//
+// Ao fim, os contadores do ingest (linha "STATS") antes e depois dão os
+// registros recebidos e gravados e a latência de ingestão.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "telemetry_frame.h"
+
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    int port = 7878;
+    size_t devices = 200;
+    double seconds = 10;
+    double envHz = 10;
+    uint32_t accelHz = 1000;
+    std::string prefix = "sim";
+};
+
+const size_t DEVICE_BUFFER = 64 * 1024;
+
+struct SimDevice {
+    int fd = -1;
+    bool failed = false;
+    uint16_t seq = 0;
+    uint32_t sampleIndex = 0;
+    uint64_t nextEnvNs = 0;
+    uint64_t nextAccelNs = 0;
+    float temperature = 25;
+    float phase = 0;
+    uint8_t buffer[DEVICE_BUFFER];
+    size_t head = 0;        // Primeiro byte não enviado
+    size_t tail = 0;        // Fim dos bytes gerados
+};
+
+struct LoadTotals {
+    uint64_t envFrames = 0;
+    uint64_t accelFrames = 0;
+    uint64_t accelSamples = 0;
+    uint64_t dropped = 0;       // Quadros descartados por contrapressão
+    uint64_t bytes = 0;
+};
+
+static int connectTo(const LoadOptions& options) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    if (fd < 0 || inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr) != 1 ||
+        connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+// Uma linha JSON do ingest; campos lidos por nome
+static bool queryStats(const LoadOptions& options, std::string& line) {
+    int fd = connectTo(options);
+    if (fd < 0) {
+        return false;
+    }
+    const char request[] = "STATS\n";
+    if (write(fd, request, sizeof(request) - 1) < 0) {
+        close(fd);
+        return false;
+    }
+    char buffer[2048];
+    size_t length = 0;
+    ssize_t n;
+    while (length < sizeof(buffer) - 1 && (n = read(fd, buffer + length, sizeof(buffer) - 1 - length)) > 0) {
+        length += n;
+    }
+    close(fd);
+    buffer[length] = '\0';
+    line = buffer;
+    return length > 0;
+}
+
+static double statsField(const std::string& line, const char* name) {
+    std::string key = std::string("\"") + name + "\":";
+    size_t at = line.find(key);
+    return at == std::string::npos ? 0 : atof(line.c_str() + at + key.size());
+}
+
+static bool append(SimDevice& device, const uint8_t* data, size_t len) {
+    if (device.tail + len > DEVICE_BUFFER) {
+        // Compacta; sem espaço mesmo assim, o quadro é descartado
+        memmove(device.buffer, device.buffer + device.head, device.tail - device.head);
+        device.tail -= device.head;
+        device.head = 0;
+        if (device.tail + len > DEVICE_BUFFER) {
+            return false;
+        }
+    }
+    memcpy(device.buffer + device.tail, data, len);
+    device.tail += len;
+    return true;
+}
+
+static void generate(SimDevice& device, const LoadOptions& options, uint64_t startNs, uint64_t nowNs,
+                     LoadTotals& totals) {
+    uint8_t frame[FRAME_MAX_ENCODED];
+    uint32_t deviceMs = (uint32_t)((nowNs - startNs) / 1000000);
+
+    uint64_t envPeriodNs = options.envHz > 0 ? (uint64_t)(1e9 / options.envHz) : 0;
+    while (envPeriodNs > 0 && device.nextEnvNs <= nowNs) {
+        device.nextEnvNs += envPeriodNs;
+        device.temperature += (rand() % 21 - 10) * 0.01f;
+        EnvironmentRecord record = {};
+        record.timestampMs = deviceMs;
+        record.temperature = device.temperature;
+        record.humidity = 60.0f + (rand() % 100) * 0.01f;
+        record.lux = 300.0f;
+        record.ldrRaw = 2000;
+        record.vibrationRms = 0.05f;
+        record.peakMagnitude = 1.05f;
+        size_t n = encodeEnvironmentFrame(device.seq, record, frame);
+        if (append(device, frame, n)) {
+            device.seq++;
+            totals.envFrames++;
+        } else {
+            totals.dropped++;
+        }
+    }
+
+    uint64_t blockPeriodNs = options.accelHz > 0 ? (uint64_t)(1e9 * ACCEL_BLOCK_SAMPLES / options.accelHz) : 0;
+    while (blockPeriodNs > 0 && device.nextAccelNs <= nowNs) {
+        device.nextAccelNs += blockPeriodNs;
+        static AccelBlock block;
+        block.timestampMs = deviceMs;
+        block.firstIndex = device.sampleIndex;
+        block.sampleRateHz = (uint16_t)options.accelHz;
+        block.count = ACCEL_BLOCK_SAMPLES;
+        for (uint32_t i = 0; i < ACCEL_BLOCK_SAMPLES; i++) {
+            device.phase += 2 * (float)M_PI * 50 / options.accelHz;
+            block.samples[i].x = (int16_t)(0.05f * 16384 * sinf(device.phase));
+            block.samples[i].y = (int16_t)(rand() % 200 - 100);
+            block.samples[i].z = 16384;
+        }
+        size_t n = encodeAccelFrame(device.seq, block, frame);
+        if (append(device, frame, n)) {
+            device.seq++;
+            device.sampleIndex += ACCEL_BLOCK_SAMPLES;
+            totals.accelFrames++;
+            totals.accelSamples += ACCEL_BLOCK_SAMPLES;
+        } else {
+            totals.dropped++;
+        }
+    }
+}
+
+static void send(SimDevice& device, LoadTotals& totals) {
+    while (device.head < device.tail && !device.failed) {
+        ssize_t n = write(device.fd, device.buffer + device.head, device.tail - device.head);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            return;
+        }
+        if (n <= 0) {
+            device.failed = true;
+            return;
+        }
+        device.head += n;
+        totals.bytes += n;
+    }
+    if (device.head == device.tail) {
+        device.head = device.tail = 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            options.host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) {
+            options.devices = (size_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--env-hz") == 0 && i + 1 < argc) {
+            options.envHz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--accel-hz") == 0 && i + 1 < argc) {
+            options.accelHz = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--prefix") == 0 && i + 1 < argc) {
+            options.prefix = argv[++i];
+        } else {
+            fprintf(stderr, "uso: %s [--host IP] [--port N] [--devices N] [--seconds N] "
+                    "[--env-hz F] [--accel-hz N] [--prefix NOME]\n", argv[0]);
+            return 2;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    std::string before;
+    if (!queryStats(options, before)) {
+        fprintf(stderr, "loadgen: ingest não responde em %s:%d\n", options.host.c_str(), options.port);
+        return 1;
+    }
+
+    // Conexões bloqueantes para o handshake; depois, escrita não bloqueante
+    std::vector<SimDevice> devices(options.devices);
+    LoadTotals totals;
+    srand(1);
+    for (size_t i = 0; i < devices.size(); i++) {
+        SimDevice& device = devices[i];
+        device.fd = connectTo(options);
+        if (device.fd < 0) {
+            fprintf(stderr, "loadgen: conexão %zu: %s\n", i, strerror(errno));
+            return 1;
+        }
+        int on = 1;
+        setsockopt(device.fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        char hello[96];
+        int n = snprintf(hello, sizeof(hello), "KATABASE %s-%03zu\n", options.prefix.c_str(), i);
+        append(device, (const uint8_t*)hello, n);
+        device.temperature = 22.0f + (rand() % 100) * 0.1f;
+    }
+    for (SimDevice& device : devices) {
+        int current = fcntl(device.fd, F_GETFL);
+        fcntl(device.fd, F_SETFL, current | O_NONBLOCK);
+    }
+
+    // Dispositivos defasados dentro de um período, como uma frota real
+    uint64_t startNs = monotonicNs();
+    for (size_t i = 0; i < devices.size(); i++) {
+        uint64_t offset = (uint64_t)(1e9 * i / devices.size() / (options.envHz > 0 ? options.envHz : 1));
+        devices[i].nextEnvNs = startNs + offset;
+        devices[i].nextAccelNs = startNs + offset % 64000000;
+    }
+    uint64_t endNs = startNs + (uint64_t)(options.seconds * 1e9);
+    for (uint64_t now = startNs; now < endNs; now = monotonicNs()) {
+        for (SimDevice& device : devices) {
+            generate(device, options, startNs, now, totals);
+            send(device, totals);
+        }
+        struct timespec tick = {0, 1000000};
+        nanosleep(&tick, nullptr);
+    }
+    double elapsed = (monotonicNs() - startNs) / 1e9;
+
+    // Esvaziar o que ficou nos buffers (até 5 s) e fechar
+    uint64_t drainUntil = monotonicNs() + 5000000000ULL;
+    bool pending = true;
+    while (pending && monotonicNs() < drainUntil) {
+        pending = false;
+        for (SimDevice& device : devices) {
+            send(device, totals);
+            pending |= device.head < device.tail && !device.failed;
+        }
+        struct timespec tick = {0, 1000000};
+        nanosleep(&tick, nullptr);
+    }
+    size_t failed = 0;
+    for (SimDevice& device : devices) {
+        failed += device.failed;
+        close(device.fd);
+    }
+
+    // O ingest grava no próximo lote: esperar os registros chegarem ao disco
+    uint64_t sentRecords = totals.envFrames + totals.accelSamples;
+    std::string after;
+    double stored = 0;
+    for (int attempt = 0; attempt < 50; attempt++) {
+        struct timespec wait = {0, 100000000};
+        nanosleep(&wait, nullptr);
+        if (!queryStats(options, after)) {
+            fprintf(stderr, "loadgen: ingest parou de responder\n");
+            return 1;
+        }
+        stored = statsField(after, "stored_env") - statsField(before, "stored_env") +
+                 statsField(after, "stored_accel") - statsField(before, "stored_accel");
+        if (stored >= sentRecords) {
+            break;
+        }
+    }
+    double received = statsField(after, "env_records") - statsField(before, "env_records") +
+                      statsField(after, "accel_samples") - statsField(before, "accel_samples");
+
+    printf("loadgen: %zu dispositivos por %.1f s (ambiental a %.1f Hz, acelerômetro a %u Hz)\n",
+           devices.size(), elapsed, options.envHz, options.accelHz);
+    printf("  enviados: %llu quadros (%.0f/s), %.0f registros/s (%llu ambientais + %llu amostras), "
+           "%.1f MB/s\n",
+           (unsigned long long)(totals.envFrames + totals.accelFrames),
+           (totals.envFrames + totals.accelFrames) / elapsed, sentRecords / elapsed,
+           (unsigned long long)totals.envFrames, (unsigned long long)totals.accelSamples,
+           totals.bytes / elapsed / 1e6);
+    printf("  ingest: %.0f registros recebidos, %.0f gravados; inválidos %.0f, lacunas %.0f\n",
+           received, stored, statsField(after, "bad_frames") - statsField(before, "bad_frames"),
+           statsField(after, "seq_gaps") - statsField(before, "seq_gaps"));
+    printf("  latência de ingestão (desde o início do ingest): p50 %.2f ms, p99 %.2f ms, máx %.2f ms\n",
+           statsField(after, "p50") / 1000, statsField(after, "p99") / 1000,
+           statsField(after, "max") / 1000);
+    printf("  descartados por contrapressão: %llu quadros; conexões com erro: %zu\n",
+           (unsigned long long)totals.dropped, failed);
+
+    bool ok = totals.dropped == 0 && failed == 0 && stored == sentRecords && received == sentRecords;
+    printf("%s\n", ok ? "OK" : "FALHA: registros perdidos entre o gerador e o armazenamento");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// katabase-query: agrega uma grandeza do armazenamento colunar num
+// intervalo de tempo, lendo só a coluna dela e a de tempo.
+//
+//   katabase-query [--table environment|accel] [--time COLUNA]
+//                  [--from MS] [--to MS] [--rows] RAIZ COLUNA
+//   katabase-query [--table environment|accel] --info RAIZ
+//
+// O intervalo é [--from, --to) na coluna de tempo (received_ms, relógio do
+// coletor em ms desde a época Unix, na tabela environment; device_ms na
+// accel). --rows lista "tempo,valor" em CSV em vez de agregar; --info mostra
+// o tamanho comprimido de cada coluna.
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "column_reader.h"
+
+static double elapsedMs(const timespec& start) {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+static int info(const TableReader& table, const ColumnSpec* specs, size_t count) {
+    uint64_t rows = table.rows();
+    printf("%llu linhas\n", (unsigned long long)rows);
+    uint64_t total = 0;
+    uint64_t raw = 0;
+    for (size_t i = 0; i < count; i++) {
+        ColumnReader column;
+        if (!table.openColumn(specs[i].name, column)) {
+            fprintf(stderr, "%s: %s\n", specs[i].name, strerror(errno));
+            return 1;
+        }
+        uint64_t width = columnWidth(specs[i].type);
+        printf("  %-14s %6zu blocos %12llu bytes  %6.2f bits/linha  (%.1fx)\n", specs[i].name,
+               column.blocks(), (unsigned long long)column.storedBytes(),
+               rows ? column.storedBytes() * 8.0 / rows : 0.0,
+               column.storedBytes() ? (double)(rows * width) / column.storedBytes() : 0.0);
+        total += column.storedBytes();
+        raw += rows * width;
+    }
+    printf("total %llu bytes (%.1fx sobre largura fixa)\n", (unsigned long long)total,
+           total ? (double)raw / total : 0.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* tableName = "environment";
+    const char* timeColumn = nullptr;
+    double from = -INFINITY;
+    double to = INFINITY;
+    bool rows = false;
+    bool showInfo = false;
+    const char* positional[2] = {nullptr, nullptr};
+    size_t positionals = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--table") == 0 && i + 1 < argc) {
+            tableName = argv[++i];
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            timeColumn = argv[++i];
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rows") == 0) {
+            rows = true;
+        } else if (strcmp(argv[i], "--info") == 0) {
+            showInfo = true;
+        } else if (argv[i][0] != '-' && positionals < 2) {
+            positional[positionals++] = argv[i];
+        } else {
+            positionals = 0;
+            break;
+        }
+    }
+    if (positionals != (showInfo ? 1u : 2u)) {
+        fprintf(stderr, "uso: %s [--table environment|accel] [--time COLUNA] [--from MS] [--to MS] "
+                "[--rows] RAIZ COLUNA\n       %s [--table environment|accel] --info RAIZ\n",
+                argv[0], argv[0]);
+        return 2;
+    }
+
+    const ColumnSpec* specs;
+    size_t count;
+    if (strcmp(tableName, "environment") == 0) {
+        specs = ENV_COLUMNS;
+        count = (size_t)EnvColumn::Count;
+        timeColumn = timeColumn ? timeColumn : "received_ms";
+    } else if (strcmp(tableName, "accel") == 0) {
+        specs = ACCEL_COLUMNS;
+        count = (size_t)AccelColumn::Count;
+        timeColumn = timeColumn ? timeColumn : "device_ms";
+    } else {
+        fprintf(stderr, "tabela desconhecida: %s (environment, accel)\n", tableName);
+        return 2;
+    }
+
+    TableReader table;
+    if (!table.open(positional[0], tableName, specs, count)) {
+        fprintf(stderr, "%s/%s: %s\n", positional[0], tableName, strerror(errno));
+        return 1;
+    }
+    if (showInfo) {
+        return info(table, specs, count);
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ColumnReader time;
+    ColumnReader value;
+    for (const char* name : {timeColumn, positional[1]}) {
+        if (!table.openColumn(name, name == timeColumn ? time : value)) {
+            fprintf(stderr, "%s: %s\n", name, strerror(errno));
+            return 1;
+        }
+    }
+
+    if (rows) {
+        bool ok = scanRange(time, value, from, to, [](double at, double x) {
+            printf("%.0f,%.9g\n", at, x);
+        });
+        return ok ? 0 : 1;
+    }
+
+    RangeAggregate result;
+    if (!aggregateRange(time, value, from, to, result)) {
+        fprintf(stderr, "blocos corrompidos ou desalinhados\n");
+        return 1;
+    }
+    printf("%s: %llu valores, min %.6g, max %.6g, média %.6g\n", positional[1],
+           (unsigned long long)result.count, result.min, result.max, result.mean());
+    fprintf(stderr, "blocos: %zu pelo índice, %zu descomprimidos, %zu fora do intervalo; %.2f ms\n",
+            result.blocksFromIndex, result.blocksDecoded, result.blocksSkipped, elapsedMs(start));
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "serial_port.h"
+
+#include <stdio.h>
+#include <termios.h>
+
+static speed_t baudConstant(long baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return 0;
+    }
+}
+
+bool configureSerial(int fd, long baud) {
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) {
+        return false;
+    }
+    speed_t speed = baudConstant(baud);
+    if (speed == 0) {
+        fprintf(stderr, "baud não suportado: %ld\n", baud);
+        return false;
+    }
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Porta serial em modo raw (sem eco, sem tradução de CR/LF); baud entre
+// 9600 e 921600
+bool configureSerial(int fd, long baud);
@@ -0,0 +1,302 @@
+// katabase-storebench: compara o armazenamento colunar com CSV para as
+// leituras ambientais (tamanho, vazão de escrita e tempo de consulta).
+//
+//   katabase-storebench [--devices N] [--days N] [--dir CAMINHO]
+//
+// Gera uma leitura por segundo por dispositivo, com a resolução dos
+// sensores (DHT22 em 0,1, BH1750 em lux inteiros, ADC de 12 bits) e
+// variação diária, intercaladas entre os dispositivos como o
+// katabase-ingest grava. Escreve o mesmo conjunto em CSV (as colunas do
+// armazenamento, com as casas do katabase-decode) e no formato colunar, e
+// mede mínimo, máximo e média da temperatura em todo o período e num dia,
+// conferindo que os dois formatos dão o mesmo resultado. As consultas
+// rodam com os arquivos no cache de páginas, nos dois casos.
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "column_reader.h"
+
+namespace {
+
+constexpr uint64_t BASE_MS = 1767225600000ull;     // 2026-01-01 00:00 UTC
+constexpr size_t BATCH_ROWS = 8192;
+
+struct Options {
+    size_t devices = 20;
+    unsigned days = 7;
+    std::string dir = "/tmp/katabase-storebench";
+};
+
+double nowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+float quantize(double value, double step) {
+    return (float)(round(value / step) * step);
+}
+
+struct Reading {
+    uint64_t receivedMs;
+    uint16_t device;
+    uint16_t seq;
+    EnvironmentRecord record;
+};
+
+// Leitura do dispositivo d no segundo s
+class Generator {
+public:
+    explicit Generator(size_t devices) : state(devices, 0x9E3779B9u) {
+        for (size_t d = 0; d < devices; d++) {
+            state[d] ^= (uint32_t)(d * 2654435761u);
+        }
+    }
+
+    Reading at(size_t d, uint64_t s) {
+        uint32_t& rng = state[d];
+        double day = (s % 86400) / 86400.0;
+        double noise = ((int)(nextRandom(rng) % 7) - 3) * 0.1;
+        Reading r = {};
+        r.receivedMs = BASE_MS + s * 1000 + d % 1000 + nextRandom(rng) % 5;
+        r.device = (uint16_t)d;
+        r.seq = (uint16_t)s;
+        r.record.timestampMs = (uint32_t)(s * 1000 + d * 37);
+        r.record.temperature = quantize(22.0 + d % 5 + 3.0 * sin(2 * M_PI * day) + noise, 0.1);
+        r.record.humidity = quantize(55.0 - 8.0 * sin(2 * M_PI * day) + noise, 0.1);
+        double light = sin(M_PI * (day - 0.25) * 2);
+        r.record.lux = light > 0 ? quantize(400.0 * light + nextRandom(rng) % 3, 1.0) : 0.0f;
+        r.record.ldrRaw = (uint16_t)(r.record.lux * 4 + nextRandom(rng) % 8);
+        r.record.alertLevel = r.record.temperature > 26.5f ? 1 : 0;
+        r.record.vibrationRms = quantize(0.020 + (nextRandom(rng) % 16) * 0.001, 0.001);
+        r.record.peakMagnitude = quantize(1.0 + (nextRandom(rng) % 8) * 0.01, 0.01);
+        return r;
+    }
+
+private:
+    std::vector<uint32_t> state;
+};
+
+uint64_t fileSize(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+struct Result {
+    uint64_t bytes = 0;
+    double writeMs = 0;
+    RangeAggregate all;
+    RangeAggregate day;
+    double allMs = 0;
+    double dayMs = 0;
+};
+
+bool writeCsv(const Options& options, uint64_t seconds, Result& out) {
+    std::string path = options.dir + "/environment.csv";
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    static char buffer[1 << 20];
+    setvbuf(file, buffer, _IOFBF, sizeof(buffer));
+    Generator generator(options.devices);
+    double start = nowMs();
+    fputs("received_ms,device,seq,device_ms,temperature,humidity,lux,ldr_raw,"
+          "alert_level,scenario,step,vib_rms,vib_peak\n", file);
+    for (uint64_t s = 0; s < seconds; s++) {
+        for (size_t d = 0; d < options.devices; d++) {
+            Reading r = generator.at(d, s);
+            const EnvironmentRecord& e = r.record;
+            fprintf(file, "%llu,%u,%u,%u,%.1f,%.1f,%.0f,%u,%u,%u,%u,%.3f,%.2f\n",
+                    (unsigned long long)r.receivedMs, r.device, r.seq, e.timestampMs,
+                    e.temperature, e.humidity, e.lux, e.ldrRaw, e.alertLevel, e.scenario,
+                    e.step, e.vibrationRms, e.peakMagnitude);
+        }
+    }
+    bool ok = fflush(file) == 0 && fdatasync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    out.writeMs = nowMs() - start;
+    out.bytes = fileSize(path);
+    return ok;
+}
+
+// Varredura mínima: só converte os campos 1 (tempo) e 5 (temperatura)
+bool queryCsv(const Options& options, double from, double to, RangeAggregate& out) {
+    FILE* file = fopen((options.dir + "/environment.csv").c_str(), "r");
+    if (file == nullptr) {
+        return false;
+    }
+    out = RangeAggregate();
+    out.min = INFINITY;
+    out.max = -INFINITY;
+    static char line[256];
+    fgets(line, sizeof(line), file);
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        char* p;
+        double at = (double)strtoull(line, &p, 10);
+        if (at < from || at >= to) {
+            continue;
+        }
+        for (int field = 1; field < 4 && p != nullptr; field++) {
+            p = strchr(p + 1, ',');
+        }
+        if (p == nullptr) {
+            continue;
+        }
+        double x = strtod(p + 1, nullptr);
+        out.count++;
+        out.sum += x;
+        out.min = x < out.min ? x : out.min;
+        out.max = x > out.max ? x : out.max;
+    }
+    fclose(file);
+    return true;
+}
+
+bool writeColumnar(const Options& options, uint64_t seconds, Result& out) {
+    std::string root = options.dir + "/store";
+    Generator generator(options.devices);
+    double start = nowMs();
+    {
+        TelemetryStore store;
+        if (!store.open(root, BATCH_ROWS, ACCEL_BLOCK_SAMPLES)) {
+            return false;
+        }
+        for (uint64_t s = 0; s < seconds; s++) {
+            for (size_t d = 0; d < options.devices; d++) {
+                if (store.full() && !store.flush(false)) {
+                    return false;
+                }
+                Reading r = generator.at(d, s);
+                store.appendEnvironment(r.device, r.seq, r.receivedMs, r.record);
+            }
+        }
+        if (!store.flush(true)) {
+            return false;
+        }
+        out.bytes = store.environmentTable().storedBytes();
+    }
+    out.writeMs = nowMs() - start;
+    // Índices e "batches" contam no tamanho
+    for (const ColumnSpec& spec : ENV_COLUMNS) {
+        out.bytes += fileSize(root + "/environment/" + spec.name + ".idx");
+    }
+    out.bytes += fileSize(root + "/environment/batches");
+    return true;
+}
+
+bool queryColumnar(const Options& options, double from, double to, RangeAggregate& out) {
+    TableReader table;
+    ColumnReader time;
+    ColumnReader temperature;
+    return table.open(options.dir + "/store", "environment", ENV_COLUMNS, (size_t)EnvColumn::Count) &&
+           table.openColumn("received_ms", time) &&
+           table.openColumn("temperature", temperature) &&
+           aggregateRange(time, temperature, from, to, out);
+}
+
+template <typename Query>
+bool timeQueries(const Options& options, uint64_t seconds, Query query, Result& out) {
+    double dayFrom = (double)(BASE_MS + seconds / 2 * 1000);
+    double dayTo = dayFrom + 86400e3;
+    // Uma passada para aquecer o cache de páginas
+    if (!query(options, -INFINITY, INFINITY, out.all)) {
+        return false;
+    }
+    double start = nowMs();
+    bool ok = query(options, -INFINITY, INFINITY, out.all);
+    out.allMs = nowMs() - start;
+    start = nowMs();
+    ok = ok && query(options, dayFrom, dayTo, out.day);
+    out.dayMs = nowMs() - start;
+    return ok;
+}
+
+bool same(const RangeAggregate& a, const RangeAggregate& b) {
+    return a.count == b.count && lround(a.min * 10) == lround(b.min * 10) &&
+           lround(a.max * 10) == lround(b.max * 10) &&
+           fabs(a.mean() - b.mean()) < 1e-4;
+}
+
+void report(const char* name, const Result& r, uint64_t rows) {
+    printf("%-9s %10.1f MiB %8.1f B/linha %10.0f linhas/s %10.1f ms %10.1f ms\n", name,
+           r.bytes / 1048576.0, (double)r.bytes / rows, rows / (r.writeMs / 1e3),
+           r.allMs, r.dayMs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) {
+            options.devices = (size_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+            options.days = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            options.dir = argv[++i];
+        } else {
+            fprintf(stderr, "uso: %s [--devices N] [--days N] [--dir CAMINHO]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.devices == 0 || options.devices > 0xFFFF || options.days == 0) {
+        fprintf(stderr, "--devices entre 1 e 65535, --days ao menos 1\n");
+        return 2;
+    }
+    std::string store = options.dir + "/store";
+    if ((mkdir(options.dir.c_str(), 0755) != 0 && errno != EEXIST) ||
+        access((store + "/environment/batches").c_str(), F_OK) == 0) {
+        fprintf(stderr, "%s: precisa ser um diretório sem um armazenamento anterior\n",
+                options.dir.c_str());
+        return 1;
+    }
+
+    uint64_t seconds = options.days * 86400ull;
+    uint64_t rows = seconds * options.devices;
+    printf("%zu dispositivos, %u dias, %llu leituras\n", options.devices, options.days,
+           (unsigned long long)rows);
+
+    Result csv;
+    Result columnar;
+    if (!writeCsv(options, seconds, csv) || !timeQueries(options, seconds, queryCsv, csv) ||
+        !writeColumnar(options, seconds, columnar) ||
+        !timeQueries(options, seconds, queryColumnar, columnar)) {
+        fprintf(stderr, "%s: %s\n", options.dir.c_str(), strerror(errno));
+        return 1;
+    }
+
+    printf("%-9s %14s %16s %19s %13s %13s\n", "formato", "tamanho", "", "escrita",
+           "consulta", "um dia");
+    report("csv", csv, rows);
+    report("colunar", columnar, rows);
+    printf("colunar: %.1fx menor, escrita %.1fx, consulta %.0fx (período) e %.0fx (um dia)\n",
+           (double)csv.bytes / columnar.bytes, csv.writeMs / columnar.writeMs,
+           csv.allMs / columnar.allMs, csv.dayMs / columnar.dayMs);
+    printf("temperatura: %llu valores, média %.3f; um dia: %llu valores, média %.3f "
+           "(%zu blocos pelo índice, %zu descomprimidos)\n",
+           (unsigned long long)columnar.all.count, columnar.all.mean(),
+           (unsigned long long)columnar.day.count, columnar.day.mean(),
+           columnar.day.blocksFromIndex, columnar.day.blocksDecoded);
+
+    bool ok = same(csv.all, columnar.all) && same(csv.day, columnar.day) && csv.all.count == rows;
+    printf("%s\n", ok ? "OK" : "FALHA: resultados diferentes entre CSV e colunar");
+    return ok ? 0 : 1;
+}
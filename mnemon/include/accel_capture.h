@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "ring_buffer.h"
+#include "samples.h"
+
+struct SensorOverrides;
+
+typedef SpscRing<AccelRaw, ACCEL_RING_CAPACITY> AccelRing;
+
+struct AccelCaptureStats {
+    uint32_t samples;        // Amostras lidas do FIFO
+    uint32_t bursts;         // Leituras I2C em rajada
+    uint32_t fifoOverflows;  // FIFO de hardware transbordou (amostras perdidas no sensor)
+    uint32_t ringOverflows;  // Ring buffer cheio (consumidor atrasado)
+};
+
+bool accelCaptureBegin(uint16_t sampleRateHz);
+
+// Produtor: drena o FIFO em rajadas de até FIFO_BURST_BYTES para o ring
+// buffer. Retorna o número de amostras lidas e a mais recente em last; com
+// o override do MPU6050 ativo em overrides as amostras são substituídas.
+size_t accelCaptureDrain(const SensorOverrides& overrides, AccelRaw& last);
+
+// Consumidor (tarefa de alertas)
+AccelRing& accelRing();
+
+AccelCaptureStats accelCaptureStats();
+
+// Converte os 6 bytes big-endian de uma amostra do FIFO
+inline AccelRaw parseFifoSample(const uint8_t* data) {
+    AccelRaw sample;
+    sample.x = (int16_t)((data[0] << 8) | data[1]);
+    sample.y = (int16_t)((data[2] << 8) | data[3]);
+    sample.z = (int16_t)((data[4] << 8) | data[5]);
+    return sample;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// Níveis de alerta e cores do LED como enums compactos. Os nomes usados no
+// JSON e os textos do LCD vêm de tabelas constexpr: nenhuma String é criada
+// ou comparada no caminho aquisição -> atuadores.
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class LedColor : uint8_t {
+    Off,
+    Green,
+    Yellow,
+    Red,
+    Count
+};
+
+enum class AlertLevel : uint8_t {
+    Normal,
+    Yellow,
+    Red,
+    Count
+};
+
+struct LedColorInfo {
+    const char* name;
+    bool red;
+    bool green;
+    bool blue;
+};
+
+constexpr LedColorInfo LED_COLORS[] = {
+    {"off", false, false, false},
+    {"green", false, true, false},
+    {"yellow", true, true, false},
+    {"red", true, false, false},
+};
+
+struct AlertLevelInfo {
+    const char* name;       // Valor de "alert_level" no JSON
+    const char* lcdText;    // Status na linha 1 do LCD
+    LedColor color;
+    bool buzzer;
+};
+
+constexpr AlertLevelInfo ALERT_LEVELS[] = {
+    {"normal", "OK", LedColor::Green, false},
+    {"yellow", "WARN", LedColor::Yellow, false},
+    {"red", "ALERT!", LedColor::Red, true},
+};
+
+static_assert(sizeof(LED_COLORS) / sizeof(LED_COLORS[0]) == (size_t)LedColor::Count,
+              "LED_COLORS deve cobrir todas as cores");
+static_assert(sizeof(ALERT_LEVELS) / sizeof(ALERT_LEVELS[0]) == (size_t)AlertLevel::Count,
+              "ALERT_LEVELS deve cobrir todos os níveis");
+
+constexpr const LedColorInfo& ledColorInfo(LedColor color) {
+    return LED_COLORS[(size_t)color];
+}
+
+constexpr const AlertLevelInfo& alertLevelInfo(AlertLevel level) {
+    return ALERT_LEVELS[(size_t)level];
+}
+
+constexpr const char* alertLevelName(AlertLevel level) {
+    return alertLevelInfo(level).name;
+}
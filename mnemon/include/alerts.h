@@ -0,0 +1,49 @@
+#pragma once
+
+#include "alert_level.h"
+#include "anomaly.h"
+#include "samples.h"
+
+// Limiares fixos de config.h (sem estado)
+AlertLevel calculateAlertLevel(float temp, float humidity, const VibrationFeatures& vibration,
+                                const SpectralResult& spectrum);
+
+struct AlertInputs {
+    float temperature;
+    float humidity;
+    bool envFresh;                      // Leitura nova do DHT22 neste ciclo
+    const VibrationFeatures* vibration;
+    const SpectralResult* spectrum;
+    bool synthetic;                     // Overrides ou cenário de teste ativos
+};
+
+// Nível de alerta final da tarefa de alertas:
+//   - com entradas simuladas (overrides/cenários) ou antes de haver linha de
+//     base, os limiares fixos, como documentado na API;
+//   - depois do aprendizado, o nível do motor de anomalias, com os limiares
+//     vermelhos fixos como limite de segurança.
+// Subir de nível é imediato; descer exige que tudo fique abaixo dos
+// limiares reduzidos de ALERT_HYSTERESIS por ALERT_CLEAR_MS seguidos.
+class AlertEvaluator {
+public:
+    explicit AlertEvaluator(AnomalyEngine& engine) : engine(engine) {}
+
+    void begin(uint32_t nowMs);
+    AlertLevel evaluate(uint32_t nowMs, const AlertInputs& inputs);
+    AlertLevel level() const { return current; }
+
+private:
+    AlertLevel target(const AlertInputs& inputs, float scale) const;
+
+    AnomalyEngine& engine;
+    AlertLevel current = AlertLevel::Normal;
+    AlertLevel anomaly = AlertLevel::Normal;
+    uint32_t lastAnomalyMs = 0;
+    uint32_t lastSpectrumFrame = 0;
+    bool envPending = false;
+    bool clearing = false;
+    uint32_t clearSinceMs = 0;
+};
+
+void updateActuators(AlertLevel level);
+void setRGBColor(LedColor color);
@@ -0,0 +1,143 @@
+#pragma once
+
+// Detecção de anomalias contra a linha de base de cada máquina, em memória
+// e custo fixos por avaliação (O(canais)).
+//
+// Cada canal (sensor ou característica de vibração) mantém média e
+// variância exponenciais. Durante o aprendizado o peso é 1/n (média
+// acumulada); depois, dt/tau do canal, de modo que a linha de base acompanha
+// mudanças lentas de regime. Contra ela são calculados:
+//   - z-score da leitura, para desvios bruscos;
+//   - CUSUM (em sigmas, com folga ANOMALY_CUSUM_SLACK), para derivas lentas
+//     que nunca chegam a um z alto.
+// Leituras anômalas não entram na linha de base, para que uma falha não
+// seja aprendida como normal. A severidade de cada canal só passa a valer
+// depois de mantida por ANOMALY_DEBOUNCE_MS.
+//
+// O motor roda na tarefa de alertas; o estado é publicado por versões
+// (seqlock.h) para a API e para a tarefa de saída, que grava a linha de base
+// no log em flash (LogRecordType::Baseline) e a restaura no boot.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alert_level.h"
+#include "config.h"
+#include "seqlock.h"
+
+class JsonWriter;
+
+enum class AnomalyChannel : uint8_t {
+    Temperature,
+    Humidity,
+    VibrationRms,
+    PeakMagnitude,
+    BandLow,
+    BandMid,
+    BandHigh,
+    Count
+};
+
+const size_t ANOMALY_CHANNELS = (size_t)AnomalyChannel::Count;
+
+struct AnomalyChannelInfo {
+    const char* name;
+    float minSigma;         // Piso do desvio padrão (resolução/ruído do sensor)
+    uint32_t tauMs;         // Constante de tempo da linha de base após o aprendizado
+    bool twoSided;          // false: só desvios para cima são anômalos
+};
+
+constexpr AnomalyChannelInfo ANOMALY_CHANNEL_INFO[] = {
+    {"temperature", 0.5, 30UL * 60 * 1000, true},
+    {"humidity", 2.0, 30UL * 60 * 1000, true},
+    {"vibration_rms", 0.01, 2UL * 3600 * 1000, false},
+    {"peak_magnitude", 0.02, 2UL * 3600 * 1000, false},
+    {"band_low", 0.01, 2UL * 3600 * 1000, false},
+    {"band_mid", 0.01, 2UL * 3600 * 1000, false},
+    {"band_high", 0.005, 2UL * 3600 * 1000, false},
+};
+
+static_assert(sizeof(ANOMALY_CHANNEL_INFO) / sizeof(ANOMALY_CHANNEL_INFO[0]) == ANOMALY_CHANNELS,
+              "ANOMALY_CHANNEL_INFO deve cobrir todos os canais");
+static_assert(SPECTRAL_BAND_COUNT == 3, "um canal de anomalia por banda espectral");
+
+struct AnomalyChannelState {
+    float mean;
+    float variance;
+    float z;                // Da última leitura
+    float cusum;            // Maior dos dois lados
+    uint32_t samples;
+    AlertLevel level;       // Já com debounce
+};
+
+struct AnomalySnapshot {
+    bool learning;
+    uint32_t learnedMs;     // Tempo de aprendizado acumulado
+    AlertLevel level;       // Maior nível entre os canais
+    AnomalyChannelState channels[ANOMALY_CHANNELS];
+};
+
+// Linha de base persistida no log em flash
+struct AnomalyBaseline {
+    float mean[ANOMALY_CHANNELS];
+    float variance[ANOMALY_CHANNELS];
+};
+
+static_assert(sizeof(AnomalyBaseline) <= LOG_MAX_PAYLOAD, "linha de base deve caber num registro do log");
+
+class AnomalyEngine {
+public:
+    void begin(uint32_t nowMs);
+
+    // Uma avaliação. values[c] NaN = sem leitura nova do canal; com learn
+    // false nada entra na linha de base (entradas não confiáveis).
+    // Retorna o nível de anomalia (Normal durante o aprendizado).
+    AlertLevel update(uint32_t nowMs, const float values[ANOMALY_CHANNELS], bool learn);
+
+    bool learning() const { return learningPhase; }
+
+    // Pedido de recomeçar o aprendizado; aplicado pela tarefa de alertas na
+    // próxima avaliação
+    void relearn() { relearnEpoch++; }
+
+    // Encerra o aprendizado com uma linha de base gravada (boot)
+    void restore(const AnomalyBaseline& baseline);
+
+    // Chamáveis de qualquer tarefa
+    AnomalySnapshot snapshot() const { return published.read(); }
+    uint32_t version() const { return published.version(); }
+    static void baseline(const AnomalySnapshot& snapshot, AnomalyBaseline& baseline);
+
+    // {"learning":b,"learned_s":N,"level":"...","channels":{"<canal>":{mean,sigma,z,cusum,samples,level},...}}
+    static void write(const AnomalySnapshot& snapshot, JsonWriter& json);
+
+private:
+    struct Channel {
+        float mean;
+        float variance;
+        float cusumHigh;
+        float cusumLow;
+        float z;
+        uint32_t samples;
+        uint32_t lastMs;
+        AlertLevel level;
+        AlertLevel pending;
+        uint32_t pendingSinceMs;
+    };
+
+    void reset(uint32_t nowMs);
+    AlertLevel observe(Channel& channel, const AnomalyChannelInfo& info, float value,
+                       uint32_t nowMs, bool learn);
+    void publish();
+
+    Channel channels[ANOMALY_CHANNELS];
+    bool learningPhase = true;
+    uint32_t learnedMs = 0;
+    uint32_t lastMs = 0;
+    AlertLevel level = AlertLevel::Normal;
+    volatile uint32_t relearnEpoch = 0;
+    uint32_t appliedEpoch = 0;
+    Seqlock<AnomalySnapshot> published;
+};
+
+AnomalyEngine& anomalyEngine();
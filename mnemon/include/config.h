@@ -0,0 +1,240 @@
+#pragma once
+
+#include <stdint.h>
+
+// Definições dos pinos
+#define DHT_PIN 23
+#define LDR_PIN 34
+#define BUZZER_PIN 32
+#define LED_R_PIN 25
+#define LED_G_PIN 26
+#define LED_B_PIN 27
+#define I2C_SDA_PIN 21
+#define I2C_SCL_PIN 22
+#define LCD_I2C_ADDR 0x27
+
+// LCD 16x2 (HD44780 via PCF8574)
+const uint8_t LCD_COLS = 16;
+const uint8_t LCD_ROWS = 2;
+
+// Calibração do LDR (divisor com resistor em série, ADC de 12 bits); a
+// tabela de lux é gerada a partir destes valores em tempo de compilação
+constexpr float LDR_GAMMA = 0.7;
+constexpr float LDR_RL10_KOHMS = 50;          // Resistência a 10 lux
+constexpr float LDR_SERIES_OHMS = 10000;
+constexpr int LDR_ADC_MAX = 4095;
+
+// Thresholds para alertas
+const float TEMP_YELLOW = 35.0;
+const float TEMP_RED = 45.0;
+const float HUMIDITY_YELLOW = 80.0;
+const float HUMIDITY_RED = 90.0;
+const float ACCEL_YELLOW = 1.3;  // Vibração leve acima de 1g normal
+const float ACCEL_RED = 1.7;     // Vibração forte
+
+// Histerese dos alertas: para baixar de nível, as leituras têm de ficar
+// abaixo dos limiares reduzidos desta fração por ALERT_CLEAR_MS seguidos
+const float ALERT_HYSTERESIS = 0.05;
+const uint32_t ALERT_CLEAR_MS = 3000;
+
+// Detecção de anomalias (anomaly.h): linha de base por canal com média e
+// variância exponenciais, z-score para desvios bruscos e CUSUM para deriva
+// lenta. Depois do aprendizado o amarelo vem da linha de base da máquina e
+// os limiares vermelhos fixos acima continuam valendo como limite de
+// segurança.
+const uint32_t ANOMALY_PERIOD_MS = 1000;              // Uma janela de vibração por avaliação
+const uint32_t ANOMALY_LEARNING_MS = 10UL * 60 * 1000;
+const uint32_t ANOMALY_MIN_SAMPLES = 100;             // Por canal, para poder alertar
+const float ANOMALY_Z_YELLOW = 4.0;
+const float ANOMALY_Z_RED = 8.0;
+const float ANOMALY_CUSUM_SLACK = 0.5;                // Desvio tolerado (em sigmas)
+const float ANOMALY_CUSUM_YELLOW = 20.0;
+const float ANOMALY_CUSUM_RED = 50.0;
+const uint32_t ANOMALY_DEBOUNCE_MS = 2500;            // Severidade mantida antes de valer
+const uint32_t ANOMALY_PERSIST_MS = 10UL * 60 * 1000; // Linha de base gravada no log
+
+// Captura de vibração: MPU6050 amostra no ritmo abaixo e acumula no FIFO de
+// hardware (1024 bytes, 6 bytes por amostra); a tarefa rápida drena em rajadas
+const uint16_t ACCEL_SAMPLE_RATE_HZ = 1000;
+const uint16_t MPU_MIN_RATE_HZ = 4;          // Divisor de 8 bits sobre 1 kHz: 1000 / 256
+const uint16_t MPU_MAX_RATE_HZ = 1000;       // Taxa base com o DLPF ativo
+static_assert(ACCEL_SAMPLE_RATE_HZ >= MPU_MIN_RATE_HZ && ACCEL_SAMPLE_RATE_HZ <= MPU_MAX_RATE_HZ,
+              "taxa do acelerômetro fora do alcance do divisor do MPU6050");
+const uint16_t MPU_FIFO_SIZE = 1024;
+const uint8_t FIFO_BURST_BYTES = 120;        // Múltiplo de 6, cabe no buffer do Wire (128)
+const uint32_t ACCEL_RING_CAPACITY = 1024;   // Potência de 2, ~1 s a 1 kHz
+
+// Janela deslizante das características de vibração: 8 blocos de 125
+// amostras (1 s a 1 kHz), atualizada a cada bloco (125 ms)
+const uint32_t FEATURE_HOP_SAMPLES = 125;
+const uint32_t FEATURE_WINDOW_BLOCKS = 8;
+
+// Vibração sustentada: RMS da componente dinâmica (g)
+const float VIB_RMS_YELLOW = 0.2;
+const float VIB_RMS_RED = 0.5;
+
+// Análise espectral: FFT real de 512 pontos sobre a magnitude da aceleração
+// (resolução de ~1,95 Hz a 1 kHz, um quadro a cada 512 ms)
+const uint32_t FFT_SIZE = 512;              // Potência de 2
+const uint32_t SPECTRAL_PEAKS = 3;          // Frequências dominantes reportadas
+
+// Bandas de energia com limiares de RMS (g) para o nível de alerta
+struct SpectralBand {
+    const char* name;
+    float lowHz;
+    float highHz;
+    float yellowRms;
+    float redRms;
+};
+
+const SpectralBand SPECTRAL_BANDS[] = {
+    {"low", 2.0, 60.0, 0.15, 0.40},     // Desbalanceamento, desalinhamento, folgas
+    {"mid", 60.0, 200.0, 0.10, 0.25},   // Harmônicos, engrenamento
+    {"high", 200.0, 500.0, 0.05, 0.15}, // Rolamentos, cavitação
+};
+const uint32_t SPECTRAL_BAND_COUNT = sizeof(SPECTRAL_BANDS) / sizeof(SPECTRAL_BANDS[0]);
+
+// Histórico em memória fixa: pontos brutos (um por snapshot, ~2 s) e
+// agregados min/max/média em três resoluções
+const uint32_t HISTORY_RAW_CAPACITY = 300;   // ~10 min
+
+struct HistoryTier {
+    const char* name;       // Valor de "resolution" na API
+    uint32_t periodMs;
+    uint32_t capacity;      // Agregados fechados mantidos
+};
+
+constexpr HistoryTier HISTORY_TIERS[] = {
+    {"10s", 10000, 90},      // 15 min
+    {"1m", 60000, 120},      // 2 h
+    {"10m", 600000, 144},    // 24 h
+};
+const uint32_t HISTORY_TIER_COUNT = sizeof(HISTORY_TIERS) / sizeof(HISTORY_TIERS[0]);
+const uint32_t HISTORY_MEMORY_BUDGET = 40 * 1024;   // Verificado em tempo de compilação
+
+// Log persistente em flash: registros com CRC em segmentos de um setor,
+// gravados em lotes e apagados em rodízio (cada setor uma vez por volta).
+// Na partição de 1,4 MB, menos a fila do uplink, cabem ~24 h de snapshots a
+// cada 2 s.
+const uint32_t FLASH_SECTOR_SIZE = 4096;
+const uint32_t LOG_BATCH_BYTES = 512;                 // Uma escrita por lote
+const uint32_t LOG_FLUSH_PERIOD_MS = 60000;           // Perda máxima em queda de energia
+const uint32_t LOG_MAX_PAYLOAD = 64;
+const uint32_t LOG_REPLAY_MS = 24UL * 3600 * 1000;    // Reinjetado no histórico no boot
+
+// Push de telemetria (WebSocket /api/live): cada cliente escolhe o
+// intervalo; com a fila do cliente cheia a leitura é coalescida (só a mais
+// recente segue) e um cliente parado por LIVE_STALL_MS é desconectado
+const uint32_t LIVE_MAX_CLIENTS = 8;
+const uint32_t LIVE_DEFAULT_INTERVAL_MS = 500;
+const uint32_t LIVE_MIN_INTERVAL_MS = 100;
+const uint32_t LIVE_CLIENT_QUEUE = 2;        // Mensagens na fila TCP por cliente
+const uint32_t LIVE_STALL_MS = 10000;
+
+// Cache das respostas GET /api/status e /api/telemetry (http_cache.h):
+// corpo pré-renderizado uma vez por ciclo de saída, servido com ETag e
+// comprimido em gzip quando o cliente aceita e o corpo passa do mínimo
+const uint32_t HTTP_CACHE_BODY_SIZE = 1280;  // Comporta o registro de telemetria
+const uint32_t HTTP_GZIP_MIN_BYTES = 256;    // Abaixo disso o ganho não paga os cabeçalhos
+const uint32_t GZIP_MAX_INPUT = HTTP_CACHE_BODY_SIZE;
+
+// Uplink para o collector (uplink.h): lotes de registros Environment em
+// gzip numa conexão TCP persistente, retirados da fila só com o ACK. Sem
+// enlace, a fila em RAM transborda para os últimos setores da partição de
+// dados (~2 h de registros a cada 2 s com 32 setores); na volta, o dreno é
+// limitado a UPLINK_DRAIN_BYTES_PER_S. Host vazio: uplink desligado até o
+// comando serial "uplink:HOST:PORTA".
+const char* const UPLINK_DEFAULT_HOST = "";
+const uint16_t UPLINK_DEFAULT_PORT = 7878;          // katabase-ingest
+const uint32_t UPLINK_BATCH_RECORDS = 30;           // Lote fechado cheio...
+const uint32_t UPLINK_BATCH_MAX_AGE_MS = 60000;     // ...ou com o 1º registro há 1 min
+const uint32_t UPLINK_QUEUE_BYTES = 8192;
+const uint32_t UPLINK_SPILL_SECTORS = 32;           // Só com partição de 4x isso ou mais
+const uint32_t UPLINK_DRAIN_BYTES_PER_S = 4096;
+const uint32_t UPLINK_ACK_TIMEOUT_MS = 10000;
+const uint32_t UPLINK_CONNECT_TIMEOUT_MS = 2000;    // Bloqueia só a tarefa do uplink
+const uint32_t UPLINK_RETRY_MIN_MS = 1000;          // Backoff exponencial entre tentativas
+const uint32_t UPLINK_RETRY_MAX_MS = 60000;
+
+// Linha do tempo de overrides (POST /api/scenario): passos por linha do
+// tempo e tamanho máximo do corpo JSON aceito
+const uint16_t TIMELINE_MAX_STEPS = 64;
+const uint32_t TIMELINE_BODY_MAX = 6144;
+
+// DHT22 capturado pelo RMT (ver dht22.h)
+const uint32_t DHT22_MIN_INTERVAL_MS = 2000;   // Entre leituras do sensor
+const uint32_t DHT22_START_MS = 2;             // Pulso de início (mínimo de 1 ms)
+const uint32_t DHT22_CAPTURE_TIMEOUT_MS = 10;  // Quadro completo em ~5 ms
+const uint16_t DHT22_IDLE_US = 200;            // Linha parada: fim do quadro
+
+// Períodos das tarefas no nível ativo (ms)
+const uint32_t FAST_SENSOR_PERIOD_MS = 20;   // Drenagem do FIFO + LDR a 50 Hz
+const uint32_t SLOW_SENSOR_PERIOD_MS = 2000; // DHT22 no limite de 0,5 Hz
+const uint32_t OUTPUT_PERIOD_MS = 2000;      // LCD + JSON serial
+const uint32_t DISPLAY_PERIOD_MS = 100;      // Envio das células alteradas ao LCD
+
+// Amostragem adaptativa (power.h): níveis do mais rápido ao mais econômico.
+// O acelerômetro segue a 1 kHz em todos (as bandas espectrais dependem
+// disso); só muda a frequência com que as tarefas acordam para drenar o
+// FIFO, ler o DHT22 e publicar. Light sleep e modem sleep do WiFi valem
+// entre as rajadas; a API continua acessível (o rádio acorda a cada beacon).
+struct SamplingTier {
+    const char* name;
+    uint32_t fastMs;        // Drenagem do FIFO + LDR
+    uint32_t envMs;         // DHT22
+    uint32_t outputMs;      // Snapshots para LCD, JSON e histórico
+    uint32_t outputPollMs;  // Espera da tarefa de saída (blocos brutos)
+    uint32_t displayMs;
+    uint32_t loopMs;        // loop() do Arduino (WiFi, WebSocket) e tarefa do uplink; com
+                            // clientes no /api/live, o loop() vai a LIVE_MIN_INTERVAL_MS
+    uint32_t calmMs;        // Tempo sem gatilhos para descer a este nível
+    bool lightSleep;
+    bool modemSleep;
+};
+
+constexpr SamplingTier SAMPLING_TIERS[] = {
+    {"active", FAST_SENSOR_PERIOD_MS, SLOW_SENSOR_PERIOD_MS, OUTPUT_PERIOD_MS, 50,
+     DISPLAY_PERIOD_MS, 100, 0, false, false},
+    {"steady", 60, 4000, 2000, 100, 250, 250, 30000, true, true},
+    {"idle", 120, 8000, 4000, 250, 500, 1000, 120000, true, true},
+};
+const uint32_t SAMPLING_TIER_COUNT = sizeof(SAMPLING_TIERS) / sizeof(SAMPLING_TIERS[0]);
+
+// Gatilhos para voltar ao nível ativo: leitura a menos de POWER_NEAR_* do
+// limiar amarelo, alerta ativo ou variação maior que POWER_TREND_* dentro de
+// POWER_TREND_WINDOW_MS. A menos do dobro da faixa (ou com clientes no
+// WebSocket) o nível não passa de steady.
+const float POWER_NEAR_TEMPERATURE = 3.0;     // °C abaixo de TEMP_YELLOW
+const float POWER_NEAR_HUMIDITY = 5.0;        // % abaixo de HUMIDITY_YELLOW
+const float POWER_NEAR_ACCEL = 0.1;           // g abaixo de ACCEL_YELLOW (pico, com 1 g da gravidade)
+const float POWER_NEAR_VIB_RMS = 0.07;        // g abaixo de VIB_RMS_YELLOW
+const uint32_t POWER_TREND_WINDOW_MS = 30000;
+const float POWER_TREND_TEMPERATURE = 0.5;    // °C
+const float POWER_TREND_HUMIDITY = 2.0;       // %
+const float POWER_TREND_VIB_RMS = 0.05;       // g
+
+// Profundidade das filas entre tarefas (tamanho fixo)
+const uint32_t FAST_QUEUE_DEPTH = 64;
+const uint32_t SLOW_QUEUE_DEPTH = 4;
+const uint32_t OUTPUT_QUEUE_DEPTH = 4;
+const uint32_t RAW_QUEUE_DEPTH = 16;         // Blocos de 64 amostras brutas (~1 s)
+
+// Prioridades (FreeRTOS: maior = mais prioritário)
+const uint32_t FAST_SENSOR_PRIORITY = 5;
+const uint32_t SLOW_SENSOR_PRIORITY = 4;
+const uint32_t ALERT_PRIORITY = 3;
+const uint32_t OUTPUT_PRIORITY = 1;
+const uint32_t DISPLAY_PRIORITY = 1;
+const uint32_t UPLINK_PRIORITY = 1;
+
+// Stacks em bytes
+const uint32_t FAST_SENSOR_STACK = 4096;
+const uint32_t SLOW_SENSOR_STACK = 4096;
+const uint32_t ALERT_STACK = 4096;
+const uint32_t OUTPUT_STACK = 8192;
+const uint32_t DISPLAY_STACK = 3072;
+const uint32_t UPLINK_STACK = 6144;          // Resolução do host e connect do lwIP
+
+// Núcleos: aquisição e alertas no APP_CPU, saída junto da pilha WiFi no PRO_CPU
+const int ACQUISITION_CORE = 1;
+const int OUTPUT_CORE = 0;
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3), usado nos quadros da serial e no log em flash
+uint32_t crc32(const uint8_t* data, size_t len);
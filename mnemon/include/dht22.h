@@ -0,0 +1,111 @@
+#pragma once
+
+// Decodificação do protocolo de um fio do DHT22, separada da captura.
+//
+// A captura (RMT no ESP32, ver hal_esp32.cpp; trem sintético no build
+// nativo) entrega segmentos de nível com duração em µs. Dht22PulseTrain os
+// agrupa em pulsos (nível baixo seguido de nível alto); dht22Decode acha no
+// trem a resposta do sensor e os 40 bits que a seguem:
+//
+//   host  ‾‾\___ ≥1 ms ___/‾ 20-40 µs ‾
+//   DHT22                              \__ 80 __/‾‾ 80 ‾‾\__ 50 __/‾ 26-28 (0) ou 70 (1) ‾\ ... \__ 50 __/‾‾‾
+//                                       resposta           bit (×40, MSB primeiro)              fim
+//
+// Os bits são, em ordem: umidade (16, décimos de %), temperatura (16,
+// décimos de °C, bit 15 = sinal) e checksum (soma dos 4 bytes anteriores).
+// Pulsos antes da resposta (cauda do pulso de início) são ignorados.
+//
+// Dht22Reader guarda o último quadro com o instante da captura e segura o
+// intervalo mínimo de 2 s entre leituras do sensor.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+struct Dht22Pulse {
+    uint16_t lowUs;
+    uint16_t highUs;    // 0 no pulso de fim (linha ociosa até o fim da captura)
+};
+
+enum class Dht22Status : uint8_t {
+    Ok,
+    NoResponse,     // Sem a resposta de 80/80 µs (sensor ausente ou capturado tarde)
+    Truncated,      // Menos de 40 bits depois da resposta
+    BadTiming,      // Pulso fora das faixas do protocolo (ruído na linha)
+    Checksum,
+    Count
+};
+
+constexpr const char* DHT22_STATUS_NAMES[] = {"ok", "no_response", "truncated", "bad_timing", "checksum"};
+
+static_assert(sizeof(DHT22_STATUS_NAMES) / sizeof(DHT22_STATUS_NAMES[0]) == (size_t)Dht22Status::Count,
+              "DHT22_STATUS_NAMES deve cobrir todos os estados");
+
+const size_t DHT22_BITS = 40;
+
+// Resposta + 40 bits + fim, com folga para a cauda do pulso de início
+const size_t DHT22_MAX_PULSES = 48;
+
+class Dht22PulseTrain {
+public:
+    void clear() { count = 0; level = -1; overflow = false; }
+
+    // Um segmento de nível (níveis repetidos são somados). Segmentos antes do
+    // primeiro nível baixo não formam pulso; além de DHT22_MAX_PULSES os
+    // pulsos são descartados e o trem é marcado como estourado.
+    void add(bool high, uint32_t us);
+
+    const Dht22Pulse* pulses() const { return buffer; }
+    size_t size() const { return count; }
+    bool overflowed() const { return overflow; }
+
+private:
+    Dht22Pulse buffer[DHT22_MAX_PULSES];
+    size_t count = 0;
+    int8_t level = -1;      // -1: nenhum nível baixo ainda
+    bool overflow = false;
+};
+
+struct Dht22Frame {
+    float temperature;
+    float humidity;
+};
+
+Dht22Status dht22Decode(const Dht22Pulse* pulses, size_t count, Dht22Frame& frame);
+
+// Gera o trem de um quadro nas temporizações nominais (simulação no host)
+size_t dht22Encode(const Dht22Frame& frame, Dht22Pulse* pulses, size_t maxPulses);
+
+struct Dht22Stats {
+    uint32_t reads;                                 // Capturas disparadas
+    uint32_t results[(size_t)Dht22Status::Count];   // Capturas por estado
+};
+
+class Dht22Reader {
+public:
+    // Se a última captura foi há menos de DHT22_MIN_INTERVAL_MS, não dispara
+    // outra e mantém o quadro guardado
+    bool due(uint32_t nowMs) const { return !started || nowMs - lastStartMs >= DHT22_MIN_INTERVAL_MS; }
+    void start(uint32_t nowMs);
+
+    // Decodifica a captura disparada por último
+    Dht22Status complete(const Dht22PulseTrain& train);
+
+    // Último quadro válido e o instante em que a sua captura foi disparada;
+    // retorna false se a última captura falhou (o quadro anterior fica em
+    // frame, se houver)
+    bool frame(Dht22Frame& frame, uint32_t& capturedMs) const;
+
+    Dht22Status lastStatus() const { return status; }
+    Dht22Stats stats() const { return counters; }
+
+private:
+    Dht22Frame last = {};
+    uint32_t lastStartMs = 0;
+    uint32_t lastFrameMs = 0;
+    bool started = false;
+    bool valid = false;
+    Dht22Status status = Dht22Status::NoResponse;
+    Dht22Stats counters = {};
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "samples.h"
+
+// O LCD é desenhado em um framebuffer de sombra: a tarefa de saída só
+// formata texto nele, e displayFlush() (tarefa própria, de baixa
+// prioridade) compara com o que está no vidro e envia apenas as células
+// alteradas, agrupadas em sequências com um único posicionamento de cursor.
+
+void displayBegin();
+
+void updateLCDDisplay(const Snapshot& snapshot);
+
+// Mensagem temporária (WiFi, troca de cenário) exibida pela tarefa de saída
+// no lugar dos dados, sem bloquear quem a solicitou
+void showLcdMessage(const char* line1, const char* line2, uint32_t durationMs);
+
+// Retorna true se uma mensagem temporária ocupa o LCD neste instante
+bool renderLcdMessage();
+
+// Envia ao LCD as diferenças entre o framebuffer e o vidro; retorna o
+// número de bytes (comandos de cursor + caracteres) enviados
+uint32_t displayFlush();
@@ -0,0 +1,96 @@
+#pragma once
+
+// Log persistente em flash, só de acréscimo, com CRC por registro.
+//
+// A partição é dividida em segmentos de um setor. Cada segmento começa com
+// um cabeçalho {magic, seq, tempo do primeiro registro, crc32}; o segmento
+// com maior seq válido é a cabeça. Os registros seguem o cabeçalho:
+//
+//   u16 length | u8 type | u8 reserved | u32 time_ms | u32 crc32 | payload
+//
+// (alinhados a 4 bytes; 0xFFFF no length marca área apagada). O CRC cobre
+// os 8 primeiros bytes e o payload.
+//
+// As escritas são acumuladas em um lote em RAM e gravadas de uma vez quando
+// o lote enche, o segmento acaba ou passa LOG_FLUSH_PERIOD_MS. Ao encher a
+// cabeça, o segmento seguinte (o mais antigo) é apagado e recebe seq + 1,
+// de modo que os setores são apagados em rodízio.
+//
+// No boot, begin() lê só os cabeçalhos para achar a cabeça e varre os
+// registros dela até a área apagada. Uma escrita interrompida (registro com
+// CRC inválido ou lixo após o último registro) encerra a cabeça e a escrita
+// segue no próximo segmento. Não há RTC: o relógio do log continua do
+// último registro gravado, sem contar o tempo desligado.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+enum class LogRecordType : uint8_t {
+    History = 1,    // float[HISTORY_METRIC_COUNT] (ver history.h)
+    Baseline = 2    // AnomalyBaseline (ver anomaly.h)
+};
+
+struct FlashLogStats {
+    uint32_t segments;
+    uint32_t headSegment;
+    uint32_t headSeq;
+    uint32_t records;         // Registros gravados desde o boot
+    uint32_t flushes;
+    uint32_t erases;
+    uint32_t tornRecords;     // Escritas interrompidas encontradas no boot
+    uint32_t writeErrors;
+};
+
+// Visitante do replay: registros do mais antigo para o mais novo
+typedef void (*LogVisitor)(LogRecordType type, uint32_t timeMs,
+                           const uint8_t* payload, size_t length, void* context);
+
+class FlashLog {
+public:
+    // Varre a partição (halFlash*) menos os últimos reservedSectors setores
+    // (fila do uplink); false se não houver flash utilizável
+    bool begin(uint32_t reservedSectors = 0);
+
+    bool enabled() const { return segmentCount >= 2; }
+
+    // Relógio persistente: tempo do último registro antes do boot + uptime
+    uint32_t clock(uint32_t uptimeMs) const { return clockBase + uptimeMs; }
+
+    bool append(LogRecordType type, uint32_t timeMs, const void* payload, size_t length);
+    bool flush();
+
+    // Percorre os registros com time_ms >= fromMs; retorna quantos visitou
+    uint32_t replay(uint32_t fromMs, LogVisitor visitor, void* context) const;
+
+    FlashLogStats stats() const;
+
+private:
+    struct SegmentHeader {
+        uint32_t magic;
+        uint32_t seq;
+        uint32_t firstTimeMs;
+        uint32_t crc;
+    };
+
+    bool readHeader(uint32_t segment, SegmentHeader& header) const;
+    bool startSegment(uint32_t segment, uint32_t seq, uint32_t timeMs);
+    bool advance(uint32_t timeMs);
+    uint32_t scanSegment(uint32_t segment, uint32_t fromMs, LogVisitor visitor,
+                         void* context, uint32_t& lastTimeMs, bool& torn,
+                         uint32_t& visited) const;
+
+    uint32_t segmentCount = 0;
+    uint32_t head = 0;
+    uint32_t headSeq = 0;
+    uint32_t writeOffset = 0;       // Próximo byte livre na cabeça
+    uint32_t clockBase = 0;
+    uint32_t batchStartMs = 0;
+    size_t batchLength = 0;
+    uint8_t batch[LOG_BATCH_BYTES];
+    FlashLogStats counters = {};
+};
+
+// Instância do firmware (escrita pela tarefa de saída)
+FlashLog& flashLog();
@@ -0,0 +1,82 @@
+#pragma once
+
+// Compressão gzip (RFC 1952) de corpos HTTP pequenos, sem alocação: LZ77
+// por cadeias de hash e um único bloco deflate, com códigos de Huffman
+// próprios do corpo ou os fixos, o que sair menor. Num JSON de ~500 bytes
+// quase todo literal, as tabelas próprias valem ~20% a mais que as fixas.
+//
+// O LZ77 roda duas vezes (contagem e emissão) em vez de guardar os tokens;
+// entre as duas o vetor das cadeias serve de rascunho para montar as
+// árvores. O estado (~5 KB) fica no objeto: uma instância por tarefa.
+//
+// GzipDecoder faz o caminho inverso para quem recebe os lotes do uplink
+// (uplink.h; katabase-ingest) e para as verificações nativas.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+class GzipEncoder {
+public:
+    // Retorna o tamanho do fluxo gzip em out, ou 0 se a entrada passar de
+    // GZIP_MAX_INPUT ou a saída não couber em capacity
+    size_t encode(const uint8_t* in, size_t length, uint8_t* out, size_t capacity);
+
+    static const uint32_t LITERALS = 286;   // 0-255, fim de bloco, 29 comprimentos
+    static const uint32_t DISTANCES = 30;
+    static const uint32_t CODE_LENGTHS = 19;
+
+private:
+    template <typename Literal, typename Match>
+    void parse(const uint8_t* in, size_t length, Literal literal, Match match);
+
+    static const uint32_t HASH_BITS = 9;
+    static const uint32_t MAX_CHAIN = 8;     // Candidatos examinados por posição
+    // Árvore de n folhas: ordem (n) + pesos e pais dos 2n nós
+    static const uint32_t TREE_WORK = 5 * LITERALS;
+
+    int16_t head[1 << HASH_BITS];
+    uint16_t chain[GZIP_MAX_INPUT > TREE_WORK ? GZIP_MAX_INPUT : TREE_WORK];
+
+    uint16_t literalFreq[LITERALS];
+    uint16_t distanceFreq[DISTANCES];
+    uint16_t codeLengthFreq[CODE_LENGTHS];
+    uint8_t lengths[LITERALS + DISTANCES];  // Literais e depois distâncias, como no cabeçalho
+    uint8_t codeLengthLengths[CODE_LENGTHS];
+    uint16_t literalCode[LITERALS];
+    uint16_t distanceCode[DISTANCES];
+    uint16_t codeLengthCode[CODE_LENGTHS];
+};
+
+// Inflate de um membro gzip com blocos armazenados, fixos ou dinâmicos, no
+// estilo do puff do zlib (decodificação canônica bit a bit), sem alocação
+class GzipDecoder {
+public:
+    // Escreve os dados em out; false se o fluxo for inválido, o CRC ou o
+    // tamanho do trailer não conferirem ou a saída passar de capacity
+    bool decode(const uint8_t* in, size_t length, uint8_t* out, size_t capacity, size_t& outLength);
+
+private:
+    struct Huffman {
+        uint16_t count[16];
+        uint16_t symbol[288];
+
+        void build(const uint8_t* lengths, uint32_t n);
+    };
+
+    bool stored();
+    bool dynamicTables(Huffman& literals, Huffman& distances);
+    bool block(const Huffman& literals, const Huffman& distances);
+    uint32_t decodeSymbol(const Huffman& h);
+    uint32_t bits(uint32_t count);
+
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+    uint32_t used;          // Bits já consumidos de data[pos]
+    bool bad;
+    uint8_t* out;
+    size_t capacity;
+    size_t written;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+// Camada de abstração de hardware. Toda a lógica de aquisição, alertas e
+// saída passa por estas funções; hal_esp32.cpp as implementa com as
+// bibliotecas Arduino e native/hal_native.cpp com drivers simulados.
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Dht22PulseTrain;
+
+void halInit();
+
+uint32_t halMillis();
+
+// Contador de ciclos para instrumentação (ESP32: ciclos da CPU, por núcleo;
+// nativo: ns do relógio real, mesmo com o relógio virtual)
+uint32_t halCycles();
+uint32_t halCyclesPerMicro();
+
+// DHT22: pulso de início e captura dos níveis da linha em train, sem
+// desligar interrupções (a tarefa dorme durante a captura); a decodificação
+// fica em dht22.h. Retorna false se nada foi capturado no prazo.
+bool halDhtCapture(Dht22PulseTrain& train);
+
+// LDR: valor bruto do ADC de 12 bits (0-4095)
+int halReadLDR();
+
+// MPU6050 em modo FIFO (somente acelerômetro, 6 bytes big-endian por amostra);
+// false com a taxa fora de MPU_MIN_RATE_HZ..MPU_MAX_RATE_HZ
+bool halAccelFifoBegin(uint16_t sampleRateHz);
+uint16_t halAccelFifoCount();
+void halAccelFifoRead(uint8_t* data, uint8_t len);
+bool halAccelFifoOverflowed();   // Lê e limpa o flag de overflow
+void halAccelFifoReset();
+
+// Atuadores
+void halSetRGB(bool red, bool green, bool blue);
+void halSetBuzzer(bool on);
+
+// LCD 16x2 (acesso ao I2C serializado internamente)
+void halLcdClear();
+void halLcdPrint(uint8_t col, uint8_t row, const char* text);
+
+// Saída serial
+void halSerialWrite(const char* data, size_t len);
+
+// Energia: configura o light sleep automático (ESP32: esp_pm com tickless
+// idle; só existe se o sdkconfig tiver CONFIG_PM_ENABLE). Retorna false se
+// o build não o suporta; o modem sleep do WiFi funciona nos dois casos.
+bool halPowerBegin();
+// Liga ou desliga o light sleep entre as rajadas e o modem sleep do WiFi
+void halPowerSetMode(bool lightSleep, bool modemSleep);
+
+// Partição de dados em flash para o log persistente. Semântica de NOR:
+// apagar um setor (FLASH_SECTOR_SIZE) deixa 0xFF e escrever só zera bits.
+uint32_t halFlashSize();         // 0 se não houver partição
+bool halFlashRead(uint32_t offset, void* data, size_t len);
+bool halFlashWrite(uint32_t offset, const void* data, size_t len);
+bool halFlashEraseSector(uint32_t offset);
+
+// Conexão TCP do uplink (uplink.h), uma por vez, usada só pela tarefa do
+// uplink. Connect bloqueia até timeoutMs; write e read não bloqueiam e
+// retornam os bytes aceitos ou lidos (0 se nada), ou -1 com a conexão
+// perdida (fechada com halUplinkClose).
+bool halUplinkConnect(const char* host, uint16_t port, uint32_t timeoutMs);
+int halUplinkWrite(const uint8_t* data, size_t len);
+int halUplinkRead(uint8_t* data, size_t len);
+void halUplinkClose();
+
+// Número aleatório (ESP32: gerador de hardware)
+uint32_t halRandom();
@@ -0,0 +1,144 @@
+#pragma once
+
+// Histórico temporal em memória fixa, para consulta pela API.
+//
+// Os timestamps vêm do relógio do log em flash (flashLog().clock()), que
+// continua entre reinícios; o histórico das últimas horas é reinjetado do
+// log no boot.
+//
+// Cada snapshot vira um ponto bruto (ring de HISTORY_RAW_CAPACITY) e entra
+// nos agregados abertos de cada resolução de HISTORY_TIERS; ao virar o
+// período, o agregado (min/max/média por métrica) fecha e vai para o ring da
+// resolução. Todos os rings são indexados por um número de sequência
+// absoluto, de modo que uma leitura em andamento detecta itens sobrescritos.
+//
+// A leitura gera JSON em blocos de qualquer tamanho (resposta chunked), sem
+// montar a resposta inteira em memória.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "rtos.h"
+#include "samples.h"
+
+enum class HistoryMetric : uint8_t {
+    Temperature,
+    Humidity,
+    Lux,
+    VibrationRms,
+    VibrationPeak,
+    Count
+};
+
+struct HistoryMetricInfo {
+    const char* name;       // Valor de "sensor" na API
+    uint8_t decimals;
+};
+
+constexpr HistoryMetricInfo HISTORY_METRICS[] = {
+    {"temperature", 1},
+    {"humidity", 1},
+    {"lux", 0},
+    {"vibration_rms", 3},
+    {"vibration_peak", 2},
+};
+
+const size_t HISTORY_METRIC_COUNT = (size_t)HistoryMetric::Count;
+static_assert(sizeof(HISTORY_METRICS) / sizeof(HISTORY_METRICS[0]) == HISTORY_METRIC_COUNT,
+              "HISTORY_METRICS deve cobrir todas as métricas");
+
+// Resolução 0 = pontos brutos; 1.. = HISTORY_TIERS[resolution - 1]
+const uint8_t HISTORY_RAW = 0;
+
+bool findHistoryMetric(const char* name, HistoryMetric& metric);
+bool findHistoryResolution(const char* name, uint8_t& resolution);
+const char* historyResolutionName(uint8_t resolution);
+
+constexpr uint32_t historyTierCapacity() {
+    uint32_t total = 0;
+    for (const HistoryTier& tier : HISTORY_TIERS) total += tier.capacity;
+    return total;
+}
+
+const uint32_t HISTORY_TIER_CAPACITY = historyTierCapacity();
+
+struct HistoryQuery {
+    HistoryMetric metric;
+    uint8_t resolution;
+    uint32_t fromMs;        // Só pontos com timestamp >= fromMs (uptime)
+};
+
+// Estado de uma leitura em blocos; copiável (vive na resposta HTTP)
+struct HistoryCursor {
+    HistoryQuery query;
+    uint32_t nowMs;
+    uint32_t next;          // Sequência do próximo item
+    uint8_t stage;
+    bool firstItem;
+    uint8_t pendingLength;
+    uint8_t pendingOffset;
+    char pending[128];      // Item já formatado que não coube no último bloco
+};
+
+class HistoryStore {
+public:
+    HistoryStore();
+
+    void begin();
+    void clear();
+
+    void record(uint32_t timestampMs, const float values[HISTORY_METRIC_COUNT]);
+
+    // Valores de cada métrica no snapshot, na ordem de HistoryMetric
+    static void values(const Snapshot& snapshot, float values[HISTORY_METRIC_COUNT]);
+
+    void open(const HistoryQuery& query, uint32_t nowMs, HistoryCursor& cursor) const;
+
+    // Escreve até capacity bytes do JSON; retorna 0 quando a resposta acabou
+    size_t readChunk(HistoryCursor& cursor, char* buffer, size_t capacity) const;
+
+    // Itens disponíveis na resolução (agregados fechados, para os tiers)
+    uint32_t size(uint8_t resolution) const;
+
+    // Memória total, constante de compilação (ver HISTORY_MEMORY_BUDGET)
+    static constexpr size_t footprint();
+
+private:
+    struct RawPoint {
+        uint32_t timestampMs;
+        float values[HISTORY_METRIC_COUNT];
+    };
+
+    struct Bucket {
+        uint32_t startMs;
+        uint16_t count[HISTORY_METRIC_COUNT];
+        float min[HISTORY_METRIC_COUNT];
+        float max[HISTORY_METRIC_COUNT];
+        float mean[HISTORY_METRIC_COUNT];   // Soma enquanto o agregado está aberto
+    };
+
+    void reset();
+    bool fill(HistoryCursor& cursor) const;
+    bool nextItem(HistoryCursor& cursor) const;
+    bool openItem(HistoryCursor& cursor) const;
+    uint32_t oldest(uint8_t resolution) const;
+    bool endsBefore(uint8_t resolution, uint32_t seq, uint32_t fromMs) const;
+    const Bucket& bucketAt(uint8_t tier, uint32_t seq) const;
+    static void finishBucket(Bucket& bucket);
+
+    RawPoint raw[HISTORY_RAW_CAPACITY];
+    Bucket buckets[HISTORY_TIER_CAPACITY];    // Rings dos tiers, contíguos
+    Bucket current[HISTORY_TIER_COUNT];     // Agregados em formação
+    bool currentActive[HISTORY_TIER_COUNT];
+    uint32_t tierOffset[HISTORY_TIER_COUNT];
+    uint32_t total[1 + HISTORY_TIER_COUNT]; // Itens já gravados por resolução
+    mutable StaticMutex mutex;
+};
+
+constexpr size_t HistoryStore::footprint() {
+    return sizeof(HistoryStore);
+}
+
+// Instância do firmware (alimentada pela tarefa de saída)
+HistoryStore& history();
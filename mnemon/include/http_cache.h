@@ -0,0 +1,92 @@
+#pragma once
+
+// Cache das respostas de GET /api/status e GET /api/telemetry.
+//
+// O corpo é renderizado na primeira requisição depois que a chave do
+// endpoint muda (um registro de telemetria novo por ciclo de saída, troca
+// de overrides ou de cenário); as demais requisições do ciclo recebem o
+// mesmo corpo, sem renderizar nem comprimir de novo (o servidor só o copia
+// para a resposta). O ETag é o CRC-32
+// do corpo: um cliente que manda If-None-Match com ele recebe 304 sem corpo,
+// e uma regeneração com o mesmo conteúdo mantém o ETag. Corpos a partir de
+// HTTP_GZIP_MIN_BYTES também são comprimidos na regeneração (gzip.h) e
+// servidos assim a quem aceita gzip.
+//
+// Dois slots alternados: a regeneração escreve no outro slot e só então o
+// publica, comparando o CRC com o do anterior. O corpo em CachedResponse
+// vale até o próximo refresh(): quem responde copia antes de devolver o
+// controle ao servidor. refresh() e select() rodam numa única tarefa
+// (async_tcp no ESP32).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+struct CachedResponse {
+    uint16_t status;        // 200, ou 304 sem corpo
+    const uint8_t* body;
+    size_t length;
+    bool gzip;              // Content-Encoding: gzip
+    const char* etag;       // Já entre aspas
+};
+
+struct ResponseCacheStats {
+    uint32_t requests;
+    uint32_t renders;       // Chamadas de Render (uma por mudança de chave)
+    uint32_t notModified;
+    uint32_t gzipped;
+    uint64_t bodyBytes;     // Corpos enviados
+};
+
+class ResponseCache {
+public:
+    // Escreve o corpo em buffer; retorna o tamanho, ou 0 se não houver corpo
+    // (telemetria antes do primeiro ciclo, estouro do buffer)
+    typedef size_t (*Render)(char* buffer, size_t capacity, const void* context);
+
+    explicit ResponseCache(Render render) : render(render) {}
+
+    // Renderiza de novo se key mudou desde a última renderização
+    void refresh(uint64_t key, const void* context);
+
+    // Resposta para os cabeçalhos If-None-Match e Accept-Encoding (NULL se
+    // ausentes); false enquanto não houver corpo
+    bool select(const char* ifNoneMatch, const char* acceptEncoding, CachedResponse& out);
+
+    ResponseCacheStats stats() const { return counters; }
+
+private:
+    struct Slot {
+        uint8_t body[HTTP_CACHE_BODY_SIZE];
+        uint8_t gzip[HTTP_CACHE_BODY_SIZE];
+        size_t length;
+        size_t gzipLength;      // 0: não compensa ou não coube
+        uint32_t crc;
+        char etag[16];          // "xxxxxxxx" e "xxxxxxxx-gz"
+        char gzipEtag[16];
+    };
+
+    Render render;
+    Slot slots[2] = {};
+    uint8_t active = 0;
+    bool rendered = false;      // slots[active] tem corpo
+    bool keyed = false;
+    uint64_t key = 0;
+    ResponseCacheStats counters = {};
+};
+
+// Entrada com ETag do cliente presente na lista de If-None-Match (ou "*")
+bool etagMatches(const char* ifNoneMatch, const char* etag);
+
+// Accept-Encoding com gzip e sem q=0
+bool acceptsGzip(const char* acceptEncoding);
+
+// Caches dos dois endpoints, com as chaves tiradas do estado global; rodam
+// refresh() e select() (wifiIp entra no corpo de /api/status)
+bool serveStatus(const char* wifiIp, const char* ifNoneMatch, const char* acceptEncoding,
+                 CachedResponse& out);
+bool serveTelemetry(const char* ifNoneMatch, const char* acceptEncoding, CachedResponse& out);
+
+ResponseCacheStats statusCacheStats();
+ResponseCacheStats telemetryCacheStats();
@@ -0,0 +1,55 @@
+#pragma once
+
+// Escritor JSON sequencial sobre um buffer fornecido pelo chamador: sem DOM,
+// sem alocação, sem String. Os números são formatados em ponto fixo com o
+// mesmo arredondamento usado antes (round(x * 10^d) / 10^d, produto em float) e com a mesma
+// apresentação do ArduinoJson (zeros à direita removidos, NaN como null),
+// de modo que a saída permanece byte a byte compatível com o esquema anterior.
+
+#include <stddef.h>
+#include <stdint.h>
+
+class JsonWriter {
+public:
+    JsonWriter(char* buffer, size_t capacity);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char* name);
+
+    void string(const char* value);
+    void integer(long value);
+    void unsignedInteger(unsigned long value);
+    void boolean(bool value);
+    void fixed(float value, uint8_t decimals);
+
+    // Atalhos chave + valor
+    void field(const char* name, const char* value) { key(name); string(value); }
+    void field(const char* name, long value) { key(name); integer(value); }
+    void field(const char* name, unsigned long value) { key(name); unsignedInteger(value); }
+    void field(const char* name, int value) { key(name); integer(value); }
+    void field(const char* name, bool value) { key(name); boolean(value); }
+    void field(const char* name, float value, uint8_t decimals) { key(name); fixed(value, decimals); }
+
+    size_t length() const { return len; }
+    bool overflowed() const { return overflow; }
+    const char* c_str() const { return buf; }
+
+private:
+    void separator();
+    void put(char c);
+    void put(const char* text);
+    void putUnsigned(uint64_t value);
+    void putQuoted(const char* value);
+
+    char* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+    uint32_t hasItems;   // Bit por nível de aninhamento: já há item neste nível
+    uint8_t depth;
+    bool afterKey;
+};
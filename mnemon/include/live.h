@@ -0,0 +1,113 @@
+#pragma once
+
+// Canal de push da telemetria: a tarefa de alertas publica a leitura mais
+// recente e as transições de alerta; pump() (no firmware, o loop(), que
+// também limpa a lista de clientes do AsyncWebSocket) codifica cada
+// mensagem uma vez e a distribui aos assinantes.
+//
+// Controle de fluxo por cliente: uma mensagem só é entregue se o transporte
+// disser que o cliente tem espaço na fila (LIVE_CLIENT_QUEUE). Leituras não
+// entregues são coalescidas (a próxima entrega leva a mais recente); a
+// última transição de alerta fica pendente e vai antes da próxima leitura.
+// Um cliente sem espaço por LIVE_STALL_MS é fechado.
+//
+// O transporte é um conjunto de callbacks: AsyncWebSocket no firmware,
+// clientes simulados no teste de carga do build nativo. pump() o chama com
+// o mutex livre, então publish() e stats() não esperam pelos envios.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "alert_level.h"
+#include "config.h"
+#include "rtos.h"
+#include "samples.h"
+
+struct LiveTransport {
+    bool (*ready)(uint32_t clientId, void* context);   // Cabe mais uma mensagem?
+    bool (*send)(uint32_t clientId, const char* data, size_t length, void* context);
+    void (*close)(uint32_t clientId, void* context);
+    void* context;
+};
+
+struct LiveClient {
+    uint32_t id;
+    uint32_t intervalMs;
+    uint32_t lastSendMs;
+    uint32_t blockedSinceMs;     // 0 = com espaço na última tentativa
+    uint32_t sampleSeq;          // Última leitura entregue
+    uint32_t alertSeq;           // Última transição entregue
+    uint32_t sent;
+    uint32_t coalesced;          // Leituras adiadas por fila cheia
+    bool active;
+};
+
+struct LiveStats {
+    uint32_t clients;
+    uint32_t samples;            // Leituras publicadas
+    uint32_t alerts;             // Transições publicadas
+    uint32_t messages;           // Entregas (todas as mensagens e clientes)
+    uint32_t coalesced;          // Leituras adiadas por fila cheia (todos os clientes)
+    uint32_t rejected;           // Conexões recusadas (tabela cheia)
+    uint32_t evicted;            // Clientes fechados por ficarem parados
+};
+
+class LiveHub {
+public:
+    // A tabela de clientes é do chamador (tamanho fixo, sem alocação)
+    LiveHub(LiveClient* clients, size_t capacity);
+
+    void begin();
+    void setTransport(const LiveTransport& transport);
+
+    // Conexões (servidor HTTP); false se não houver vaga
+    bool addClient(uint32_t id, uint32_t intervalMs, uint32_t nowMs);
+    void removeClient(uint32_t id);
+    void setInterval(uint32_t id, uint32_t intervalMs);
+
+    // Produtor (tarefa de alertas)
+    void publish(const LiveSample& sample);
+    void publishAlert(AlertLevel from, AlertLevel to, uint32_t timestampMs);
+
+    // Distribuição (loop() no firmware); retorna as mensagens entregues
+    uint32_t pump(uint32_t nowMs);
+
+    LiveStats stats() const;
+
+    // Sem o mutex: a tarefa de alertas consulta a cada passo
+    uint32_t clientCount() const { return activeClients.load(std::memory_order_relaxed); }
+
+private:
+    static uint32_t clampInterval(uint32_t intervalMs);
+    void encodeSample(const LiveSample& sample, uint32_t seq);
+    void encodeAlert(AlertLevel from, AlertLevel to, uint32_t timestampMs, uint32_t seq);
+
+    LiveClient* clients;
+    size_t capacity;
+    LiveTransport transport = {};
+    mutable StaticMutex mutex;
+
+    // Último estado publicado (protegido por mutex)
+    LiveSample latest = {};
+    uint32_t latestSeq = 0;
+    AlertLevel alertFrom = AlertLevel::Normal;
+    AlertLevel alertTo = AlertLevel::Normal;
+    uint32_t alertMs = 0;
+    uint32_t latestAlertSeq = 0;
+
+    // Mensagens codificadas uma vez por sequência (só quem chama pump())
+    char sampleMessage[256];
+    size_t sampleLength = 0;
+    uint32_t encodedSampleSeq = 0;
+    char alertMessage[128];
+    size_t alertLength = 0;
+    uint32_t encodedAlertSeq = 0;
+
+    LiveStats counters = {};                // clients vem de activeClients
+    std::atomic<uint32_t> activeClients{0};
+};
+
+// Instância do firmware (/api/live)
+LiveHub& liveHub();
@@ -0,0 +1,82 @@
+#pragma once
+
+// Conversão LDR -> lux por tabela de 4096 entradas (uma por código do ADC
+// de 12 bits), gerada em tempo de compilação a partir do mesmo modelo
+// GAMMA/RL10 de antes. O constexpr do C++17 não tem pow(), então log e exp
+// são calculados aqui em double por séries, com precisão de ~1e-15.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+namespace luxmath {
+
+constexpr double LN2 = 0.693147180559945309417;
+
+// ln(x) = k*ln2 + 2*atanh((m-1)/(m+1)), com x = m * 2^k e m em [1, 2)
+constexpr double log(double x) {
+    int k = 0;
+    while (x >= 2.0) { x /= 2.0; k++; }
+    while (x < 1.0) { x *= 2.0; k--; }
+    double z = (x - 1.0) / (x + 1.0);
+    double z2 = z * z;
+    double term = z;
+    double sum = 0.0;
+    for (int n = 1; n < 60; n += 2) {
+        sum += term / n;
+        term *= z2;
+    }
+    return k * LN2 + 2.0 * sum;
+}
+
+// exp(y) = 2^k * exp(r), com |r| <= ln2/2 pela série de Taylor
+constexpr double exp(double y) {
+    int k = (int)(y / LN2 + (y >= 0 ? 0.5 : -0.5));
+    double r = y - k * LN2;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 30; n++) {
+        term *= r / n;
+        sum += term;
+    }
+    for (; k > 0; k--) sum *= 2.0;
+    for (; k < 0; k++) sum /= 2.0;
+    return sum;
+}
+
+constexpr double pow(double x, double y) {
+    return x <= 0.0 ? 0.0 : exp(y * log(x));
+}
+
+} // namespace luxmath
+
+// Modelo do divisor com o LDR: R = R_série * (ADC_MAX - raw) / raw e
+// lux = (RL10 * 10^GAMMA / R)^(1/GAMMA). Os extremos, em que o modelo não
+// é definido, saturam: 0 lux com o ADC em 0 e o valor de ADC_MAX - 1 no topo.
+constexpr double luxModel(int raw) {
+    if (raw <= 0) {
+        return 0.0;
+    }
+    if (raw >= LDR_ADC_MAX) {
+        raw = LDR_ADC_MAX - 1;
+    }
+    double resistance = (double)(LDR_ADC_MAX - raw) * LDR_SERIES_OHMS / raw;
+    double gamma = LDR_GAMMA;
+    double inverseGamma = (float)(1 / LDR_GAMMA);   // Como no cálculo original, em float
+    return luxmath::pow(LDR_RL10_KOHMS * 1e3 * luxmath::pow(10, gamma) / resistance, inverseGamma);
+}
+
+const size_t LUX_TABLE_SIZE = LDR_ADC_MAX + 1;
+
+struct LuxTable {
+    float lux[LUX_TABLE_SIZE];
+};
+
+constexpr LuxTable makeLuxTable() {
+    LuxTable table = {};
+    for (size_t raw = 0; raw < LUX_TABLE_SIZE; raw++) {
+        table.lux[raw] = (float)luxModel((int)raw);
+    }
+    return table;
+}
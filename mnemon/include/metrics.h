@@ -0,0 +1,104 @@
+#pragma once
+
+// Instrumentação de latência por estágio do pipeline: cada estágio tem um
+// histograma logarítmico de durações em ciclos (ESP32: contador de ciclos da
+// CPU; nativo: ns), em memória fixa, de onde saem min/média/p50/p99/max.
+//
+// Cada estágio é medido por uma única tarefa (fixada em um núcleo, de modo
+// que o contador de ciclos é sempre o mesmo); leitores em outras tarefas
+// podem ver um resumo ligeiramente inconsistente, o que basta para
+// diagnóstico.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hal.h"
+
+class JsonWriter;
+
+enum class MetricStage : uint8_t {
+    FastSensor,     // fastSensorStep: drenagem do FIFO + LDR
+    DhtRead,        // Pulso de início + captura do DHT22 (a tarefa dorme)
+    Alert,          // Características, FFT e avaliação do alerta
+    Lcd,            // Envio das células alteradas ao LCD (tarefa do display)
+    Telemetry,      // Codificação e envio serial (JSON ou quadro binário)
+    History,        // Histórico em RAM + log em flash
+    LivePump,       // Distribuição aos clientes do WebSocket
+    OutputCycle,    // Ciclo completo da tarefa de saída para um snapshot
+    Count
+};
+
+constexpr const char* METRIC_STAGE_NAMES[] = {
+    "fast_sensor", "dht_read", "alert", "lcd", "telemetry", "history", "live_pump", "output_cycle",
+};
+
+static_assert(sizeof(METRIC_STAGE_NAMES) / sizeof(METRIC_STAGE_NAMES[0]) == (size_t)MetricStage::Count,
+              "METRIC_STAGE_NAMES deve cobrir todos os estágios");
+
+constexpr const char* metricStageName(MetricStage stage) {
+    return METRIC_STAGE_NAMES[(size_t)stage];
+}
+
+// Quatro sub-faixas por potência de 2: erro relativo de até 25% nos percentis
+const uint32_t METRIC_SUB_BUCKETS = 4;
+const uint32_t METRIC_BUCKETS = METRIC_SUB_BUCKETS + 30 * METRIC_SUB_BUCKETS;
+
+struct StageSummary {
+    uint32_t count;
+    float minUs;
+    float meanUs;
+    float p50Us;
+    float p99Us;
+    float maxUs;
+};
+
+class StageHistogram {
+public:
+    void clear();
+    void record(uint32_t cycles);
+    StageSummary summary(uint32_t cyclesPerMicro) const;
+
+    static uint32_t bucketOf(uint32_t cycles);
+    static uint32_t bucketUpper(uint32_t bucket);   // Maior valor do bucket
+
+private:
+    uint32_t counts[METRIC_BUCKETS];
+    uint32_t total;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t sumCycles;
+};
+
+class StageMetrics {
+public:
+    void begin();
+    void record(MetricStage stage, uint32_t cycles);
+
+    // Pedido de zerar; aplicado por cada estágio na próxima medida, pela
+    // própria tarefa que o escreve
+    void reset() { resetEpoch++; }
+
+    StageSummary summary(MetricStage stage) const;
+
+    // {"unit":"us","cycles_per_us":N,"stages":{"<estágio>":{count,min,mean,p50,p99,max},...}}
+    void write(JsonWriter& json) const;
+
+private:
+    StageHistogram histograms[(size_t)MetricStage::Count];
+    uint32_t epochs[(size_t)MetricStage::Count];
+    volatile uint32_t resetEpoch = 0;
+    uint32_t cyclesPerMicro = 1;
+};
+
+StageMetrics& metrics();
+
+// Mede o escopo atual como um estágio
+class StageTimer {
+public:
+    explicit StageTimer(MetricStage stage) : stage(stage), start(halCycles()) {}
+    ~StageTimer() { metrics().record(stage, halCycles() - start); }
+
+private:
+    MetricStage stage;
+    uint32_t start;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "samples.h"
+
+// Pipeline de aquisição em tarefas FreeRTOS:
+//
+//   fast_sensors (MPU6050 + LDR) --fastQueue--+
+//                                              +--> alerts --outputQueue--> output
+//   slow_sensors (DHT22)         --envQueue---+     (atuadores)   (LCD, JSON, histórico)
+//                                                   \--rawQueue-------->
+//
+// No modo binário a tarefa de alertas também agrupa as amostras brutas em
+// blocos de 64 e os passa à saída pela rawQueue. A leitura mais recente e as
+// transições de alerta vão ao canal de push (live.h), distribuído pela saída.
+// A saída só formata o LCD no framebuffer de sombra; a tarefa display envia
+// ao LCD as células alteradas (display.h). Cada registro também entra no
+// lote aberto do uplink, que o loop() fecha e envia ao collector (uplink.h).
+// Os períodos das tarefas vêm do nível de amostragem atual, escolhido pela
+// tarefa de alertas (power.h).
+//
+// As filas têm tamanho fixo e os produtores nunca bloqueiam: se um
+// consumidor atrasar (LCD lento, reconexão WiFi), a amostra é descartada e
+// contabilizada, sem parar a amostragem de vibração.
+
+struct PipelineStats {
+    uint32_t fastSamples;
+    uint32_t envSamples;
+    uint32_t snapshots;
+    uint32_t outputs;
+    uint32_t maxFastGapMs;   // Maior intervalo observado entre amostras rápidas
+    uint32_t fastDropped;
+    uint32_t envDropped;
+    uint32_t outputDropped;
+    uint32_t rawDropped;
+};
+
+// Cria filas e inicializa os estágios, sem iniciar tarefas
+bool pipelineBegin();
+
+// pipelineBegin() + criação das tarefas
+bool startPipeline();
+
+// Etapas individuais, executadas em laço pelas tarefas
+void fastSensorStep();
+void slowSensorStep();
+bool alertStep(uint32_t timeoutMs);
+bool outputStep(uint32_t timeoutMs);
+void displayStep();
+void uplinkStep();
+
+// Grava o snapshot no histórico e no log em flash (parte de outputStep)
+void recordHistory(const Snapshot& snapshot);
+
+PipelineStats pipelineStats();
@@ -0,0 +1,164 @@
+#pragma once
+
+// Amostragem adaptativa e contabilidade de energia.
+//
+// A tarefa de alertas escolhe, a cada avaliação, um dos SAMPLING_TIERS de
+// config.h: sobe para o nível ativo na hora em que uma leitura se aproxima
+// do limiar amarelo, muda rápido ou um alerta está ativo, e desce um nível
+// de cada vez depois de calmMs sem gatilhos. As tarefas do pipeline e o
+// loop() leem os períodos do nível atual a cada volta; a troca de nível
+// também liga ou desliga o light sleep automático e o modem sleep do WiFi
+// (halPowerSetMode).
+//
+// Cada tarefa conta despertares e tempo ocupado (TaskActivity), de onde
+// saem o duty cycle e os despertares por segundo de GET /api/power. Cada
+// contador tem um único escritor; leitores em outras tarefas podem ver um
+// resumo ligeiramente inconsistente, como em metrics.h.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alert_level.h"
+#include "config.h"
+#include "hal.h"
+
+class JsonWriter;
+
+enum class PowerTask : uint8_t {
+    FastSensor,
+    EnvSensor,
+    Alert,          // Uma amostra rápida por despertar (os timeouts não entram)
+    Output,         // Cada espera da fila de snapshots (timeout ou snapshot)
+    Display,
+    Uplink,         // Um step() do uplink por despertar
+    Loop,           // loop() do Arduino
+    Count
+};
+
+constexpr const char* POWER_TASK_NAMES[] = {
+    "fast_sensor", "env_sensor", "alert", "output", "display", "uplink", "loop",
+};
+
+static_assert(sizeof(POWER_TASK_NAMES) / sizeof(POWER_TASK_NAMES[0]) == (size_t)PowerTask::Count,
+              "POWER_TASK_NAMES deve cobrir todas as tarefas");
+
+// Leituras vistas pela tarefa de alertas a cada avaliação
+struct PowerInputs {
+    float temperature;
+    float humidity;
+    bool envFresh;
+    float vibrationRms;
+    float peakMagnitude;
+    AlertLevel level;
+    bool watched;           // Clientes no WebSocket /api/live
+};
+
+// Gatilho que levou ao nível atual (o último a subir o nível)
+enum class PowerReason : uint8_t {
+    Boot,
+    Threshold,      // Leitura perto do limiar amarelo
+    Trend,          // Variação rápida
+    Alert,          // Nível de alerta acima de normal
+    Calm,           // Descida por calmMs sem gatilhos
+    Fixed,          // Adaptação desligada
+    Count
+};
+
+constexpr const char* POWER_REASON_NAMES[] = {
+    "boot", "threshold", "trend", "alert", "calm", "fixed",
+};
+
+static_assert(sizeof(POWER_REASON_NAMES) / sizeof(POWER_REASON_NAMES[0]) == (size_t)PowerReason::Count,
+              "POWER_REASON_NAMES deve cobrir todos os gatilhos");
+
+struct PowerSnapshot {
+    uint8_t tier;
+    PowerReason reason;
+    bool adaptive;
+    bool lightSleepAvailable;   // Build com gerenciamento de energia (halPowerBegin)
+    uint32_t elapsedMs;         // Desde begin() ou reset()
+    uint32_t tierChanges;
+    uint32_t tierMs[SAMPLING_TIER_COUNT];
+    uint32_t wakes[(size_t)PowerTask::Count];
+    uint64_t busyUs[(size_t)PowerTask::Count];
+};
+
+class PowerManager {
+public:
+    void begin(uint32_t nowMs, bool lightSleepAvailable);
+
+    // Tarefa de alertas: escolhe o nível para as próximas voltas
+    void update(uint32_t nowMs, const PowerInputs& inputs);
+
+    const SamplingTier& tier() const { return SAMPLING_TIERS[current]; }
+
+    // Sem adaptação o nível fica no ativo (comportamento anterior)
+    void setAdaptive(bool enabled) { adaptive = enabled; }
+
+    // Zera despertares, tempos e o tempo por nível
+    void reset(uint32_t nowMs);
+
+    void recordWake(PowerTask task, uint32_t busyCycles);
+
+    PowerSnapshot snapshot(uint32_t nowMs) const;
+
+    // {"tier":..,"adaptive":..,"duty_cycle":..,"wakes_per_second":..,
+    //  "tiers":{"<nível>":{seconds,share},..},"tasks":{"<tarefa>":{wakes,busy_ms,duty},..}}
+    static void write(const PowerSnapshot& snapshot, JsonWriter& json);
+
+private:
+    bool triggered(uint32_t nowMs, const PowerInputs& inputs, PowerReason& reason);
+    void enter(uint8_t next, PowerReason why);
+
+    volatile uint8_t current = 0;
+    volatile PowerReason reason = PowerReason::Boot;
+    volatile bool adaptive = true;
+    bool lightSleepAvailable = false;
+    uint32_t cyclesPerMicro = 1;
+
+    // Estado da decisão (só a tarefa de alertas)
+    uint32_t lastUpdateMs = 0;
+    uint32_t calmSinceMs = 0;
+    uint32_t trendSinceMs = 0;
+    float trendTemperature = NAN;
+    float trendHumidity = NAN;
+    float trendVibRms = NAN;
+
+    // Contadores
+    volatile uint32_t sinceMs = 0;
+    volatile uint32_t tierChanges = 0;
+    volatile uint32_t tierMs[SAMPLING_TIER_COUNT] = {};
+    volatile uint32_t wakes[(size_t)PowerTask::Count] = {};
+    volatile uint64_t busyCycles[(size_t)PowerTask::Count] = {};
+};
+
+PowerManager& powerManager();
+
+// Conta um despertar da tarefa e o tempo até o fim do escopo; pause() e
+// resume() excluem esperas bloqueantes no meio dele
+class TaskActivity {
+public:
+    explicit TaskActivity(PowerTask task) : task(task), start(halCycles()) {}
+    ~TaskActivity() {
+        if (running) {
+            busy += halCycles() - start;
+        }
+        powerManager().recordWake(task, busy);
+    }
+
+    void pause() {
+        busy += halCycles() - start;
+        running = false;
+    }
+    void resume() {
+        start = halCycles();
+        running = true;
+    }
+
+private:
+    PowerTask task;
+    uint32_t start;
+    uint32_t busy = 0;
+    bool running = true;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// Ring buffer lock-free de um produtor e um consumidor (SPSC). O produtor só
+// escreve head e o consumidor só escreve tail, então basta ordenar os acessos
+// com acquire/release; nenhuma seção crítica é necessária entre núcleos.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "capacidade deve ser potência de 2");
+
+public:
+    // Produtor: retorna false (e conta o descarte) se o buffer estiver cheio
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: copia até maxItems itens em out, retorna quantos copiou
+    size_t pop(T* out, size_t maxItems) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - t;
+        size_t n = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < n; i++) {
+            out[i] = items[(t + i) & (N - 1)];
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    bool pop(T& out) { return pop(&out, 1) == 1; }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    uint32_t overflows() const { return overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> overflowCount{0};
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+// Camada fina sobre FreeRTOS. No ESP32 usa filas/tarefas estáticas do
+// FreeRTOS; no build nativo (Linux) usa std::thread e std::mutex com a mesma
+// interface, permitindo exercitar o pipeline fora do hardware.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+typedef void (*TaskEntry)(void* arg);
+
+// Cria uma tarefa (fixada em um núcleo no ESP32)
+bool startTask(TaskEntry entry, const char* name, uint32_t stackBytes,
+               uint32_t priority, int core, void* arg = nullptr);
+
+// Instante do último despertar de uma tarefa periódica, no relógio do
+// escalonador: ticks do FreeRTOS no ESP32 (millis() vem do esp_timer, que
+// começa antes do escalonador e não é comparável), halMillis() no host
+struct TaskWake {
+#if defined(ESP32)
+    TickType_t tick;
+#else
+    uint32_t ms;
+#endif
+};
+
+TaskWake taskWakeNow();
+
+// Bloqueia até o próximo período, sem acumular deriva
+void taskDelayUntil(TaskWake& lastWake, uint32_t periodMs);
+
+void taskDelay(uint32_t ms);
+
+// Fila de tamanho fixo, sem alocação após begin()
+template <typename T, size_t N>
+class FixedQueue {
+public:
+    bool begin() {
+#if defined(ESP32)
+        handle = xQueueCreateStatic(N, sizeof(T), storage, &control);
+        return handle != nullptr;
+#else
+        return true;
+#endif
+    }
+
+    // Envia sem bloquear além de timeoutMs; conta descartes quando cheia
+    bool send(const T& item, uint32_t timeoutMs = 0) {
+#if defined(ESP32)
+        if (xQueueSend(handle, &item, pdMS_TO_TICKS(timeoutMs)) == pdTRUE) {
+            return true;
+        }
+#else
+        // Timeout zero não passa pela espera temporizada (~50 us por chamada)
+        std::unique_lock<std::mutex> lock(mutex);
+        if (count < N || (timeoutMs > 0 &&
+                          notFull.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                           [this] { return count < N; }))) {
+            storage[(head + count) % N] = item;
+            count++;
+            if (count > highWater) highWater = count;
+            notEmpty.notify_one();
+            return true;
+        }
+#endif
+        dropCount++;
+        return false;
+    }
+
+    bool receive(T& item, uint32_t timeoutMs) {
+#if defined(ESP32)
+        return xQueueReceive(handle, &item, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        if (count == 0 && (timeoutMs == 0 ||
+                           !notEmpty.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                              [this] { return count > 0; }))) {
+            return false;
+        }
+        item = storage[head];
+        head = (head + 1) % N;
+        count--;
+        notFull.notify_one();
+        return true;
+#endif
+    }
+
+    size_t waiting() const {
+#if defined(ESP32)
+        return uxQueueMessagesWaiting(handle);
+#else
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+#endif
+    }
+
+    uint32_t dropped() const { return dropCount; }
+
+#if !defined(ESP32)
+    size_t highWaterMark() const { return highWater; }
+#endif
+
+private:
+    volatile uint32_t dropCount = 0;
+#if defined(ESP32)
+    QueueHandle_t handle = nullptr;
+    StaticQueue_t control;
+    uint8_t storage[N * sizeof(T)];
+#else
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    T storage[N];
+    size_t head = 0;
+    size_t count = 0;
+    size_t highWater = 0;
+#endif
+};
+
+// Mutex estático (usado para serializar o barramento I2C entre tarefas)
+class StaticMutex {
+public:
+    void begin() {
+#if defined(ESP32)
+        handle = xSemaphoreCreateMutexStatic(&control);
+#endif
+    }
+    void lock() {
+#if defined(ESP32)
+        xSemaphoreTake(handle, portMAX_DELAY);
+#else
+        mutex.lock();
+#endif
+    }
+    void unlock() {
+#if defined(ESP32)
+        xSemaphoreGive(handle);
+#else
+        mutex.unlock();
+#endif
+    }
+
+private:
+#if defined(ESP32)
+    SemaphoreHandle_t handle = nullptr;
+    StaticSemaphore_t control;
+#else
+    std::mutex mutex;
+#endif
+};
+
+class ScopedLock {
+public:
+    explicit ScopedLock(StaticMutex& m) : mutex(m) { mutex.lock(); }
+    ~ScopedLock() { mutex.unlock(); }
+
+private:
+    StaticMutex& mutex;
+};
+
+// Trecho curto que não pode ser preemptado nem interrompido no núcleo atual
+// (ESP32: spinlock do FreeRTOS). No host as threads do SO sempre voltam a
+// rodar, então basta não fazer nada.
+class CriticalSection {
+public:
+    void enter() {
+#if defined(ESP32)
+        portENTER_CRITICAL(&spinlock);
+#endif
+    }
+    void exit() {
+#if defined(ESP32)
+        portEXIT_CRITICAL(&spinlock);
+#endif
+    }
+
+private:
+#if defined(ESP32)
+    portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+};
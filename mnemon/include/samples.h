@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "alert_level.h"
+#include "config.h"
+
+// Mensagens trocadas entre as tarefas (tamanho fixo, copiadas por valor)
+
+// Amostra bruta do acelerômetro (16384 LSB/g em ±2g)
+struct AccelRaw {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+// Características de vibração de uma janela (ver vibration_features.h)
+struct AxisFeatures {
+    float mean;
+    float rms;          // RMS da componente dinâmica (média removida)
+    float peak;         // Maior desvio absoluto em relação à média
+    float peakToPeak;
+    float crestFactor;  // peak / rms
+    float kurtosis;     // m4 / m2² (3 para ruído gaussiano, 1,5 para senoide)
+};
+
+struct VibrationFeatures {
+    uint32_t samples;           // Amostras na janela
+    AxisFeatures axis[3];       // X, Y, Z
+    AxisFeatures magnitude;     // Sobre |a| = sqrt(x² + y² + z²)
+    float peakMagnitude;        // Maior |a| absoluto na janela (inclui 1g)
+    float rmsTotal;             // sqrt(var(x) + var(y) + var(z))
+};
+
+// Resultado de um quadro da análise espectral (ver spectrum.h)
+struct SpectralPeak {
+    float frequencyHz;
+    float amplitude;    // Amplitude da senoide equivalente (g)
+};
+
+struct SpectralResult {
+    uint32_t frames;
+    SpectralPeak peaks[SPECTRAL_PEAKS];
+    float bandRms[SPECTRAL_BAND_COUNT];
+    float totalRms;
+};
+
+// Sensores rápidos: LDR + última amostra do MPU6050. As amostras de vibração
+// em alta taxa seguem pelo ring buffer de captura; accelCount informa quantas
+// entraram nele desde o último tick
+struct FastSample {
+    uint32_t timestampMs;
+    float accelX;
+    float accelY;
+    float accelZ;
+    int ldrRaw;
+    uint16_t accelCount;
+};
+
+// Sensores lentos: DHT22
+struct EnvSample {
+    uint32_t timestampMs;
+    float temperature;
+    float humidity;
+};
+
+// Leitura consolidada enviada para a saída (LCD, serial, HTTP)
+struct Snapshot {
+    uint32_t timestampMs;
+    float temperature;
+    float humidity;
+    int ldrRaw;
+    float lux;
+    float accelX;
+    float accelY;
+    float accelZ;
+    VibrationFeatures vibration;
+    SpectralResult spectrum;
+    AlertLevel alertLevel;
+};
+
+// Leitura mais recente para o canal de push (ver live.h)
+struct LiveSample {
+    uint32_t timestampMs;
+    float temperature;
+    float humidity;
+    int ldrRaw;
+    float accelX;
+    float accelY;
+    float accelZ;
+    float vibrationRms;
+    float peakMagnitude;
+    AlertLevel alertLevel;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+// Cenários de teste identificados por enum, com nome e progressão de steps
+// em tabela constexpr (antes: comparações de String a cada ciclo)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum class ScenarioId : uint8_t {
+    ApiControl,
+    SensorValidation,
+    RealisticConditions,
+    ExtremeConditions,
+    Timeline,           // Carregado por POST /api/scenario
+    Count
+};
+
+struct ScenarioInfo {
+    const char* name;
+    uint16_t stepSeconds;   // Duração de cada step (0 = sem progressão)
+    uint8_t stepCount;
+};
+
+constexpr ScenarioInfo SCENARIOS[] = {
+    {"api_control", 0, 0},
+    {"sensor_validation", 10, 8},      // Steps 1-8, muda a cada 10s
+    {"realistic_conditions", 30, 10},  // Steps 1-10, muda a cada 30s
+    {"extreme_conditions", 20, 6},     // Steps 1-6, muda a cada 20s
+    {"timeline", 0, 0},                // Passos definidos pela linha do tempo
+};
+
+static_assert(sizeof(SCENARIOS) / sizeof(SCENARIOS[0]) == (size_t)ScenarioId::Count,
+              "SCENARIOS deve cobrir todos os cenários");
+
+constexpr const ScenarioInfo& scenarioInfo(ScenarioId id) {
+    return SCENARIOS[(size_t)id];
+}
+
+constexpr const char* scenarioName(ScenarioId id) {
+    return scenarioInfo(id).name;
+}
+
+inline bool findScenario(const char* name, ScenarioId& id) {
+    for (size_t i = 0; i < (size_t)ScenarioId::Count; i++) {
+        if (strcmp(SCENARIOS[i].name, name) == 0) {
+            id = (ScenarioId)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "dht22.h"
+#include "samples.h"
+
+float calculateLux(int rawValue);
+
+// Leituras com possível override via API
+void readFastSample(FastSample& sample);
+void readEnvSample(EnvSample& sample);
+
+// Capturas do DHT22 por resultado (escrito pela tarefa lenta)
+Dht22Stats dhtStats();
@@ -0,0 +1,116 @@
+#pragma once
+
+// Valor pequeno publicado por versões (seqlock): leitores em qualquer tarefa
+// ou núcleo nunca bloqueiam e sempre recebem um conjunto coerente de campos.
+//
+// O escritor deixa a sequência ímpar, grava e a deixa par de novo; o leitor
+// copia e repete se a sequência estava ímpar ou mudou durante a cópia. O
+// valor fica em palavras atômicas relaxadas, então uma leitura concorrente
+// nunca é corrida de dados, só possivelmente rasgada, e é isso que a
+// sequência detecta.
+//
+// Escritores são serializados por um mutex (que só bloqueia outros
+// escritores), e a gravação em si roda numa seção crítica: um escritor
+// preemptado no meio deixaria um leitor de prioridade maior no mesmo núcleo
+// girando para sempre.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "rtos.h"
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock copia o valor por memcpy");
+
+public:
+    // Antes das tarefas existirem: grava direto, sem seção crítica
+    explicit Seqlock(const T& initial = T()) {
+        memcpy(scratch, &initial, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++) {
+            data[i].store(scratch[i], std::memory_order_relaxed);
+        }
+    }
+
+    void begin() { mutex.begin(); }
+
+    T read() const {
+        T value;
+        read(value);
+        return value;
+    }
+
+    // Retorna a versão lida (conta as publicações desde o boot)
+    uint32_t read(T& value) const {
+        uint32_t words[WORDS];
+        for (;;) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; i++) {
+                words[i] = data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                memcpy((void*)&value, words, sizeof(T));
+                return before / 2;
+            }
+        }
+    }
+
+    uint32_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+    void write(const T& value) {
+        ScopedLock lock(mutex);
+        store(value);
+    }
+
+    // Leitura-modificação-escrita atômica em relação aos outros escritores;
+    // modify(T&) retorna false para não publicar nada
+    template <typename Modify>
+    bool update(Modify modify) {
+        ScopedLock lock(mutex);
+        T value;
+        memcpy((void*)&value, words(), sizeof(T));
+        if (!modify(value)) {
+            return false;
+        }
+        store(value);
+        return true;
+    }
+
+private:
+    static const size_t WORDS = (sizeof(T) + 3) / 4;
+
+    // Só sob o mutex: nenhum outro escritor muda os dados
+    const uint32_t* words() {
+        for (size_t i = 0; i < WORDS; i++) {
+            scratch[i] = data[i].load(std::memory_order_relaxed);
+        }
+        return scratch;
+    }
+
+    void store(const T& value) {
+        memcpy(scratch, &value, sizeof(T));
+        critical.enter();
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            data[i].store(scratch[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+        critical.exit();
+    }
+
+    StaticMutex mutex;
+    CriticalSection critical;
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> data[WORDS];
+    uint32_t scratch[WORDS] = {};
+};
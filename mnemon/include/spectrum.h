@@ -0,0 +1,52 @@
+#pragma once
+
+// Análise espectral da vibração: FFT real radix-2 in-place, janela de Hann,
+// tabelas de twiddle e bit-reversal pré-calculadas em begin(). Nenhuma
+// alocação por quadro: todos os buffers são membros de tamanho fixo.
+//
+// A FFT real de N pontos é feita como uma FFT complexa de N/2 pontos sobre as
+// amostras pares/ímpares empacotadas, seguida do passo de separação.
+
+#include <stdint.h>
+
+#include "config.h"
+#include "samples.h"
+
+class SpectrumAnalyzer {
+public:
+    void begin(float sampleRateHz);
+
+    // Acumula uma amostra; retorna true quando um quadro foi analisado
+    bool addSample(float value);
+
+    // Analisa um quadro completo de FFT_SIZE amostras
+    void analyze(const float* samples);
+
+    const SpectralResult& result() const { return current; }
+
+    // Potência por bin (0..FFT_SIZE/2) do último quadro, em g²
+    const float* powerSpectrum() const { return power; }
+
+    float binHz() const { return sampleRate / FFT_SIZE; }
+
+private:
+    void fft(float* data);
+    void findPeaks();
+    void computeBands();
+
+    float sampleRate = 0;
+    float windowSum = 0;        // soma de w[n]: ganho coerente
+    float windowPowerSum = 0;   // soma de w[n]²: ganho de potência
+
+    float frame[FFT_SIZE];
+    uint32_t fill = 0;
+
+    float work[FFT_SIZE];                  // N/2 complexos intercalados (re, im)
+    float power[FFT_SIZE / 2 + 1];
+    float window[FFT_SIZE];
+    float cosTable[FFT_SIZE / 2];          // cos(2πk/N), k = 0..N/2-1
+    float sinTable[FFT_SIZE / 2];
+    uint16_t bitReverse[FFT_SIZE / 2];
+
+    SpectralResult current = {};
+};
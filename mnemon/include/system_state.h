@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "alert_level.h"
+#include "samples.h"
+#include "scenario.h"
+#include "seqlock.h"
+
+class JsonWriter;
+
+// Controles manuais dos sensores via API
+struct SensorOverrides {
+    bool dht22_override = false;
+    float temperature_override = 25.0;
+    float humidity_override = 60.0;
+    
+    bool ldr_override = false;
+    int ldr_raw_override = 500;
+    
+    bool mpu6050_override = false;
+    float accel_x_override = 0.0;
+    float accel_y_override = 0.0;
+    float accel_z_override = 1.0;
+};
+
+// Estado compartilhado entre a API, o canal serial e as tarefas. Os
+// overrides e a leitura atual são publicados por versões (seqlock.h): a API
+// grava de uma tarefa, a aquisição lê de outra, e nenhum leitor vê um
+// conjunto de campos pela metade
+extern Seqlock<SensorOverrides> sensorOverrides;
+extern Seqlock<LiveSample> currentReading;
+extern volatile ScenarioId currentScenario;
+extern volatile AlertLevel alertLevel;
+extern volatile int testStep;
+extern volatile uint32_t scenarioStartTime;
+
+// Cenários embutidos viram linhas do tempo de marcas de step (timeline.h)
+void setScenario(ScenarioId id);
+
+// Corpo de GET /api/status (renderizado pelo cache, ver http_cache.h)
+void writeStatus(JsonWriter& json, const char* wifiIp);
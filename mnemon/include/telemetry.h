@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "samples.h"
+#include "telemetry_frame.h"
+
+// Buffer estático da telemetria: o registro tem ~900 bytes com vibração e espectro
+const size_t TELEMETRY_BUFFER_SIZE = 1280;
+
+// Codifica a leitura no esquema JSON da serial (ver API_REST_REFERENCE.md).
+// Retorna o tamanho escrito, ou 0 se o buffer não comportar o registro.
+size_t encodeTelemetry(const Snapshot& snapshot, uint32_t nowMs, char* buffer, size_t capacity);
+
+// Timestamp ISO 8601 simulado a partir de 13/06/2025
+void formatTimestamp(uint32_t nowMs, char* buffer, size_t capacity);
+
+// Formato da telemetria na serial, alternado em tempo de execução pelos
+// comandos "mode:json" e "mode:binary" (ver telemetry_frame.h)
+enum class TelemetryFormat : uint8_t {
+    Json,
+    Binary
+};
+
+void setTelemetryFormat(TelemetryFormat format);
+TelemetryFormat telemetryFormat();
+
+// Envia o registro: linha JSON ou quadro Environment, conforme o formato.
+// O JSON é sempre codificado para continuar disponível em lastTelemetry(), e
+// o registro Environment vai também ao lote aberto do uplink (uplink.h).
+void sendJSONData(const Snapshot& snapshot);
+
+// Envia um bloco de amostras brutas (só no modo binário)
+void sendAccelBlock(const AccelBlock& block);
+
+// Último registro enviado (para servir por HTTP sem recodificar)
+const char* lastTelemetry(size_t& length);
+
+// Conta os registros publicados: muda uma vez por ciclo de saída
+uint32_t telemetrySequence();
+
+// Cópia coerente do último registro, de qualquer tarefa; retorna 0 se não
+// houver registro ou ele não couber em capacity
+size_t copyTelemetry(char* out, size_t capacity, uint32_t& sequence);
@@ -0,0 +1,80 @@
+#pragma once
+
+// Telemetria binária para a serial: structs empacotadas em little-endian,
+// com número de sequência e CRC-32, enquadradas em COBS. Cada quadro vai entre
+// dois 0x00, então texto avulso na serial (mensagens de boot, WiFi) fica
+// isolado e o receptor ressincroniza no próximo zero após qualquer erro.
+//
+// Quadro (antes do COBS):
+//   u8 type | u8 version | u16 seq | u32 timestamp_ms | corpo | u32 crc32
+//
+// Corpo AccelBlock:  u16 rate_hz | u16 count | u32 first_index | count x (i16 x, y, z)
+// Corpo Environment: f32 temperature | f32 humidity | f32 lux | u16 ldr_raw |
+//                    u8 alert_level | u8 scenario | u8 step | u8 reserved |
+//                    f32 vib_rms | f32 vib_peak
+//
+// Este arquivo é compartilhado com o decodificador Linux (katabase).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crc32.h"
+#include "samples.h"
+
+enum class FrameType : uint8_t {
+    AccelBlock = 1,
+    Environment = 2
+};
+
+const uint8_t FRAME_VERSION = 1;
+const uint32_t ACCEL_BLOCK_SAMPLES = 64;
+const size_t FRAME_HEADER_SIZE = 8;
+const size_t FRAME_CRC_SIZE = 4;
+const size_t FRAME_MAX_PAYLOAD = FRAME_HEADER_SIZE + 8 + ACCEL_BLOCK_SAMPLES * 6 + FRAME_CRC_SIZE;
+// COBS acrescenta 1 byte a cada 254, mais os dois delimitadores
+const size_t FRAME_MAX_ENCODED = FRAME_MAX_PAYLOAD + FRAME_MAX_PAYLOAD / 254 + 3;
+const size_t ENVIRONMENT_BODY_SIZE = 26;
+const size_t ENVIRONMENT_FRAME_ENCODED = FRAME_HEADER_SIZE + ENVIRONMENT_BODY_SIZE + FRAME_CRC_SIZE + 3;
+
+// Bloco de amostras brutas do acelerômetro
+struct AccelBlock {
+    uint32_t timestampMs;
+    uint32_t firstIndex;    // Índice da primeira amostra desde o boot
+    uint16_t sampleRateHz;
+    uint16_t count;
+    AccelRaw samples[ACCEL_BLOCK_SAMPLES];
+};
+
+// Leitura ambiental de baixa taxa
+struct EnvironmentRecord {
+    uint32_t timestampMs;
+    float temperature;
+    float humidity;
+    float lux;
+    uint16_t ldrRaw;
+    uint8_t alertLevel;
+    uint8_t scenario;
+    uint8_t step;
+    float vibrationRms;
+    float peakMagnitude;
+};
+
+struct DecodedFrame {
+    FrameType type;
+    uint16_t seq;
+    uint32_t timestampMs;
+    AccelBlock accel;
+    EnvironmentRecord environment;
+};
+
+// COBS: retornam o tamanho de saída (decode retorna 0 para entrada inválida)
+size_t cobsEncode(const uint8_t* input, size_t len, uint8_t* output);
+size_t cobsDecode(const uint8_t* input, size_t len, uint8_t* output);
+
+// Codificam um quadro completo (0x00 + COBS + 0x00) em output, que deve
+// ter FRAME_MAX_ENCODED bytes. Retornam o número de bytes a transmitir.
+size_t encodeAccelFrame(uint16_t seq, const AccelBlock& block, uint8_t* output);
+size_t encodeEnvironmentFrame(uint16_t seq, const EnvironmentRecord& record, uint8_t* output);
+
+// Valida o CRC e decodifica um quadro já sem COBS
+bool decodeFrame(const uint8_t* payload, size_t len, DecodedFrame& frame);
@@ -0,0 +1,135 @@
+#pragma once
+
+// Linha do tempo de overrides executada no dispositivo: uma lista de
+// passos (instante relativo ao início, sensor, valores, rampa opcional)
+// carregada de uma vez por POST /api/scenario e tocada pela tarefa rápida a
+// cada período (o do nível de amostragem, power.h), sem depender do ritmo
+// do HTTP.
+//
+// Os cenários embutidos (sensor_validation etc.) também são linhas do tempo,
+// só com marcas de step; é daqui que vem o "step" da telemetria.
+//
+// Os instantes são sempre os agendados: um passo aplicado com atraso de um
+// tick não desloca os seguintes, e as rampas interpolam a partir do instante
+// agendado do seu passo.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "rtos.h"
+#include "seqlock.h"
+#include "system_state.h"
+
+enum class TimelineSensor : uint8_t {
+    None,       // Só marca de step
+    Dht22,
+    Ldr,
+    Mpu6050,
+    All,        // Só com disable
+};
+
+constexpr const char* TIMELINE_SENSOR_NAMES[] = {"none", "dht22", "ldr", "mpu6050", "all"};
+
+// Nomes JSON dos valores de cada sensor, na ordem dos bits de fields
+constexpr const char* TIMELINE_FIELD_NAMES[][3] = {
+    {nullptr, nullptr, nullptr},
+    {"temperature", "humidity", nullptr},
+    {"raw_value", nullptr, nullptr},
+    {"accel_x", "accel_y", "accel_z"},
+    {nullptr, nullptr, nullptr},
+};
+
+bool findTimelineSensor(const char* name, TimelineSensor& sensor);
+
+// Bits de TimelineStep::fields: valores presentes, na ordem do sensor
+// (dht22: temperature, humidity; ldr: raw_value; mpu6050: accel_x/y/z)
+const uint8_t TIMELINE_FIELD_0 = 1 << 0;
+const uint8_t TIMELINE_FIELD_1 = 1 << 1;
+const uint8_t TIMELINE_FIELD_2 = 1 << 2;
+const uint8_t TIMELINE_DISABLE = 1 << 7;
+
+struct TimelineStep {
+    uint32_t atMs;          // Desde o início da linha do tempo
+    uint32_t rampMs;        // 0 = valor aplicado de imediato
+    TimelineSensor sensor;
+    uint8_t fields;
+    uint8_t step;           // Novo "step" do cenário (0 = mantém)
+    float values[3];
+};
+
+struct Timeline {
+    char name[24];
+    uint32_t loopMs;        // > 0: recomeça a cada loopMs
+    uint16_t count;
+    TimelineStep steps[TIMELINE_MAX_STEPS];
+};
+
+struct TimelineStatus {
+    bool active;
+    char name[sizeof(Timeline::name)];
+    uint32_t elapsedMs;
+    uint16_t nextStep;
+    uint16_t count;
+    uint32_t loops;
+};
+
+// Monta a linha do tempo de marcas de step de um cenário embutido
+void scenarioTimeline(ScenarioId id, Timeline& timeline);
+
+// Ordena os passos por instante (estável) e verifica os campos
+bool prepareTimeline(Timeline& timeline, const char*& error);
+
+class TimelinePlayer {
+public:
+    void begin();
+
+    // Agenda a troca pela tarefa rápida no próximo tick (chamável de outra
+    // tarefa); o tempo zero é o instante dessa troca
+    void load(const Timeline& timeline);
+    void loadScenario(ScenarioId id);     // Monta direto no buffer pendente
+    void stop();
+
+    // Executado pela tarefa rápida antes de ler os sensores; retorna se
+    // algum override mudou
+    bool tick(uint32_t nowMs, SensorOverrides& overrides);
+
+    // Idem sobre o estado compartilhado: só publica uma versão nova quando
+    // algum passo ou rampa mexeu nos overrides
+    void tick(uint32_t nowMs, Seqlock<SensorOverrides>& overrides) {
+        overrides.update([&](SensorOverrides& o) { return tick(nowMs, o); });
+    }
+
+    TimelineStatus status() const;
+
+private:
+    struct Ramp {
+        float from;
+        float to;
+        uint32_t startMs;
+        uint32_t durationMs;
+        bool active;
+    };
+
+    static const uint8_t CHANNELS = 6;   // temperatura, umidade, LDR, X, Y, Z
+
+    void apply(const TimelineStep& step, uint32_t scheduledMs, SensorOverrides& overrides);
+    bool updateRamps(uint32_t nowMs, SensorOverrides& overrides);
+
+    // Protege o buffer pendente e, durante tick(), o estado em execução, que
+    // status() copia de uma vez
+    mutable StaticMutex mutex;
+    Timeline pending;
+    volatile bool pendingLoad = false;
+    volatile bool pendingStop = false;
+
+    Timeline current;
+    bool active = false;
+    uint32_t startMs = 0;
+    uint32_t lastTickMs = 0;
+    uint16_t next = 0;
+    uint32_t loops = 0;
+    Ramp ramps[CHANNELS];
+};
+
+TimelinePlayer& timeline();
@@ -0,0 +1,262 @@
+#pragma once
+
+// Uplink para um collector: store-and-forward dos registros de telemetria.
+//
+// A tarefa de saída entrega cada registro Environment a record(), que só
+// acrescenta o quadro (o mesmo do modo binário, no relógio persistente do
+// log) ao lote aberto. O resto roda em step(), na tarefa do uplink:
+//
+//   - o lote é fechado com UPLINK_BATCH_RECORDS registros ou
+//     UPLINK_BATCH_MAX_AGE_MS de idade, comprimido em gzip (gzip.h; sem
+//     compressão se não compensar) e posto no fim da fila;
+//   - a conexão TCP com o collector (katabase-ingest, protocolo em
+//     uplink_batch.h) é aberta e mantida, com nova tentativa em backoff
+//     exponencial de UPLINK_RETRY_MIN_MS a UPLINK_RETRY_MAX_MS;
+//   - o lote da frente é enviado e só sai da fila com o ACK, que o collector
+//     manda depois de gravá-lo. Sem ACK em UPLINK_ACK_TIMEOUT_MS, a conexão
+//     é refeita e o lote reenviado.
+//
+// A fila é um anel em RAM de UPLINK_QUEUE_BYTES; cheio, os lotes mais
+// antigos passam para um anel em flash (BatchSpill) nos últimos setores da
+// partição de dados, que sobrevive a reboots. Com os dois cheios o lote mais
+// antigo é descartado e contado. O envio segue sempre do mais antigo para o
+// mais novo, primeiro a flash e depois a RAM.
+//
+// Um lote em voo por vez: como o ACK só vem depois da gravação, o dreno
+// após uma queda fica limitado pelos lotes do collector (~4 por segundo com
+// --flush-ms 250, ~100x a produção) e por UPLINK_DRAIN_BYTES_PER_S, que
+// evita que a volta do enlace ocupe o rádio de uma vez. Um ACK perdido faz
+// o lote ser reenviado; o collector descarta os registros com tempo não
+// posterior ao último gravado do dispositivo.
+//
+// record() e step() rodam em tarefas diferentes e só compartilham o lote
+// aberto (dois buffers alternados sob um mutex); fila, conexão e contadores
+// são da tarefa do uplink. configure() deixa o collector pedido sob o mesmo
+// mutex e step() o aplica, fechando a conexão anterior. snapshot() pode ser
+// lido de outras tarefas com a mesma tolerância de metrics.h.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "gzip.h"
+#include "metrics.h"
+#include "rtos.h"
+#include "telemetry_frame.h"
+#include "uplink_batch.h"
+
+class JsonWriter;
+
+const uint32_t UPLINK_BODY_MAX = UPLINK_BATCH_RECORDS * ENVIRONMENT_FRAME_ENCODED;
+static_assert(UPLINK_BODY_MAX <= GZIP_MAX_INPUT, "lote do uplink maior que a entrada do gzip");
+
+const size_t UPLINK_HOST_MAX = 64;
+const size_t UPLINK_DEVICE_MAX = 32;
+
+// Lote fechado, como fica na fila (RAM e flash) antes do corpo
+struct QueuedBatch {
+    uint16_t length;        // Corpo
+    uint16_t records;
+    uint8_t encoding;       // BatchEncoding
+    uint8_t reserved[3];
+    uint32_t sealMs;        // Fechamento, no relógio persistente (flash_log.h)
+    uint32_t crc;           // CRC-32 do corpo
+};
+
+struct BatchSpillStats {
+    uint32_t sectors;
+    uint32_t batches;       // Pendentes
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t recovered;     // Pendentes encontrados no boot
+    uint32_t corrupt;       // Lotes com CRC inválido ao ler (descartados)
+};
+
+// Anel de lotes em setores de flash, no esquema do log (flash_log.h): cada
+// setor começa com {magic, seq, crc} e o de maior seq é a cauda. Cada lote
+// leva uma palavra de estado que a confirmação zera (escrever só zera
+// bits); no boot, o primeiro lote com a palavra intacta é a frente. Cheio, o
+// setor mais antigo é apagado e reaproveitado, com os lotes pendentes nele.
+class BatchSpill {
+public:
+    // sectors < 2: desligado
+    void begin(uint32_t offset, uint32_t sectors);
+
+    bool enabled() const { return sectorCount >= 2; }
+    uint32_t count() const { return pending; }
+
+    // Grava o lote no fim, com o corpo em até duas partes (o anel da RAM dá
+    // a volta); droppedBatches/droppedRecords: pendentes perdidos no setor
+    // reaproveitado
+    void push(const QueuedBatch& batch, const uint8_t* body, size_t length,
+              const uint8_t* more, size_t moreLength,
+              uint32_t& droppedBatches, uint32_t& droppedRecords);
+
+    // Lote da frente (corpo opcional, conferido pelo CRC); false se vazio ou
+    // se o corpo estiver corrompido
+    bool front(QueuedBatch& batch, uint8_t* body);
+    void pop();
+
+    BatchSpillStats stats() const;
+
+private:
+    uint32_t address(uint32_t sector) const { return base + sector * FLASH_SECTOR_SIZE; }
+    bool readSector(uint32_t sector, uint32_t& seq) const;
+    bool readEntry(uint32_t sector, uint32_t offset, QueuedBatch& batch, uint32_t& state) const;
+    void scan();
+    void startSector(uint32_t sector, uint32_t seq);
+
+    uint32_t base = 0;
+    uint32_t sectorCount = 0;
+    uint32_t tail = 0;
+    uint32_t tailSeq = 0;
+    uint32_t liveSectors = 0;       // Setores na sequência que termina na cauda
+    uint32_t writeOffset = 0;
+    uint32_t frontSector = 0;
+    uint32_t frontOffset = 0;
+    uint32_t pending = 0;
+    BatchSpillStats counters = {};
+};
+
+struct UplinkSnapshot {
+    bool enabled;
+    bool connected;
+    bool inFlight;
+    char host[UPLINK_HOST_MAX];
+    uint16_t port;
+    char device[UPLINK_DEVICE_MAX];
+
+    uint32_t records;           // Registros recebidos da saída
+    uint32_t overruns;          // Perdidos com o lote aberto cheio antes da troca em step()
+    uint32_t batches;           // Lotes fechados
+    uint32_t gzipBatches;
+    uint64_t rawBytes;          // Quadros antes da compressão
+    uint64_t batchBytes;        // Corpos na fila
+    uint16_t lastRecords;
+    uint16_t lastBytes;
+
+    uint32_t ramBatches;
+    uint32_t ramBytes;
+    BatchSpillStats spill;
+    uint32_t peakBatches;       // Maior fila (RAM + flash)
+    uint32_t droppedBatches;
+    uint32_t droppedRecords;
+
+    uint32_t connects;
+    uint32_t connectFailures;
+    uint32_t disconnects;
+    uint32_t ackTimeouts;
+    uint32_t sent;
+    uint32_t resent;            // Envios de um lote já enviado sem ACK
+    uint32_t acked;
+    uint64_t sentBytes;         // Cabeçalhos + corpos
+    StageSummary uploadMs;      // Envio -> ACK (campos *Us em ms)
+    StageSummary ageMs;         // Fechamento -> ACK, com o tempo na fila
+};
+
+class Uplink {
+public:
+    // Fila em flash nos setores [spillOffset, + spillSectors) da partição
+    // de dados (0: só RAM), com os lotes pendentes de antes do reboot
+    void begin(uint32_t spillOffset, uint32_t spillSectors);
+
+    // Collector e nome do dispositivo (qualquer tarefa), aplicados no
+    // próximo step(); host vazio desliga o uplink: registros novos deixam de
+    // entrar e a fila é mantida
+    void configure(const char* host, uint16_t port, const char* device);
+
+    // Tarefa de saída; não bloqueia além do mutex do lote aberto
+    void record(const EnvironmentRecord& record);
+
+    // Tarefa do uplink (pipeline.cpp): fecha lotes, mantém a conexão e
+    // envia; só bloqueia na conexão, por até UPLINK_CONNECT_TIMEOUT_MS
+    void step(uint32_t nowMs);
+
+    UplinkSnapshot snapshot() const;
+    static void write(const UplinkSnapshot& snapshot, JsonWriter& json);
+
+private:
+    struct OpenBatch {
+        uint8_t frames[UPLINK_BODY_MAX];
+        uint16_t length;
+        uint16_t records;
+        uint32_t firstMs;       // Uptime do primeiro registro
+    };
+
+    void seal(uint32_t nowMs);
+    void applyConfig();
+    void enqueue(const QueuedBatch& batch, const uint8_t* body);
+    void drop(uint32_t batches, uint32_t records);
+    uint32_t queued() const { return ringCount + spill.count(); }
+    bool loadFront(QueuedBatch& batch, uint8_t* body);
+    void popFront();
+
+    void ringPeek(QueuedBatch& batch, const uint8_t*& body, size_t& length,
+                  const uint8_t*& more, size_t& moreLength) const;
+    void ringCopy(uint32_t offset, void* out, size_t length) const;
+    void ringPush(const QueuedBatch& batch, const uint8_t* body);
+    void ringPop();
+
+    bool connect(uint32_t nowMs);
+    void disconnect(uint32_t nowMs);
+    void receive(uint32_t nowMs);
+    bool prepare(uint32_t nowMs);
+    void transmit(uint32_t nowMs);
+    void acknowledge(uint32_t nowMs);
+
+    // Lote aberto: record() escreve só em open[openIndex]; step() troca o
+    // índice e fecha o outro fora do mutex, que também guarda a configuração
+    // pedida
+    mutable StaticMutex mutex;
+    OpenBatch open[2];
+    uint8_t openIndex = 0;
+    uint16_t frameSeq = 0;
+    GzipEncoder encoder;
+    uint8_t sealed[UPLINK_BODY_MAX];
+
+    // Fila em RAM: anel de bytes com lotes {QueuedBatch, corpo}
+    uint8_t ring[UPLINK_QUEUE_BYTES];
+    uint32_t ringHead = 0;
+    uint32_t ringUsed = 0;
+    uint32_t ringCount = 0;
+    BatchSpill spill;
+
+    // Configuração pedida por configure(), copiada por step()
+    char nextHost[UPLINK_HOST_MAX] = "";
+    uint16_t nextPort = 0;
+    char nextDevice[UPLINK_DEVICE_MAX] = "";
+    bool reconfigured = false;
+
+    // Conexão (só a tarefa do uplink)
+    char host[UPLINK_HOST_MAX] = "";
+    uint16_t port = 0;
+    char device[UPLINK_DEVICE_MAX] = "";
+    volatile bool enabled = false;
+    bool connected = false;
+    bool attempted = false;
+    uint32_t lastAttemptMs = 0;
+    uint32_t retryMs = 0;
+    uint32_t waitMs = 0;            // retryMs com sorteio de até +25%
+    uint32_t bootId = 0;
+    uint32_t nextId = 1;
+    uint32_t tokens = 0;            // Balde de UPLINK_DRAIN_BYTES_PER_S
+    uint32_t refillMs = 0;
+    uint8_t message[BATCH_HEADER_SIZE + UPLINK_BODY_MAX];
+    size_t messageLength = 0;
+    size_t messageSent = 0;
+    bool inFlight = false;
+    bool inFlightDropped = false;   // Descartado da fila enquanto esperava o ACK
+    bool frontSent = false;         // A frente da fila já foi enviada uma vez
+    uint32_t inFlightId = 0;
+    uint32_t inFlightSealMs = 0;
+    uint32_t sentMs = 0;
+    char ackLine[24];
+    size_t ackLength = 0;
+
+    UplinkSnapshot counters = {};
+    StageHistogram upload;
+    StageHistogram age;
+};
+
+// Instância do firmware
+Uplink& uplink();
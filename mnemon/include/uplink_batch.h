@@ -0,0 +1,43 @@
+#pragma once
+
+// Lotes do uplink (uplink.h) na conexão TCP com o collector.
+//
+// A conexão começa com a linha "KATABASE <dispositivo> BATCH <boot>\n"
+// (boot: 8 dígitos hex sorteados a cada boot) e segue com lotes, cada um com
+// um cabeçalho de 16 bytes em little-endian e o corpo:
+//
+//   u32 id | u16 records | u8 encoding | u8 reserved | u32 length | u32 crc32
+//
+// O corpo são os quadros Environment (telemetry_frame.h) concatenados, o
+// mesmo fluxo que a serial leva no modo binário, em gzip ou sem compressão
+// quando o gzip não compensa. O CRC cobre o corpo como transmitido.
+//
+// O collector responde "ACK <id>\n" quando o lote e todos os anteriores da
+// conexão estão gravados. Os ids começam em 1 a cada conexão; um lote sem
+// ACK é reenviado na conexão seguinte, com outro id.
+//
+// Este arquivo é compartilhado com o collector Linux (katabase-ingest).
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class BatchEncoding : uint8_t {
+    Frames = 0,     // Quadros COBS como estão
+    Gzip = 1        // gzip.h
+};
+
+const size_t BATCH_HEADER_SIZE = 16;
+const uint32_t BATCH_MAX_BODY = 65536;      // Limite do collector
+
+struct BatchHeader {
+    uint32_t id;
+    uint16_t records;
+    BatchEncoding encoding;
+    uint32_t length;
+    uint32_t crc;
+};
+
+void encodeBatchHeader(const BatchHeader& header, uint8_t* output);
+
+// false para codificação desconhecida ou corpo acima de BATCH_MAX_BODY
+bool decodeBatchHeader(const uint8_t* input, BatchHeader& header);
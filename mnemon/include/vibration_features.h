@@ -0,0 +1,62 @@
+#pragma once
+
+// Extração de características de vibração em janelas deslizantes.
+//
+// A janela de FEATURE_WINDOW_BLOCKS blocos avança um bloco (hop) por vez. Cada
+// amostra só atualiza as somas do bloco corrente (O(1)); ao fechar um bloco
+// seus momentos centrais são combinados com os dos blocos anteriores pela
+// fórmula de Chan/Pébay, custo O(blocos) por hop, amortizado O(1) por amostra.
+// As somas de cada bloco são tomadas em torno da primeira amostra do bloco, o
+// que evita o cancelamento numérico causado pela gravidade no eixo Z.
+
+#include <stdint.h>
+
+#include "config.h"
+#include "samples.h"
+
+// Momentos centrais de um conjunto de amostras
+struct Moments {
+    uint32_t n;
+    float mean;
+    float m2;
+    float m3;
+    float m4;
+    float min;
+    float max;
+};
+
+class VibrationFeatureEngine {
+public:
+    VibrationFeatureEngine();
+
+    void reset();
+
+    // Retorna true quando um bloco fecha e features() foi atualizado
+    bool addSample(const AccelRaw& sample);
+
+    const VibrationFeatures& features() const { return current; }
+
+    static void merge(Moments& into, const Moments& other);
+
+private:
+    static const int CHANNELS = 4; // X, Y, Z, magnitude
+
+    struct Accumulator {
+        float shift;
+        float s1, s2, s3, s4;
+        float min, max;
+    };
+
+    void closeBlock();
+
+    Accumulator acc[CHANNELS];
+    uint32_t blockCount;
+    float blockPeakMagnitude;
+
+    Moments blocks[FEATURE_WINDOW_BLOCKS][CHANNELS];
+    float blockPeaks[FEATURE_WINDOW_BLOCKS];
+    uint32_t nextBlock;
+    uint32_t filledBlocks;
+
+    VibrationFeatures current;
+};
@@ -0,0 +1,77 @@
+#include "accel_capture.h"
+
+#include "hal.h"
+#include "system_state.h"
+
+static AccelRing ring;
+static volatile uint32_t samples = 0;
+static volatile uint32_t bursts = 0;
+static volatile uint32_t fifoOverflows = 0;
+
+const uint8_t FIFO_SAMPLE_BYTES = 6;
+
+static_assert(FIFO_BURST_BYTES % FIFO_SAMPLE_BYTES == 0, "rajada deve conter amostras inteiras");
+
+// Converte g para LSB (±2g), saturando no limite do registrador
+static int16_t accelToRaw(float g) {
+    float raw = g * 16384.0f;
+    if (raw > 32767.0f) return 32767;
+    if (raw < -32768.0f) return -32768;
+    return (int16_t)raw;
+}
+
+bool accelCaptureBegin(uint16_t sampleRateHz) {
+    return halAccelFifoBegin(sampleRateHz);
+}
+
+size_t accelCaptureDrain(const SensorOverrides& overrides, AccelRaw& last) {
+    // Após overflow o FIFO perde o alinhamento das amostras: descartar e recomeçar
+    if (halAccelFifoOverflowed()) {
+        fifoOverflows++;
+        halAccelFifoReset();
+        return 0;
+    }
+    
+    uint16_t count = halAccelFifoCount();
+    count -= count % FIFO_SAMPLE_BYTES;
+    
+    // Override via API substitui o conteúdo, mantendo o ritmo de amostragem
+    AccelRaw override;
+    bool overridden = overrides.mpu6050_override;
+    if (overridden) {
+        override.x = accelToRaw(overrides.accel_x_override);
+        override.y = accelToRaw(overrides.accel_y_override);
+        override.z = accelToRaw(overrides.accel_z_override);
+    }
+    
+    uint8_t burst[FIFO_BURST_BYTES];
+    size_t read = 0;
+    while (count > 0) {
+        uint8_t len = count < FIFO_BURST_BYTES ? count : FIFO_BURST_BYTES;
+        halAccelFifoRead(burst, len);
+        bursts++;
+        
+        for (uint8_t offset = 0; offset < len; offset += FIFO_SAMPLE_BYTES) {
+            last = overridden ? override : parseFifoSample(burst + offset);
+            ring.push(last);
+            read++;
+        }
+        count -= len;
+    }
+    
+    samples += read;
+    return read;
+}
+
+AccelRing& accelRing() {
+    return ring;
+}
+
+AccelCaptureStats accelCaptureStats() {
+    AccelCaptureStats stats;
+    stats.samples = samples;
+    stats.bursts = bursts;
+    stats.fifoOverflows = fifoOverflows;
+    stats.ringOverflows = ring.overflows();
+    return stats;
+}
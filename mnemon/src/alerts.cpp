@@ -0,0 +1,133 @@
+#include "alerts.h"
+
+#include <math.h>
+
+#include "config.h"
+#include "hal.h"
+
+// Nível de alerta pela energia nas bandas de frequência: 2 = vermelho, 1 = amarelo
+static int spectralSeverity(const SpectralResult& spectrum, float scale) {
+    int severity = 0;
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        if (spectrum.bandRms[b] >= SPECTRAL_BANDS[b].redRms * scale) return 2;
+        if (spectrum.bandRms[b] >= SPECTRAL_BANDS[b].yellowRms * scale) severity = 1;
+    }
+    return severity;
+}
+
+// Limiares fixos multiplicados por scale (< 1 para a histerese)
+static AlertLevel thresholdLevel(float temp, float humidity, const VibrationFeatures& vibration,
+                                 const SpectralResult& spectrum, float scale) {
+    // Picos curtos: maior magnitude da janela; vibração sustentada: RMS dinâmico
+    float accelMagnitude = vibration.peakMagnitude;
+    float vibrationRms = vibration.rmsTotal;
+    int bandSeverity = spectralSeverity(spectrum, scale);
+    
+    // Verificar condições críticas (vermelho)
+    if (temp >= TEMP_RED * scale || humidity >= HUMIDITY_RED * scale ||
+        accelMagnitude >= ACCEL_RED * scale || vibrationRms >= VIB_RMS_RED * scale || bandSeverity == 2) {
+        return AlertLevel::Red;
+    }
+    
+    // Verificar condições de alerta (amarelo)
+    if (temp >= TEMP_YELLOW * scale || humidity >= HUMIDITY_YELLOW * scale ||
+        accelMagnitude >= ACCEL_YELLOW * scale || vibrationRms >= VIB_RMS_YELLOW * scale || bandSeverity == 1) {
+        return AlertLevel::Yellow;
+    }
+    
+    return AlertLevel::Normal;
+}
+
+AlertLevel calculateAlertLevel(float temp, float humidity, const VibrationFeatures& vibration,
+                                const SpectralResult& spectrum) {
+    return thresholdLevel(temp, humidity, vibration, spectrum, 1.0f);
+}
+
+void AlertEvaluator::begin(uint32_t nowMs) {
+    current = AlertLevel::Normal;
+    anomaly = AlertLevel::Normal;
+    lastAnomalyMs = nowMs;
+    lastSpectrumFrame = 0;
+    envPending = false;
+    clearing = false;
+}
+
+AlertLevel AlertEvaluator::target(const AlertInputs& inputs, float scale) const {
+    AlertLevel fixed = thresholdLevel(inputs.temperature, inputs.humidity, *inputs.vibration,
+                                      *inputs.spectrum, scale);
+    if (inputs.synthetic || engine.learning()) {
+        return fixed;
+    }
+    if (fixed == AlertLevel::Red) {
+        return fixed;
+    }
+    return anomaly;
+}
+
+AlertLevel AlertEvaluator::evaluate(uint32_t nowMs, const AlertInputs& inputs) {
+    envPending |= inputs.envFresh;
+    
+    // Motor de anomalias no seu período, só com entradas reais. Canais sem
+    // leitura nova ficam NaN (o DHT22 lê a cada 2 s, a FFT a cada 512 ms):
+    // repetir a mesma leitura contaria o mesmo ruído duas vezes no CUSUM
+    // e na variância
+    if (nowMs - lastAnomalyMs >= ANOMALY_PERIOD_MS && !inputs.synthetic) {
+        lastAnomalyMs = nowMs;
+        const VibrationFeatures& vibration = *inputs.vibration;
+        const SpectralResult& spectrum = *inputs.spectrum;
+        bool vibrationReady = vibration.samples > 0;
+        bool spectrumReady = spectrum.frames != lastSpectrumFrame;
+        lastSpectrumFrame = spectrum.frames;
+        float values[ANOMALY_CHANNELS] = {
+            envPending ? inputs.temperature : NAN,
+            envPending ? inputs.humidity : NAN,
+            vibrationReady ? vibration.rmsTotal : NAN,
+            vibrationReady ? vibration.peakMagnitude : NAN,
+            spectrumReady ? spectrum.bandRms[0] : NAN,
+            spectrumReady ? spectrum.bandRms[1] : NAN,
+            spectrumReady ? spectrum.bandRms[2] : NAN,
+        };
+        envPending = false;
+        
+        // Estados além do limite de segurança não entram na linha de base
+        bool learn = thresholdLevel(inputs.temperature, inputs.humidity, vibration, spectrum, 1.0f) !=
+                     AlertLevel::Red;
+        anomaly = engine.update(nowMs, values, learn);
+    } else if (inputs.synthetic) {
+        anomaly = AlertLevel::Normal;
+    }
+    
+    AlertLevel raise = target(inputs, 1.0f);
+    if (raise >= current) {
+        current = raise;
+        clearing = false;
+        return current;
+    }
+    
+    // Descer: tudo abaixo dos limiares reduzidos, mantido por ALERT_CLEAR_MS
+    AlertLevel hold = target(inputs, 1.0f - ALERT_HYSTERESIS);
+    if (hold >= current) {
+        clearing = false;
+        return current;
+    }
+    if (!clearing) {
+        clearing = true;
+        clearSinceMs = nowMs;
+    }
+    if (nowMs - clearSinceMs >= ALERT_CLEAR_MS) {
+        current = hold;
+        clearing = false;
+    }
+    return current;
+}
+
+void updateActuators(AlertLevel level) {
+    const AlertLevelInfo& info = alertLevelInfo(level);
+    setRGBColor(info.color);
+    halSetBuzzer(info.buzzer);
+}
+
+void setRGBColor(LedColor color) {
+    const LedColorInfo& info = ledColorInfo(color);
+    halSetRGB(info.red, info.green, info.blue);
+}
@@ -0,0 +1,175 @@
+#include "anomaly.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "json_writer.h"
+
+static AnomalyEngine engine;
+
+AnomalyEngine& anomalyEngine() {
+    return engine;
+}
+
+static float sigmaOf(float variance, const AnomalyChannelInfo& info) {
+    float floor = info.minSigma * info.minSigma;
+    return sqrtf(variance > floor ? variance : floor);
+}
+
+void AnomalyEngine::begin(uint32_t nowMs) {
+    published.begin();
+    appliedEpoch = relearnEpoch;
+    reset(nowMs);
+}
+
+void AnomalyEngine::reset(uint32_t nowMs) {
+    memset(channels, 0, sizeof(channels));
+    learningPhase = true;
+    learnedMs = 0;
+    lastMs = nowMs;
+    level = AlertLevel::Normal;
+    publish();
+}
+
+void AnomalyEngine::restore(const AnomalyBaseline& baseline) {
+    for (size_t c = 0; c < ANOMALY_CHANNELS; c++) {
+        Channel& channel = channels[c];
+        if (!isfinite(baseline.mean[c]) || !isfinite(baseline.variance[c]) || baseline.variance[c] < 0) {
+            continue;
+        }
+        channel.mean = baseline.mean[c];
+        channel.variance = baseline.variance[c];
+        channel.samples = ANOMALY_MIN_SAMPLES;
+        channel.cusumHigh = 0;
+        channel.cusumLow = 0;
+    }
+    learningPhase = false;
+    learnedMs = ANOMALY_LEARNING_MS;
+    publish();
+}
+
+AlertLevel AnomalyEngine::observe(Channel& channel, const AnomalyChannelInfo& info, float value,
+                                  uint32_t nowMs, bool learn) {
+    if (!isfinite(value)) {
+        return channel.level;
+    }
+    uint32_t dt = channel.samples > 0 ? nowMs - channel.lastMs : ANOMALY_PERIOD_MS;
+    channel.lastMs = nowMs;
+    
+    AlertLevel severity = AlertLevel::Normal;
+    bool ready = !learningPhase && channel.samples >= ANOMALY_MIN_SAMPLES;
+    if (channel.samples > 0) {
+        channel.z = (value - channel.mean) / sigmaOf(channel.variance, info);
+    }
+    if (ready) {
+        float z = channel.z;
+        channel.cusumHigh = fmaxf(0.0f, channel.cusumHigh + z - ANOMALY_CUSUM_SLACK);
+        channel.cusumLow = info.twoSided ? fmaxf(0.0f, channel.cusumLow - z - ANOMALY_CUSUM_SLACK) : 0.0f;
+        float deviation = info.twoSided ? fabsf(z) : z;
+        float cusum = fmaxf(channel.cusumHigh, channel.cusumLow);
+        if (deviation >= ANOMALY_Z_RED || cusum >= ANOMALY_CUSUM_RED) {
+            severity = AlertLevel::Red;
+        } else if (deviation >= ANOMALY_Z_YELLOW || cusum >= ANOMALY_CUSUM_YELLOW) {
+            severity = AlertLevel::Yellow;
+        }
+    }
+    
+    // Sobe só depois de mantida; desce na hora (a histerese do alerta final
+    // fica com AlertEvaluator)
+    if (severity != channel.pending) {
+        channel.pending = severity;
+        channel.pendingSinceMs = nowMs;
+    }
+    if (severity < channel.level ||
+        (severity > channel.level && nowMs - channel.pendingSinceMs >= ANOMALY_DEBOUNCE_MS)) {
+        channel.level = severity;
+    }
+    
+    // Linha de base: só leituras confiáveis e sem anomalia
+    if (learn && severity == AlertLevel::Normal) {
+        channel.samples++;
+        float alpha = learningPhase ? 1.0f / channel.samples : (float)dt / info.tauMs;
+        if (alpha > 1.0f) alpha = 1.0f;
+        float diff = value - channel.mean;
+        float increment = alpha * diff;
+        channel.mean += increment;
+        channel.variance = (1.0f - alpha) * (channel.variance + diff * increment);
+    }
+    return channel.level;
+}
+
+AlertLevel AnomalyEngine::update(uint32_t nowMs, const float values[ANOMALY_CHANNELS], bool learn) {
+    if (relearnEpoch != appliedEpoch) {
+        appliedEpoch = relearnEpoch;
+        reset(nowMs);
+    }
+    
+    AlertLevel worst = AlertLevel::Normal;
+    for (size_t c = 0; c < ANOMALY_CHANNELS; c++) {
+        AlertLevel l = observe(channels[c], ANOMALY_CHANNEL_INFO[c], values[c], nowMs, learn);
+        if (l > worst) worst = l;
+    }
+    
+    // Lacunas longas (tarefa parada, entradas simuladas) não contam como
+    // tempo de aprendizado
+    if (learningPhase && learn) {
+        uint32_t dt = nowMs - lastMs;
+        learnedMs += dt < 2 * ANOMALY_PERIOD_MS ? dt : 2 * ANOMALY_PERIOD_MS;
+        if (learnedMs >= ANOMALY_LEARNING_MS) {
+            learningPhase = false;
+        }
+    }
+    lastMs = nowMs;
+    level = worst;
+    publish();
+    return level;
+}
+
+void AnomalyEngine::publish() {
+    AnomalySnapshot s;
+    s.learning = learningPhase;
+    s.learnedMs = learnedMs;
+    s.level = level;
+    for (size_t c = 0; c < ANOMALY_CHANNELS; c++) {
+        const Channel& channel = channels[c];
+        AnomalyChannelState& out = s.channels[c];
+        out.mean = channel.mean;
+        out.variance = channel.variance;
+        out.z = channel.z;
+        out.cusum = fmaxf(channel.cusumHigh, channel.cusumLow);
+        out.samples = channel.samples;
+        out.level = channel.level;
+    }
+    published.write(s);
+}
+
+void AnomalyEngine::baseline(const AnomalySnapshot& snapshot, AnomalyBaseline& baseline) {
+    for (size_t c = 0; c < ANOMALY_CHANNELS; c++) {
+        bool known = snapshot.channels[c].samples >= ANOMALY_MIN_SAMPLES;
+        baseline.mean[c] = known ? snapshot.channels[c].mean : NAN;
+        baseline.variance[c] = known ? snapshot.channels[c].variance : NAN;
+    }
+}
+
+void AnomalyEngine::write(const AnomalySnapshot& snapshot, JsonWriter& json) {
+    json.beginObject();
+    json.field("learning", snapshot.learning);
+    json.field("learned_s", (unsigned long)(snapshot.learnedMs / 1000));
+    json.field("level", alertLevelName(snapshot.level));
+    json.key("channels");
+    json.beginObject();
+    for (size_t c = 0; c < ANOMALY_CHANNELS; c++) {
+        const AnomalyChannelState& channel = snapshot.channels[c];
+        json.key(ANOMALY_CHANNEL_INFO[c].name);
+        json.beginObject();
+        json.field("mean", channel.mean, 3);
+        json.field("sigma", sigmaOf(channel.variance, ANOMALY_CHANNEL_INFO[c]), 3);
+        json.field("z", channel.z, 2);
+        json.field("cusum", channel.cusum, 1);
+        json.field("samples", (unsigned long)channel.samples);
+        json.field("level", alertLevelName(channel.level));
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+}
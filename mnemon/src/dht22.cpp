@@ -0,0 +1,124 @@
+#include "dht22.h"
+
+#include <math.h>
+
+// Faixas aceitas (µs), com folga sobre as do datasheet para o desvio do
+// oscilador do sensor e o filtro de glitches da captura
+const uint16_t RESPONSE_MIN_US = 60;
+const uint16_t RESPONSE_MAX_US = 110;
+const uint16_t BIT_LOW_MIN_US = 30;
+const uint16_t BIT_LOW_MAX_US = 90;
+const uint16_t BIT_HIGH_MIN_US = 10;
+const uint16_t BIT_HIGH_MAX_US = 100;
+const uint16_t BIT_ONE_US = 48;         // Entre 26-28 µs (0) e 70 µs (1)
+
+void Dht22PulseTrain::add(bool high, uint32_t us) {
+    uint16_t duration = us > UINT16_MAX ? UINT16_MAX : (uint16_t)us;
+    if (!high) {
+        if (level == 0) {
+            buffer[count - 1].lowUs += duration;
+            return;
+        }
+        if (count == DHT22_MAX_PULSES) {
+            overflow = true;
+            level = -1;
+            return;
+        }
+        buffer[count].lowUs = duration;
+        buffer[count].highUs = 0;
+        count++;
+        level = 0;
+    } else if (level >= 0) {
+        buffer[count - 1].highUs += duration;
+        level = 1;
+    }
+}
+
+static bool inRange(uint16_t value, uint16_t min, uint16_t max) {
+    return value >= min && value <= max;
+}
+
+Dht22Status dht22Decode(const Dht22Pulse* pulses, size_t count, Dht22Frame& frame) {
+    // A resposta é o primeiro pulso de 80/80 µs; os bits têm nível baixo
+    // de 50 µs, o que a distingue deles
+    size_t first = 0;
+    while (first < count && !(inRange(pulses[first].lowUs, RESPONSE_MIN_US, RESPONSE_MAX_US) &&
+                              inRange(pulses[first].highUs, RESPONSE_MIN_US, RESPONSE_MAX_US))) {
+        first++;
+    }
+    if (first == count) {
+        return Dht22Status::NoResponse;
+    }
+    first++;
+    if (count - first < DHT22_BITS) {
+        return Dht22Status::Truncated;
+    }
+    
+    uint8_t bytes[5] = {};
+    for (size_t i = 0; i < DHT22_BITS; i++) {
+        const Dht22Pulse& pulse = pulses[first + i];
+        if (!inRange(pulse.lowUs, BIT_LOW_MIN_US, BIT_LOW_MAX_US) ||
+            !inRange(pulse.highUs, BIT_HIGH_MIN_US, BIT_HIGH_MAX_US)) {
+            return Dht22Status::BadTiming;
+        }
+        bytes[i / 8] = (uint8_t)(bytes[i / 8] << 1) | (pulse.highUs > BIT_ONE_US);
+    }
+    if ((uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]) != bytes[4]) {
+        return Dht22Status::Checksum;
+    }
+    
+    frame.humidity = ((bytes[0] << 8) | bytes[1]) / 10.0f;
+    float temperature = (((bytes[2] & 0x7F) << 8) | bytes[3]) / 10.0f;
+    frame.temperature = (bytes[2] & 0x80) ? -temperature : temperature;
+    return Dht22Status::Ok;
+}
+
+size_t dht22Encode(const Dht22Frame& frame, Dht22Pulse* pulses, size_t maxPulses) {
+    if (maxPulses < DHT22_BITS + 3) {
+        return 0;
+    }
+    float h = frame.humidity < 0 ? 0 : frame.humidity > 100 ? 100 : frame.humidity;
+    float t = fabsf(frame.temperature) > 125 ? 125 : fabsf(frame.temperature);
+    uint16_t humidity = (uint16_t)lroundf(h * 10);
+    uint16_t temperature = (uint16_t)lroundf(t * 10) | (frame.temperature < 0 ? 0x8000 : 0);
+    uint8_t bytes[5] = {(uint8_t)(humidity >> 8), (uint8_t)humidity,
+                        (uint8_t)(temperature >> 8), (uint8_t)temperature, 0};
+    bytes[4] = (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+    
+    size_t n = 0;
+    pulses[n++] = {5, 30};      // Cauda do pulso de início + espera do sensor
+    pulses[n++] = {80, 80};
+    for (size_t i = 0; i < DHT22_BITS; i++) {
+        bool one = bytes[i / 8] & (0x80 >> (i % 8));
+        pulses[n++] = {50, (uint16_t)(one ? 70 : 27)};
+    }
+    pulses[n++] = {50, 0};
+    return n;
+}
+
+void Dht22Reader::start(uint32_t nowMs) {
+    started = true;
+    lastStartMs = nowMs;
+    counters.reads++;
+}
+
+Dht22Status Dht22Reader::complete(const Dht22PulseTrain& train) {
+    Dht22Frame decoded;
+    status = dht22Decode(train.pulses(), train.size(), decoded);
+    counters.results[(size_t)status]++;
+    if (status == Dht22Status::Ok) {
+        last = decoded;
+        lastFrameMs = lastStartMs;
+        valid = true;
+    }
+    return status;
+}
+
+bool Dht22Reader::frame(Dht22Frame& frame, uint32_t& capturedMs) const {
+    if (!valid) {
+        return false;
+    }
+    frame = last;
+    capturedMs = lastFrameMs;
+    return status == Dht22Status::Ok;
+}
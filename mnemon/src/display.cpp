@@ -0,0 +1,166 @@
+#include "display.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "hal.h"
+#include "rtos.h"
+#include "system_state.h"
+
+// Desenho desejado (escrito pela tarefa de saída) e conteúdo atual do vidro
+// (só a tarefa do display o conhece)
+static StaticMutex frameMutex;
+static char frame[LCD_ROWS][LCD_COLS];
+static char glass[LCD_ROWS][LCD_COLS];
+
+// Reposicionar o cursor custa um byte, o mesmo que reescrever uma célula
+// igual: lacunas até este tamanho entram na sequência em vez de dividi-la
+const uint8_t LCD_RUN_GAP = 1;
+
+static StaticMutex messageMutex;
+static char messageLine1[17];
+static char messageLine2[17];
+static uint32_t messageUntil = 0;
+static bool messagePending = false;
+static bool messageActive = false;
+
+void displayBegin() {
+    messageMutex.begin();
+    frameMutex.begin();
+    // O vidro pode ter a tela de inicialização: marcado como desconhecido
+    // ('\0' nunca aparece no framebuffer), o primeiro flush reescreve tudo
+    memset(frame, ' ', sizeof(frame));
+    memset(glass, '\0', sizeof(glass));
+}
+
+// Escreve o texto a partir de col, cortado no fim da linha
+static void frameText(char* line, uint8_t col, const char* text) {
+    for (; col < LCD_COLS && *text; col++, text++) {
+        line[col] = *text;
+    }
+}
+
+static void publishFrame(const char line1[LCD_COLS], const char line2[LCD_COLS]) {
+    ScopedLock lock(frameMutex);
+    memcpy(frame[0], line1, LCD_COLS);
+    memcpy(frame[1], line2, LCD_COLS);
+}
+
+static uint32_t flushRun(uint8_t row, uint8_t first, uint8_t last, const char* line) {
+    char text[LCD_COLS + 1];
+    uint8_t len = last - first + 1;
+    memcpy(text, line + first, len);
+    text[len] = '\0';
+    halLcdPrint(first, row, text);
+    memcpy(glass[row] + first, text, len);
+    return 1 + len;
+}
+
+uint32_t displayFlush() {
+    char target[LCD_ROWS][LCD_COLS];
+    {
+        ScopedLock lock(frameMutex);
+        memcpy(target, frame, sizeof(target));
+    }
+    
+    uint32_t bytes = 0;
+    for (uint8_t row = 0; row < LCD_ROWS; row++) {
+        int first = -1;
+        int last = -1;
+        for (int col = 0; col < LCD_COLS; col++) {
+            if (target[row][col] == glass[row][col]) {
+                continue;
+            }
+            if (first >= 0 && col - last - 1 > LCD_RUN_GAP) {
+                bytes += flushRun(row, first, last, target[row]);
+                first = col;
+            } else if (first < 0) {
+                first = col;
+            }
+            last = col;
+        }
+        if (first >= 0) {
+            bytes += flushRun(row, first, last, target[row]);
+        }
+    }
+    return bytes;
+}
+
+void showLcdMessage(const char* line1, const char* line2, uint32_t durationMs) {
+    ScopedLock lock(messageMutex);
+    strncpy(messageLine1, line1, sizeof(messageLine1) - 1);
+    strncpy(messageLine2, line2, sizeof(messageLine2) - 1);
+    messageUntil = halMillis() + durationMs;
+    messagePending = true;
+}
+
+bool renderLcdMessage() {
+    char line1[17];
+    char line2[17];
+    {
+        ScopedLock lock(messageMutex);
+        if (!messagePending && !messageActive) {
+            return false;
+        }
+        if ((int32_t)(halMillis() - messageUntil) >= 0) {
+            messagePending = false;
+            messageActive = false;
+            return false;
+        }
+        if (!messagePending) {
+            return true; // Já está na tela
+        }
+        memcpy(line1, messageLine1, sizeof(line1));
+        memcpy(line2, messageLine2, sizeof(line2));
+        messagePending = false;
+        messageActive = true;
+    }
+    
+    char rows[LCD_ROWS][LCD_COLS];
+    memset(rows, ' ', sizeof(rows));
+    frameText(rows[0], 0, line1);
+    frameText(rows[1], 0, line2);
+    publishFrame(rows[0], rows[1]);
+    return true;
+}
+
+void updateLCDDisplay(const Snapshot& snapshot) {
+    char rows[LCD_ROWS][LCD_COLS];
+    char text[LCD_COLS + 1];
+    memset(rows, ' ', sizeof(rows));
+    
+    // Linha 1: Cenário e status
+    snprintf(text, sizeof(text), "%.8s", scenarioName(currentScenario)); // Primeiros 8 chars
+    frameText(rows[0], 0, text);
+    frameText(rows[0], 9, alertLevelInfo(snapshot.alertLevel).lcdText);
+    
+    snprintf(text, sizeof(text), "%d", (int)testStep);
+    frameText(rows[0], 14, text);
+    
+    // Linha 2: Dados dos sensores (rotativo)
+    unsigned long elapsed = (halMillis() - scenarioStartTime) / 1000;
+    int displayMode = (elapsed / 5) % 4; // Muda a cada 5 segundos
+    
+    switch (displayMode) {
+        case 0: // Temperatura e umidade
+            snprintf(text, sizeof(text), "T:%.1fC H:%.0f%%",
+                     snapshot.temperature, snapshot.humidity);
+            break;
+            
+        case 1: // Luminosidade
+            snprintf(text, sizeof(text), "Luz: %.0f lux", snapshot.lux);
+            break;
+            
+        case 2: // Aceleração X,Y
+            snprintf(text, sizeof(text), "X:%.1f Y:%.1f",
+                     snapshot.accelX, snapshot.accelY);
+            break;
+            
+        default: // Aceleração Z e tempo
+            snprintf(text, sizeof(text), "Z:%.1f %lus", snapshot.accelZ, elapsed);
+            break;
+    }
+    frameText(rows[1], 0, text);
+    publishFrame(rows[0], rows[1]);
+}
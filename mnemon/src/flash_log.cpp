@@ -0,0 +1,264 @@
+#include "flash_log.h"
+
+#include <string.h>
+
+#include "crc32.h"
+#include "hal.h"
+
+static const uint32_t SEGMENT_MAGIC = 0x474C4E4D; // "MNLG"
+
+struct RecordHeader {
+    uint16_t length;
+    uint8_t type;
+    uint8_t reserved;
+    uint32_t timeMs;
+    uint32_t crc;
+};
+
+static_assert(sizeof(RecordHeader) == 12, "cabeçalho do registro deve ter 12 bytes");
+
+static FlashLog instance;
+
+FlashLog& flashLog() {
+    return instance;
+}
+
+static size_t recordSize(size_t length) {
+    return (sizeof(RecordHeader) + length + 3) & ~(size_t)3;
+}
+
+static uint32_t recordCrc(const RecordHeader& header, const uint8_t* payload) {
+    uint8_t data[8 + LOG_MAX_PAYLOAD];
+    memcpy(data, &header, 8);
+    memcpy(data + 8, payload, header.length);
+    return crc32(data, 8 + header.length);
+}
+
+static bool erased(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+bool FlashLog::begin(uint32_t reservedSectors) {
+    segmentCount = 0;
+    batchLength = 0;
+    clockBase = 0;
+    counters = {};
+    
+    uint32_t count = halFlashSize() / FLASH_SECTOR_SIZE;
+    count = count > reservedSectors ? count - reservedSectors : 0;
+    if (count < 2) {
+        return false;
+    }
+    segmentCount = count;
+    
+    // Só os cabeçalhos: acha o segmento mais recente
+    bool found = false;
+    for (uint32_t s = 0; s < count; s++) {
+        SegmentHeader header;
+        if (readHeader(s, header) && (!found || header.seq > headSeq)) {
+            head = s;
+            headSeq = header.seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        return startSegment(0, 1, 0); // Partição nova
+    }
+    
+    SegmentHeader header;
+    readHeader(head, header);
+    uint32_t lastTimeMs = header.firstTimeMs;
+    uint32_t visited = 0;
+    bool torn = false;
+    writeOffset = scanSegment(head, 0, nullptr, nullptr, lastTimeMs, torn, visited);
+    clockBase = lastTimeMs;
+    
+    // Não dá para escrever sobre bytes parcialmente gravados
+    if (torn) {
+        counters.tornRecords++;
+        return advance(lastTimeMs);
+    }
+    return true;
+}
+
+bool FlashLog::readHeader(uint32_t segment, SegmentHeader& header) const {
+    if (!halFlashRead(segment * FLASH_SECTOR_SIZE, &header, sizeof(header))) {
+        return false;
+    }
+    return header.magic == SEGMENT_MAGIC &&
+           header.crc == crc32((const uint8_t*)&header, offsetof(SegmentHeader, crc));
+}
+
+bool FlashLog::startSegment(uint32_t segment, uint32_t seq, uint32_t timeMs) {
+    head = segment;
+    headSeq = seq;
+    writeOffset = sizeof(SegmentHeader);
+    
+    counters.erases++;
+    SegmentHeader header = {SEGMENT_MAGIC, seq, timeMs, 0};
+    header.crc = crc32((const uint8_t*)&header, offsetof(SegmentHeader, crc));
+    if (!halFlashEraseSector(segment * FLASH_SECTOR_SIZE) ||
+        !halFlashWrite(segment * FLASH_SECTOR_SIZE, &header, sizeof(header))) {
+        counters.writeErrors++;
+        return false;
+    }
+    return true;
+}
+
+bool FlashLog::advance(uint32_t timeMs) {
+    return startSegment((head + 1) % segmentCount, headSeq + 1, timeMs);
+}
+
+bool FlashLog::append(LogRecordType type, uint32_t timeMs, const void* payload, size_t length) {
+    if (!enabled() || length > LOG_MAX_PAYLOAD) {
+        return false;
+    }
+    size_t size = recordSize(length);
+    
+    if (writeOffset + batchLength + size > FLASH_SECTOR_SIZE) {
+        // Cabeça cheia: grava o lote nela e abre o próximo segmento
+        flush();
+        if (!advance(timeMs)) {
+            return false;
+        }
+    } else if (batchLength + size > LOG_BATCH_BYTES) {
+        flush();
+    }
+    
+    if (batchLength == 0) {
+        batchStartMs = timeMs;
+    }
+    RecordHeader header;
+    header.length = length;
+    header.type = (uint8_t)type;
+    header.reserved = 0xFF;
+    header.timeMs = timeMs;
+    header.crc = recordCrc(header, (const uint8_t*)payload);
+    
+    uint8_t* out = batch + batchLength;
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), payload, length);
+    memset(out + sizeof(header) + length, 0xFF, size - sizeof(header) - length);
+    batchLength += size;
+    counters.records++;
+    
+    if (timeMs - batchStartMs >= LOG_FLUSH_PERIOD_MS) {
+        flush();
+    }
+    return true;
+}
+
+bool FlashLog::flush() {
+    if (batchLength == 0) {
+        return true;
+    }
+    bool ok = halFlashWrite(head * FLASH_SECTOR_SIZE + writeOffset, batch, batchLength);
+    // Mesmo em falha a área é dada como usada: não se grava duas vezes por cima
+    writeOffset += batchLength;
+    batchLength = 0;
+    counters.flushes++;
+    if (!ok) {
+        counters.writeErrors++;
+    }
+    return ok;
+}
+
+uint32_t FlashLog::scanSegment(uint32_t segment, uint32_t fromMs, LogVisitor visitor,
+                               void* context, uint32_t& lastTimeMs, bool& torn,
+                               uint32_t& visited) const {
+    // Lê a flash em janelas de 256 bytes (vários registros por leitura)
+    const uint32_t WINDOW = 256;
+    static_assert(WINDOW >= sizeof(RecordHeader) + LOG_MAX_PAYLOAD, "janela menor que um registro");
+    uint8_t window[WINDOW];
+    uint32_t windowStart = 0;
+    uint32_t windowLength = 0;
+    
+    uint32_t base = segment * FLASH_SECTOR_SIZE;
+    uint32_t offset = sizeof(SegmentHeader);
+    torn = false;
+    
+    while (offset + sizeof(RecordHeader) <= FLASH_SECTOR_SIZE) {
+        uint32_t available = FLASH_SECTOR_SIZE - offset;
+        uint32_t need = sizeof(RecordHeader) + LOG_MAX_PAYLOAD;
+        if (need > available) need = available;
+        if (offset < windowStart || offset + need > windowStart + windowLength) {
+            windowStart = offset;
+            windowLength = available < WINDOW ? available : WINDOW;
+            if (!halFlashRead(base + windowStart, window, windowLength)) {
+                break;
+            }
+        }
+        const uint8_t* data = window + (offset - windowStart);
+        
+        RecordHeader header;
+        memcpy(&header, data, sizeof(header));
+        if (header.length == 0xFFFF) {
+            torn = !erased(data, sizeof(header));
+            break;
+        }
+        size_t size = recordSize(header.length);
+        if (header.length > LOG_MAX_PAYLOAD || offset + size > FLASH_SECTOR_SIZE ||
+            header.crc != recordCrc(header, data + sizeof(header))) {
+            torn = true;
+            break;
+        }
+        
+        lastTimeMs = header.timeMs;
+        if (visitor != nullptr && header.timeMs >= fromMs) {
+            visitor((LogRecordType)header.type, header.timeMs, data + sizeof(header),
+                    header.length, context);
+            visited++;
+        }
+        offset += size;
+    }
+    return offset;
+}
+
+uint32_t FlashLog::replay(uint32_t fromMs, LogVisitor visitor, void* context) const {
+    if (!enabled()) {
+        return 0;
+    }
+    
+    // Em ordem física a partir da cabeça + 1, os segmentos válidos vêm do
+    // mais antigo para o mais novo. Primeiro passo: o último segmento que
+    // começa até fromMs, para não ler registros antigos demais.
+    uint32_t start = 0;
+    uint32_t previousSeq = 0;
+    for (uint32_t i = 0; i < segmentCount; i++) {
+        SegmentHeader header;
+        uint32_t s = (head + 1 + i) % segmentCount;
+        if (!readHeader(s, header) || header.seq <= previousSeq || header.seq > headSeq) {
+            continue;
+        }
+        previousSeq = header.seq;
+        if (header.firstTimeMs <= fromMs) {
+            start = i;
+        }
+    }
+    
+    uint32_t visited = 0;
+    previousSeq = 0;
+    for (uint32_t i = start; i < segmentCount; i++) {
+        SegmentHeader header;
+        uint32_t s = (head + 1 + i) % segmentCount;
+        if (!readHeader(s, header) || header.seq <= previousSeq || header.seq > headSeq) {
+            continue;
+        }
+        previousSeq = header.seq;
+        uint32_t lastTimeMs;
+        bool torn;
+        scanSegment(s, fromMs, visitor, context, lastTimeMs, torn, visited);
+    }
+    return visited;
+}
+
+FlashLogStats FlashLog::stats() const {
+    FlashLogStats stats = counters;
+    stats.segments = segmentCount;
+    stats.headSegment = head;
+    stats.headSeq = headSeq;
+    return stats;
+}
@@ -0,0 +1,668 @@
+#include "gzip.h"
+
+#include <string.h>
+
+#include "crc32.h"
+
+namespace {
+
+// Comprimentos 3..258 e distâncias 1..32768: base e bits extras de cada
+// símbolo (RFC 1951, 3.2.5)
+const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+const uint16_t DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+const uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+// Ordem dos comprimentos do alfabeto de comprimentos no cabeçalho (3.2.7)
+const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+const uint8_t CODE_LENGTH_EXTRA[19] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7};
+
+const uint32_t MIN_MATCH = 3;
+const uint32_t MAX_MATCH = 258;
+const uint32_t END_OF_BLOCK = 256;
+
+uint32_t lengthSymbol(uint32_t length) {
+    uint32_t l = 28;
+    while (LENGTH_BASE[l] > length) {
+        l--;
+    }
+    return l;
+}
+
+uint32_t distanceSymbol(uint32_t distance) {
+    uint32_t d = 29;
+    while (DISTANCE_BASE[d] > distance) {
+        d--;
+    }
+    return d;
+}
+
+// Comprimento do código fixo de literal/comprimento (3.2.6)
+uint32_t fixedLength(uint32_t symbol) {
+    return symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8;
+}
+
+uint32_t fixedCode(uint32_t symbol) {
+    return symbol < 144 ? 0x30 + symbol
+         : symbol < 256 ? 0x190 + symbol - 144
+         : symbol < 280 ? symbol - 256
+         : 0xC0 + symbol - 280;
+}
+
+// Bits do deflate: valores a partir do bit menos significativo, códigos de
+// Huffman a partir do mais significativo
+class BitWriter {
+public:
+    BitWriter(uint8_t* out, size_t capacity) : out(out), cap(capacity) {}
+
+    void bits(uint32_t value, uint32_t count) {
+        acc |= value << used;
+        used += count;
+        while (used >= 8) {
+            byte((uint8_t)acc);
+            acc >>= 8;
+            used -= 8;
+        }
+    }
+
+    void code(uint32_t code, uint32_t count) {
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        bits(reversed, count);
+    }
+
+    void flush() {
+        if (used > 0) {
+            byte((uint8_t)acc);
+        }
+        acc = 0;
+        used = 0;
+    }
+
+    void byte(uint8_t value) {
+        if (pos < cap) {
+            out[pos] = value;
+        } else {
+            overflow = true;
+        }
+        pos++;
+    }
+
+    void le32(uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            byte((uint8_t)(value >> (8 * i)));
+        }
+    }
+
+    size_t length() const { return overflow ? 0 : pos; }
+
+private:
+    uint8_t* out;
+    size_t cap;
+    size_t pos = 0;
+    uint32_t acc = 0;
+    uint32_t used = 0;
+    bool overflow = false;
+};
+
+// Comprimentos de Huffman limitados a maxBits. Com uma árvore funda demais
+// as frequências são divididas por dois (as não nulas ficam em pelo menos
+// 1) e a árvore é refeita. work comporta 5n entradas.
+void huffmanLengths(const uint16_t* freq, uint32_t n, uint32_t maxBits, uint8_t* lengths, uint16_t* work) {
+    uint16_t* order = work;             // Folhas em ordem crescente de peso
+    uint16_t* weight = work + n;        // Folhas 0..m-1, nós internos depois
+    uint16_t* parent = work + 3 * n;    // Vira a profundidade no fim
+
+    for (uint32_t shift = 0;; shift++) {
+        uint32_t m = 0;
+        for (uint32_t s = 0; s < n; s++) {
+            lengths[s] = 0;
+            if (freq[s] == 0) {
+                continue;
+            }
+            // Inserção ordenada: n <= 286
+            uint16_t w = (uint16_t)((freq[s] + (1u << shift) - 1) >> shift);
+            uint32_t j = m++;
+            while (j > 0 && weight[j - 1] > w) {
+                weight[j] = weight[j - 1];
+                order[j] = order[j - 1];
+                j--;
+            }
+            weight[j] = w;
+            order[j] = (uint16_t)s;
+        }
+        if (m == 0) {
+            return;
+        }
+        if (m == 1) {
+            lengths[order[0]] = 1;
+            return;
+        }
+
+        // Duas filas: folhas ordenadas e nós internos, criados em ordem
+        // crescente de peso; o menor das duas frentes sai primeiro
+        uint32_t leaf = 0;
+        uint32_t node = m;
+        uint32_t next = m;
+        auto smallest = [&]() {
+            if (leaf < m && (node >= next || weight[leaf] <= weight[node])) {
+                return leaf++;
+            }
+            return node++;
+        };
+        for (uint32_t k = 0; k + 1 < m; k++) {
+            uint32_t a = smallest();
+            uint32_t b = smallest();
+            weight[next] = weight[a] + weight[b];
+            parent[a] = (uint16_t)next;
+            parent[b] = (uint16_t)next;
+            next++;
+        }
+
+        // Pais têm índice maior que os filhos: de cima para baixo
+        uint32_t root = next - 1;
+        parent[root] = 0;
+        uint32_t deepest = 0;
+        for (uint32_t i = root; i-- > 0;) {
+            parent[i] = parent[parent[i]] + 1;
+            if (i < m && parent[i] > deepest) {
+                deepest = parent[i];
+            }
+        }
+        if (deepest <= maxBits) {
+            for (uint32_t j = 0; j < m; j++) {
+                lengths[order[j]] = (uint8_t)parent[j];
+            }
+            return;
+        }
+    }
+}
+
+// Códigos canônicos a partir dos comprimentos (3.2.2)
+void canonicalCodes(const uint8_t* lengths, uint32_t n, uint16_t* codes) {
+    uint16_t count[16] = {};
+    for (uint32_t s = 0; s < n; s++) {
+        count[lengths[s]]++;
+    }
+    count[0] = 0;
+    uint16_t next[16];
+    uint16_t code = 0;
+    for (uint32_t bits = 1; bits < 16; bits++) {
+        code = (code + count[bits - 1]) << 1;
+        next[bits] = code;
+    }
+    for (uint32_t s = 0; s < n; s++) {
+        if (lengths[s] != 0) {
+            codes[s] = next[lengths[s]]++;
+        }
+    }
+}
+
+// Comprimentos do cabeçalho em corridas: 16 repete o anterior 3-6 vezes,
+// 17 e 18 dão 3-10 e 11-138 zeros. emit(símbolo, valor dos bits extras)
+template <typename Emit>
+void runLengths(const uint8_t* lengths, uint32_t count, Emit emit) {
+    uint32_t i = 0;
+    while (i < count) {
+        uint8_t value = lengths[i];
+        uint32_t run = 1;
+        while (i + run < count && lengths[i + run] == value) {
+            run++;
+        }
+        i += run;
+        if (value == 0) {
+            while (run >= 11) {
+                uint32_t r = run < 138 ? run : 138;
+                emit(18, r - 11);
+                run -= r;
+            }
+            if (run >= 3) {
+                emit(17, run - 3);
+                run = 0;
+            }
+        } else {
+            emit(value, 0);
+            run--;
+            while (run >= 3) {
+                uint32_t r = run < 6 ? run : 6;
+                emit(16, r - 3);
+                run -= r;
+            }
+        }
+        while (run > 0) {
+            emit(value, 0);
+            run--;
+        }
+    }
+}
+
+} // namespace
+
+// LZ77 guloso: maior casamento entre até MAX_CHAIN posições anteriores com
+// os mesmos três bytes
+template <typename Literal, typename Match>
+void GzipEncoder::parse(const uint8_t* in, size_t length, Literal literal, Match match) {
+    for (int16_t& h : head) {
+        h = -1;
+    }
+    auto hashAt = [in](size_t i) {
+        uint32_t v = in[i] | (in[i + 1] << 8) | (in[i + 2] << 16);
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    };
+    auto insert = [&](size_t i) {
+        if (i + MIN_MATCH <= length) {
+            uint32_t h = hashAt(i);
+            chain[i] = (uint16_t)head[h];
+            head[h] = (int16_t)i;
+        }
+    };
+
+    size_t i = 0;
+    while (i < length) {
+        uint32_t bestLength = 0;
+        uint32_t bestDistance = 0;
+        if (i + MIN_MATCH <= length) {
+            uint32_t limit = length - i < MAX_MATCH ? (uint32_t)(length - i) : MAX_MATCH;
+            int32_t candidate = head[hashAt(i)];
+            for (uint32_t tries = 0; candidate >= 0 && tries < MAX_CHAIN; tries++) {
+                uint32_t n = 0;
+                while (n < limit && in[candidate + n] == in[i + n]) {
+                    n++;
+                }
+                if (n > bestLength) {
+                    bestLength = n;
+                    bestDistance = (uint32_t)(i - candidate);
+                    if (n == limit) {
+                        break;
+                    }
+                }
+                candidate = (int16_t)chain[candidate];
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            match(bestLength, bestDistance);
+            for (uint32_t k = 0; k < bestLength; k++) {
+                insert(i + k);
+            }
+            i += bestLength;
+        } else {
+            literal(in[i]);
+            insert(i);
+            i++;
+        }
+    }
+}
+
+size_t GzipEncoder::encode(const uint8_t* in, size_t length, uint8_t* out, size_t capacity) {
+    if (length > GZIP_MAX_INPUT) {
+        return 0;
+    }
+
+    // Primeira passada: frequências dos símbolos
+    memset(literalFreq, 0, sizeof(literalFreq));
+    memset(distanceFreq, 0, sizeof(distanceFreq));
+    uint32_t extraBits = 0;
+    parse(in, length,
+          [this](uint8_t byte) { literalFreq[byte]++; },
+          [this, &extraBits](uint32_t len, uint32_t distance) {
+              uint32_t l = lengthSymbol(len);
+              uint32_t d = distanceSymbol(distance);
+              literalFreq[257 + l]++;
+              distanceFreq[d]++;
+              extraBits += LENGTH_EXTRA[l] + DISTANCE_EXTRA[d];
+          });
+    literalFreq[END_OF_BLOCK] = 1;
+    // Sem casamentos ainda é preciso um código de distância (de 1 bit)
+    bool matched = false;
+    for (uint16_t f : distanceFreq) {
+        matched |= f != 0;
+    }
+    if (!matched) {
+        distanceFreq[0] = 1;
+    }
+
+    // Árvores do corpo; chain está livre até a segunda passada
+    uint8_t* distanceLengths = lengths + LITERALS;
+    huffmanLengths(literalFreq, LITERALS, 15, lengths, chain);
+    huffmanLengths(distanceFreq, DISTANCES, 15, distanceLengths, chain);
+    canonicalCodes(lengths, LITERALS, literalCode);
+    canonicalCodes(distanceLengths, DISTANCES, distanceCode);
+
+    uint32_t literalCount = LITERALS;
+    while (literalCount > 257 && lengths[literalCount - 1] == 0) {
+        literalCount--;
+    }
+    uint32_t distanceCount = DISTANCES;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) {
+        distanceCount--;
+    }
+
+    uint64_t fixedBits = 3 + extraBits;
+    uint64_t dynamicBits = 3 + 5 + 5 + 4 + extraBits;
+    for (uint32_t s = 0; s < LITERALS; s++) {
+        fixedBits += literalFreq[s] * fixedLength(s);
+        dynamicBits += literalFreq[s] * lengths[s];
+    }
+    for (uint32_t d = 0; d < DISTANCES; d++) {
+        fixedBits += distanceFreq[d] * 5;
+        dynamicBits += distanceFreq[d] * distanceLengths[d];
+    }
+
+    // Distâncias logo depois dos literais usados, como no cabeçalho
+    memmove(lengths + literalCount, distanceLengths, distanceCount);
+    uint32_t headerLengths = literalCount + distanceCount;
+    memset(codeLengthFreq, 0, sizeof(codeLengthFreq));
+    runLengths(lengths, headerLengths, [this](uint32_t symbol, uint32_t) { codeLengthFreq[symbol]++; });
+    huffmanLengths(codeLengthFreq, CODE_LENGTHS, 7, codeLengthLengths, chain);
+    canonicalCodes(codeLengthLengths, CODE_LENGTHS, codeLengthCode);
+    uint32_t codeLengthCount = CODE_LENGTHS;
+    while (codeLengthCount > 4 && codeLengthLengths[CODE_LENGTH_ORDER[codeLengthCount - 1]] == 0) {
+        codeLengthCount--;
+    }
+    dynamicBits += 3 * codeLengthCount;
+    for (uint32_t s = 0; s < CODE_LENGTHS; s++) {
+        dynamicBits += codeLengthFreq[s] * (codeLengthLengths[s] + CODE_LENGTH_EXTRA[s]);
+    }
+    bool dynamic = dynamicBits < fixedBits;
+
+    // Cabeçalho gzip: deflate, sem nome nem data, sistema desconhecido
+    static const uint8_t HEADER[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    BitWriter w(out, capacity);
+    for (uint8_t b : HEADER) {
+        w.byte(b);
+    }
+
+    // Um único bloco final
+    w.bits(1, 1);
+    if (dynamic) {
+        w.bits(2, 2);
+        w.bits(literalCount - 257, 5);
+        w.bits(distanceCount - 1, 5);
+        w.bits(codeLengthCount - 4, 4);
+        for (uint32_t i = 0; i < codeLengthCount; i++) {
+            w.bits(codeLengthLengths[CODE_LENGTH_ORDER[i]], 3);
+        }
+        runLengths(lengths, headerLengths, [this, &w](uint32_t symbol, uint32_t extra) {
+            w.code(codeLengthCode[symbol], codeLengthLengths[symbol]);
+            w.bits(extra, CODE_LENGTH_EXTRA[symbol]);
+        });
+        // Comprimentos das distâncias de volta ao lugar para a emissão
+        memmove(distanceLengths, lengths + literalCount, distanceCount);
+    } else {
+        w.bits(1, 2);
+    }
+
+    // Segunda passada: emissão (o LZ77 é determinístico)
+    auto literal = [&](uint32_t symbol) {
+        if (dynamic) {
+            w.code(literalCode[symbol], lengths[symbol]);
+        } else {
+            w.code(fixedCode(symbol), fixedLength(symbol));
+        }
+    };
+    parse(in, length, literal, [&](uint32_t len, uint32_t distance) {
+        uint32_t l = lengthSymbol(len);
+        literal(257 + l);
+        w.bits(len - LENGTH_BASE[l], LENGTH_EXTRA[l]);
+        uint32_t d = distanceSymbol(distance);
+        if (dynamic) {
+            w.code(distanceCode[d], distanceLengths[d]);
+        } else {
+            w.code(d, 5);
+        }
+        w.bits(distance - DISTANCE_BASE[d], DISTANCE_EXTRA[d]);
+    });
+    literal(END_OF_BLOCK);
+    w.flush();
+
+    w.le32(crc32(in, length));
+    w.le32((uint32_t)length);
+    return w.length();
+}
+
+void GzipDecoder::Huffman::build(const uint8_t* lengths, uint32_t n) {
+    memset(count, 0, sizeof(count));
+    for (uint32_t s = 0; s < n; s++) {
+        count[lengths[s]]++;
+    }
+    uint16_t offset[16];
+    offset[1] = 0;
+    for (uint32_t len = 1; len < 15; len++) {
+        offset[len + 1] = offset[len] + count[len];
+    }
+    for (uint32_t s = 0; s < n; s++) {
+        if (lengths[s] != 0) {
+            symbol[offset[lengths[s]]++] = (uint16_t)s;
+        }
+    }
+}
+
+uint32_t GzipDecoder::bits(uint32_t count) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (pos >= length) {
+            bad = true;
+            return 0;
+        }
+        value |= (uint32_t)((data[pos] >> used) & 1) << i;
+        if (++used == 8) {
+            used = 0;
+            pos++;
+        }
+    }
+    return value;
+}
+
+// Códigos de Huffman chegam a partir do bit mais significativo
+uint32_t GzipDecoder::decodeSymbol(const Huffman& h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (uint32_t len = 1; len < 16; len++) {
+        code |= bits(1);
+        int count = h.count[len];
+        if (code - count < first) {
+            return h.symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    bad = true;
+    return 0xFFFF;
+}
+
+bool GzipDecoder::stored() {
+    if (used > 0) {
+        pos++;
+        used = 0;
+    }
+    if (pos + 4 > length) {
+        return false;
+    }
+    uint32_t len = data[pos] | (data[pos + 1] << 8);
+    uint32_t complement = data[pos + 2] | (data[pos + 3] << 8);
+    pos += 4;
+    if ((len ^ 0xFFFF) != complement || pos + len > length || written + len > capacity) {
+        return false;
+    }
+    memcpy(out + written, data + pos, len);
+    pos += len;
+    written += len;
+    return true;
+}
+
+bool GzipDecoder::dynamicTables(Huffman& literals, Huffman& distances) {
+    uint32_t nlen = bits(5) + 257;
+    uint32_t ndist = bits(5) + 1;
+    uint32_t ncode = bits(4) + 4;
+    if (nlen > GzipEncoder::LITERALS || ndist > GzipEncoder::DISTANCES) {
+        return false;
+    }
+    uint8_t lengths[GzipEncoder::LITERALS + GzipEncoder::DISTANCES] = {};
+    for (uint32_t i = 0; i < ncode; i++) {
+        lengths[CODE_LENGTH_ORDER[i]] = (uint8_t)bits(3);
+    }
+    Huffman codes;
+    codes.build(lengths, GzipEncoder::CODE_LENGTHS);
+    uint32_t index = 0;
+    memset(lengths, 0, sizeof(lengths));
+    while (index < nlen + ndist && !bad) {
+        uint32_t symbol = decodeSymbol(codes);
+        if (symbol < 16) {
+            lengths[index++] = (uint8_t)symbol;
+            continue;
+        }
+        uint8_t value = 0;
+        uint32_t repeat;
+        if (symbol == 16) {
+            if (index == 0) {
+                return false;
+            }
+            value = lengths[index - 1];
+            repeat = 3 + bits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + bits(3);
+        } else if (symbol == 18) {
+            repeat = 11 + bits(7);
+        } else {
+            return false;
+        }
+        if (index + repeat > nlen + ndist) {
+            return false;
+        }
+        while (repeat-- > 0) {
+            lengths[index++] = value;
+        }
+    }
+    literals.build(lengths, nlen);
+    distances.build(lengths + nlen, ndist);
+    return !bad && lengths[END_OF_BLOCK] != 0;
+}
+
+bool GzipDecoder::block(const Huffman& literals, const Huffman& distances) {
+    for (;;) {
+        uint32_t symbol = decodeSymbol(literals);
+        if (bad || symbol > 285) {
+            return false;
+        }
+        if (symbol < 256) {
+            if (written == capacity) {
+                return false;
+            }
+            out[written++] = (uint8_t)symbol;
+            continue;
+        }
+        if (symbol == END_OF_BLOCK) {
+            return true;
+        }
+        uint32_t l = symbol - 257;
+        uint32_t len = LENGTH_BASE[l] + bits(LENGTH_EXTRA[l]);
+        uint32_t d = decodeSymbol(distances);
+        if (d >= 30) {
+            return false;
+        }
+        uint32_t distance = DISTANCE_BASE[d] + bits(DISTANCE_EXTRA[d]);
+        if (bad || distance > written || written + len > capacity) {
+            return false;
+        }
+        // Cópia byte a byte: a origem pode sobrepor o destino
+        for (uint32_t k = 0; k < len; k++, written++) {
+            out[written] = out[written - distance];
+        }
+    }
+}
+
+bool GzipDecoder::decode(const uint8_t* in, size_t inLength, uint8_t* output, size_t outCapacity,
+                         size_t& outLength) {
+    data = in;
+    length = inLength;
+    used = 0;
+    bad = false;
+    out = output;
+    capacity = outCapacity;
+    written = 0;
+    outLength = 0;
+    if (length < 18 || data[0] != 0x1f || data[1] != 0x8b || data[2] != 8) {
+        return false;
+    }
+    // Campos opcionais do cabeçalho (RFC 1952, 2.3)
+    uint8_t flags = data[3];
+    pos = 10;
+    if (flags & 0x04) {
+        if (pos + 2 > length) {
+            return false;
+        }
+        pos += 2 + (data[pos] | (data[pos + 1] << 8));
+    }
+    static const uint8_t TEXT_FIELDS[2] = {0x08, 0x10};   // Nome e comentário
+    for (uint8_t flag : TEXT_FIELDS) {
+        if (flags & flag) {
+            while (pos < length && data[pos] != 0) {
+                pos++;
+            }
+            pos++;
+        }
+    }
+    if (flags & 0x02) {
+        pos += 2;
+    }
+
+    bool final = false;
+    while (!final) {
+        final = bits(1);
+        uint32_t type = bits(2);
+        Huffman literals;
+        Huffman distances;
+        if (type == 0) {
+            if (!stored()) {
+                return false;
+            }
+            continue;
+        } else if (type == 1) {
+            uint8_t lengths[288 + 30];
+            for (uint32_t s = 0; s < 288; s++) {
+                lengths[s] = (uint8_t)fixedLength(s);
+            }
+            memset(lengths + 288, 5, 30);
+            literals.build(lengths, 288);
+            distances.build(lengths + 288, 30);
+        } else if (type != 2 || !dynamicTables(literals, distances)) {
+            return false;
+        }
+        if (bad || !block(literals, distances)) {
+            return false;
+        }
+    }
+    // Trailer alinhado ao byte: CRC-32 e tamanho
+    if (used > 0) {
+        pos++;
+        used = 0;
+    }
+    if (bad || pos + 8 != length) {
+        return false;
+    }
+    uint32_t crc = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((uint32_t)data[pos + 3] << 24);
+    uint32_t size = data[pos + 4] | (data[pos + 5] << 8) | (data[pos + 6] << 16) | ((uint32_t)data[pos + 7] << 24);
+    if (size != written || crc != crc32(out, written)) {
+        return false;
+    }
+    outLength = written;
+    return true;
+}
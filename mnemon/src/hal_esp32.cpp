@@ -0,0 +1,319 @@
+#include "hal.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <LiquidCrystal_I2C.h>
+#include <MPU6050.h>
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <driver/uart.h>
+#include <esp_partition.h>
+#include <esp_pm.h>
+#include <esp_random.h>
+#include <esp_sleep.h>
+#include <WiFi.h>
+#include <errno.h>
+#include <lwip/sockets.h>
+
+#include "config.h"
+#include "dht22.h"
+#include "rtos.h"
+
+// Inicialização dos componentes
+static LiquidCrystal_I2C lcd(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS); // Endereço I2C padrão, 16 colunas, 2 linhas
+static MPU6050 mpu;
+
+// LCD e MPU6050 compartilham o barramento I2C, acessado por tarefas diferentes
+static StaticMutex i2cMutex;
+
+// DHT22 pelo RMT: o periférico mede os níveis da linha com resolução de
+// 1 µs enquanto a tarefa espera no ring buffer do driver, com as interrupções
+// habilitadas (a biblioteca da Adafruit as desligava por ~5 ms a cada leitura,
+// atrasando o FIFO do MPU6050 e o ADC)
+static const rmt_channel_t DHT_RMT_CHANNEL = RMT_CHANNEL_4;
+static RingbufHandle_t dhtRingbuf = nullptr;
+
+// Log persistente na partição "spiffs" da tabela padrão (sem sistema de
+// arquivos montado nela)
+static const esp_partition_t* logPartition = nullptr;
+
+// Conexão do uplink, usada só pela tarefa do uplink
+static WiFiClient uplinkClient;
+
+// Light sleep automático: o FreeRTOS dorme quando nenhuma tarefa está
+// pronta e nenhuma trava de energia está tomada. O nível ativo segura
+// tierLock; a captura do DHT22 segura dhtLock (o RMT para no light sleep).
+// I2C e UART tomam as travas do próprio driver durante as transações.
+static esp_pm_lock_handle_t tierLock = nullptr;
+static esp_pm_lock_handle_t dhtLock = nullptr;
+static bool tierLockHeld = false;
+
+static bool dhtBegin() {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)DHT_PIN, DHT_RMT_CHANNEL);
+    config.clk_div = 80;                            // 1 tick = 1 µs (APB de 80 MHz)
+    config.mem_block_num = 1;                       // 128 níveis; o quadro tem ~86
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = 100;     // Glitches < 1,25 µs (ciclos do APB)
+    config.rx_config.idle_threshold = DHT22_IDLE_US;
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(DHT_RMT_CHANNEL, 512, 0) != ESP_OK) {
+        return false;
+    }
+    rmt_get_ringbuf_handle(DHT_RMT_CHANNEL, &dhtRingbuf);
+    
+    // Dreno aberto com pull-up: a mesma linha gera o pulso de início e
+    // segue roteada para a entrada do RMT
+    gpio_set_direction((gpio_num_t)DHT_PIN, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode((gpio_num_t)DHT_PIN, GPIO_PULLUP_ONLY);
+    gpio_set_level((gpio_num_t)DHT_PIN, 1);
+    return dhtRingbuf != nullptr;
+}
+
+void halInit() {
+    i2cMutex.begin();
+    
+    // Inicializar I2C
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+    
+    // Inicializar LCD
+    lcd.init();
+    lcd.backlight();
+    lcd.clear();
+    
+    // Inicializar sensores
+    dhtBegin();
+    mpu.initialize();
+    
+    // Verificar se o MPU6050 está funcionando
+    if (mpu.testConnection()) {
+        Serial.println("MPU6050 conectado com sucesso");
+    } else {
+        Serial.println("ERRO: MPU6050 não encontrado");
+    }
+    
+    // Configurar escala do MPU6050 para ±2g (0 = ±2g, 1 = ±4g, 2 = ±8g, 3 = ±16g)
+    mpu.setFullScaleAccelRange(0);
+    
+    // Configurar pinos dos atuadores
+    pinMode(BUZZER_PIN, OUTPUT);
+    pinMode(LED_R_PIN, OUTPUT);
+    pinMode(LED_G_PIN, OUTPUT);
+    pinMode(LED_B_PIN, OUTPUT);
+    
+    logPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                            ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+}
+
+uint32_t halMillis() {
+    return millis();
+}
+
+uint32_t halCycles() {
+    return ESP.getCycleCount();
+}
+
+uint32_t halCyclesPerMicro() {
+    return ESP.getCpuFreqMHz();
+}
+
+bool halDhtCapture(Dht22PulseTrain& train) {
+    if (dhtRingbuf == nullptr) {
+        return false;
+    }
+    
+    // Pulso de início com a tarefa dormindo; a captura começa antes de
+    // soltar a linha para não perder a resposta (20-40 µs depois)
+    if (dhtLock != nullptr) {
+        esp_pm_lock_acquire(dhtLock);
+    }
+    gpio_set_level((gpio_num_t)DHT_PIN, 0);
+    vTaskDelay(pdMS_TO_TICKS(DHT22_START_MS));
+    rmt_rx_start(DHT_RMT_CHANNEL, true);
+    gpio_set_level((gpio_num_t)DHT_PIN, 1);
+    
+    size_t size = 0;
+    rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(dhtRingbuf, &size,
+                                                            pdMS_TO_TICKS(DHT22_CAPTURE_TIMEOUT_MS));
+    rmt_rx_stop(DHT_RMT_CHANNEL);
+    if (dhtLock != nullptr) {
+        esp_pm_lock_release(dhtLock);
+    }
+    if (items == nullptr) {
+        return false;
+    }
+    // Cada item traz dois níveis; duração 0 marca o fim da captura
+    for (size_t i = 0; i < size / sizeof(rmt_item32_t); i++) {
+        if (items[i].duration0 == 0) break;
+        train.add(items[i].level0, items[i].duration0);
+        if (items[i].duration1 == 0) break;
+        train.add(items[i].level1, items[i].duration1);
+    }
+    vRingbufferReturnItem(dhtRingbuf, items);
+    return true;
+}
+
+int halReadLDR() {
+    return analogRead(LDR_PIN);
+}
+
+bool halAccelFifoBegin(uint16_t sampleRateHz) {
+    // Com o DLPF ativo a taxa base é 1 kHz: rate = 1000 / (1 + divisor), com
+    // divisor de 8 bits
+    if (sampleRateHz < MPU_MIN_RATE_HZ || sampleRateHz > MPU_MAX_RATE_HZ) {
+        return false;
+    }
+    ScopedLock lock(i2cMutex);
+    mpu.setDLPFMode(MPU6050_DLPF_BW_188);
+    mpu.setRate(MPU_MAX_RATE_HZ / sampleRateHz - 1);
+    
+    // Somente o acelerômetro entra no FIFO (6 bytes por amostra)
+    mpu.setAccelFIFOEnabled(true);
+    mpu.setFIFOEnabled(true);
+    mpu.resetFIFO();
+    return mpu.testConnection();
+}
+
+uint16_t halAccelFifoCount() {
+    ScopedLock lock(i2cMutex);
+    return mpu.getFIFOCount();
+}
+
+void halAccelFifoRead(uint8_t* data, uint8_t len) {
+    ScopedLock lock(i2cMutex);
+    mpu.getFIFOBytes(data, len);
+}
+
+bool halAccelFifoOverflowed() {
+    ScopedLock lock(i2cMutex);
+    return mpu.getIntFIFOBufferOverflowStatus();
+}
+
+void halAccelFifoReset() {
+    ScopedLock lock(i2cMutex);
+    mpu.resetFIFO();
+}
+
+void halSetRGB(bool red, bool green, bool blue) {
+    digitalWrite(LED_R_PIN, red ? HIGH : LOW);
+    digitalWrite(LED_G_PIN, green ? HIGH : LOW);
+    digitalWrite(LED_B_PIN, blue ? HIGH : LOW);
+}
+
+void halSetBuzzer(bool on) {
+    digitalWrite(BUZZER_PIN, on ? HIGH : LOW);
+}
+
+void halLcdClear() {
+    ScopedLock lock(i2cMutex);
+    lcd.clear();
+}
+
+void halLcdPrint(uint8_t col, uint8_t row, const char* text) {
+    ScopedLock lock(i2cMutex);
+    lcd.setCursor(col, row);
+    lcd.print(text);
+}
+
+void halSerialWrite(const char* data, size_t len) {
+    Serial.write((const uint8_t*)data, len);
+}
+
+bool halPowerBegin() {
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    // Frequência fixa: os contadores de ciclos (metrics.h) seguem em ciclos
+    // de 240 MHz
+    esp_pm_config_esp32_t config = {};
+    config.max_freq_mhz = 240;
+    config.min_freq_mhz = 240;
+    config.light_sleep_enable = true;
+    if (esp_pm_configure(&config) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "tier", &tierLock) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "dht22", &dhtLock) != ESP_OK) {
+        return false;
+    }
+    // Começa no nível ativo, sem light sleep
+    esp_pm_lock_acquire(tierLock);
+    tierLockHeld = true;
+    
+    // Comandos seriais acordam o chip (o primeiro caractere se perde)
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void halPowerSetMode(bool lightSleep, bool modemSleep) {
+    if (tierLock != nullptr && lightSleep == tierLockHeld) {
+        if (lightSleep) {
+            esp_pm_lock_release(tierLock);
+        } else {
+            esp_pm_lock_acquire(tierLock);
+        }
+        tierLockHeld = !lightSleep;
+    }
+    // Em modem sleep o rádio acorda a cada beacon (DTIM): a associação e o
+    // servidor HTTP seguem de pé, com até ~100 ms a mais de latência
+    WiFi.setSleep(modemSleep ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE);
+}
+
+uint32_t halFlashSize() {
+    return logPartition != nullptr ? logPartition->size : 0;
+}
+
+bool halFlashRead(uint32_t offset, void* data, size_t len) {
+    return esp_partition_read(logPartition, offset, data, len) == ESP_OK;
+}
+
+bool halFlashWrite(uint32_t offset, const void* data, size_t len) {
+    return esp_partition_write(logPartition, offset, data, len) == ESP_OK;
+}
+
+// Apagar suspende o cache de flash por ~45 ms nos dois núcleos; o FIFO do
+// MPU6050 (~170 ms a 1 kHz) absorve a pausa da tarefa rápida
+bool halFlashEraseSector(uint32_t offset) {
+    return esp_partition_erase_range(logPartition, offset, FLASH_SECTOR_SIZE) == ESP_OK;
+}
+
+bool halUplinkConnect(const char* host, uint16_t port, uint32_t timeoutMs) {
+    uplinkClient.stop();
+    if (WiFi.status() != WL_CONNECTED || !uplinkClient.connect(host, port, (int32_t)timeoutMs)) {
+        return false;
+    }
+    uplinkClient.setNoDelay(true);
+    return true;
+}
+
+// write() do WiFiClient espera o socket aceitar tudo (até o timeout do
+// cliente); send com MSG_DONTWAIT aceita só o que cabe no buffer de envio
+// do lwIP e o resto sai no próximo step()
+int halUplinkWrite(const uint8_t* data, size_t len) {
+    if (!uplinkClient.connected()) {
+        return -1;
+    }
+    int n = send(uplinkClient.fd(), data, len, MSG_DONTWAIT);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+    return n;
+}
+
+int halUplinkRead(uint8_t* data, size_t len) {
+    if (!uplinkClient.connected()) {
+        return -1;
+    }
+    int available = uplinkClient.available();
+    if (available <= 0) {
+        return 0;
+    }
+    int n = uplinkClient.read(data, len < (size_t)available ? len : (size_t)available);
+    return n < 0 ? 0 : n;
+}
+
+void halUplinkClose() {
+    uplinkClient.stop();
+}
+
+uint32_t halRandom() {
+    return esp_random();
+}
@@ -0,0 +1,322 @@
+#include "history.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "json_writer.h"
+
+static_assert(HistoryStore::footprint() <= HISTORY_MEMORY_BUDGET,
+              "histórico excede HISTORY_MEMORY_BUDGET");
+
+enum : uint8_t {
+    STAGE_HEADER,
+    STAGE_ITEMS,
+    STAGE_OPEN,
+    STAGE_FOOTER,
+    STAGE_DONE
+};
+
+static HistoryStore store;
+
+HistoryStore& history() {
+    return store;
+}
+
+bool findHistoryMetric(const char* name, HistoryMetric& metric) {
+    for (size_t i = 0; i < HISTORY_METRIC_COUNT; i++) {
+        if (strcmp(name, HISTORY_METRICS[i].name) == 0) {
+            metric = (HistoryMetric)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool findHistoryResolution(const char* name, uint8_t& resolution) {
+    if (strcmp(name, "raw") == 0) {
+        resolution = HISTORY_RAW;
+        return true;
+    }
+    for (uint32_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+        if (strcmp(name, HISTORY_TIERS[i].name) == 0) {
+            resolution = i + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* historyResolutionName(uint8_t resolution) {
+    return resolution == HISTORY_RAW ? "raw" : HISTORY_TIERS[resolution - 1].name;
+}
+
+HistoryStore::HistoryStore() {
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+        tierOffset[i] = offset;
+        offset += HISTORY_TIERS[i].capacity;
+    }
+    reset();
+}
+
+void HistoryStore::begin() {
+    mutex.begin();
+}
+
+void HistoryStore::clear() {
+    ScopedLock lock(mutex);
+    reset();
+}
+
+void HistoryStore::reset() {
+    for (uint32_t i = 0; i <= HISTORY_TIER_COUNT; i++) {
+        total[i] = 0;
+    }
+    for (uint32_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+        currentActive[i] = false;
+    }
+}
+
+void HistoryStore::values(const Snapshot& snapshot, float values[HISTORY_METRIC_COUNT]) {
+    values[(size_t)HistoryMetric::Temperature] = snapshot.temperature;
+    values[(size_t)HistoryMetric::Humidity] = snapshot.humidity;
+    values[(size_t)HistoryMetric::Lux] = snapshot.lux;
+    values[(size_t)HistoryMetric::VibrationRms] = snapshot.vibration.rmsTotal;
+    values[(size_t)HistoryMetric::VibrationPeak] = snapshot.vibration.peakMagnitude;
+}
+
+void HistoryStore::record(uint32_t timestampMs, const float values[HISTORY_METRIC_COUNT]) {
+    ScopedLock lock(mutex);
+    
+    RawPoint& point = raw[total[HISTORY_RAW] % HISTORY_RAW_CAPACITY];
+    point.timestampMs = timestampMs;
+    memcpy(point.values, values, sizeof(point.values));
+    total[HISTORY_RAW]++;
+    
+    for (uint32_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+        const HistoryTier& tier = HISTORY_TIERS[i];
+        uint32_t start = timestampMs - timestampMs % tier.periodMs;
+        Bucket& bucket = current[i];
+        
+        // Virada de período: fecha o agregado no ring do tier
+        if (currentActive[i] && bucket.startMs != start) {
+            finishBucket(bucket);
+            buckets[tierOffset[i] + total[i + 1] % tier.capacity] = bucket;
+            total[i + 1]++;
+            currentActive[i] = false;
+        }
+        if (!currentActive[i]) {
+            bucket.startMs = start;
+            for (size_t m = 0; m < HISTORY_METRIC_COUNT; m++) {
+                bucket.count[m] = 0;
+                bucket.min[m] = INFINITY;
+                bucket.max[m] = -INFINITY;
+                bucket.mean[m] = 0;
+            }
+            currentActive[i] = true;
+        }
+        
+        for (size_t m = 0; m < HISTORY_METRIC_COUNT; m++) {
+            float v = values[m];
+            if (isnan(v) || bucket.count[m] == UINT16_MAX) {
+                continue; // Leitura inválida do sensor não entra no agregado
+            }
+            bucket.count[m]++;
+            if (v < bucket.min[m]) bucket.min[m] = v;
+            if (v > bucket.max[m]) bucket.max[m] = v;
+            bucket.mean[m] += v;
+        }
+    }
+}
+
+// Converte a soma em média; métricas sem leitura ficam NaN (null no JSON)
+void HistoryStore::finishBucket(Bucket& bucket) {
+    for (size_t m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        if (bucket.count[m] == 0) {
+            bucket.min[m] = bucket.max[m] = bucket.mean[m] = NAN;
+        } else {
+            bucket.mean[m] /= bucket.count[m];
+        }
+    }
+}
+
+uint32_t HistoryStore::size(uint8_t resolution) const {
+    uint32_t capacity = resolution == HISTORY_RAW ? HISTORY_RAW_CAPACITY
+                                                  : HISTORY_TIERS[resolution - 1].capacity;
+    return total[resolution] < capacity ? total[resolution] : capacity;
+}
+
+uint32_t HistoryStore::oldest(uint8_t resolution) const {
+    return total[resolution] - size(resolution);
+}
+
+const HistoryStore::Bucket& HistoryStore::bucketAt(uint8_t tier, uint32_t seq) const {
+    return buckets[tierOffset[tier] + seq % HISTORY_TIERS[tier].capacity];
+}
+
+// Pontos brutos valem no instante; agregados cobrem [início, início + período)
+bool HistoryStore::endsBefore(uint8_t resolution, uint32_t seq, uint32_t fromMs) const {
+    if (resolution == HISTORY_RAW) {
+        return raw[seq % HISTORY_RAW_CAPACITY].timestampMs < fromMs;
+    }
+    const HistoryTier& tier = HISTORY_TIERS[resolution - 1];
+    return bucketAt(resolution - 1, seq).startMs + tier.periodMs <= fromMs;
+}
+
+static size_t formatBucket(char* out, size_t capacity, uint32_t startMs, uint16_t count,
+                           float min, float max, float mean, uint8_t decimals, bool partial) {
+    JsonWriter json(out, capacity);
+    json.beginObject();
+    json.field("t", (unsigned long)startMs);
+    json.field("min", min, decimals);
+    json.field("max", max, decimals);
+    json.field("mean", mean, decimals);
+    json.field("n", (unsigned long)count);
+    if (partial) {
+        json.field("partial", true);
+    }
+    json.endObject();
+    return json.overflowed() ? 0 : json.length();
+}
+
+void HistoryStore::open(const HistoryQuery& query, uint32_t nowMs, HistoryCursor& cursor) const {
+    cursor.query = query;
+    cursor.nowMs = nowMs;
+    cursor.next = 0;
+    cursor.stage = STAGE_HEADER;
+    cursor.firstItem = true;
+    cursor.pendingLength = 0;
+    cursor.pendingOffset = 0;
+}
+
+bool HistoryStore::nextItem(HistoryCursor& cursor) const {
+    ScopedLock lock(mutex);
+    uint8_t r = cursor.query.resolution;
+    
+    // Itens sobrescritos durante a leitura são pulados
+    if (cursor.next < oldest(r)) {
+        cursor.next = oldest(r);
+    }
+    while (cursor.next < total[r] && endsBefore(r, cursor.next, cursor.query.fromMs)) {
+        cursor.next++;
+    }
+    if (cursor.next >= total[r]) {
+        return false;
+    }
+    
+    size_t m = (size_t)cursor.query.metric;
+    uint8_t decimals = HISTORY_METRICS[m].decimals;
+    char* out = cursor.pending;
+    size_t capacity = sizeof(cursor.pending);
+    if (!cursor.firstItem) {
+        *out++ = ',';
+        capacity--;
+    }
+    
+    size_t length;
+    if (r == HISTORY_RAW) {
+        const RawPoint& point = raw[cursor.next % HISTORY_RAW_CAPACITY];
+        JsonWriter json(out, capacity);
+        json.beginObject();
+        json.field("t", (unsigned long)point.timestampMs);
+        json.field("v", point.values[m], decimals);
+        json.endObject();
+        length = json.overflowed() ? 0 : json.length();
+    } else {
+        const Bucket& b = bucketAt(r - 1, cursor.next);
+        length = formatBucket(out, capacity, b.startMs, b.count[m], b.min[m], b.max[m],
+                              b.mean[m], decimals, false);
+    }
+    cursor.next++;
+    cursor.pendingLength = length > 0 ? (out - cursor.pending) + length : 0;
+    cursor.firstItem = cursor.firstItem && length == 0;
+    return true;
+}
+
+// Agregado ainda aberto do tier, marcado como parcial
+bool HistoryStore::openItem(HistoryCursor& cursor) const {
+    uint8_t tier = cursor.query.resolution - 1;
+    size_t m = (size_t)cursor.query.metric;
+    Bucket bucket;
+    {
+        ScopedLock lock(mutex);
+        if (!currentActive[tier]) {
+            return false;
+        }
+        bucket = current[tier];
+    }
+    if (bucket.startMs + HISTORY_TIERS[tier].periodMs <= cursor.query.fromMs) {
+        return false;
+    }
+    finishBucket(bucket);
+    
+    char* out = cursor.pending;
+    size_t capacity = sizeof(cursor.pending);
+    if (!cursor.firstItem) {
+        *out++ = ',';
+        capacity--;
+    }
+    size_t length = formatBucket(out, capacity, bucket.startMs, bucket.count[m], bucket.min[m],
+                                 bucket.max[m], bucket.mean[m], HISTORY_METRICS[m].decimals, true);
+    cursor.pendingLength = length > 0 ? (out - cursor.pending) + length : 0;
+    return length > 0;
+}
+
+// Prepara o próximo trecho da resposta em cursor.pending
+bool HistoryStore::fill(HistoryCursor& cursor) const {
+    cursor.pendingOffset = 0;
+    cursor.pendingLength = 0;
+    uint8_t r = cursor.query.resolution;
+    
+    switch (cursor.stage) {
+        case STAGE_HEADER: {
+            JsonWriter json(cursor.pending, sizeof(cursor.pending));
+            json.beginObject();
+            json.field("sensor", HISTORY_METRICS[(size_t)cursor.query.metric].name);
+            json.field("resolution", historyResolutionName(r));
+            json.field("period_ms", (unsigned long)(r == HISTORY_RAW ? 0 : HISTORY_TIERS[r - 1].periodMs));
+            json.field("now_ms", (unsigned long)cursor.nowMs);
+            json.field("from_ms", (unsigned long)cursor.query.fromMs);
+            json.key("points");
+            json.beginArray();
+            cursor.pendingLength = json.overflowed() ? 0 : json.length();
+            cursor.stage = STAGE_ITEMS;
+            return true;
+        }
+        case STAGE_ITEMS:
+            if (nextItem(cursor)) {
+                return true;
+            }
+            cursor.stage = r == HISTORY_RAW ? STAGE_FOOTER : STAGE_OPEN;
+            return fill(cursor);
+        case STAGE_OPEN:
+            cursor.stage = STAGE_FOOTER;
+            return openItem(cursor) || fill(cursor);
+        case STAGE_FOOTER:
+            cursor.pending[0] = ']';
+            cursor.pending[1] = '}';
+            cursor.pendingLength = 2;
+            cursor.stage = STAGE_DONE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t HistoryStore::readChunk(HistoryCursor& cursor, char* buffer, size_t capacity) const {
+    size_t written = 0;
+    while (written < capacity) {
+        if (cursor.pendingOffset < cursor.pendingLength) {
+            size_t n = cursor.pendingLength - cursor.pendingOffset;
+            if (n > capacity - written) n = capacity - written;
+            memcpy(buffer + written, cursor.pending + cursor.pendingOffset, n);
+            cursor.pendingOffset += n;
+            written += n;
+            continue;
+        }
+        if (!fill(cursor)) {
+            break;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,183 @@
+#include "http_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "gzip.h"
+#include "json_writer.h"
+#include "system_state.h"
+#include "telemetry.h"
+
+// Um só compressor: as regenerações rodam todas na mesma tarefa
+static GzipEncoder encoder;
+
+void ResponseCache::refresh(uint64_t newKey, const void* context) {
+    if (keyed && newKey == key && rendered) {
+        return;
+    }
+    uint8_t target = active ^ 1;
+    Slot& slot = slots[target];
+    size_t length = render((char*)slot.body, sizeof(slot.body), context);
+    counters.renders++;
+    if (length == 0) {
+        return;
+    }
+    key = newKey;
+    keyed = true;
+
+    // Conteúdo igual ao publicado: mantém o slot e o ETag
+    uint32_t crc = crc32(slot.body, length);
+    const Slot& current = slots[active];
+    if (rendered && crc == current.crc && length == current.length) {
+        return;
+    }
+
+    slot.length = length;
+    slot.crc = crc;
+    snprintf(slot.etag, sizeof(slot.etag), "\"%08lx\"", (unsigned long)crc);
+    snprintf(slot.gzipEtag, sizeof(slot.gzipEtag), "\"%08lx-gz\"", (unsigned long)crc);
+    slot.gzipLength = 0;
+    if (length >= HTTP_GZIP_MIN_BYTES) {
+        size_t gzipLength = encoder.encode(slot.body, length, slot.gzip, sizeof(slot.gzip));
+        if (gzipLength > 0 && gzipLength < length) {
+            slot.gzipLength = gzipLength;
+        }
+    }
+    active = target;
+    rendered = true;
+}
+
+bool ResponseCache::select(const char* ifNoneMatch, const char* acceptEncoding, CachedResponse& out) {
+    if (!rendered) {
+        return false;
+    }
+    const Slot& slot = slots[active];
+    counters.requests++;
+    out.gzip = slot.gzipLength > 0 && acceptsGzip(acceptEncoding);
+    out.etag = out.gzip ? slot.gzipEtag : slot.etag;
+
+    // Qualquer das duas representações vale: o conteúdo é o mesmo
+    if (ifNoneMatch != NULL && (etagMatches(ifNoneMatch, slot.etag) || etagMatches(ifNoneMatch, slot.gzipEtag))) {
+        out.status = 304;
+        out.body = NULL;
+        out.length = 0;
+        counters.notModified++;
+        return true;
+    }
+    out.status = 200;
+    out.body = out.gzip ? slot.gzip : slot.body;
+    out.length = out.gzip ? slot.gzipLength : slot.length;
+    counters.gzipped += out.gzip;
+    counters.bodyBytes += out.length;
+    return true;
+}
+
+// If-None-Match: "*" ou lista de ETags separados por vírgula, fortes ou
+// fracos (W/"..."); a comparação fraca basta para GET
+bool etagMatches(const char* list, const char* etag) {
+    size_t etagLength = strlen(etag);
+    const char* p = list;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        if (*p == '*') {
+            return true;
+        }
+        if (p[0] == 'W' && p[1] == '/') {
+            p += 2;
+        }
+        const char* end = p;
+        while (*end != '\0' && *end != ',') {
+            end++;
+        }
+        const char* last = end;
+        while (last > p && (last[-1] == ' ' || last[-1] == '\t')) {
+            last--;
+        }
+        if ((size_t)(last - p) == etagLength && memcmp(p, etag, etagLength) == 0) {
+            return true;
+        }
+        p = end;
+    }
+    return false;
+}
+
+bool acceptsGzip(const char* header) {
+    if (header == NULL) {
+        return false;
+    }
+    for (const char* p = strstr(header, "gzip"); p != NULL; p = strstr(p + 4, "gzip")) {
+        // Token inteiro: "x-gzip" ou "gzipx" não contam
+        bool start = p == header || p[-1] == ' ' || p[-1] == ',' || p[-1] == '\t';
+        const char* q = p + 4;
+        while (*q == ' ') {
+            q++;
+        }
+        if (!start || (*q != '\0' && *q != ',' && *q != ';')) {
+            continue;
+        }
+        if (*q != ';') {
+            return true;
+        }
+        // gzip;q=0, q=0.0, q=0.000 recusam
+        q++;
+        while (*q == ' ') {
+            q++;
+        }
+        if (q[0] != 'q' || q[1] != '=') {
+            return true;
+        }
+        q += 2;
+        if (*q != '0') {
+            return true;
+        }
+        q++;
+        if (*q == '.') {
+            q++;
+            while (*q == '0') {
+                q++;
+            }
+        }
+        return *q >= '1' && *q <= '9';
+    }
+    return false;
+}
+
+static size_t renderStatus(char* buffer, size_t capacity, const void* wifiIp) {
+    JsonWriter json(buffer, capacity);
+    writeStatus(json, (const char*)wifiIp);
+    return json.overflowed() ? 0 : json.length();
+}
+
+static size_t renderTelemetry(char* buffer, size_t capacity, const void*) {
+    uint32_t sequence;
+    return copyTelemetry(buffer, capacity, sequence);
+}
+
+static ResponseCache statusCache(renderStatus);
+static ResponseCache telemetryCache(renderTelemetry);
+
+bool serveStatus(const char* wifiIp, const char* ifNoneMatch, const char* acceptEncoding,
+                 CachedResponse& out) {
+    // Um registro de telemetria por ciclo de saída (e por transição de
+    // alerta); overrides e cenário mudam pela API fora do ciclo
+    uint64_t key = ((uint64_t)telemetrySequence() << 32) |
+                   ((uint64_t)(sensorOverrides.version() & 0xFFFFFF) << 8) | (uint8_t)currentScenario;
+    statusCache.refresh(key, wifiIp);
+    return statusCache.select(ifNoneMatch, acceptEncoding, out);
+}
+
+bool serveTelemetry(const char* ifNoneMatch, const char* acceptEncoding, CachedResponse& out) {
+    telemetryCache.refresh(telemetrySequence(), NULL);
+    return telemetryCache.select(ifNoneMatch, acceptEncoding, out);
+}
+
+ResponseCacheStats statusCacheStats() {
+    return statusCache.stats();
+}
+
+ResponseCacheStats telemetryCacheStats() {
+    return telemetryCache.stats();
+}
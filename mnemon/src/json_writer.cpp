@@ -0,0 +1,192 @@
+#include "json_writer.h"
+
+#include <math.h>
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+    : buf(buffer), cap(capacity), len(0), overflow(false),
+      hasItems(0), depth(0), afterKey(false) {
+    if (cap > 0) buf[0] = '\0';
+}
+
+void JsonWriter::put(char c) {
+    if (len + 1 < cap) {
+        buf[len++] = c;
+        buf[len] = '\0';
+    } else {
+        overflow = true;
+    }
+}
+
+void JsonWriter::put(const char* text) {
+    while (*text) put(*text++);
+}
+
+void JsonWriter::putUnsigned(uint64_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) put(digits[--n]);
+}
+
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    uint32_t bit = 1u << depth;
+    if (hasItems & bit) put(',');
+    hasItems |= bit;
+}
+
+void JsonWriter::beginObject() {
+    separator();
+    put('{');
+    depth++;
+    hasItems &= ~(1u << depth);
+}
+
+void JsonWriter::endObject() {
+    depth--;
+    put('}');
+}
+
+void JsonWriter::beginArray() {
+    separator();
+    put('[');
+    depth++;
+    hasItems &= ~(1u << depth);
+}
+
+void JsonWriter::endArray() {
+    depth--;
+    put(']');
+}
+
+void JsonWriter::key(const char* name) {
+    separator();
+    putQuoted(name);
+    put(':');
+    afterKey = true;
+}
+
+void JsonWriter::string(const char* value) {
+    separator();
+    putQuoted(value);
+}
+
+void JsonWriter::putQuoted(const char* value) {
+    put('"');
+    for (const char* p = value; *p; p++) {
+        char c = *p;
+        switch (c) {
+            case '"': put("\\\""); break;
+            case '\\': put("\\\\"); break;
+            case '\n': put("\\n"); break;
+            case '\r': put("\\r"); break;
+            case '\t': put("\\t"); break;
+            default:
+                if ((unsigned char)c >= 0x20) put(c);
+                break;
+        }
+    }
+    put('"');
+}
+
+void JsonWriter::integer(long value) {
+    separator();
+    if (value < 0) {
+        put('-');
+        putUnsigned((uint64_t)(-(int64_t)value));
+    } else {
+        putUnsigned(value);
+    }
+}
+
+void JsonWriter::unsignedInteger(unsigned long value) {
+    separator();
+    putUnsigned(value);
+}
+
+void JsonWriter::boolean(bool value) {
+    separator();
+    put(value ? "true" : "false");
+}
+
+void JsonWriter::fixed(float value, uint8_t decimals) {
+    static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    separator();
+    
+    if (isnan(value) || isinf(value)) {
+        put("null");
+        return;
+    }
+    if (decimals > 6) decimals = 6;
+    
+    // Produto em float, como em round(temp * 10) no código original
+    float product = value * POW10[decimals];
+    double scaled = round((double)product);
+    if (scaled == 0) {
+        put('0'); // Inclui -0, que o ArduinoJson também escreve como 0
+        return;
+    }
+    if (scaled < 0) {
+        put('-');
+        scaled = -scaled;
+    }
+    
+    double magnitude = scaled / POW10[decimals];
+    if (magnitude >= 1e7) {
+        // Notação exponencial como no ArduinoJson: mantissa em [1, 10) com
+        // até 9 dígitos significativos
+        int exponent = (int)floor(log10(magnitude));
+        double mantissa = magnitude / pow(10.0, exponent);
+        uint64_t digits = (uint64_t)round(mantissa * 1e8);
+        if (digits >= 1000000000ULL) {
+            digits /= 10;
+            exponent++;
+        }
+        putUnsigned(digits / 100000000ULL);
+        uint32_t fraction = digits % 100000000ULL;
+        if (fraction > 0) {
+            int width = 8;
+            while (fraction % 10 == 0) {
+                fraction /= 10;
+                width--;
+            }
+            put('.');
+            char text[8];
+            for (int i = width - 1; i >= 0; i--) {
+                text[i] = '0' + fraction % 10;
+                fraction /= 10;
+            }
+            for (int i = 0; i < width; i++) put(text[i]);
+        }
+        put('e');
+        putUnsigned(exponent);
+        return;
+    }
+    
+    uint64_t units = (uint64_t)scaled;
+    putUnsigned(units / POW10[decimals]);
+    uint32_t fraction = units % POW10[decimals];
+    if (fraction == 0) {
+        return;
+    }
+    
+    // Parte fracionária com zeros à esquerda preservados e à direita removidos
+    int width = decimals;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        width--;
+    }
+    char text[6];
+    for (int i = width - 1; i >= 0; i--) {
+        text[i] = '0' + fraction % 10;
+        fraction /= 10;
+    }
+    put('.');
+    for (int i = 0; i < width; i++) put(text[i]);
+}
@@ -0,0 +1,241 @@
+#include "live.h"
+
+#include "json_writer.h"
+#include "sensors.h"
+
+static LiveClient liveClients[LIVE_MAX_CLIENTS];
+static LiveHub hub(liveClients, LIVE_MAX_CLIENTS);
+
+LiveHub& liveHub() {
+    return hub;
+}
+
+LiveHub::LiveHub(LiveClient* clients, size_t capacity)
+    : clients(clients), capacity(capacity) {
+    for (size_t i = 0; i < capacity; i++) {
+        clients[i].active = false;
+    }
+}
+
+void LiveHub::begin() {
+    mutex.begin();
+}
+
+void LiveHub::setTransport(const LiveTransport& newTransport) {
+    ScopedLock lock(mutex);
+    transport = newTransport;
+}
+
+uint32_t LiveHub::clampInterval(uint32_t intervalMs) {
+    if (intervalMs == 0) return LIVE_DEFAULT_INTERVAL_MS;
+    return intervalMs < LIVE_MIN_INTERVAL_MS ? LIVE_MIN_INTERVAL_MS : intervalMs;
+}
+
+bool LiveHub::addClient(uint32_t id, uint32_t intervalMs, uint32_t nowMs) {
+    ScopedLock lock(mutex);
+    for (size_t i = 0; i < capacity; i++) {
+        LiveClient& client = clients[i];
+        if (client.active) {
+            continue;
+        }
+        client.id = id;
+        client.intervalMs = clampInterval(intervalMs);
+        client.lastSendMs = nowMs - client.intervalMs; // Primeira leitura sem espera
+        client.blockedSinceMs = 0;
+        client.sampleSeq = latestSeq > 0 ? latestSeq - 1 : 0;
+        client.alertSeq = latestAlertSeq;  // Só transições futuras
+        client.sent = 0;
+        client.coalesced = 0;
+        client.active = true;
+        activeClients.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    counters.rejected++;
+    return false;
+}
+
+void LiveHub::removeClient(uint32_t id) {
+    ScopedLock lock(mutex);
+    for (size_t i = 0; i < capacity; i++) {
+        if (clients[i].active && clients[i].id == id) {
+            clients[i].active = false;
+            activeClients.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void LiveHub::setInterval(uint32_t id, uint32_t intervalMs) {
+    ScopedLock lock(mutex);
+    for (size_t i = 0; i < capacity; i++) {
+        if (clients[i].active && clients[i].id == id) {
+            clients[i].intervalMs = clampInterval(intervalMs);
+        }
+    }
+}
+
+void LiveHub::publish(const LiveSample& sample) {
+    ScopedLock lock(mutex);
+    latest = sample;
+    latestSeq++;
+    counters.samples++;
+}
+
+void LiveHub::publishAlert(AlertLevel from, AlertLevel to, uint32_t timestampMs) {
+    ScopedLock lock(mutex);
+    alertFrom = from;
+    alertTo = to;
+    alertMs = timestampMs;
+    latestAlertSeq++;
+    counters.alerts++;
+}
+
+void LiveHub::encodeSample(const LiveSample& sample, uint32_t seq) {
+    JsonWriter json(sampleMessage, sizeof(sampleMessage));
+    json.beginObject();
+    json.field("type", "sample");
+    json.field("seq", (unsigned long)seq);
+    json.field("t", (unsigned long)sample.timestampMs);
+    json.field("temperature", sample.temperature, 1);
+    json.field("humidity", sample.humidity, 1);
+    json.field("lux", calculateLux(sample.ldrRaw), 0);
+    json.key("accel");
+    json.beginArray();
+    json.fixed(sample.accelX, 2);
+    json.fixed(sample.accelY, 2);
+    json.fixed(sample.accelZ, 2);
+    json.endArray();
+    json.field("vib_rms", sample.vibrationRms, 3);
+    json.field("vib_peak", sample.peakMagnitude, 2);
+    json.field("alert_level", alertLevelName(sample.alertLevel));
+    json.endObject();
+    sampleLength = json.overflowed() ? 0 : json.length();
+    encodedSampleSeq = seq;
+}
+
+void LiveHub::encodeAlert(AlertLevel from, AlertLevel to, uint32_t timestampMs, uint32_t seq) {
+    JsonWriter json(alertMessage, sizeof(alertMessage));
+    json.beginObject();
+    json.field("type", "alert");
+    json.field("seq", (unsigned long)seq);
+    json.field("t", (unsigned long)timestampMs);
+    json.field("from", alertLevelName(from));
+    json.field("to", alertLevelName(to));
+    json.endObject();
+    alertLength = json.overflowed() ? 0 : json.length();
+    encodedAlertSeq = seq;
+}
+
+// Copia o estado publicado e o de cada cliente sob o mutex e chama o
+// transporte (E/S do AsyncWebSocket) com ele livre, para que publish() e
+// stats() nunca esperem pelo envio. Um cliente removido durante o envio é
+// reconhecido pelo id ao atualizar
+uint32_t LiveHub::pump(uint32_t nowMs) {
+    LiveTransport out;
+    LiveSample sample;
+    uint32_t sampleSeq;
+    AlertLevel from;
+    AlertLevel to;
+    uint32_t alertAtMs;
+    uint32_t alertSeq;
+    {
+        ScopedLock lock(mutex);
+        if (activeClients.load(std::memory_order_relaxed) == 0 || transport.send == nullptr) {
+            return 0;
+        }
+        out = transport;
+        sample = latest;
+        sampleSeq = latestSeq;
+        from = alertFrom;
+        to = alertTo;
+        alertAtMs = alertMs;
+        alertSeq = latestAlertSeq;
+    }
+    
+    // Codificar uma vez por publicação, não por cliente
+    if (sampleSeq != encodedSampleSeq) {
+        encodeSample(sample, sampleSeq);
+    }
+    if (alertSeq != encodedAlertSeq) {
+        encodeAlert(from, to, alertAtMs, alertSeq);
+    }
+    
+    uint32_t delivered = 0;
+    for (size_t i = 0; i < capacity; i++) {
+        uint32_t id;
+        bool alertDue;
+        bool sampleDue;
+        {
+            ScopedLock lock(mutex);
+            const LiveClient& client = clients[i];
+            if (!client.active) {
+                continue;
+            }
+            id = client.id;
+            alertDue = client.alertSeq != alertSeq && alertLength > 0;
+            sampleDue = client.sampleSeq != sampleSeq && sampleLength > 0 &&
+                        nowMs - client.lastSendMs >= client.intervalMs;
+        }
+        if (!alertDue && !sampleDue) {
+            continue;
+        }
+        
+        // Transição primeiro; a leitura vai no próximo pump se a fila encher
+        bool ready = out.ready(id, out.context);
+        bool alertSent = false;
+        bool sampleSent = false;
+        if (ready && alertDue) {
+            alertSent = out.send(id, alertMessage, alertLength, out.context);
+        }
+        if (ready && sampleDue && (!alertDue || (alertSent && out.ready(id, out.context)))) {
+            sampleSent = out.send(id, sampleMessage, sampleLength, out.context);
+        }
+        
+        bool evict = false;
+        {
+            ScopedLock lock(mutex);
+            LiveClient& client = clients[i];
+            if (!client.active || client.id != id) {
+                continue;
+            }
+            if (!ready) {
+                if (sampleDue) {
+                    client.coalesced++; // Vai a leitura mais recente quando houver espaço
+                    counters.coalesced++;
+                }
+                if (client.blockedSinceMs == 0) {
+                    client.blockedSinceMs = nowMs | 1;
+                } else if (nowMs - client.blockedSinceMs >= LIVE_STALL_MS) {
+                    client.active = false;
+                    activeClients.fetch_sub(1, std::memory_order_relaxed);
+                    counters.evicted++;
+                    evict = true;
+                }
+            } else {
+                client.blockedSinceMs = 0;
+            }
+            if (alertSent) {
+                client.alertSeq = alertSeq;
+                client.sent++;
+                delivered++;
+            }
+            if (sampleSent) {
+                client.sampleSeq = sampleSeq;
+                client.lastSendMs = nowMs;
+                client.sent++;
+                delivered++;
+            }
+            counters.messages += alertSent + sampleSent;
+        }
+        if (evict) {
+            out.close(id, out.context);
+        }
+    }
+    return delivered;
+}
+
+LiveStats LiveHub::stats() const {
+    ScopedLock lock(mutex);
+    LiveStats copy = counters;
+    copy.clients = activeClients.load(std::memory_order_relaxed);
+    return copy;
+}
@@ -1,74 +1,57 @@
 #include <Arduino.h>
-#include <Wire.h>
-#include <LiquidCrystal_I2C.h>
-#include <DHT.h>
 #include <ArduinoJson.h>
-#include <MPU6050.h>
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 
-// Definições dos pinos
-#define DHT_PIN 23
-#define DHT_TYPE DHT22
-#define LDR_PIN 34
-#define BUZZER_PIN 32
-#define LED_R_PIN 25
-#define LED_G_PIN 26
-#define LED_B_PIN 27
-
-// Inicialização dos componentes
-DHT dht(DHT_PIN, DHT_TYPE);
-LiquidCrystal_I2C lcd(0x27, 16, 2); // Endereço I2C padrão, 16 colunas, 2 linhas
-MPU6050 mpu;
+#include "alerts.h"
+#include "anomaly.h"
+#include "config.h"
+#include "display.h"
+#include "flash_log.h"
+#include "hal.h"
+#include "history.h"
+#include "http_cache.h"
+#include "json_writer.h"
+#include "live.h"
+#include "metrics.h"
+#include "pipeline.h"
+#include "power.h"
+#include "sensors.h"
+#include "system_state.h"
+#include "telemetry.h"
+#include "timeline.h"
+#include "uplink.h"
 
 // Configuração WiFi (para Wokwi)
 const char* ssid = "Wokwi-GUEST";
 const char* password = "";
+const uint32_t WIFI_TIMEOUT_MS = 10000;
 
 // Servidor web
 AsyncWebServer server(80);
 
-// Variáveis globais
-String currentScenario = "api_control";
-String alertLevel = "normal";
-unsigned long lastUpdate = 0;
-unsigned long scenarioStartTime = 0;
-int testStep = 0;
-
-// Controles manuais dos sensores via API
-struct SensorOverrides {
-    bool dht22_override = false;
-    float temperature_override = 25.0;
-    float humidity_override = 60.0;
-    
-    bool ldr_override = false;
-    int ldr_raw_override = 500;
-    
-    bool mpu6050_override = false;
-    float accel_x_override = 0.0;
-    float accel_y_override = 0.0;
-    float accel_z_override = 1.0;
-} sensorOverrides;
-
-// Thresholds para alertas
-const float TEMP_YELLOW = 35.0;
-const float TEMP_RED = 45.0;
-const float HUMIDITY_YELLOW = 80.0;
-const float HUMIDITY_RED = 90.0;
-const float ACCEL_YELLOW = 1.3;  // Vibração leve acima de 1g normal
-const float ACCEL_RED = 1.7;     // Vibração forte
+// Push da telemetria (ver live.h)
+AsyncWebSocket liveSocket("/api/live");
+
+// Estado da conexão WiFi (atualizado pelo callback de eventos)
+volatile bool wifiConnected = false;
+char wifiIp[16] = "0.0.0.0";
+bool wifiFailureReported = false;
+uint32_t wifiStartTime = 0;
+
+// Nome do dispositivo no collector ("mnemon-" + fim do MAC)
+char uplinkDevice[UPLINK_DEVICE_MAX] = "mnemon";
 
 // Declarações das funções (protótipos)
-float calculateLux(int rawValue);
-String calculateAlertLevel(float temp, float humidity, float ax, float ay, float az);
-void updateActuators(String level);
-void setRGBColor(String color);
-void updateLCDDisplay(float temp, float humidity, float lux, float ax, float ay, float az);
-void sendJSONData(float temp, float humidity, int ldrRaw, float lux, float ax, float ay, float az);
-void updateScenarioStep();
 void setupWiFi();
+void checkWiFi();
 void setupAPIRoutes();
 void handleCORS(AsyncWebServerRequest *request);
+void sendJSON(AsyncWebServerRequest *request, const JsonWriter& json, bool cors);
+void sendError(AsyncWebServerRequest *request, int code, const char* message);
+void sendCached(AsyncWebServerRequest *request, const CachedResponse& cached);
+const char* requestHeader(AsyncWebServerRequest *request, const char* name);
+void setupLiveSocket();
 
 void setup() {
     Serial.begin(115200);
@@ -76,350 +59,198 @@ void setup() {
         delay(10);
     }
     
-    // Inicializar I2C
-    Wire.begin(21, 22); // SDA=21, SCL=22
-    
-    // Inicializar LCD
-    lcd.init();
-    lcd.backlight();
-    lcd.clear();
-    
-    // Inicializar sensores
-    dht.begin();
-    mpu.initialize();
-    
-    // Verificar se o MPU6050 está funcionando
-    if (mpu.testConnection()) {
-        Serial.println("MPU6050 conectado com sucesso");
-    } else {
-        Serial.println("ERRO: MPU6050 não encontrado");
-    }
-    
-    // Configurar escala do MPU6050 para ±2g (0 = ±2g, 1 = ±4g, 2 = ±8g, 3 = ±16g)
-    mpu.setFullScaleAccelRange(0);
-    
-    // Configurar pinos dos atuadores
-    pinMode(BUZZER_PIN, OUTPUT);
-    pinMode(LED_R_PIN, OUTPUT);
-    pinMode(LED_G_PIN, OUTPUT);
-    pinMode(LED_B_PIN, OUTPUT);
+    // Inicializar I2C, LCD, sensores e atuadores
+    halInit();
     
     // LED inicial verde
-    setRGBColor("green");
-    digitalWrite(BUZZER_PIN, LOW);
+    setRGBColor(LedColor::Green);
+    halSetBuzzer(false);
     
     // Mostrar inicialização no LCD
-    lcd.setCursor(0, 0);
-    lcd.print("EIDOLON v2.0");
-    lcd.setCursor(0, 1);
-    lcd.print("Inicializando...");
+    halLcdPrint(0, 0, "EIDOLON v2.0");
+    halLcdPrint(0, 1, "Inicializando...");
     
     delay(2000);
     scenarioStartTime = millis();
     
-    // Configurar WiFi e API REST
+    // Tarefas de aquisição, alertas e saída
+    if (!startPipeline()) {
+        Serial.println("ERRO: falha ao criar tarefas do pipeline");
+    }
+    
+    // Configurar WiFi e API REST (sem bloquear a aquisição)
     setupWiFi();
+    setupLiveSocket();
     setupAPIRoutes();
     
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(uplinkDevice, sizeof(uplinkDevice), "mnemon-%02x%02x%02x", mac[3], mac[4], mac[5]);
+    uplink().configure(UPLINK_DEFAULT_HOST, UPLINK_DEFAULT_PORT, uplinkDevice);
+    
     Serial.println("Sistema iniciado - Eidolon Multi-Sensor com API REST");
 }
 
 void loop() {
-    unsigned long currentTime = millis();
-    
-    // Atualizar dados a cada 2 segundos
-    if (currentTime - lastUpdate >= 2000) {
-        lastUpdate = currentTime;
-        
-        // Ler sensores (com possível override via API)
-        float temperature, humidity;
-        if (sensorOverrides.dht22_override) {
-            temperature = sensorOverrides.temperature_override;
-            humidity = sensorOverrides.humidity_override;
-        } else {
-            temperature = dht.readTemperature();
-            humidity = dht.readHumidity();
+    // Aquisição, saída e uplink rodam nas tarefas do pipeline; aqui só
+    // resta acompanhar o WiFi, distribuir o WebSocket e atender comandos
+    // seriais (serialEvent), no ritmo do nível de amostragem (o delay deixa
+    // o chip dormir). O pump fica nesta tarefa
+    // junto com cleanupClients: a lista de clientes do AsyncWebSocket não é
+    // protegida para acesso de outras tarefas.
+    {
+        TaskActivity activity(PowerTask::Loop);
+        checkWiFi();
+        liveSocket.cleanupClients(LIVE_MAX_CLIENTS);
+        {
+            StageTimer timer(MetricStage::LivePump);
+            liveHub().pump(millis());
         }
-        
-        int ldrRaw;
-        if (sensorOverrides.ldr_override) {
-            ldrRaw = sensorOverrides.ldr_raw_override;
-        } else {
-            ldrRaw = analogRead(LDR_PIN);
-        }
-        float lux = calculateLux(ldrRaw);
-        
-        // Ler MPU6050 (com possível override via API)
-        float accelX, accelY, accelZ;
-        if (sensorOverrides.mpu6050_override) {
-            accelX = sensorOverrides.accel_x_override;
-            accelY = sensorOverrides.accel_y_override;
-            accelZ = sensorOverrides.accel_z_override;
-        } else {
-            int16_t ax, ay, az;
-            mpu.getAcceleration(&ax, &ay, &az);
-            
-            // Converter para g (16384 LSB/g para escala ±2g)
-            accelX = ax / 16384.0;
-            accelY = ay / 16384.0;
-            accelZ = az / 16384.0;
-        }
-        
-        // Debug ocasional para verificação
-        if (millis() % 10000 < 100) { // A cada 10s por 100ms
-            Serial.print("MPU6050 Debug: X=");
-            Serial.print(accelX, 2);
-            Serial.print("g Y=");
-            Serial.print(accelY, 2);
-            Serial.print("g Z=");
-            Serial.print(accelZ, 2);
-            Serial.println("g");
-        }
-        
-        // Calcular nível de alerta
-        alertLevel = calculateAlertLevel(temperature, humidity, accelX, accelY, accelZ);
-        
-        // Atualizar atuadores
-        updateActuators(alertLevel);
-        
-        // Atualizar LCD
-        updateLCDDisplay(temperature, humidity, lux, accelX, accelY, accelZ);
-        
-        // Enviar JSON para console serial
-        sendJSONData(temperature, humidity, ldrRaw, lux, accelX, accelY, accelZ);
-        
-        // Atualizar step do cenário
-        updateScenarioStep();
     }
-    
-    delay(100);
+    uint32_t wait = powerManager().tier().loopMs;
+    if (wait > LIVE_MIN_INTERVAL_MS && liveHub().clientCount() > 0) {
+        wait = LIVE_MIN_INTERVAL_MS;   // Atende o menor intervalo do /api/live
+    }
+    delay(wait);
 }
 
-float calculateLux(int rawValue) {
-    // Fórmula para converter valor ADC para lux
-    const float GAMMA = 0.7;
-    const float RL10 = 50;
-    float resistance = (4095.0 - rawValue) * 10000.0 / rawValue;
-    return pow(RL10 * 1e3 * pow(10, GAMMA) / resistance, (1 / GAMMA));
+// Configuração WiFi (assíncrona: o resultado chega por evento)
+void setupWiFi() {
+    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+        wifiConnected = true;
+        
+        Serial.print("WiFi conectado! IP: ");
+        Serial.println(WiFi.localIP());
+        
+        // Mostrar IP no LCD
+        IPAddress address = WiFi.localIP();
+        snprintf(wifiIp, sizeof(wifiIp), "%u.%u.%u.%u", address[0], address[1], address[2], address[3]);
+        showLcdMessage("WiFi: OK", wifiIp, 3000);
+    }, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    
+    WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+        wifiConnected = false;
+        strcpy(wifiIp, "0.0.0.0");
+    }, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    
+    WiFi.setAutoReconnect(true);
+    WiFi.begin(ssid, password);
+    wifiStartTime = millis();
+    Serial.println("Conectando ao WiFi...");
 }
 
-String calculateAlertLevel(float temp, float humidity, float ax, float ay, float az) {
-    float accelMagnitude = sqrt(ax*ax + ay*ay + az*az);
-    
-    // Verificar condições críticas (vermelho)
-    if (temp >= TEMP_RED || humidity >= HUMIDITY_RED || accelMagnitude >= ACCEL_RED) {
-        return "red";
+void checkWiFi() {
+    if (wifiConnected || wifiFailureReported) {
+        return;
     }
     
-    // Verificar condições de alerta (amarelo)
-    if (temp >= TEMP_YELLOW || humidity >= HUMIDITY_YELLOW || accelMagnitude >= ACCEL_YELLOW) {
-        return "yellow";
+    if (millis() - wifiStartTime >= WIFI_TIMEOUT_MS) {
+        wifiFailureReported = true;
+        Serial.println("WiFi falhou - modo standalone");
+        showLcdMessage("WiFi: FALHOU", "Modo local", 2000);
     }
-    
-    return "normal";
 }
 
-void updateActuators(String level) {
-    if (level == "red") {
-        setRGBColor("red");
-        digitalWrite(BUZZER_PIN, HIGH);
-    } else if (level == "yellow") {
-        setRGBColor("yellow");
-        digitalWrite(BUZZER_PIN, LOW);
-    } else {
-        setRGBColor("green");
-        digitalWrite(BUZZER_PIN, LOW);
-    }
+// Transporte do LiveHub sobre o AsyncWebSocket, chamado só pelo loop() (a
+// mesma tarefa de cleanupClients); o cliente é buscado pelo id a cada chamada
+static bool liveReady(uint32_t id, void*) {
+    AsyncWebSocketClient *client = liveSocket.client(id);
+    return client != nullptr && client->status() == WS_CONNECTED &&
+           client->queueLen() < LIVE_CLIENT_QUEUE;
 }
 
-void setRGBColor(String color) {
-    // Resetar todos os pinos
-    digitalWrite(LED_R_PIN, LOW);
-    digitalWrite(LED_G_PIN, LOW);
-    digitalWrite(LED_B_PIN, LOW);
-    
-    if (color == "red") {
-        digitalWrite(LED_R_PIN, HIGH);
-    } else if (color == "green") {
-        digitalWrite(LED_G_PIN, HIGH);
-    } else if (color == "yellow") {
-        digitalWrite(LED_R_PIN, HIGH);
-        digitalWrite(LED_G_PIN, HIGH);
+static bool liveSend(uint32_t id, const char* data, size_t length, void*) {
+    AsyncWebSocketClient *client = liveSocket.client(id);
+    if (client == nullptr) {
+        return false;
     }
+    client->text(data, length);
+    return true;
 }
 
-void updateLCDDisplay(float temp, float humidity, float lux, float ax, float ay, float az) {
-    lcd.clear();
-    
-    // Linha 1: Cenário e status
-    lcd.setCursor(0, 0);
-    lcd.print(currentScenario.substring(0, 8)); // Primeiros 8 chars
-    lcd.setCursor(9, 0);
-    
-    if (alertLevel == "red") {
-        lcd.print("ALERT!");
-    } else if (alertLevel == "yellow") {
-        lcd.print("WARN");
-    } else {
-        lcd.print("OK");
-    }
-    
-    lcd.setCursor(14, 0);
-    lcd.print(String(testStep));
-    
-    // Linha 2: Dados dos sensores (rotativo)
-    lcd.setCursor(0, 1);
-    
-    unsigned long elapsed = (millis() - scenarioStartTime) / 1000;
-    int displayMode = (elapsed / 5) % 4; // Muda a cada 5 segundos
-    
-    switch (displayMode) {
-        case 0: // Temperatura e umidade
-            lcd.print("T:");
-            lcd.print(temp, 1);
-            lcd.print("C H:");
-            lcd.print(humidity, 0);
-            lcd.print("%");
-            break;
-            
-        case 1: // Luminosidade
-            lcd.print("Luz: ");
-            lcd.print(lux, 0);
-            lcd.print(" lux");
-            break;
-            
-        case 2: // Aceleração X,Y
-            lcd.print("X:");
-            lcd.print(ax, 1);
-            lcd.print(" Y:");
-            lcd.print(ay, 1);
-            break;
-            
-        case 3: // Aceleração Z e tempo
-            lcd.print("Z:");
-            lcd.print(az, 1);
-            lcd.print(" ");
-            lcd.print(elapsed);
-            lcd.print("s");
-            break;
+static void liveClose(uint32_t id, void*) {
+    AsyncWebSocketClient *client = liveSocket.client(id);
+    if (client != nullptr) {
+        client->close();
     }
 }
 
-void sendJSONData(float temp, float humidity, int ldrRaw, float lux, float ax, float ay, float az) {
-    JsonDocument doc;
-    
-    // Timestamp ISO 8601
-    char timestamp[32];
-    unsigned long elapsed = millis() / 1000;
-    // Timestamp mais realístico baseado no tempo atual (13 de junho de 2025 como base)
-    unsigned long totalSeconds = elapsed + 1734120000; // Offset para 13/06/2025 00:00:00 UTC
-    unsigned long days = totalSeconds / 86400;
-    unsigned long daySeconds = totalSeconds % 86400;
-    unsigned long hours = daySeconds / 3600;
-    unsigned long minutes = (daySeconds % 3600) / 60;
-    unsigned long seconds = daySeconds % 60;
-    
-    // Ajustar para 13 de junho de 2025 como data base
-    int day = 13 + (days % 30); // Simular progressão de dias
-    int month = 6;
-    int year = 2025;
-    
-    if (day > 30) {
-        day = day - 30;
-        month++;
-        if (month > 12) {
-            month = 1;
-            year++;
+// WebSocket /api/live?interval_ms=N; o cliente pode mudar o intervalo
+// enviando "interval:N"
+void setupLiveSocket() {
+    liveSocket.onEvent([](AsyncWebSocket *socket, AsyncWebSocketClient *client, AwsEventType type,
+                          void *arg, uint8_t *data, size_t len) {
+        if (type == WS_EVT_CONNECT) {
+            AsyncWebServerRequest *request = (AsyncWebServerRequest *)arg;
+            uint32_t interval = 0;
+            if (request != nullptr && request->hasParam("interval_ms")) {
+                interval = strtoul(request->getParam("interval_ms")->value().c_str(), NULL, 10);
+            }
+            if (!liveHub().addClient(client->id(), interval, millis())) {
+                client->close(1013, "Too many clients");
+            }
+        } else if (type == WS_EVT_DISCONNECT) {
+            liveHub().removeClient(client->id());
+        } else if (type == WS_EVT_DATA) {
+            AwsFrameInfo *info = (AwsFrameInfo *)arg;
+            char command[24];
+            if (info->final && info->index == 0 && info->opcode == WS_TEXT && len < sizeof(command)) {
+                memcpy(command, data, len);
+                command[len] = '\0';
+                if (strncmp(command, "interval:", 9) == 0) {
+                    liveHub().setInterval(client->id(), strtoul(command + 9, NULL, 10));
+                }
+            }
         }
-    }
-    
-    sprintf(timestamp, "%04d-%02d-%02dT%02d:%02d:%02dZ", 
-            year, month, day, (int)hours, (int)minutes, (int)seconds);
-    
-    doc["timestamp"] = timestamp;
-    doc["scenario"] = currentScenario;
-    doc["step"] = testStep;
-    doc["elapsed_seconds"] = elapsed;
-    
-    // Dados dos sensores
-    JsonObject sensors = doc["sensors"].to<JsonObject>();
-    
-    JsonObject dht22 = sensors["dht22"].to<JsonObject>();
-    dht22["temperature"] = round(temp * 10) / 10.0;
-    dht22["humidity"] = round(humidity * 10) / 10.0;
-    
-    JsonObject ldr = sensors["ldr"].to<JsonObject>();
-    ldr["raw"] = ldrRaw;
-    ldr["lux"] = round(lux);
-    
-    JsonObject mpu6050 = sensors["mpu6050"].to<JsonObject>();
-    mpu6050["accelX"] = round(ax * 100) / 100.0;
-    mpu6050["accelY"] = round(ay * 100) / 100.0;
-    mpu6050["accelZ"] = round(az * 100) / 100.0;
-    
-    // Status dos atuadores
-    JsonObject actuators = doc["actuators"].to<JsonObject>();
-    
-    String rgbColor = "green";
-    if (alertLevel == "red") rgbColor = "red";
-    else if (alertLevel == "yellow") rgbColor = "yellow";
-    
-    actuators["rgb_led"] = rgbColor;
-    actuators["buzzer"] = (alertLevel == "red") ? "on" : "off";
-    
-    doc["alert_level"] = alertLevel;
+    });
     
-    // Enviar JSON
-    serializeJson(doc, Serial);
-    Serial.println();
+    LiveTransport transport = {liveReady, liveSend, liveClose, nullptr};
+    liveHub().setTransport(transport);
+    server.addHandler(&liveSocket);
 }
 
-void updateScenarioStep() {
-    // Simular progressão do cenário baseado no tempo
-    unsigned long elapsed = (millis() - scenarioStartTime) / 1000;
-    
-    if (currentScenario == "sensor_validation") {
-        testStep = (elapsed / 10) % 8 + 1; // Steps 1-8, muda a cada 10s
-    } else if (currentScenario == "realistic_conditions") {
-        testStep = (elapsed / 30) % 10 + 1; // Steps 1-10, muda a cada 30s
-    } else if (currentScenario == "extreme_conditions") {
-        testStep = (elapsed / 20) % 6 + 1; // Steps 1-6, muda a cada 20s
+// Converte o corpo de POST /api/scenario em linha do tempo (sem ordenar nem
+// validar a coerência dos passos; isso fica com prepareTimeline)
+static bool parseTimeline(JsonDocument& doc, Timeline& timeline, const char*& error) {
+    memset(&timeline, 0, sizeof(timeline));
+    strlcpy(timeline.name, doc["name"] | "timeline", sizeof(timeline.name));
+    timeline.loopMs = doc["loop_ms"] | 0;
+    
+    JsonArray steps = doc["steps"].as<JsonArray>();
+    if (steps.isNull() || steps.size() == 0) {
+        error = "Missing steps";
+        return false;
     }
-}
-
-// Configuração WiFi
-void setupWiFi() {
-    WiFi.begin(ssid, password);
-    Serial.print("Conectando ao WiFi");
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
+    if (steps.size() > TIMELINE_MAX_STEPS) {
+        error = "Too many steps";
+        return false;
     }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.print("WiFi conectado! IP: ");
-        Serial.println(WiFi.localIP());
-        
-        // Mostrar IP no LCD
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("WiFi: OK");
-        lcd.setCursor(0, 1);
-        lcd.print(WiFi.localIP());
-        delay(3000);
-    } else {
-        Serial.println("\nWiFi falhou - modo standalone");
-        lcd.clear();
-        lcd.setCursor(0, 0);
-        lcd.print("WiFi: FALHOU");
-        lcd.setCursor(0, 1);
-        lcd.print("Modo local");
-        delay(2000);
+    for (JsonObject s : steps) {
+        TimelineStep& step = timeline.steps[timeline.count++];
+        if (s["at_ms"].isNull()) {
+            error = "Step without at_ms";
+            return false;
+        }
+        step.atMs = s["at_ms"];
+        step.rampMs = s["ramp_ms"] | 0;
+        step.step = s["step"] | 0;
+        step.sensor = TimelineSensor::None;
+        if (!s["sensor"].isNull() && !findTimelineSensor(s["sensor"] | "", step.sensor)) {
+            error = "Unknown sensor";
+            return false;
+        }
+        const char* const* names = TIMELINE_FIELD_NAMES[(size_t)step.sensor];
+        for (uint8_t i = 0; i < 3; i++) {
+            if (names[i] && !s[names[i]].isNull()) {
+                step.values[i] = s[names[i]];
+                step.fields |= 1 << i;
+            }
+        }
+        if (s["disable"] | false) {
+            step.fields |= TIMELINE_DISABLE;
+        }
     }
+    return true;
 }
 
 // Configuração das rotas da API REST
@@ -433,24 +264,97 @@ void setupAPIRoutes() {
         }
     });
 
-    // GET /api/status - Status atual dos sensores
-    server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {        
-        JsonDocument doc;
-        doc["status"] = "online";
-        doc["scenario"] = currentScenario;
-        doc["alert_level"] = alertLevel;
-        doc["uptime_seconds"] = millis() / 1000;
-        doc["wifi_ip"] = WiFi.localIP().toString();
-        
-        JsonObject overrides = doc["overrides"].to<JsonObject>();
-        overrides["dht22"] = sensorOverrides.dht22_override;
-        overrides["ldr"] = sensorOverrides.ldr_override;
-        overrides["mpu6050"] = sensorOverrides.mpu6050_override;
+    // GET /api/status - Status atual dos sensores, renderizado uma vez por
+    // ciclo e servido do cache com ETag (http_cache.h)
+    server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+        CachedResponse cached;
+        if (!serveStatus(wifiIp, requestHeader(request, "If-None-Match"),
+                         requestHeader(request, "Accept-Encoding"), cached)) {
+            request->send(500, "application/json", "{\"error\":\"Response too large\"}");
+            return;
+        }
+        sendCached(request, cached);
+    });
+
+    // GET /api/telemetry - Último registro enviado à serial, servido do cache
+    server.on("/api/telemetry", HTTP_GET, [](AsyncWebServerRequest *request) {
+        CachedResponse cached;
+        if (!serveTelemetry(requestHeader(request, "If-None-Match"),
+                            requestHeader(request, "Accept-Encoding"), cached)) {
+            request->send(503, "application/json", "{\"error\":\"No telemetry yet\"}");
+            return;
+        }
+        sendCached(request, cached);
+    });
+
+    // GET /api/metrics - Latência por estágio (histogramas de ciclos)
+    server.on("/api/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static char body[1536];
+        JsonWriter json(body, sizeof(body));
+        metrics().write(json);
+        sendJSON(request, json, true);
+    });
+
+    // GET /api/power - Nível de amostragem, duty cycle e despertares por tarefa
+    server.on("/api/power", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static char body[1024];
+        JsonWriter json(body, sizeof(body));
+        PowerManager::write(powerManager().snapshot(millis()), json);
+        sendJSON(request, json, true);
+    });
+
+    // GET /api/anomaly - Linha de base aprendida e desvio atual por canal
+    server.on("/api/anomaly", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static char body[1024];
+        JsonWriter json(body, sizeof(body));
+        AnomalyEngine::write(anomalyEngine().snapshot(), json);
+        sendJSON(request, json, true);
+    });
+
+    // GET /api/uplink - Lotes, fila (RAM e flash) e envio ao collector
+    server.on("/api/uplink", HTTP_GET, [](AsyncWebServerRequest *request) {
+        static char body[1024];
+        JsonWriter json(body, sizeof(body));
+        Uplink::write(uplink().snapshot(), json);
+        sendJSON(request, json, true);
+    });
+
+    // POST /api/anomaly/relearn - Recomeçar o aprendizado (troca de máquina,
+    // manutenção); aplicado pela tarefa de alertas na próxima avaliação
+    server.on("/api/anomaly/relearn", HTTP_POST, [](AsyncWebServerRequest *request) {
+        handleCORS(request);
+        anomalyEngine().relearn();
+        request->send(200, "application/json",
+                      "{\"success\":true,\"message\":\"Baseline learning restarted\"}");
+    });
+
+    // GET /api/history?sensor=&from=&resolution= - Série temporal em blocos
+    // (chunked): cada bloco é gerado sob demanda no buffer TCP
+    server.on("/api/history", HTTP_GET, [](AsyncWebServerRequest *request) {
+        HistoryQuery query;
+        query.resolution = HISTORY_RAW;
+        query.fromMs = 0;
         
-        String responseStr;
-        serializeJson(doc, responseStr);
+        if (!request->hasParam("sensor") ||
+            !findHistoryMetric(request->getParam("sensor")->value().c_str(), query.metric)) {
+            request->send(400, "application/json", "{\"error\":\"Unknown sensor\"}");
+            return;
+        }
+        if (request->hasParam("resolution") &&
+            !findHistoryResolution(request->getParam("resolution")->value().c_str(), query.resolution)) {
+            request->send(400, "application/json", "{\"error\":\"Unknown resolution\"}");
+            return;
+        }
+        if (request->hasParam("from")) {
+            query.fromMs = strtoul(request->getParam("from")->value().c_str(), NULL, 10);
+        }
         
-        AsyncWebServerResponse *response = request->beginResponse(200, "application/json", responseStr);
+        HistoryCursor cursor;
+        history().open(query, flashLog().clock(millis()), cursor);
+        AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+            [cursor](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+                return history().readChunk(cursor, (char*)buffer, maxLen);
+            });
         response->addHeader("Access-Control-Allow-Origin", "*");
         request->send(response);
     });
@@ -461,31 +365,33 @@ void setupAPIRoutes() {
     }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
         JsonDocument doc;
         if (deserializeJson(doc, data, len) == DeserializationError::Ok) {
+            SensorOverrides updated;
+            sensorOverrides.update([&](SensorOverrides& o) {
+                if (!doc["temperature"].isNull()) {
+                    o.temperature_override = doc["temperature"];
+                    o.dht22_override = true;
+                }
+                if (!doc["humidity"].isNull()) {
+                    o.humidity_override = doc["humidity"];
+                    o.dht22_override = true;
+                }
+                if (!doc["disable"].isNull() && doc["disable"]) {
+                    o.dht22_override = false;
+                }
+                updated = o;
+                return true;
+            });
             
-            if (!doc["temperature"].isNull()) {
-                sensorOverrides.temperature_override = doc["temperature"];
-                sensorOverrides.dht22_override = true;
-            }
-            if (!doc["humidity"].isNull()) {
-                sensorOverrides.humidity_override = doc["humidity"];
-                sensorOverrides.dht22_override = true;
-            }
-            if (!doc["disable"].isNull() && doc["disable"]) {
-                sensorOverrides.dht22_override = false;
-            }
-            
-            JsonDocument response;
-            response["success"] = true;
-            response["temperature"] = sensorOverrides.temperature_override;
-            response["humidity"] = sensorOverrides.humidity_override;
-            response["override_active"] = sensorOverrides.dht22_override;
+            static char body[128];
+            JsonWriter json(body, sizeof(body));
+            json.beginObject();
+            json.field("success", true);
+            json.field("temperature", updated.temperature_override, 2);
+            json.field("humidity", updated.humidity_override, 2);
+            json.field("override_active", updated.dht22_override);
+            json.endObject();
             
-            String responseStr;
-            serializeJson(response, responseStr);
-            
-            AsyncWebServerResponse *resp = request->beginResponse(200, "application/json", responseStr);
-            resp->addHeader("Access-Control-Allow-Origin", "*");
-            request->send(resp);
+            sendJSON(request, json, true);
         } else {
             request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
         }
@@ -497,24 +403,29 @@ void setupAPIRoutes() {
     }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
         JsonDocument doc;
         if (deserializeJson(doc, data, len) == DeserializationError::Ok) {
+            SensorOverrides updated;
+            sensorOverrides.update([&](SensorOverrides& o) {
+                if (!doc["raw_value"].isNull()) {
+                    o.ldr_raw_override = doc["raw_value"];
+                    o.ldr_override = true;
+                }
+                if (!doc["disable"].isNull() && doc["disable"]) {
+                    o.ldr_override = false;
+                }
+                updated = o;
+                return true;
+            });
             
-            if (!doc["raw_value"].isNull()) {
-                sensorOverrides.ldr_raw_override = doc["raw_value"];
-                sensorOverrides.ldr_override = true;
-            }
-            if (!doc["disable"].isNull() && doc["disable"]) {
-                sensorOverrides.ldr_override = false;
-            }
-            
-            JsonDocument response;
-            response["success"] = true;
-            response["raw_value"] = sensorOverrides.ldr_raw_override;
-            response["lux"] = calculateLux(sensorOverrides.ldr_raw_override);
-            response["override_active"] = sensorOverrides.ldr_override;
+            static char body[128];
+            JsonWriter json(body, sizeof(body));
+            json.beginObject();
+            json.field("success", true);
+            json.field("raw_value", updated.ldr_raw_override);
+            json.field("lux", calculateLux(updated.ldr_raw_override), 2);
+            json.field("override_active", updated.ldr_override);
+            json.endObject();
             
-            String responseStr;
-            serializeJson(response, responseStr);
-            request->send(200, "application/json", responseStr);
+            sendJSON(request, json, false);
         } else {
             request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
         }
@@ -526,33 +437,38 @@ void setupAPIRoutes() {
     }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
         JsonDocument doc;
         if (deserializeJson(doc, data, len) == DeserializationError::Ok) {
+            SensorOverrides updated;
+            sensorOverrides.update([&](SensorOverrides& o) {
+                if (!doc["accel_x"].isNull()) {
+                    o.accel_x_override = doc["accel_x"];
+                    o.mpu6050_override = true;
+                }
+                if (!doc["accel_y"].isNull()) {
+                    o.accel_y_override = doc["accel_y"];
+                    o.mpu6050_override = true;
+                }
+                if (!doc["accel_z"].isNull()) {
+                    o.accel_z_override = doc["accel_z"];
+                    o.mpu6050_override = true;
+                }
+                if (!doc["disable"].isNull() && doc["disable"]) {
+                    o.mpu6050_override = false;
+                }
+                updated = o;
+                return true;
+            });
             
-            if (!doc["accel_x"].isNull()) {
-                sensorOverrides.accel_x_override = doc["accel_x"];
-                sensorOverrides.mpu6050_override = true;
-            }
-            if (!doc["accel_y"].isNull()) {
-                sensorOverrides.accel_y_override = doc["accel_y"];
-                sensorOverrides.mpu6050_override = true;
-            }
-            if (!doc["accel_z"].isNull()) {
-                sensorOverrides.accel_z_override = doc["accel_z"];
-                sensorOverrides.mpu6050_override = true;
-            }
-            if (!doc["disable"].isNull() && doc["disable"]) {
-                sensorOverrides.mpu6050_override = false;
-            }
+            static char body[160];
+            JsonWriter json(body, sizeof(body));
+            json.beginObject();
+            json.field("success", true);
+            json.field("accel_x", updated.accel_x_override, 3);
+            json.field("accel_y", updated.accel_y_override, 3);
+            json.field("accel_z", updated.accel_z_override, 3);
+            json.field("override_active", updated.mpu6050_override);
+            json.endObject();
             
-            JsonDocument response;
-            response["success"] = true;
-            response["accel_x"] = sensorOverrides.accel_x_override;
-            response["accel_y"] = sensorOverrides.accel_y_override;
-            response["accel_z"] = sensorOverrides.accel_z_override;
-            response["override_active"] = sensorOverrides.mpu6050_override;
-            
-            String responseStr;
-            serializeJson(response, responseStr);
-            request->send(200, "application/json", responseStr);
+            sendJSON(request, json, false);
         } else {
             request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
         }
@@ -562,23 +478,169 @@ void setupAPIRoutes() {
     server.on("/api/sensors/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
         handleCORS(request);
         
-        sensorOverrides.dht22_override = false;
-        sensorOverrides.ldr_override = false;
-        sensorOverrides.mpu6050_override = false;
+        // Uma linha do tempo em execução religaria os overrides
+        if (currentScenario == ScenarioId::Timeline) {
+            setScenario(ScenarioId::ApiControl);
+        }
+        sensorOverrides.update([](SensorOverrides& o) {
+            o.dht22_override = false;
+            o.ldr_override = false;
+            o.mpu6050_override = false;
+            return true;
+        });
+        
+        request->send(200, "application/json",
+                      "{\"success\":true,\"message\":\"All sensor overrides disabled\"}");
+    });
+
+    // POST /api/scenario - Carregar uma linha do tempo de overrides, tocada
+    // pela tarefa de aquisição (ver timeline.h)
+    server.on("/api/scenario", HTTP_POST, [](AsyncWebServerRequest *request) {
+        // Resposta enviada no callback de body
+    }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+        // O corpo pode chegar em vários pedaços: acumula até o último num
+        // buffer da própria requisição (_tempObject, liberado pelo servidor),
+        // para que uploads simultâneos não se misturem
+        if (total > TIMELINE_BODY_MAX) {
+            if (index == 0) {
+                sendError(request, 413, "Timeline too large");
+            }
+            return;
+        }
+        if (index == 0) {
+            request->_tempObject = malloc(total);
+            if (request->_tempObject == NULL) {
+                sendError(request, 503, "Out of memory");
+                return;
+            }
+        }
+        char* body = (char*)request->_tempObject;
+        if (body == NULL) {
+            return;     // Sem memória no primeiro pedaço: erro já enviado
+        }
+        memcpy(body + index, data, len);
+        if (index + len < total) {
+            return;
+        }
         
-        JsonDocument response;
-        response["success"] = true;
-        response["message"] = "All sensor overrides disabled";
+        // Corpo completo: daqui em diante tudo roda nesta chamada, na tarefa
+        // async_tcp, então o buffer estático não é compartilhado
+        static Timeline parsed;
+        const char* error = nullptr;
+        JsonDocument doc;
+        if (deserializeJson(doc, body, total) != DeserializationError::Ok) {
+            sendError(request, 400, "Invalid JSON");
+            return;
+        }
+        if (!parseTimeline(doc, parsed, error) || !prepareTimeline(parsed, error)) {
+            sendError(request, 400, error);
+            return;
+        }
+        setScenario(ScenarioId::Timeline);
+        timeline().load(parsed);
         
-        String responseStr;
-        serializeJson(response, responseStr);
-        request->send(200, "application/json", responseStr);
+        const TimelineStep& last = parsed.steps[parsed.count - 1];
+        static char response[128];
+        JsonWriter json(response, sizeof(response));
+        json.beginObject();
+        json.field("success", true);
+        json.field("name", parsed.name);
+        json.field("steps", (int)parsed.count);
+        json.field("loop_ms", (unsigned long)parsed.loopMs);
+        json.field("duration_ms", (unsigned long)(last.atMs + last.rampMs));
+        json.endObject();
+        sendJSON(request, json, true);
+    });
+
+    // GET /api/scenario - Progresso da linha do tempo em execução
+    server.on("/api/scenario", HTTP_GET, [](AsyncWebServerRequest *request) {
+        TimelineStatus status = timeline().status();
+        static char body[256];
+        JsonWriter json(body, sizeof(body));
+        json.beginObject();
+        json.field("scenario", scenarioName(currentScenario));
+        json.field("timeline", status.name);
+        json.field("active", status.active);
+        json.field("elapsed_ms", (unsigned long)status.elapsedMs);
+        json.field("next_step", (int)status.nextStep);
+        json.field("steps", (int)status.count);
+        json.field("loops", (unsigned long)status.loops);
+        json.field("step", (int)testStep);
+        json.endObject();
+        sendJSON(request, json, true);
     });
 
     server.begin();
     Serial.println("Servidor HTTP iniciado na porta 80");
 }
 
+// Cópia do corpo que vai com a resposta. O AsyncWebServer só passa ao TCP o
+// que cabe na janela de envio e manda o resto depois, a cada ACK; a essa
+// altura o buffer estático do handler ou o slot do cache já podem ter sido
+// reescritos por outra requisição. String guarda o tamanho, então os bytes
+// nulos do gzip passam.
+static String responseBody(const void* data, size_t length) {
+    String body;
+    body.reserve(length);
+    body.concat((const char*)data, length);
+    return body;
+}
+
+// Envia um corpo JSON codificado em buffer estático (JsonWriter); a resposta
+// leva uma cópia, então o buffer pode ser reaproveitado pela próxima
+// requisição
+void sendJSON(AsyncWebServerRequest *request, const JsonWriter& json, bool cors) {
+    if (json.overflowed()) {
+        request->send(500, "application/json", "{\"error\":\"Response too large\"}");
+        return;
+    }
+    AsyncWebServerResponse *response = request->beginResponse(200, "application/json",
+                                                              responseBody(json.c_str(), json.length()));
+    if (cors) {
+        response->addHeader("Access-Control-Allow-Origin", "*");
+    }
+    request->send(response);
+}
+
+// Erro {"error": message} com CORS, para os handlers que respondem no
+// callback de body (o corpo vai copiado para a resposta)
+void sendError(AsyncWebServerRequest *request, int code, const char* message) {
+    char body[128];
+    JsonWriter json(body, sizeof(body));
+    json.beginObject();
+    json.field("error", message);
+    json.endObject();
+    AsyncWebServerResponse *response = request->beginResponse(code, "application/json", json.c_str());
+    response->addHeader("Access-Control-Allow-Origin", "*");
+    request->send(response);
+}
+
+// Resposta do cache (http_cache.h): o corpo já renderizado (e comprimido) é
+// copiado para a resposta, que não depende mais do slot
+void sendCached(AsyncWebServerRequest *request, const CachedResponse& cached) {
+    AsyncWebServerResponse *response;
+    if (cached.status == 304) {
+        response = request->beginResponse(304);
+    } else {
+        response = request->beginResponse(200, "application/json",
+                                          responseBody(cached.body, cached.length));
+        if (cached.gzip) {
+            response->addHeader("Content-Encoding", "gzip");
+        }
+    }
+    response->addHeader("ETag", cached.etag);
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("Vary", "Accept-Encoding");
+    response->addHeader("Access-Control-Allow-Origin", "*");
+    request->send(response);
+}
+
+// Valor do cabeçalho sem cópia para String, ou NULL se ausente
+const char* requestHeader(AsyncWebServerRequest *request, const char* name) {
+    const AsyncWebHeader* header = request->getHeader(name);
+    return header != NULL ? header->value().c_str() : NULL;
+}
+
 // Manipular headers CORS
 void handleCORS(AsyncWebServerRequest *request) {
     AsyncWebServerResponse *response = request->beginResponse(200, "text/plain", "");
@@ -589,22 +651,102 @@ void handleCORS(AsyncWebServerRequest *request) {
 }
 
 // Função para mudar cenário via comando serial (opcional)
+// Linha acumulada em buffer fixo, sem String
 void serialEvent() {
-    if (Serial.available()) {
-        String command = Serial.readStringUntil('\n');
-        command.trim();
+    static char command[96];
+    static size_t length = 0;
+    
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c != '\n') {
+            if (c != '\r' && length < sizeof(command) - 1) {
+                command[length++] = c;
+            }
+            continue;
+        }
+        while (length > 0 && command[length - 1] == ' ') {
+            length--;
+        }
+        command[length] = '\0';
+        length = 0;
         
-        if (command.startsWith("scenario:")) {
-            currentScenario = command.substring(9);
-            testStep = 0;
-            scenarioStartTime = millis();
-            
-            lcd.clear();
-            lcd.setCursor(0, 0);
-            lcd.print("Cenario mudou:");
-            lcd.setCursor(0, 1);
-            lcd.print(currentScenario);
-            delay(2000);
+        if (strncmp(command, "scenario:", 9) == 0) {
+            ScenarioId id;
+            if (findScenario(command + 9, id)) {
+                setScenario(id);
+                showLcdMessage("Cenario mudou:", scenarioName(id), 2000);
+            } else {
+                Serial.print("Cenario desconhecido: ");
+                Serial.println(command + 9);
+            }
+        } else if (strcmp(command, "metrics") == 0) {
+            // Uma linha JSON, no mesmo formato de GET /api/metrics
+            static char body[1536];
+            JsonWriter json(body, sizeof(body));
+            metrics().write(json);
+            if (!json.overflowed()) {
+                Serial.write((const uint8_t*)body, json.length());
+                Serial.println();
+            }
+        } else if (strcmp(command, "metrics:reset") == 0) {
+            metrics().reset();
+        } else if (strcmp(command, "anomaly") == 0) {
+            // Uma linha JSON, no mesmo formato de GET /api/anomaly
+            static char body[1024];
+            JsonWriter json(body, sizeof(body));
+            AnomalyEngine::write(anomalyEngine().snapshot(), json);
+            if (!json.overflowed()) {
+                Serial.write((const uint8_t*)body, json.length());
+                Serial.println();
+            }
+        } else if (strcmp(command, "power") == 0) {
+            // Uma linha JSON, no mesmo formato de GET /api/power
+            static char body[1024];
+            JsonWriter json(body, sizeof(body));
+            PowerManager::write(powerManager().snapshot(millis()), json);
+            if (!json.overflowed()) {
+                Serial.write((const uint8_t*)body, json.length());
+                Serial.println();
+            }
+        } else if (strcmp(command, "uplink") == 0) {
+            // Uma linha JSON, no mesmo formato de GET /api/uplink
+            static char body[1024];
+            JsonWriter json(body, sizeof(body));
+            Uplink::write(uplink().snapshot(), json);
+            if (!json.overflowed()) {
+                Serial.write((const uint8_t*)body, json.length());
+                Serial.println();
+            }
+        } else if (strcmp(command, "uplink:off") == 0) {
+            uplink().configure("", UPLINK_DEFAULT_PORT, uplinkDevice);
+            showLcdMessage("Uplink:", "desligado", 2000);
+        } else if (strncmp(command, "uplink:", 7) == 0) {
+            // uplink:HOST:PORTA (porta opcional)
+            char host[UPLINK_HOST_MAX];
+            const char* colon = strrchr(command + 7, ':');
+            size_t hostLength = colon != NULL ? (size_t)(colon - (command + 7)) : strlen(command + 7);
+            if (hostLength > 0 && hostLength < sizeof(host)) {
+                memcpy(host, command + 7, hostLength);
+                host[hostLength] = '\0';
+                uint16_t port = colon != NULL ? (uint16_t)strtoul(colon + 1, NULL, 10) : UPLINK_DEFAULT_PORT;
+                uplink().configure(host, port, uplinkDevice);
+                showLcdMessage("Uplink:", host, 2000);
+            }
+        } else if (strcmp(command, "power:adaptive") == 0) {
+            powerManager().setAdaptive(true);
+            showLcdMessage("Amostragem:", "adaptativa", 2000);
+        } else if (strcmp(command, "power:fixed") == 0) {
+            powerManager().setAdaptive(false);
+            showLcdMessage("Amostragem:", "fixa (ativa)", 2000);
+        } else if (strcmp(command, "anomaly:relearn") == 0) {
+            anomalyEngine().relearn();
+            showLcdMessage("Anomalias:", "reaprendendo", 2000);
+        } else if (strcmp(command, "mode:binary") == 0) {
+            setTelemetryFormat(TelemetryFormat::Binary);
+            showLcdMessage("Serial:", "binario (COBS)", 2000);
+        } else if (strcmp(command, "mode:json") == 0) {
+            setTelemetryFormat(TelemetryFormat::Json);
+            showLcdMessage("Serial:", "JSON", 2000);
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+#include "metrics.h"
+
+#include <string.h>
+
+#include "json_writer.h"
+
+static StageMetrics stageMetrics;
+
+StageMetrics& metrics() {
+    return stageMetrics;
+}
+
+void StageHistogram::clear() {
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    minCycles = UINT32_MAX;
+    maxCycles = 0;
+    sumCycles = 0;
+}
+
+// Valores < 4 têm bucket próprio; acima, o expoente escolhe o grupo e os
+// dois bits seguintes ao mais significativo escolhem a sub-faixa
+uint32_t StageHistogram::bucketOf(uint32_t cycles) {
+    if (cycles < METRIC_SUB_BUCKETS) {
+        return cycles;
+    }
+    uint32_t exponent = 31 - __builtin_clz(cycles);
+    uint32_t sub = (cycles >> (exponent - 2)) & (METRIC_SUB_BUCKETS - 1);
+    return METRIC_SUB_BUCKETS + (exponent - 2) * METRIC_SUB_BUCKETS + sub;
+}
+
+uint32_t StageHistogram::bucketUpper(uint32_t bucket) {
+    if (bucket < METRIC_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t exponent = (bucket - METRIC_SUB_BUCKETS) / METRIC_SUB_BUCKETS + 2;
+    uint32_t sub = (bucket - METRIC_SUB_BUCKETS) % METRIC_SUB_BUCKETS;
+    uint64_t lower = (uint64_t)(METRIC_SUB_BUCKETS + sub) << (exponent - 2);
+    uint64_t upper = lower + (1ULL << (exponent - 2)) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+void StageHistogram::record(uint32_t cycles) {
+    counts[bucketOf(cycles)]++;
+    total++;
+    sumCycles += cycles;
+    if (cycles < minCycles) minCycles = cycles;
+    if (cycles > maxCycles) maxCycles = cycles;
+}
+
+StageSummary StageHistogram::summary(uint32_t cyclesPerMicro) const {
+    StageSummary s = {};
+    s.count = total;
+    if (total == 0) {
+        return s;
+    }
+    float scale = 1.0f / cyclesPerMicro;
+    s.minUs = minCycles * scale;
+    s.maxUs = maxCycles * scale;
+    s.meanUs = (float)((double)sumCycles / total) * scale;
+
+    // Percentis pelo limite superior do bucket, limitados ao máximo observado
+    uint32_t p50Rank = (total + 1) / 2;
+    uint32_t p99Rank = total - total / 100;
+    uint32_t seen = 0;
+    bool p50Done = false;
+    for (uint32_t b = 0; b < METRIC_BUCKETS; b++) {
+        seen += counts[b];
+        uint32_t upper = bucketUpper(b) < maxCycles ? bucketUpper(b) : maxCycles;
+        if (!p50Done && seen >= p50Rank) {
+            s.p50Us = upper * scale;
+            p50Done = true;
+        }
+        if (seen >= p99Rank) {
+            s.p99Us = upper * scale;
+            break;
+        }
+    }
+    return s;
+}
+
+void StageMetrics::begin() {
+    cyclesPerMicro = halCyclesPerMicro();
+    for (size_t i = 0; i < (size_t)MetricStage::Count; i++) {
+        histograms[i].clear();
+        epochs[i] = resetEpoch;
+    }
+}
+
+void StageMetrics::record(MetricStage stage, uint32_t cycles) {
+    size_t i = (size_t)stage;
+    uint32_t epoch = resetEpoch;
+    if (epochs[i] != epoch) {
+        histograms[i].clear();
+        epochs[i] = epoch;
+    }
+    histograms[i].record(cycles);
+}
+
+StageSummary StageMetrics::summary(MetricStage stage) const {
+    return histograms[(size_t)stage].summary(cyclesPerMicro);
+}
+
+void StageMetrics::write(JsonWriter& json) const {
+    json.beginObject();
+    json.field("unit", "us");
+    json.field("cycles_per_us", (unsigned long)cyclesPerMicro);
+    json.key("stages");
+    json.beginObject();
+    for (size_t i = 0; i < (size_t)MetricStage::Count; i++) {
+        StageSummary s = summary((MetricStage)i);
+        json.key(METRIC_STAGE_NAMES[i]);
+        json.beginObject();
+        json.field("count", (unsigned long)s.count);
+        json.field("min", s.minUs, 1);
+        json.field("mean", s.meanUs, 1);
+        json.field("p50", s.p50Us, 1);
+        json.field("p99", s.p99Us, 1);
+        json.field("max", s.maxUs, 1);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+}
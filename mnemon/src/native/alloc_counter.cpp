@@ -0,0 +1,74 @@
+#include "native/alloc_counter.h"
+
+#include <malloc.h>
+#include <stddef.h>
+
+#include <atomic>
+
+// Interposição dos símbolos da glibc: o executável define malloc & cia. e
+// repassa para as implementações internas, contando cada chamada e os
+// bytes vivos (malloc_usable_size de cada bloco)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<uint64_t> allocations(0);
+static std::atomic<int64_t> heapBytes(0);     // Tamanho utilizável dos blocos vivos
+static std::atomic<int64_t> heapMax(0);
+
+static void* counted(void* ptr) {
+    if (ptr != nullptr) {
+        int64_t size = (int64_t)malloc_usable_size(ptr);
+        int64_t now = heapBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        int64_t peak = heapMax.load(std::memory_order_relaxed);
+        while (now > peak && !heapMax.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+        }
+    }
+    return ptr;
+}
+
+static void released(void* ptr) {
+    if (ptr != nullptr) {
+        heapBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+}
+
+extern "C" void* malloc(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return counted(__libc_malloc(size));
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return counted(__libc_calloc(count, size));
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    released(ptr);
+    return counted(__libc_realloc(ptr, size));
+}
+
+extern "C" void free(void* ptr) {
+    released(ptr);
+    __libc_free(ptr);
+}
+
+uint64_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+int64_t heapInUse() {
+    return heapBytes.load(std::memory_order_relaxed);
+}
+
+int64_t heapPeak() {
+    return heapMax.load(std::memory_order_relaxed);
+}
+
+void resetHeapPeak() {
+    heapMax.store(heapBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
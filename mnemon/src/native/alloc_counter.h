@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+// Contador global de alocações do build nativo (malloc, calloc, realloc e,
+// por consequência, operator new e o alocador padrão do ArduinoJson)
+uint64_t allocationCount();
+
+// Bytes vivos no heap (tamanho utilizável de cada bloco) e o pico desde o
+// último resetHeapPeak()
+int64_t heapInUse();
+int64_t heapPeak();
+void resetHeapPeak();
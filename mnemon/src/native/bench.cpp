@@ -0,0 +1,1087 @@
+#include "native/bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "alerts.h"
+#include "dht22.h"
+#include "display.h"
+#include "flash_log.h"
+#include "history.h"
+#include "lux_table.h"
+#include "metrics.h"
+#include "native/flash_emulator.h"
+#include "native/hal_native.h"
+#include "sensors.h"
+#include "spectrum.h"
+#include "system_state.h"
+#include "telemetry.h"
+#include "telemetry_frame.h"
+#include "timeline.h"
+#include "vibration_features.h"
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double elapsedNs(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+}
+
+// Sinal sintético: 1g em Z, senoide em X e ruído uniforme em Y
+static std::vector<AccelRaw> syntheticAccel(size_t count, float sineG, float noiseG) {
+    std::vector<AccelRaw> samples(count);
+    srand(42);
+    for (size_t i = 0; i < count; i++) {
+        float t = i / 1000.0f;
+        float noise = noiseG * (2.0f * rand() / RAND_MAX - 1.0f);
+        samples[i].x = (int16_t)(sineG * 16384 * sinf(2 * M_PI * 50 * t));
+        samples[i].y = (int16_t)(noise * 16384);
+        samples[i].z = 16384;
+    }
+    return samples;
+}
+
+static int benchFeatures() {
+    const size_t count = 2000000;
+    const float sineG = 0.5f;
+    std::vector<AccelRaw> samples = syntheticAccel(count, sineG, 0.05f);
+    
+    VibrationFeatureEngine engine;
+    BenchClock::time_point start = BenchClock::now();
+    uint32_t windows = 0;
+    for (size_t i = 0; i < count; i++) {
+        windows += engine.addSample(samples[i]);
+    }
+    double ns = elapsedNs(start);
+    
+    const VibrationFeatures& f = engine.features();
+    const AxisFeatures& x = f.axis[0];
+    printf("features: %zu amostras, %u janelas, %.1f ns/amostra (%.0f kamostras/s)\n",
+           count, windows, ns / count, count / ns * 1e6);
+    printf("  X: rms %.4f (ref %.4f) crest %.3f (ref %.3f) kurtosis %.3f (ref 1.500)\n",
+           x.rms, sineG / sqrtf(2), x.crestFactor, sqrtf(2), x.kurtosis);
+    printf("  Y: rms %.4f (ref %.4f) kurtosis %.3f (ref 1.800)\n",
+           f.axis[1].rms, 0.05f / sqrtf(3), f.axis[1].kurtosis);
+    printf("  |a|: pico %.3f, rms total %.4f\n", f.peakMagnitude, f.rmsTotal);
+    
+    // Senoide e ruído uniforme têm curtose e fator de crista conhecidos
+    bool ok = fabsf(x.rms - sineG / sqrtf(2)) < 0.01f &&
+              fabsf(x.kurtosis - 1.5f) < 0.05f &&
+              fabsf(f.axis[1].kurtosis - 1.8f) < 0.1f;
+    printf("%s\n", ok ? "OK" : "FALHA: características fora da referência");
+    return ok ? 0 : 1;
+}
+
+static int benchSpectrum() {
+    const uint32_t frames = 2000;
+    const float rate = ACCEL_SAMPLE_RATE_HZ;
+    
+    // Dois tons (banda baixa e média) com ruído uniforme de ±0,02 g
+    struct Tone { float hz; float g; } tones[] = {{37.3f, 0.10f}, {120.0f, 0.20f}};
+    static float signal[FFT_SIZE];
+    srand(7);
+    for (uint32_t n = 0; n < FFT_SIZE; n++) {
+        float t = n / rate;
+        float noise = 0.02f * (2.0f * rand() / RAND_MAX - 1.0f);
+        signal[n] = 1.0f + noise;
+        for (const Tone& tone : tones) {
+            signal[n] += tone.g * sinf(2 * M_PI * tone.hz * t);
+        }
+    }
+    
+    static SpectrumAnalyzer analyzer;
+    analyzer.begin(rate);
+    BenchClock::time_point start = BenchClock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        analyzer.analyze(signal);
+    }
+    double ns = elapsedNs(start);
+    
+    const SpectralResult& r = analyzer.result();
+    printf("spectrum: FFT %u pontos, %.2f us/quadro (%.1f ns/amostra)\n",
+           FFT_SIZE, ns / frames / 1000, ns / frames / FFT_SIZE);
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) {
+        printf("  pico %u: %.2f Hz, %.4f g\n", p, r.peaks[p].frequencyHz, r.peaks[p].amplitude);
+    }
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        printf("  banda %-5s %.4f g rms\n", SPECTRAL_BANDS[b].name, r.bandRms[b]);
+    }
+    printf("  total %.4f g rms (ref %.4f)\n", r.totalRms,
+           sqrtf(0.10f * 0.10f / 2 + 0.20f * 0.20f / 2 + 0.02f * 0.02f / 3));
+    
+    // Picos dentro de 0,25 bin e 5% da amplitude; bandas com o RMS de cada tom
+    float bin = analyzer.binHz();
+    bool ok = fabsf(r.peaks[0].frequencyHz - 120.0f) < 0.25f * bin &&
+              fabsf(r.peaks[1].frequencyHz - 37.3f) < 0.25f * bin &&
+              fabsf(r.peaks[0].amplitude - 0.20f) < 0.01f &&
+              fabsf(r.peaks[1].amplitude - 0.10f) < 0.005f &&
+              fabsf(r.bandRms[0] - 0.10f / sqrtf(2)) < 0.005f &&
+              fabsf(r.bandRms[1] - 0.20f / sqrtf(2)) < 0.01f;
+    printf("%s\n", ok ? "OK" : "FALHA: espectro fora da referência");
+    return ok ? 0 : 1;
+}
+
+// Renderização antiga do LCD (clear + reescrita a cada ciclo), mantida
+// aqui como referência de custo e de conteúdo
+static void legacyLcdUpdate(const Snapshot& snapshot) {
+    char text[17];
+    halLcdClear();
+    snprintf(text, sizeof(text), "%.8s", scenarioName(currentScenario));
+    halLcdPrint(0, 0, text);
+    halLcdPrint(9, 0, alertLevelInfo(snapshot.alertLevel).lcdText);
+    snprintf(text, sizeof(text), "%d", (int)testStep);
+    halLcdPrint(14, 0, text);
+    
+    unsigned long elapsed = (halMillis() - scenarioStartTime) / 1000;
+    switch ((elapsed / 5) % 4) {
+        case 0:
+            snprintf(text, sizeof(text), "T:%.1fC H:%.0f%%", snapshot.temperature, snapshot.humidity);
+            break;
+        case 1:
+            snprintf(text, sizeof(text), "Luz: %.0f lux", snapshot.lux);
+            break;
+        case 2:
+            snprintf(text, sizeof(text), "X:%.1f Y:%.1f", snapshot.accelX, snapshot.accelY);
+            break;
+        default:
+            snprintf(text, sizeof(text), "Z:%.1f %lus", snapshot.accelZ, elapsed);
+            break;
+    }
+    halLcdPrint(0, 1, text);
+}
+
+// Snapshot do quadro n de uma sessão de sensor_validation, um a cada 2 s
+static Snapshot lcdBenchSnapshot(uint32_t n) {
+    Snapshot snapshot = {};
+    snapshot.temperature = 25.0f + 3.0f * sinf(n / 40.0f);
+    snapshot.humidity = 60.0f + 10.0f * cosf(n / 55.0f);
+    snapshot.ldrRaw = 2000 + (int)(500 * sinf(n / 20.0f));
+    snapshot.lux = calculateLux(snapshot.ldrRaw);
+    snapshot.accelX = 0.05f * sinf(n * 1.7f);
+    snapshot.accelY = 0.05f * cosf(n * 2.3f);
+    snapshot.accelZ = 1.0f;
+    snapshot.alertLevel = (AlertLevel)(n / 15 % 3);
+    return snapshot;
+}
+
+// Transações I2C por quadro com clear + reescrita e com o framebuffer de
+// sombra, sobre o LCD simulado; o conteúdo final do vidro tem de ser igual
+static int benchLcd() {
+    const uint32_t frames = 600;
+    nativeHal.virtualClock = true;
+    std::vector<std::string> expected(frames);
+    char glass[LCD_ROWS][LCD_COLS];
+    
+    struct Pass { NativeHalCounters before, after; double ns; } passes[2];
+    for (int pass = 0; pass < 2; pass++) {
+        halInit();
+        displayBegin();
+        setScenario(ScenarioId::SensorValidation);
+        passes[pass].before = nativeHalCounters();
+        double ns = 0;
+        for (uint32_t n = 0; n < frames; n++) {
+            timeline().tick(halMillis(), sensorOverrides);
+            Snapshot snapshot = lcdBenchSnapshot(n);
+            BenchClock::time_point start = BenchClock::now();
+            if (pass == 0) {
+                legacyLcdUpdate(snapshot);
+            } else {
+                updateLCDDisplay(snapshot);
+                displayFlush();
+            }
+            ns += elapsedNs(start);
+            nativeLcdGlass(glass);
+            std::string screen((const char*)glass, sizeof(glass));
+            if (pass == 0) {
+                expected[n] = screen;
+            } else if (screen != expected[n]) {
+                printf("lcd: quadro %u diverge: [%.32s] != [%.32s]\n", n, screen.c_str(), expected[n].c_str());
+                nativeHal.virtualClock = false;
+                return 1;
+            }
+            nativeClockAdvance(OUTPUT_PERIOD_MS * 1000);
+        }
+        passes[pass].after = nativeHalCounters();
+        passes[pass].ns = ns;
+    }
+    nativeHal.virtualClock = false;
+    
+    // Barramento a 100 kHz: ~20 bits por escrita no expansor; clear leva 1,52 ms
+    const char* names[] = {"clear + reescrita", "framebuffer"};
+    uint32_t writes[2];
+    for (int pass = 0; pass < 2; pass++) {
+        const Pass& p = passes[pass];
+        uint32_t clears = p.after.lcdClears - p.before.lcdClears;
+        writes[pass] = p.after.lcdI2cWrites - p.before.lcdI2cWrites;
+        uint32_t bytes = (p.after.lcdCommands - p.before.lcdCommands) +
+                         (p.after.lcdChars - p.before.lcdChars);
+        double busMs = (writes[pass] * 20 / 100e3 * 1e3 + clears * 1.52) / frames;
+        printf("lcd %-18s: %6.1f transações I2C/quadro, %5.1f bytes/quadro, %.2f clears/quadro, "
+               "~%.2f ms de barramento/quadro, %.2f us de CPU\n",
+               names[pass], (double)writes[pass] / frames, (double)bytes / frames,
+               (double)clears / frames, busMs, p.ns / frames / 1000);
+    }
+    printf("  %u quadros com vidro idêntico, %.1fx menos transações\n",
+           frames, (double)writes[0] / writes[1]);
+    
+    bool ok = writes[1] * 3 < writes[0];
+    printf("%s\n", ok ? "OK" : "FALHA: framebuffer não reduz o tráfego I2C");
+    return ok ? 0 : 1;
+}
+
+// Harness no estilo do Google Benchmark: dobra as iterações até um lote
+// levar pelo menos 20 ms, repete 5 lotes e fica com a mediana
+template <typename Body>
+static double measureNs(Body body) {
+    uint32_t iterations = 1;
+    for (;;) {
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t i = 0; i < iterations; i++) body(i);
+        if (elapsedNs(start) >= 20e6 || iterations >= (1u << 30)) break;
+        iterations *= 2;
+    }
+    double runs[5];
+    for (double& run : runs) {
+        BenchClock::time_point start = BenchClock::now();
+        for (uint32_t i = 0; i < iterations; i++) body(i);
+        run = elapsedNs(start) / iterations;
+    }
+    std::sort(runs, runs + 5);
+    return runs[2];
+}
+
+static volatile float benchSink;
+
+// Fórmula original com pow(), referência para a tabela de lux
+static float referenceLux(int rawValue) {
+    const float GAMMA = 0.7;
+    const float RL10 = 50;
+    float resistance = (4095.0 - rawValue) * 10000.0 / rawValue;
+    return pow(RL10 * 1e3 * pow(10, GAMMA) / resistance, (1 / GAMMA));
+}
+
+// Exatidão da tabela gerada em tempo de compilação em cada código do ADC,
+// contra o modelo em double (std::pow) e contra a fórmula antiga em float,
+// e o custo das duas
+static int benchLux() {
+    uint32_t exact = 0;
+    uint32_t compared = 0;
+    double tableError = 0;
+    double referenceError = 0;
+    double maxDifference = 0;
+    for (int raw = 1; raw < LDR_ADC_MAX; raw++) {   // Nas pontas a fórmula não é definida
+        double gamma = LDR_GAMMA;
+        double resistance = (double)(LDR_ADC_MAX - raw) * LDR_SERIES_OHMS / raw;
+        double model = std::pow(LDR_RL10_KOHMS * 1e3 * std::pow(10.0, gamma) / resistance,
+                                (double)(float)(1 / LDR_GAMMA));
+        float table = calculateLux(raw);
+        float reference = referenceLux(raw);
+        compared++;
+        exact += table == reference;
+        tableError = std::max(tableError, fabs(table - model) / model);
+        referenceError = std::max(referenceError, fabs(reference - model) / model);
+        maxDifference = std::max(maxDifference, fabs((double)table - reference) / reference);
+    }
+    
+    double tableNs = measureNs([](uint32_t i) { benchSink = calculateLux(i & 4095); });
+    double powNs = measureNs([](uint32_t i) { benchSink = referenceLux(1 + i % 4094); });
+    
+    printf("lux: tabela de %zu entradas (%zu bytes); erro relativo máx contra o modelo: "
+           "tabela %.2e, pow() em float %.2e\n",
+           LUX_TABLE_SIZE, sizeof(LuxTable), tableError, referenceError);
+    printf("  %u/%u códigos idênticos à implementação anterior, diferença máx %.2e\n",
+           exact, compared, maxDifference);
+    printf("  raw 0 -> %.1f lux, raw %d -> %.0f lux (saturado; a fórmula dá divisão por zero)\n",
+           calculateLux(0), LDR_ADC_MAX, calculateLux(LDR_ADC_MAX));
+    printf("  tabela %.2f ns/leitura, pow() %.2f ns/leitura (%.1fx)\n",
+           tableNs, powNs, powNs / tableNs);
+    
+    // Meio ULP de float: a tabela é o modelo arredondado uma única vez
+    bool ok = tableError <= 6e-8 && maxDifference < 5e-7 && calculateLux(0) == 0.0f &&
+              calculateLux(LDR_ADC_MAX) == calculateLux(LDR_ADC_MAX - 1) &&
+              calculateLux(-5) == 0.0f && calculateLux(9999) == calculateLux(LDR_ADC_MAX);
+    printf("%s\n", ok ? "OK" : "FALHA: tabela de lux diverge da fórmula");
+    return ok ? 0 : 1;
+}
+
+// Trem de níveis no formato da captura do RMT (nível, duração em µs), com
+// a cauda do pulso de início e temporizações fora do nominal como as de um
+// sensor real: exemplo do datasheet, 65,2% e 35,1 °C (0x028C 0x015F, checksum 0xEE)
+struct DhtLevel {
+    bool high;
+    uint16_t us;
+};
+
+static std::vector<DhtLevel> datasheetCapture() {
+    const uint8_t bytes[5] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+    std::vector<DhtLevel> levels = {{false, 3}, {true, 24}, {false, 83}, {true, 86}};
+    for (size_t i = 0; i < DHT22_BITS; i++) {
+        bool one = bytes[i / 8] & (0x80 >> (i % 8));
+        levels.push_back({false, (uint16_t)(52 + i % 3)});
+        levels.push_back({true, (uint16_t)(one ? 68 + i % 5 : 24 + i % 4)});
+    }
+    levels.push_back({false, 55});
+    return levels;
+}
+
+static Dht22Status decodeLevels(const std::vector<DhtLevel>& levels, Dht22Frame& frame) {
+    Dht22PulseTrain train;
+    train.clear();
+    for (const DhtLevel& level : levels) {
+        train.add(level.high, level.us);
+    }
+    return dht22Decode(train.pulses(), train.size(), frame);
+}
+
+static int benchDht22() {
+    bool ok = true;
+    
+    // Exemplo do datasheet e variações corrompidas
+    std::vector<DhtLevel> capture = datasheetCapture();
+    Dht22Frame frame = {};
+    Dht22Status status = decodeLevels(capture, frame);
+    printf("dht22: captura do datasheet: %s, %.1f C, %.1f%%\n",
+           DHT22_STATUS_NAMES[(size_t)status], frame.temperature, frame.humidity);
+    ok &= status == Dht22Status::Ok && lroundf(frame.temperature * 10) == 351 &&
+          lroundf(frame.humidity * 10) == 652;
+    
+    struct Corruption {
+        const char* name;
+        Dht22Status expected;
+        std::vector<DhtLevel> levels;
+    };
+    std::vector<Corruption> corruptions;
+    {
+        Corruption c = {"bit invertido", Dht22Status::Checksum, capture};
+        c.levels[4 + 2 * 20 + 1].us = c.levels[4 + 2 * 20 + 1].us > 48 ? 26 : 70;
+        corruptions.push_back(c);
+    }
+    {
+        Corruption c = {"quadro cortado", Dht22Status::Truncated, capture};
+        c.levels.resize(4 + 2 * 30);
+        corruptions.push_back(c);
+    }
+    {
+        Corruption c = {"sem resposta", Dht22Status::NoResponse, {{false, 3}, {true, 9000}}};
+        corruptions.push_back(c);
+    }
+    {
+        // Glitch de 5 µs no meio de um bit alto: desalinha os bits seguintes
+        Corruption c = {"glitch na linha", Dht22Status::BadTiming, capture};
+        size_t at = 4 + 2 * 10 + 1;
+        uint16_t high = c.levels[at].us;
+        c.levels[at].us = high / 2;
+        c.levels.insert(c.levels.begin() + at + 1, {{false, 5}, {true, (uint16_t)(high - high / 2)}});
+        corruptions.push_back(c);
+    }
+    for (const Corruption& c : corruptions) {
+        Dht22Frame ignored;
+        Dht22Status got = decodeLevels(c.levels, ignored);
+        printf("  %-16s: %s (esperado %s)\n", c.name, DHT22_STATUS_NAMES[(size_t)got],
+               DHT22_STATUS_NAMES[(size_t)c.expected]);
+        ok &= got == c.expected;
+    }
+    
+    // Toda a faixa do sensor, ida e volta, com jitter de ±8 µs em cada nível
+    srand(7);
+    uint32_t frames = 0, exact = 0;
+    for (int t = -400; t <= 800; t += 7) {
+        for (int h = 0; h <= 1000; h += 13) {
+            Dht22Frame sent = {t / 10.0f, h / 10.0f};
+            Dht22Pulse pulses[DHT22_MAX_PULSES];
+            size_t count = dht22Encode(sent, pulses, DHT22_MAX_PULSES);
+            Dht22PulseTrain train;
+            train.clear();
+            for (size_t i = 0; i < count; i++) {
+                train.add(false, pulses[i].lowUs + rand() % 17 - 8);
+                if (pulses[i].highUs > 0) {
+                    train.add(true, pulses[i].highUs + rand() % 17 - 8);
+                }
+            }
+            Dht22Frame got;
+            frames++;
+            exact += dht22Decode(train.pulses(), train.size(), got) == Dht22Status::Ok &&
+                     lroundf(got.temperature * 10) == t && lroundf(got.humidity * 10) == h;
+        }
+    }
+    printf("  faixa -40..80 C, 0..100%%, jitter ±8 µs: %u/%u quadros exatos\n", exact, frames);
+    ok &= exact == frames;
+    
+    // Intervalo mínimo e quadro guardado
+    Dht22Reader reader;
+    Dht22PulseTrain good, bad;
+    good.clear();
+    bad.clear();
+    for (const DhtLevel& level : capture) good.add(level.high, level.us);
+    bad.add(false, 3);
+    bool first = reader.due(0);
+    reader.start(0);
+    reader.complete(good);
+    bool early = reader.due(DHT22_MIN_INTERVAL_MS - 1);
+    bool later = reader.due(DHT22_MIN_INTERVAL_MS);
+    reader.start(DHT22_MIN_INTERVAL_MS);
+    reader.complete(bad);
+    Dht22Frame cached;
+    uint32_t capturedMs = 1;
+    bool fresh = reader.frame(cached, capturedMs);
+    printf("  leitor: intervalo de %u ms respeitado %s; depois de uma falha, quadro de %u ms "
+           "guardado (%.1f C), leitura %s\n", DHT22_MIN_INTERVAL_MS, first && !early && later ? "sim" : "não",
+           capturedMs, cached.temperature, fresh ? "válida" : "inválida");
+    ok &= first && !early && later && !fresh && capturedMs == 0 && lroundf(cached.temperature * 10) == 351 &&
+          reader.stats().reads == 2 && reader.stats().results[(size_t)Dht22Status::NoResponse] == 1;
+    
+    double ns = measureNs([&](uint32_t i) {
+        Dht22Frame f;
+        benchSink = (float)dht22Decode(good.pulses(), good.size(), f) + f.temperature + i;
+    });
+    printf("  decodificação: %.0f ns/quadro\n", ns);
+    
+    printf("%s\n", ok ? "OK" : "FALHA: decodificação do DHT22");
+    return ok ? 0 : 1;
+}
+
+// Etapas de lógica pura do ciclo (conversão de lux, avaliação do alerta,
+// serialização) e o custo da própria instrumentação por estágio
+static int benchLogic() {
+    VibrationFeatures vibration = {};
+    vibration.peakMagnitude = 1.05f;
+    vibration.rmsTotal = 0.03f;
+    SpectralResult spectrum = {};
+    Snapshot snapshot = {};
+    snapshot.temperature = 25.3f;
+    snapshot.humidity = 61.2f;
+    snapshot.ldrRaw = 2011;
+    snapshot.lux = calculateLux(2011);
+    snapshot.accelZ = 1.0f;
+    static char json[TELEMETRY_BUFFER_SIZE];
+    static uint8_t frame[FRAME_MAX_ENCODED];
+    EnvironmentRecord record = {123456, 24.5f, 61.0f, 187.0f, 1001, 0, 1, 2, 0.02f, 1.01f};
+    StageHistogram histogram;
+    histogram.clear();
+    
+    struct Result { const char* name; double ns; } results[] = {
+        {"calculateLux", measureNs([](uint32_t i) {
+            benchSink = calculateLux(1 + i % 4094);
+        })},
+        {"calculateAlertLevel", measureNs([&](uint32_t i) {
+            benchSink = (float)calculateAlertLevel(20.0f + i % 30, 60.0f, vibration, spectrum);
+        })},
+        {"encodeTelemetry", measureNs([&](uint32_t i) {
+            benchSink = (float)encodeTelemetry(snapshot, i, json, sizeof(json));
+        })},
+        {"encodeEnvironmentFrame", measureNs([&](uint32_t i) {
+            benchSink = (float)encodeEnvironmentFrame((uint16_t)i, record, frame);
+        })},
+        {"halCycles", measureNs([](uint32_t) {
+            benchSink = (float)halCycles();
+        })},
+        {"StageHistogram::record", measureNs([&](uint32_t i) {
+            histogram.record(i & 0xFFFFF);
+        })},
+    };
+    for (const Result& r : results) {
+        printf("logic: %-24s %9.1f ns/op\n", r.name, r.ns);
+    }
+    
+    // Percentis de uma distribuição uniforme 1..10000 dentro do erro dos buckets
+    histogram.clear();
+    for (uint32_t v = 1; v <= 10000; v++) histogram.record(v);
+    StageSummary s = histogram.summary(1);
+    printf("  histograma 1..10000: min %.0f p50 %.0f p99 %.0f max %.0f média %.1f\n",
+           s.minUs, s.p50Us, s.p99Us, s.maxUs, s.meanUs);
+    bool ok = s.count == 10000 && s.minUs == 1 && s.maxUs == 10000 &&
+              fabsf(s.meanUs - 5000.5f) < 0.5f &&
+              s.p50Us >= 5000 && s.p50Us <= 5000 * 1.25f &&
+              s.p99Us >= 9900 && s.p99Us <= 10000;
+    for (uint32_t v = 1; v < 1u << 31 && ok; v = v * 3 + 1) {
+        uint32_t b = StageHistogram::bucketOf(v);
+        ok = b < METRIC_BUCKETS && StageHistogram::bucketUpper(b) >= v &&
+             (b == 0 || StageHistogram::bucketUpper(b - 1) < v);
+    }
+    printf("%s\n", ok ? "OK" : "FALHA: histograma de latência incorreto");
+    return ok ? 0 : 1;
+}
+
+// Ida e volta dos quadros binários: blocos aleatórios (com muitos zeros e
+// sequências longas sem zero, os casos de borda do COBS), mais a rejeição
+// de quadros corrompidos pelo CRC
+static int benchFrames() {
+    const uint32_t frames = 20000;
+    static uint8_t encoded[FRAME_MAX_ENCODED];
+    static uint8_t payload[FRAME_MAX_ENCODED];
+    static DecodedFrame decoded;
+    
+    srand(11);
+    uint32_t mismatches = 0;
+    uint32_t undetected = 0;
+    size_t bytes = 0;
+    double encodeNs = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        AccelBlock block;
+        block.timestampMs = rand();
+        block.firstIndex = rand();
+        block.sampleRateHz = ACCEL_SAMPLE_RATE_HZ;
+        block.count = f % 4 == 0 ? rand() % (ACCEL_BLOCK_SAMPLES + 1) : ACCEL_BLOCK_SAMPLES;
+        int pattern = f % 3;
+        for (uint16_t i = 0; i < block.count; i++) {
+            int16_t v = pattern == 0 ? 0 : pattern == 1 ? (int16_t)(0x0101 * (1 + rand() % 255)) : (int16_t)rand();
+            block.samples[i] = {v, (int16_t)-v, (int16_t)(v ^ 0x4000)};
+        }
+        
+        BenchClock::time_point start = BenchClock::now();
+        size_t len = encodeAccelFrame(f, block, encoded);
+        encodeNs += elapsedNs(start);
+        bytes += len;
+        
+        // Delimitadores só nas pontas
+        bool framed = encoded[0] == 0 && encoded[len - 1] == 0 &&
+                      memchr(encoded + 1, 0, len - 2) == nullptr;
+        size_t n = cobsDecode(encoded + 1, len - 2, payload);
+        bool ok = framed && decodeFrame(payload, n, decoded) &&
+                  decoded.type == FrameType::AccelBlock && decoded.seq == (uint16_t)f &&
+                  decoded.accel.timestampMs == block.timestampMs &&
+                  decoded.accel.firstIndex == block.firstIndex &&
+                  decoded.accel.count == block.count &&
+                  memcmp(decoded.accel.samples, block.samples, block.count * sizeof(AccelRaw)) == 0;
+        mismatches += !ok;
+        
+        // Um bit trocado no payload não pode passar pelo CRC
+        payload[rand() % n] ^= 1 << (rand() % 8);
+        undetected += decodeFrame(payload, n, decoded);
+    }
+    
+    EnvironmentRecord record = {123456, 24.5f, 61.0f, 187.0f, 1001, 2, 3, 7, 0.123f, 1.75f};
+    size_t len = encodeEnvironmentFrame(65535, record, encoded);
+    size_t n = cobsDecode(encoded + 1, len - 2, payload);
+    const EnvironmentRecord& env = decoded.environment;
+    bool envOk = decodeFrame(payload, n, decoded) && decoded.type == FrameType::Environment &&
+                 decoded.seq == 65535 && env.timestampMs == record.timestampMs &&
+                 env.temperature == record.temperature && env.humidity == record.humidity &&
+                 env.lux == record.lux && env.ldrRaw == record.ldrRaw &&
+                 env.alertLevel == record.alertLevel && env.scenario == record.scenario &&
+                 env.step == record.step && env.vibrationRms == record.vibrationRms &&
+                 env.peakMagnitude == record.peakMagnitude;
+    
+    printf("frames: %u blocos, %.2f us/quadro, %.1f bytes/quadro (%.0f B/s a 1 kHz)\n",
+           frames, encodeNs / frames / 1000, (double)bytes / frames,
+           (double)bytes / frames * ACCEL_SAMPLE_RATE_HZ / ACCEL_BLOCK_SAMPLES);
+    printf("  divergências %u, corrupções não detectadas %u, environment %s\n",
+           mismatches, undetected, envOk ? "ok" : "divergente");
+    
+    bool ok = mismatches == 0 && undetected == 0 && envOk;
+    printf("%s\n", ok ? "OK" : "FALHA: quadros binários não fazem ida e volta");
+    return ok ? 0 : 1;
+}
+
+// Lê a consulta inteira em blocos de chunkSize bytes
+static std::string readHistory(const HistoryStore& store, const HistoryQuery& query,
+                               uint32_t nowMs, size_t chunkSize) {
+    std::string body;
+    std::vector<char> chunk(chunkSize);
+    HistoryCursor cursor;
+    store.open(query, nowMs, cursor);
+    size_t n;
+    while ((n = store.readChunk(cursor, chunk.data(), chunkSize)) > 0) {
+        body.append(chunk.data(), n);
+    }
+    return body;
+}
+
+static size_t countItems(const std::string& body) {
+    size_t count = 0;
+    for (size_t pos = 0; (pos = body.find("{\"t\":", pos)) != std::string::npos; pos++) {
+        count++;
+    }
+    return count;
+}
+
+// 26 h de snapshots a cada 2 s: tamanho dos rings, agregados contra a
+// referência por força bruta e respostas idênticas para qualquer bloco
+static int benchHistory() {
+    const uint32_t periodMs = 2000;
+    const uint32_t points = 26 * 3600 * 1000 / periodMs;
+    static HistoryStore store;
+    store.begin();
+    
+    std::vector<float> temperature(points);
+    BenchClock::time_point start = BenchClock::now();
+    for (uint32_t i = 0; i < points; i++) {
+        float t = i * periodMs / 1000.0f;
+        float values[HISTORY_METRIC_COUNT];
+        values[0] = i % 97 == 0 ? NAN : 25.0f + 5.0f * sinf(t / 900.0f); // Falhas do DHT22
+        values[1] = 60.0f + 10.0f * cosf(t / 1300.0f);
+        values[2] = 100.0f + (i % 50);
+        values[3] = 0.01f * (i % 13);
+        values[4] = 1.0f + 0.001f * (i % 7);
+        temperature[i] = values[0];
+        store.record(i * periodMs, values);
+    }
+    double ns = elapsedNs(start);
+    uint32_t nowMs = points * periodMs;
+    
+    bool sizesOk = store.size(HISTORY_RAW) == HISTORY_RAW_CAPACITY;
+    for (uint32_t r = 1; r <= HISTORY_TIER_COUNT; r++) {
+        sizesOk = sizesOk && store.size(r) == HISTORY_TIERS[r - 1].capacity;
+    }
+    
+    // Penúltimo agregado de cada tier (já fechado) contra a média direta dos pontos
+    // (temperatura sai com 1 casa decimal: tolerância de meio décimo)
+    float maxError = 0;
+    for (uint32_t r = 1; r <= HISTORY_TIER_COUNT; r++) {
+        uint32_t tierMs = HISTORY_TIERS[r - 1].periodMs;
+        uint32_t bucketStart = nowMs - nowMs % tierMs - 2 * tierMs;
+        float lo = INFINITY, hi = -INFINITY;
+        double sum = 0;
+        uint32_t count = 0;
+        for (uint32_t i = bucketStart / periodMs; i < (bucketStart + tierMs) / periodMs; i++) {
+            if (isnan(temperature[i])) continue;
+            lo = fminf(lo, temperature[i]);
+            hi = fmaxf(hi, temperature[i]);
+            sum += temperature[i];
+            count++;
+        }
+        
+        HistoryQuery query = {HistoryMetric::Temperature, (uint8_t)r, bucketStart};
+        std::string body = readHistory(store, query, nowMs, 4096);
+        char expected[160];
+        snprintf(expected, sizeof(expected), "{\"t\":%u,", bucketStart);
+        size_t pos = body.find(expected);
+        float gotMin = NAN, gotMax = NAN, gotMean = NAN;
+        unsigned gotCount = 0;
+        if (pos != std::string::npos) {
+            sscanf(body.c_str() + pos, "{\"t\":%*u,\"min\":%f,\"max\":%f,\"mean\":%f,\"n\":%u",
+                   &gotMin, &gotMax, &gotMean, &gotCount);
+        }
+        float error = fmaxf(fmaxf(fabsf(gotMin - lo), fabsf(gotMax - hi)),
+                            fabsf(gotMean - (float)(sum / count)));
+        maxError = gotCount == count && !isnan(error) ? fmaxf(maxError, error) : INFINITY;
+        printf("  %-4s agregado %u: n %u (ref %u), mean %.2f (ref %.2f)\n",
+               HISTORY_TIERS[r - 1].name, bucketStart, gotCount, count, gotMean, sum / count);
+    }
+    
+    // A resposta não pode depender do tamanho do bloco do servidor
+    HistoryQuery raw = {HistoryMetric::Lux, HISTORY_RAW, 0};
+    HistoryQuery tier = {HistoryMetric::VibrationRms, 1, nowMs - 60000};
+    std::string rawBody = readHistory(store, raw, nowMs, 4096);
+    std::string tierBody = readHistory(store, tier, nowMs, 4096);
+    bool chunksOk = readHistory(store, raw, nowMs, 7) == rawBody &&
+                    readHistory(store, tier, nowMs, 1) == tierBody &&
+                    rawBody.compare(rawBody.size() - 2, 2, "]}") == 0;
+    size_t rawItems = countItems(rawBody);
+    size_t tierItems = countItems(tierBody);
+    
+    printf("history: %u pontos, %.1f ns/registro, %zu bytes de memória (limite %u)\n",
+           points, ns / points, HistoryStore::footprint(), HISTORY_MEMORY_BUDGET);
+    printf("  raw: %zu itens, %zu bytes; 10s desde -60 s: %zu itens (ref 6 com o parcial)\n",
+           rawItems, rawBody.size(), tierItems);
+    
+    bool ok = sizesOk && chunksOk && maxError <= 0.051f &&
+              rawItems == HISTORY_RAW_CAPACITY && tierItems == 6;
+    printf("%s\n", ok ? "OK" : "FALHA: histórico divergente da referência");
+    return ok ? 0 : 1;
+}
+
+// Registros sintéticos do log: o payload é derivado do tempo, então o
+// replay pode conferir cada registro sem guardar uma cópia
+static void logPayload(uint32_t timeMs, float values[HISTORY_METRIC_COUNT]) {
+    for (size_t m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        values[m] = timeMs * 0.001f + m;
+    }
+}
+
+struct ReplayCheck {
+    uint32_t count;
+    uint32_t firstMs;
+    uint32_t lastMs;
+    uint32_t stepMs;
+    uint32_t errors;     // Payload divergente ou fora de ordem
+};
+
+static void checkRecord(LogRecordType type, uint32_t timeMs, const uint8_t* payload,
+                        size_t length, void* context) {
+    ReplayCheck& check = *(ReplayCheck*)context;
+    float expected[HISTORY_METRIC_COUNT];
+    logPayload(timeMs, expected);
+    bool ok = type == LogRecordType::History && length == sizeof(expected) &&
+              memcmp(payload, expected, sizeof(expected)) == 0 &&
+              (check.count == 0 || timeMs == check.lastMs + check.stepMs);
+    check.errors += !ok;
+    if (check.count == 0) check.firstMs = timeMs;
+    check.lastMs = timeMs;
+    check.count++;
+}
+
+static ReplayCheck replayAll(const FlashLog& log, uint32_t fromMs, uint32_t stepMs) {
+    ReplayCheck check = {0, 0, 0, stepMs, 0};
+    log.replay(fromMs, checkRecord, &check);
+    return check;
+}
+
+// Log em flash sobre o emulador: rodízio dos setores, reinícios com
+// escritas e apagamentos interrompidos em pontos aleatórios e tempo de boot
+// com a partição cheia
+static int benchFlashLog() {
+    const uint32_t stepMs = 2000;
+    float values[HISTORY_METRIC_COUNT];
+    FlashEmulator& flash = nativeFlash();
+    bool ok = true;
+    
+    // 1. Várias voltas em 16 segmentos: todos os setores apagados por igual
+    flash.open(nullptr, 16 * FLASH_SECTOR_SIZE);
+    static FlashLog log;
+    log.begin();
+    flash.resetCounters();
+    uint32_t timeMs = 0;
+    for (uint32_t i = 0; i < 20000; i++, timeMs += stepMs) {
+        logPayload(timeMs, values);
+        log.append(LogRecordType::History, timeMs, values, sizeof(values));
+    }
+    log.flush();
+    uint32_t minErase = UINT32_MAX, maxErase = 0;
+    for (uint32_t s = 0; s < 16; s++) {
+        minErase = std::min(minErase, flash.eraseCount(s));
+        maxErase = std::max(maxErase, flash.eraseCount(s));
+    }
+    static FlashLog rebooted;
+    rebooted.begin();
+    ReplayCheck all = replayAll(rebooted, 0, stepMs);
+    bool wearOk = maxErase - minErase <= 1 && all.errors == 0 &&
+                  all.lastMs == timeMs - stepMs && rebooted.clock(0) == timeMs - stepMs &&
+                  all.count >= 15 * ((FLASH_SECTOR_SIZE - 16) / 32);
+    printf("flashlog: 20000 registros em 16 segmentos, apagamentos por setor %u..%u, "
+           "%u recuperados após reinício\n", minErase, maxErase, all.count);
+    ok = ok && wearOk;
+    
+    // 2. Cortes de energia em pontos aleatórios (escrita de lote, cabeçalho
+    // ou apagamento); após cada reinício o log tem de continuar consistente
+    srand(3);
+    uint32_t trials = 300, recovered = 0, torn = 0, lost = 0;
+    flash.open(nullptr, 8 * FLASH_SECTOR_SIZE);
+    log.begin();
+    timeMs = 0;
+    uint32_t lastDurableMs = 0;
+    for (uint32_t t = 0; t < trials; t++) {
+        flash.powerLossAfter(rand() % 6000);
+        uint32_t appended = 0;
+        while (!flash.poweredOff() && appended < 400) {
+            logPayload(timeMs, values);
+            log.append(LogRecordType::History, timeMs, values, sizeof(values));
+            timeMs += stepMs;
+            appended++;
+        }
+        flash.powerOn();
+        
+        rebooted.begin();
+        torn += rebooted.stats().tornRecords;
+        ReplayCheck check = replayAll(rebooted, 0, stepMs);
+        // O relógio retoma do último registro durável, sem voltar no tempo
+        uint32_t resumeMs = rebooted.clock(0);
+        bool trialOk = check.errors == 0 && check.lastMs == resumeMs && resumeMs >= lastDurableMs;
+        recovered += trialOk;
+        lost += (timeMs - stepMs - resumeMs) / stepMs;
+        lastDurableMs = resumeMs;
+        timeMs = resumeMs + stepMs;
+        std::swap(log, rebooted);
+    }
+    printf("  %u cortes de energia: %u recuperações consistentes, %u escritas rasgadas "
+           "detectadas, %.1f registros perdidos por corte (lote em RAM)\n",
+           trials, recovered, torn, (double)lost / trials);
+    ok = ok && recovered == trials && torn > 0;
+    
+    // 3. Boot com a partição cheia (tamanho da partição do ESP32)
+    const uint32_t partition = 0x170000;
+    flash.open(nullptr, partition);
+    log.begin();
+    uint32_t records = partition / 32 + 1000;
+    for (uint32_t i = 0; i < records; i++) {
+        logPayload(i * stepMs, values);
+        log.append(LogRecordType::History, i * stepMs, values, sizeof(values));
+    }
+    log.flush();
+    flash.resetCounters();
+    BenchClock::time_point start = BenchClock::now();
+    rebooted.begin();
+    double scanNs = elapsedNs(start);
+    uint64_t scanBytes = flash.bytesRead();
+    
+    uint32_t now = rebooted.clock(0);
+    start = BenchClock::now();
+    ReplayCheck window = replayAll(rebooted, now - LOG_REPLAY_MS, stepMs);
+    double replayNs = elapsedNs(start);
+    uint64_t replayBytes = flash.bytesRead() - scanBytes;
+    
+    // Leitura da flash do ESP32 a ~10 MB/s (SPI 40 MHz, QIO) domina o boot
+    printf("  boot com %u setores: varredura %.2f ms (%llu bytes, ~%.0f ms no ESP32), "
+           "replay de 24 h: %u registros em %.1f ms (%llu bytes, ~%.0f ms no ESP32)\n",
+           partition / FLASH_SECTOR_SIZE, scanNs / 1e6, (unsigned long long)scanBytes,
+           scanBytes / 10e3, window.count, replayNs / 1e6, (unsigned long long)replayBytes,
+           replayBytes / 10e3);
+    ok = ok && window.errors == 0 && window.count == LOG_REPLAY_MS / stepMs + 1;
+    
+    flash.close();
+    printf("%s\n", ok ? "OK" : "FALHA: log em flash inconsistente após reinício");
+    return ok ? 0 : 1;
+}
+
+// Estado esperado da linha do tempo de teste em cada instante da volta
+struct TimelineExpect {
+    bool dht;
+    bool ldr;
+    bool mpu;
+    float temperature;
+    int ldrRaw;
+    float accelX;
+    int step;
+};
+
+static TimelineExpect expectedTimeline(uint32_t e) {
+    TimelineExpect x = {e < 9000, e >= 3033 && e < 9000, e >= 7007 && e < 9000, 20.0f, 500, 0.0f, 1};
+    if (e >= 5010) {
+        x.temperature = 30.0f;
+    } else if (e >= 1010) {
+        x.temperature = 20.0f + 10.0f * ((float)(e - 1010) / 4000);
+    }
+    if (e >= 3033) {
+        x.ldrRaw = 3000;
+        x.step = 2;
+    }
+    if (e >= 7007) {
+        x.accelX = 0.5f;
+    }
+    return x;
+}
+
+// Linha do tempo tocada em tempo virtual a cada FAST_SENSOR_PERIOD_MS: cada
+// passo tem de valer a partir do primeiro tick no ou após o seu instante
+// agendado (atraso < um tick), as rampas têm de bater com a interpolação
+// exata, uma parada longa da tarefa tem de contar as voltas perdidas, e o
+// step de sensor_validation tem de mudar a cada 10 s como antes
+static int benchTimeline() {
+    bool ok = true;
+    nativeHal.virtualClock = true;
+    halInit();
+    timeline().begin();
+    
+    // Passos fora de ordem e fora da grade de 20 ms, de propósito
+    Timeline t = {};
+    strcpy(t.name, "bench");
+    t.loopMs = 12000;
+    TimelineStep steps[] = {
+        {3033, 0, TimelineSensor::Ldr, TIMELINE_FIELD_0, 2, {3000}},
+        {0, 0, TimelineSensor::Dht22, TIMELINE_FIELD_0 | TIMELINE_FIELD_1, 1, {20.0f, 50.0f}},
+        {9000, 0, TimelineSensor::All, TIMELINE_DISABLE, 0, {}},
+        {1010, 4000, TimelineSensor::Dht22, TIMELINE_FIELD_0, 0, {30.0f}},
+        {7007, 0, TimelineSensor::Mpu6050, TIMELINE_FIELD_0 | TIMELINE_FIELD_1 | TIMELINE_FIELD_2, 0, {0.5f, 0.0f, 1.2f}},
+    };
+    t.count = sizeof(steps) / sizeof(steps[0]);
+    memcpy(t.steps, steps, sizeof(steps));
+    const char* error = nullptr;
+    if (!prepareTimeline(t, error)) {
+        printf("timeline: linha do tempo de teste rejeitada: %s\n", error);
+        nativeHal.virtualClock = false;
+        return 1;
+    }
+    
+    SensorOverrides overrides;
+    overrides.ldr_raw_override = 500;
+    timeline().load(t);
+    uint32_t startMs = halMillis();
+    uint32_t ticks = 0;
+    uint32_t mismatches = 0;
+    uint32_t maxLateMs = 0;
+    int lastStep = 0;
+    for (uint32_t now = startMs; now - startMs < 3 * t.loopMs; now += FAST_SENSOR_PERIOD_MS) {
+        timeline().tick(now, overrides);
+        ticks++;
+        uint32_t e = (now - startMs) % t.loopMs;
+        TimelineExpect x = expectedTimeline(e);
+        bool match = overrides.dht22_override == x.dht && overrides.ldr_override == x.ldr &&
+                     overrides.mpu6050_override == x.mpu &&
+                     fabsf(overrides.temperature_override - x.temperature) < 1e-4f &&
+                     (!x.ldr || overrides.ldr_raw_override == x.ldrRaw) &&
+                     (!x.mpu || fabsf(overrides.accel_x_override - x.accelX) < 1e-6f) &&
+                     testStep == x.step;
+        if (!match) {
+            if (mismatches++ < 3) {
+                printf("timeline: t=%u ms: T=%.4f (esperado %.4f) ldr=%d step=%d flags=%d%d%d\n",
+                       e, overrides.temperature_override, x.temperature, overrides.ldr_raw_override,
+                       (int)testStep, overrides.dht22_override, overrides.ldr_override,
+                       overrides.mpu6050_override);
+            }
+        }
+        // Atraso de aplicação: o step muda no primeiro tick após o agendado
+        if (testStep != lastStep) {
+            uint32_t scheduled = x.step == 2 ? 3033 : 0;
+            uint32_t late = e - scheduled;
+            if (late > maxLateMs) maxLateMs = late;
+            lastStep = testStep;
+        }
+    }
+    TimelineStatus status = timeline().status();
+    printf("timeline: %u ticks em 3 voltas de %u ms, %u divergências, atraso máximo %u ms, %u voltas\n",
+           ticks, t.loopMs, mismatches, maxLateMs, status.loops);
+    ok &= mismatches == 0 && maxLateMs < FAST_SENSOR_PERIOD_MS && status.loops == 2;
+    
+    // Tarefa parada por 40 s: as voltas perdidas contam e o estado é o do
+    // instante atual dentro da volta
+    uint32_t resume = startMs + 3 * t.loopMs + 40000 + 4321;
+    timeline().tick(resume, overrides);
+    TimelineExpect x = expectedTimeline((resume - startMs) % t.loopMs);
+    status = timeline().status();
+    bool stallOk = status.loops == (resume - startMs) / t.loopMs &&
+                   overrides.ldr_override == x.ldr && testStep == x.step &&
+                   fabsf(overrides.temperature_override - x.temperature) < 1e-4f;
+    printf("timeline: após parada de 40 s: %u voltas, step %d, T=%.3f (esperado %.3f)\n",
+           status.loops, (int)testStep, overrides.temperature_override, x.temperature);
+    ok &= stallOk;
+    
+    // Validação do pedido
+    struct { TimelineStep step; uint32_t loopMs; } invalid[] = {
+        {{0, 100, TimelineSensor::Ldr, TIMELINE_DISABLE, 0, {}}, 0},
+        {{0, 0, TimelineSensor::Ldr, TIMELINE_FIELD_1, 0, {1, 2}}, 0},
+        {{0, 0, TimelineSensor::All, TIMELINE_FIELD_0, 0, {1}}, 0},
+        {{0, 0, TimelineSensor::None, 0, 0, {}}, 0},
+        {{5000, 0, TimelineSensor::Ldr, TIMELINE_FIELD_0, 0, {1}}, 5000},
+    };
+    uint32_t rejected = 0;
+    for (const auto& c : invalid) {
+        Timeline bad = {};
+        bad.count = 1;
+        bad.loopMs = c.loopMs;
+        bad.steps[0] = c.step;
+        rejected += !prepareTimeline(bad, error);
+    }
+    printf("timeline: %u de %u pedidos inválidos rejeitados\n", rejected,
+           (unsigned)(sizeof(invalid) / sizeof(invalid[0])));
+    ok &= rejected == sizeof(invalid) / sizeof(invalid[0]);
+    
+    // Cenário embutido: step de 1 a 8, trocando a cada 10 s, em ciclo
+    setScenario(ScenarioId::SensorValidation);
+    startMs = halMillis();
+    uint32_t stepMismatches = 0;
+    for (uint32_t now = startMs; now - startMs < 200000; now += FAST_SENSOR_PERIOD_MS) {
+        timeline().tick(now, sensorOverrides);
+        int expected = (int)((now - startMs) / 10000 % 8 + 1);
+        stepMismatches += testStep != expected;
+    }
+    printf("timeline: sensor_validation por 200 s: %u ticks com step divergente\n", stepMismatches);
+    ok &= stepMismatches == 0;
+    setScenario(ScenarioId::ApiControl);
+    timeline().tick(halMillis(), sensorOverrides);
+    
+    // Custo de um tick, com o relógio andando 1 ms por chamada
+    timeline().load(t);
+    uint32_t now = halMillis();
+    timeline().tick(now, overrides);
+    double tickNs = measureNs([&](uint32_t) { timeline().tick(++now, overrides); });
+    printf("timeline: %.1f ns por tick\n", tickNs);
+    timeline().stop();
+    timeline().tick(now, overrides);
+    nativeHal.virtualClock = false;
+    
+    printf("%s\n", ok ? "OK" : "FALHA: linha do tempo fora do agendado");
+    return ok ? 0 : 1;
+}
+
+int runBenchmark(const char* name) {
+    bool all = strcmp(name, "all") == 0;
+    int result = 0;
+    bool found = false;
+    
+    if (all || strcmp(name, "features") == 0) {
+        found = true;
+        result |= benchFeatures();
+    }
+    
+    if (all || strcmp(name, "spectrum") == 0) {
+        found = true;
+        result |= benchSpectrum();
+    }
+    
+    if (all || strcmp(name, "telemetry") == 0) {
+        found = true;
+        result |= benchTelemetry();
+    }
+    
+    if (all || strcmp(name, "frames") == 0) {
+        found = true;
+        result |= benchFrames();
+    }
+    
+    if (all || strcmp(name, "history") == 0) {
+        found = true;
+        result |= benchHistory();
+    }
+    
+    if (all || strcmp(name, "flashlog") == 0) {
+        found = true;
+        result |= benchFlashLog();
+    }
+    
+    if (all || strcmp(name, "lcd") == 0) {
+        found = true;
+        result |= benchLcd();
+    }
+    
+    if (all || strcmp(name, "lux") == 0) {
+        found = true;
+        result |= benchLux();
+    }
+    
+    if (all || strcmp(name, "dht22") == 0) {
+        found = true;
+        result |= benchDht22();
+    }
+    
+    if (all || strcmp(name, "logic") == 0) {
+        found = true;
+        result |= benchLogic();
+    }
+    
+    if (all || strcmp(name, "live") == 0) {
+        found = true;
+        result |= benchLive();
+    }
+    
+    if (all || strcmp(name, "timeline") == 0) {
+        found = true;
+        result |= benchTimeline();
+    }
+    
+    if (all || strcmp(name, "seqlock") == 0) {
+        found = true;
+        result |= benchSeqlock();
+    }
+    
+    if (all || strcmp(name, "anomaly") == 0) {
+        found = true;
+        result |= benchAnomaly();
+    }
+    
+    if (all || strcmp(name, "power") == 0) {
+        found = true;
+        result |= benchPower();
+    }
+    
+    if (all || strcmp(name, "http") == 0) {
+        found = true;
+        result |= benchHttp();
+    }
+    
+    if (all || strcmp(name, "uplink") == 0) {
+        found = true;
+        result |= benchUplink();
+    }
+    
+    if (!found) {
+        fprintf(stderr, "benchmark desconhecido: %s (features, spectrum, telemetry, frames, history, flashlog, lcd, lux, dht22, logic, live, timeline, seqlock, anomaly, power, http, uplink, all)\n", name);
+        return 2;
+    }
+    return result;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Benchmarks das etapas de lógica pura, executados no host:
+//   .pio/build/native/program --bench <nome>
+// Retorna o código de saída do programa.
+int runBenchmark(const char* name);
+
+// Definido em bench_telemetry.cpp (depende do ArduinoJson para a comparação)
+int benchTelemetry();
+
+// Definido em bench_live.cpp (teste de carga do canal de push)
+int benchLive();
+
+// Definido em bench_seqlock.cpp (escritores e leitores concorrentes)
+int benchSeqlock();
+
+// Definido em bench_anomaly.cpp (traces sintéticos com falhas conhecidas)
+int benchAnomaly();
+
+// Definido em bench_power.cpp (escolha do nível de amostragem)
+int benchPower();
+
+// Definido em bench_http.cpp (cache de respostas sob polling concorrente)
+int benchHttp();
+
+// Definido em bench_uplink.cpp (fila store-and-forward contra um collector local)
+int benchUplink();
@@ -0,0 +1,216 @@
+// Validação do motor de anomalias em traces sintéticos de uma máquina cujo
+// regime normal fica acima dos limiares fixos de amarelo (vibração e banda
+// baixa), com oscilação diária de temperatura e umidade. Em tempo virtual,
+// na cadência do pipeline (avaliação a 50 Hz, DHT22 a cada 2 s, vibração a
+// cada 125 ms, espectro a cada 512 ms), mede:
+//   - alarmes falsos em 24 h de operação normal;
+//   - atraso de detecção de falhas que os limiares fixos não enxergam
+//     (deriva lenta de temperatura, rolamento, aumento de vibração);
+//   - transições com e sem histerese com a leitura oscilando num limiar;
+//   - linha de base restaurada do registro do log;
+//   - custo por avaliação e memória.
+
+#include "native/bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#include "alerts.h"
+#include "anomaly.h"
+
+namespace {
+
+// Ruído gaussiano determinístico (xorshift + Box-Muller)
+struct Noise {
+    uint32_t state;
+    explicit Noise(uint32_t seed) : state(seed) {}
+    float uniform() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f) + 1e-7f;
+    }
+    float gauss(float sigma) {
+        return sigma * sqrtf(-2.0f * logf(uniform())) * cosf(6.2831853f * uniform());
+    }
+};
+
+const uint32_t DAY_MS = 24UL * 3600 * 1000;
+const uint32_t HOUR_MS = 3600UL * 1000;
+
+// Desvios da falha em relação ao regime normal, em função do tempo
+struct Fault {
+    const char* name;
+    uint32_t onsetMs;
+    float temperaturePerHour;   // Deriva
+    float vibrationRms;         // Degrau
+    float bandHigh;             // Degrau
+};
+
+struct RunResult {
+    uint32_t evaluations = 0;
+    uint32_t transitions = 0;           // Depois do aprendizado
+    uint32_t falseAlarms = 0;           // Subidas antes do início da falha
+    uint32_t fixedNonNormalMs = 0;      // Tempo fora do normal nos limiares fixos
+    uint32_t detectionMs = UINT32_MAX;  // Do início da falha ao primeiro alerta
+    double wallNs = 0;
+};
+
+RunResult runMachine(AnomalyEngine& engine, uint32_t durationMs, const Fault* fault, uint32_t seed,
+                     bool begin = true) {
+    AlertEvaluator evaluator(engine);
+    if (begin) {
+        engine.begin(0);
+    }
+    evaluator.begin(0);
+    Noise noise(seed);
+
+    VibrationFeatures vibration = {};
+    SpectralResult spectrum = {};
+    float temperature = NAN;
+    float humidity = NAN;
+    RunResult result;
+    AlertLevel last = AlertLevel::Normal;
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    for (uint32_t t = 0; t < durationMs; t += FAST_SENSOR_PERIOD_MS) {
+        bool faulty = fault && t >= fault->onsetMs;
+        float faultHours = faulty ? (t - fault->onsetMs) / (float)HOUR_MS : 0;
+        float day = 6.2831853f * (t % DAY_MS) / DAY_MS;
+
+        AlertInputs inputs;
+        inputs.envFresh = t % SLOW_SENSOR_PERIOD_MS == 0;
+        if (inputs.envFresh) {
+            // DHT22: resolução de 0,1
+            float drift = faulty ? fault->temperaturePerHour * faultHours : 0;
+            temperature = roundf((38.0f + 1.5f * sinf(day) + drift + noise.gauss(0.15f)) * 10) / 10;
+            humidity = roundf((55.0f - 3.0f * sinf(day) + noise.gauss(0.5f)) * 10) / 10;
+        }
+        if (t % 125 == 0) {
+            vibration.samples = 1000;
+            vibration.rmsTotal = 0.25f + (faulty ? fault->vibrationRms : 0) + noise.gauss(0.01f);
+            vibration.peakMagnitude = 1.35f + noise.gauss(0.02f);
+        }
+        if (t % 512 == 0) {
+            spectrum.frames++;
+            spectrum.bandRms[0] = 0.18f + noise.gauss(0.01f);
+            spectrum.bandRms[1] = 0.06f + noise.gauss(0.005f);
+            spectrum.bandRms[2] = 0.02f + (faulty ? fault->bandHigh : 0) + noise.gauss(0.003f);
+        }
+        inputs.temperature = temperature;
+        inputs.humidity = humidity;
+        inputs.vibration = &vibration;
+        inputs.spectrum = &spectrum;
+        inputs.synthetic = false;
+
+        AlertLevel level = evaluator.evaluate(t, inputs);
+        result.evaluations++;
+        if (calculateAlertLevel(temperature, humidity, vibration, spectrum) != AlertLevel::Normal) {
+            result.fixedNonNormalMs += FAST_SENSOR_PERIOD_MS;
+        }
+        if (level != last && !engine.learning()) {
+            result.transitions++;
+            if (level > last && !faulty) {
+                result.falseAlarms++;
+            }
+        }
+        if (faulty && level != AlertLevel::Normal && result.detectionMs == UINT32_MAX) {
+            result.detectionMs = t - fault->onsetMs;
+        }
+        last = level;
+    }
+    result.wallNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return result;
+}
+
+}  // namespace
+
+int benchAnomaly() {
+    bool ok = true;
+    static AnomalyEngine engine;
+
+    // 24 h normais depois do aprendizado
+    RunResult normal = runMachine(engine, ANOMALY_LEARNING_MS + DAY_MS, nullptr, 1);
+    AnomalySnapshot learned = engine.snapshot();
+    printf("anomaly: 24 h normais: %u alarmes falsos, %u transições; limiares fixos fora do normal "
+           "%.0f%% do tempo\n", normal.falseAlarms, normal.transitions,
+           100.0 * normal.fixedNonNormalMs / (ANOMALY_LEARNING_MS + DAY_MS));
+    printf("  linha de base: T %.2f±%.2f C, UR %.1f±%.1f%%, vib %.3f±%.3f g, banda alta %.4f g\n",
+           learned.channels[0].mean, sqrtf(learned.channels[0].variance),
+           learned.channels[1].mean, sqrtf(learned.channels[1].variance),
+           learned.channels[2].mean, sqrtf(learned.channels[2].variance),
+           learned.channels[6].mean);
+    ok &= normal.falseAlarms == 0 && !learned.learning;
+
+    // Falhas abaixo dos limiares fixos, duas horas depois do aprendizado
+    const uint32_t onset = ANOMALY_LEARNING_MS + 2 * HOUR_MS;
+    const Fault faults[] = {
+        {"deriva de temperatura 2 C/h", onset, 2.0f, 0, 0},
+        {"rolamento (banda alta +0,025 g)", onset, 0, 0, 0.025f},
+        {"vibração +0,08 g rms", onset, 0, 0.08f, 0},
+    };
+    const uint32_t limits[] = {45 * 60 * 1000, 10 * 1000, 10 * 1000};
+    for (size_t i = 0; i < sizeof(faults) / sizeof(faults[0]); i++) {
+        RunResult r = runMachine(engine, onset + HOUR_MS, &faults[i], 7 + i);
+        bool detected = r.detectionMs <= limits[i] && r.falseAlarms == 0;
+        if (r.detectionMs == UINT32_MAX) {
+            printf("anomaly: %-34s: não detectada\n", faults[i].name);
+        } else {
+            printf("anomaly: %-34s: detectada em %.1f s (limite %u s), %u alarmes falsos antes\n",
+                   faults[i].name, r.detectionMs / 1000.0, limits[i] / 1000, r.falseAlarms);
+        }
+        ok &= detected;
+    }
+
+    // Linha de base restaurada do registro do log: sem novo aprendizado e
+    // sem alarmes em mais 6 h
+    AnomalyBaseline baseline;
+    AnomalyEngine::baseline(learned, baseline);
+    static AnomalyEngine restored;
+    restored.begin(0);
+    restored.restore(baseline);
+    bool restoredReady = !restored.learning();
+    RunResult resumed = runMachine(restored, 6 * HOUR_MS, nullptr, 99, false);
+    printf("anomaly: linha de base restaurada (%u bytes no log): aprendizado %s, %u alarmes em 6 h\n",
+           (unsigned)sizeof(baseline), restoredReady ? "dispensado" : "recomeçado", resumed.falseAlarms);
+    ok &= restoredReady && resumed.falseAlarms == 0;
+
+    // Histerese: temperatura oscilando em torno do limiar fixo (entradas
+    // simuladas, portanto limiares fixos)
+    {
+        AnomalyEngine fixedEngine;
+        fixedEngine.begin(0);
+        AlertEvaluator evaluator(fixedEngine);
+        evaluator.begin(0);
+        Noise noise(5);
+        VibrationFeatures vibration = {};
+        SpectralResult spectrum = {};
+        uint32_t raw = 0, hysteresis = 0;
+        AlertLevel lastRaw = AlertLevel::Normal, lastLevel = AlertLevel::Normal;
+        float temperature = 25;
+        for (uint32_t t = 0; t < HOUR_MS; t += FAST_SENSOR_PERIOD_MS) {
+            if (t % SLOW_SENSOR_PERIOD_MS == 0) {
+                temperature = TEMP_YELLOW + noise.gauss(0.3f);
+            }
+            AlertInputs inputs = {temperature, 60.0f, t % SLOW_SENSOR_PERIOD_MS == 0, &vibration, &spectrum, true};
+            AlertLevel level = evaluator.evaluate(t, inputs);
+            AlertLevel rawLevel = calculateAlertLevel(temperature, 60.0f, vibration, spectrum);
+            raw += rawLevel != lastRaw;
+            hysteresis += level != lastLevel;
+            lastRaw = rawLevel;
+            lastLevel = level;
+        }
+        printf("anomaly: 1 h oscilando em %.0f C: %u transições sem histerese, %u com\n",
+               TEMP_YELLOW, raw, hysteresis);
+        ok &= hysteresis * 10 < raw;
+    }
+
+    printf("anomaly: %.0f ns por avaliação (50 Hz), motor com %u bytes\n",
+           normal.wallNs / normal.evaluations, (unsigned)sizeof(AnomalyEngine));
+
+    printf("%s\n", ok ? "OK" : "FALHA: detecção de anomalias fora do esperado");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+// Cache das respostas HTTP (http_cache.h) sob polling concorrente: uma
+// thread faz o papel da tarefa de saída e publica um registro de telemetria
+// por ciclo, e a thread do servidor (a async_tcp do ESP32) atende em rodízio
+// centenas de clientes, cada um repetindo o último ETag recebido; metade
+// aceita gzip. Compara com a renderização a cada requisição (o handler
+// anterior) em requisições/s, bytes de corpo, alocações e pico de heap, e
+// confere o gzip pelo GzipDecoder e o tratamento dos cabeçalhos.
+
+#include "native/bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "crc32.h"
+#include "gzip.h"
+#include "hal.h"
+#include "http_cache.h"
+#include "json_writer.h"
+#include "native/alloc_counter.h"
+#include "native/hal_native.h"
+#include "system_state.h"
+#include "telemetry.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t CLIENTS = 256;
+const uint32_t ROUNDS = 1000;          // Segundos simulados de polling
+const uint32_t RACE_MS = 300;
+
+bool roundTrip(GzipEncoder& encoder, const uint8_t* in, size_t length, size_t& compressed) {
+    static uint8_t out[2 * GZIP_MAX_INPUT + 64];
+    static uint8_t back[GZIP_MAX_INPUT];
+    static GzipDecoder decoder;
+    compressed = encoder.encode(in, length, out, sizeof(out));
+    size_t backLength;
+    return compressed > 0 && decoder.decode(out, compressed, back, sizeof(back), backLength) &&
+           backLength == length && memcmp(back, in, length) == 0;
+}
+
+Snapshot cycleSnapshot(uint32_t i) {
+    Snapshot s = {};
+    s.timestampMs = i * 2000;
+    s.temperature = 24.0f + 0.1f * (i % 17);
+    s.humidity = 55.0f + 0.3f * (i % 11);
+    s.ldrRaw = 1800 + (int)(i % 40);
+    s.lux = 300.0f + i % 40;
+    s.accelX = 0.02f * sinf(i * 0.7f);
+    s.accelY = 0.01f * cosf(i * 0.3f);
+    s.accelZ = 1.0f;
+    s.vibration.rmsTotal = 0.03f + 0.001f * (i % 9);
+    s.vibration.peakMagnitude = 1.05f;
+    s.vibration.magnitude.peakToPeak = 0.08f;
+    s.vibration.magnitude.crestFactor = 1.414f;
+    s.vibration.magnitude.kurtosis = 3.0f;
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) {
+        s.spectrum.peaks[p].frequencyHz = 25.0f * (p + 1) + 0.37f * (i % 5);
+        s.spectrum.peaks[p].amplitude = 0.05f / (p + 1);
+    }
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        s.spectrum.bandRms[b] = 0.01f * b + 0.0004f * (i % 7);
+    }
+    s.alertLevel = AlertLevel::Normal;
+    return s;
+}
+
+// Tarefa de saída: uma leitura atual e um registro de telemetria
+void publish(uint32_t i) {
+    Snapshot s = cycleSnapshot(i);
+    LiveSample live = {};
+    live.timestampMs = s.timestampMs;
+    live.temperature = s.temperature;
+    live.humidity = s.humidity;
+    live.ldrRaw = s.ldrRaw;
+    live.accelZ = 1.0f;
+    live.vibrationRms = s.vibration.rmsTotal;
+    currentReading.write(live);
+    sendJSONData(s);
+}
+
+struct Poller {
+    char etag[2][20];       // status, telemetria
+    bool gzip;
+};
+
+struct LoadResult {
+    uint64_t requests = 0;
+    uint64_t notModified = 0;
+    uint64_t gzipped = 0;
+    uint64_t bodyBytes = 0;
+    uint64_t allocations = 0;
+    int64_t heapPeak = 0;
+    uint32_t renders = 0;
+    double seconds = 0;
+};
+
+// Handler anterior: /api/status renderizado a cada requisição em buffer
+// estático, /api/telemetry direto do buffer publicado, sem ETag. Cada
+// resposta é montada na hora, então conta como uma renderização por
+// requisição (o equivalente às do cache)
+size_t perRequest(bool status) {
+    if (status) {
+        static char body[768];
+        JsonWriter json(body, sizeof(body));
+        writeStatus(json, "10.0.0.42");
+        return json.length();
+    }
+    size_t length;
+    lastTelemetry(length);
+    return length;
+}
+
+// Um cliente pede um endpoint com o último ETag recebido dele
+bool poll(Poller& p, bool status, CachedResponse& out) {
+    char* etag = p.etag[status ? 0 : 1];
+    const char* ifNoneMatch = etag[0] != '\0' ? etag : NULL;
+    const char* acceptEncoding = p.gzip ? "gzip, deflate" : NULL;
+    bool ok = status ? serveStatus("10.0.0.42", ifNoneMatch, acceptEncoding, out)
+                     : serveTelemetry(ifNoneMatch, acceptEncoding, out);
+    if (ok && out.status == 200) {
+        strncpy(etag, out.etag, sizeof(p.etag[0]) - 1);
+    }
+    return ok;
+}
+
+uint32_t totalRenders() {
+    return statusCacheStats().renders + telemetryCacheStats().renders;
+}
+
+// Em rodadas de 1 s: cada cliente pede os dois endpoints e a saída publica
+// um registro a cada OUTPUT_PERIOD_MS, como no ESP32 em nível ativo
+LoadResult load(bool cached, std::vector<Poller>& pollers) {
+    for (Poller& p : pollers) {
+        p.etag[0][0] = p.etag[1][0] = '\0';
+    }
+    LoadResult r;
+    resetHeapPeak();
+    int64_t heapStart = heapInUse();
+    uint64_t allocStart = allocationCount();
+    uint32_t rendersStart = totalRenders();
+    Clock::time_point start = Clock::now();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        if (round * 1000 % OUTPUT_PERIOD_MS == 0) {
+            publish(round);
+        }
+        for (Poller& p : pollers) {
+            for (int endpoint = 0; endpoint < 2; endpoint++) {
+                r.requests++;
+                if (!cached) {
+                    r.bodyBytes += perRequest(endpoint == 0);
+                    r.renders++;
+                    continue;
+                }
+                CachedResponse out;
+                if (!poll(p, endpoint == 0, out)) {
+                    continue;
+                }
+                r.notModified += out.status == 304;
+                r.gzipped += out.gzip && out.status == 200;
+                r.bodyBytes += out.length;
+            }
+        }
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    r.allocations = allocationCount() - allocStart;
+    r.heapPeak = heapPeak() - heapStart;
+    if (cached) {
+        r.renders = totalRenders() - rendersStart;
+    }
+    return r;
+}
+
+void printLoad(const char* name, const LoadResult& r) {
+    printf("http: %-22s %9.0f req/s, %5.1f%% 304, %5.1f%% gzip, %4.0f bytes de corpo/req, "
+           "%u renderizações, %.3f alocações/req, pico de heap +%lld bytes\n",
+           name, r.requests / r.seconds, 100.0 * r.notModified / r.requests, 100.0 * r.gzipped / r.requests,
+           (double)r.bodyBytes / r.requests, r.renders, (double)r.allocations / r.requests, (long long)r.heapPeak);
+}
+
+// Corrida com a tarefa de saída publicando a cada milissegundo: todo corpo
+// 200 sem gzip tem o CRC do seu ETag, ou seja, nenhum registro rasgado
+uint32_t tornResponses(std::vector<Poller>& pollers, uint32_t& checked) {
+    std::atomic<bool> stop(false);
+    std::thread publisher([&stop] {
+        for (uint32_t i = 0; !stop.load(); i++) {
+            publish(i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    uint32_t torn = 0;
+    checked = 0;
+    Clock::time_point end = Clock::now() + std::chrono::milliseconds(RACE_MS);
+    while (Clock::now() < end) {
+        for (Poller& p : pollers) {
+            for (int endpoint = 0; endpoint < 2; endpoint++) {
+                CachedResponse out;
+                if (p.gzip || !poll(p, endpoint == 0, out) || out.status != 200) {
+                    continue;
+                }
+                checked++;
+                unsigned long crc = strtoul(out.etag + 1, NULL, 16);
+                if (crc32(out.body, out.length) != crc || out.body[0] != '{' || out.body[out.length - 1] != '}') {
+                    torn++;
+                }
+            }
+        }
+    }
+    stop = true;
+    publisher.join();
+    return torn;
+}
+
+} // namespace
+
+int benchHttp() {
+    bool ok = true;
+    nativeHal.serialEcho = false;
+    halInit();
+
+    // gzip: corpos reais, casos extremos, volta pelo inflate
+    static GzipEncoder encoder;
+    static char telemetry[TELEMETRY_BUFFER_SIZE];
+    size_t telemetryLength = encodeTelemetry(cycleSnapshot(7), 14000, telemetry, sizeof(telemetry));
+    static char status[768];
+    JsonWriter statusJson(status, sizeof(status));
+    writeStatus(statusJson, "10.0.0.42");
+
+    uint8_t repeated[GZIP_MAX_INPUT];
+    memset(repeated, 'a', sizeof(repeated));
+    uint8_t noise[GZIP_MAX_INPUT];
+    uint32_t seed = 12345;
+    for (uint8_t& b : noise) {
+        seed = seed * 1103515245 + 12345;
+        b = (uint8_t)(seed >> 16);
+    }
+    struct Case {
+        const char* name;
+        const uint8_t* data;
+        size_t length;
+    };
+    const Case cases[] = {
+        {"telemetria", (const uint8_t*)telemetry, telemetryLength},
+        {"status", (const uint8_t*)status, statusJson.length()},
+        {"vazio", repeated, 0},
+        {"um byte", repeated, 1},
+        {"repetido", repeated, sizeof(repeated)},
+        {"aleatório", noise, sizeof(noise)},
+    };
+    for (const Case& c : cases) {
+        size_t compressed;
+        bool good = roundTrip(encoder, c.data, c.length, compressed);
+        printf("http: gzip %-10s %5zu -> %5zu bytes (%5.1f%%) %s\n", c.name, c.length, compressed,
+               c.length > 0 ? 100.0 * compressed / c.length : 0.0, good ? "ok" : "FALHA");
+        ok &= good;
+    }
+    Clock::time_point start = Clock::now();
+    const uint32_t rounds = 2000;
+    static uint8_t out[TELEMETRY_BUFFER_SIZE];
+    for (uint32_t i = 0; i < rounds; i++) {
+        encoder.encode((const uint8_t*)telemetry, telemetryLength, out, sizeof(out));
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+    printf("http: gzip da telemetria em %.1f us, compressor com %zu bytes\n", us, sizeof(GzipEncoder));
+
+    // Cabeçalhos
+    struct Header {
+        const char* value;
+        bool expected;
+    };
+    const Header matches[] = {
+        {"\"1a2b3c4d\"", true},   {"W/\"1a2b3c4d\"", true}, {"\"0\", \"1a2b3c4d\"", true},
+        {"*", true},              {"\"1a2b3c4e\"", false},  {"1a2b3c4d", false},
+        {"\"1a2b3c4d-gz\"", false},
+    };
+    const Header encodings[] = {
+        {"gzip", true},           {"gzip, deflate, br", true}, {"deflate, gzip;q=0.5", true},
+        {"gzip;q=0", false},      {"gzip; q=0.000", false},    {"x-gzip", false},
+        {"identity", false},      {"br, gzip ;q=1", true},
+    };
+    bool headers = true;
+    for (const Header& h : matches) {
+        headers &= etagMatches(h.value, "\"1a2b3c4d\"") == h.expected;
+    }
+    for (const Header& h : encodings) {
+        headers &= acceptsGzip(h.value) == h.expected;
+    }
+    headers &= !acceptsGzip(NULL);
+    printf("http: If-None-Match e Accept-Encoding: %s\n", headers ? "ok" : "FALHA");
+    ok &= headers;
+
+    // Carga: cada cliente repete o último ETag, com e sem cache
+    std::vector<Poller> pollers(CLIENTS);
+    for (uint32_t i = 0; i < CLIENTS; i++) {
+        pollers[i].gzip = i % 2 == 0;
+    }
+    LoadResult uncached = load(false, pollers);
+    LoadResult cached = load(true, pollers);
+    printLoad("render por requisição", uncached);
+    printLoad("cache + ETag", cached);
+    uint32_t cycles = ROUNDS * 1000 / OUTPUT_PERIOD_MS;
+    double speedup = (cached.requests / cached.seconds) / (uncached.requests / uncached.seconds);
+    printf("http: %u clientes, %u ciclos de saída, %.1fx requisições/s, %.0f%% dos bytes de corpo\n",
+           CLIENTS, cycles, speedup, 100.0 * cached.bodyBytes / uncached.bodyBytes);
+    ok &= cached.allocations == 0 && cached.heapPeak <= 0;
+    ok &= cached.renders <= 2 * cycles + 2;
+    ok &= speedup > 1 && cached.bodyBytes < uncached.bodyBytes;
+
+    uint32_t checked;
+    uint32_t torn = tornResponses(pollers, checked);
+    printf("http: publicação a cada 1 ms durante o polling: %u de %u corpos rasgados\n", torn, checked);
+    ok &= torn == 0 && checked > 0;
+
+    // Mesmo conteúdo nas duas representações; 304 com o ETag recebido
+    CachedResponse plain;
+    CachedResponse gzip;
+    CachedResponse again;
+    bool served = serveTelemetry(NULL, NULL, plain) && serveTelemetry(NULL, "gzip", gzip);
+    static uint8_t inflated[HTTP_CACHE_BODY_SIZE];
+    size_t inflatedLength;
+    GzipDecoder decoder;
+    bool same = served && gzip.gzip && !plain.gzip &&
+                decoder.decode(gzip.body, gzip.length, inflated, sizeof(inflated), inflatedLength) &&
+                inflatedLength == plain.length && memcmp(inflated, plain.body, plain.length) == 0;
+    bool notModified = serveTelemetry(plain.etag, "gzip", again) && again.status == 304 &&
+                       serveTelemetry(gzip.etag, NULL, again) && again.status == 304;
+    printf("http: gzip igual ao corpo original %s, 304 com qualquer das duas representações %s\n",
+           same ? "sim" : "não", notModified ? "sim" : "não");
+    ok &= same && notModified;
+
+    printf("%s\n", ok ? "OK" : "FALHA: cache HTTP fora do esperado");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+// Teste de carga do canal de push: centenas de clientes simulados com
+// velocidades diferentes sobre o LiveHub, em tempo virtual. Mede o custo
+// da distribuição (CPU real por pump e por mensagem), a latência de entrega
+// (tempo virtual entre a publicação e o consumo pelo cliente) e a memória
+// por cliente.
+
+#include "native/bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "live.h"
+
+namespace {
+
+enum class Speed { Fast, Slow, Stalled };
+
+struct SimClient {
+    Speed speed;
+    uint32_t intervalMs;
+    std::vector<uint32_t> queue;     // Instante de publicação de cada mensagem na fila
+    std::vector<size_t> queueBytes;
+    uint32_t lastDrainMs = 0;
+    uint32_t samples = 0;
+    uint32_t alerts = 0;
+    uint64_t latencySum = 0;
+    uint32_t latencyMax = 0;
+    size_t maxQueuedBytes = 0;
+    bool closed = false;
+};
+
+struct Simulation {
+    std::vector<SimClient> clients;
+    std::vector<uint32_t> samplePublishedMs;   // Por seq
+    std::vector<uint32_t> alertPublishedMs;
+    uint32_t nowMs = 0;
+};
+
+bool simReady(uint32_t id, void* context) {
+    SimClient& client = ((Simulation*)context)->clients[id];
+    return !client.closed && client.queue.size() < LIVE_CLIENT_QUEUE;
+}
+
+bool simSend(uint32_t id, const char* data, size_t length, void* context) {
+    Simulation& sim = *(Simulation*)context;
+    SimClient& client = sim.clients[id];
+    if (client.closed) {
+        return false;
+    }
+    unsigned seq = 0;
+    uint32_t published;
+    if (sscanf(data, "{\"type\":\"sample\",\"seq\":%u", &seq) == 1) {
+        published = sim.samplePublishedMs[seq];
+    } else {
+        sscanf(data, "{\"type\":\"alert\",\"seq\":%u", &seq);
+        published = sim.alertPublishedMs[seq] | 0x80000000u;   // Marca de alerta
+    }
+    client.queue.push_back(published);
+    client.queueBytes.push_back(length);
+    size_t bytes = 0;
+    for (size_t b : client.queueBytes) bytes += b;
+    client.maxQueuedBytes = std::max(client.maxQueuedBytes, bytes);
+    return true;
+}
+
+void simClose(uint32_t id, void* context) {
+    ((Simulation*)context)->clients[id].closed = true;
+}
+
+// Consumo pelo cliente: rápidos esvaziam a fila, lentos 1 mensagem/s
+void drain(SimClient& client, uint32_t nowMs) {
+    size_t count = 0;
+    if (client.speed == Speed::Fast) {
+        count = client.queue.size();
+    } else if (client.speed == Speed::Slow && nowMs - client.lastDrainMs >= 1000) {
+        count = std::min<size_t>(1, client.queue.size());
+    }
+    if (count > 0) {
+        client.lastDrainMs = nowMs;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint32_t published = client.queue[i];
+        if (published & 0x80000000u) {
+            client.alerts++;
+            continue;
+        }
+        uint32_t latency = nowMs - published;
+        client.samples++;
+        client.latencySum += latency;
+        client.latencyMax = std::max(client.latencyMax, latency);
+    }
+    client.queue.erase(client.queue.begin(), client.queue.begin() + count);
+    client.queueBytes.erase(client.queueBytes.begin(), client.queueBytes.begin() + count);
+}
+
+} // namespace
+
+int benchLive() {
+    const uint32_t fastClients = 200, slowClients = 40, stalledClients = 16;
+    const uint32_t total = fastClients + slowClients + stalledClients;
+    const uint32_t durationMs = 60000, stepMs = 10, pumpMs = 50, alertEveryMs = 7000;
+    const uint32_t intervals[] = {100, 500, 1000};
+    
+    static LiveClient table[256];
+    static LiveHub hub(table, 256);
+    static Simulation sim;
+    hub.begin();
+    LiveTransport transport = {simReady, simSend, simClose, &sim};
+    hub.setTransport(transport);
+    
+    sim.clients.resize(total);
+    sim.samplePublishedMs.assign(1, 0);
+    sim.alertPublishedMs.assign(1, 0);
+    for (uint32_t id = 0; id < total; id++) {
+        SimClient& client = sim.clients[id];
+        client.speed = id < fastClients ? Speed::Fast
+                     : id < fastClients + slowClients ? Speed::Slow : Speed::Stalled;
+        client.intervalMs = client.speed == Speed::Fast ? intervals[id % 3] : LIVE_MIN_INTERVAL_MS;
+        hub.addClient(id, client.intervalMs, 0);
+    }
+    bool overflowRejected = !hub.addClient(999, 0, 0) || total < 256;
+    
+    std::vector<double> pumpNs;
+    uint32_t delivered = 0;
+    uint32_t alertCount = 0;
+    AlertLevel level = AlertLevel::Normal;
+    typedef std::chrono::steady_clock Clock;
+    
+    for (sim.nowMs = stepMs; sim.nowMs <= durationMs; sim.nowMs += stepMs) {
+        uint32_t now = sim.nowMs;
+        if (now % LIVE_MIN_INTERVAL_MS == 0) {
+            LiveSample sample = {};
+            sample.timestampMs = now;
+            sample.temperature = 25.0f;
+            sample.humidity = 60.0f;
+            sample.ldrRaw = 2000;
+            sample.accelZ = 1.0f;
+            sample.alertLevel = level;
+            sim.samplePublishedMs.push_back(now);
+            hub.publish(sample);
+        }
+        if (now % alertEveryMs == 0) {
+            AlertLevel next = level == AlertLevel::Normal ? AlertLevel::Yellow : AlertLevel::Normal;
+            sim.alertPublishedMs.push_back(now);
+            hub.publishAlert(level, next, now);
+            level = next;
+            alertCount++;
+        }
+        if (now % pumpMs == 0) {
+            Clock::time_point start = Clock::now();
+            delivered += hub.pump(now);
+            pumpNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        }
+        for (SimClient& client : sim.clients) {
+            drain(client, now);
+        }
+    }
+    
+    // Agregados por tipo de cliente
+    struct Group { uint32_t n = 0, samples = 0, alerts = 0, closed = 0, latencyMax = 0;
+                   uint64_t latencySum = 0; size_t maxQueued = 0; } groups[3];
+    for (const SimClient& client : sim.clients) {
+        Group& g = groups[(int)client.speed];
+        g.n++;
+        g.samples += client.samples;
+        g.alerts += client.alerts;
+        g.closed += client.closed;
+        g.latencySum += client.latencySum;
+        g.latencyMax = std::max(g.latencyMax, client.latencyMax);
+        g.maxQueued = std::max(g.maxQueued, client.maxQueuedBytes);
+    }
+    std::sort(pumpNs.begin(), pumpNs.end());
+    double pumpSum = 0;
+    for (double ns : pumpNs) pumpSum += ns;
+    LiveStats stats = hub.stats();
+    
+    printf("live: %u clientes (%u rápidos, %u lentos, %u parados), %u s virtuais, "
+           "leitura a cada %u ms, pump a cada %u ms\n",
+           total, fastClients, slowClients, stalledClients, durationMs / 1000,
+           LIVE_MIN_INTERVAL_MS, pumpMs);
+    printf("  distribuição: %.1f us/pump médio, p99 %.1f us, %.0f ns/mensagem (%u entregas)\n",
+           pumpSum / pumpNs.size() / 1000, pumpNs[pumpNs.size() * 99 / 100] / 1000,
+           pumpSum / delivered, delivered);
+    const char* names[] = {"rápidos", "lentos", "parados"};
+    for (int g = 0; g < 3; g++) {
+        const Group& group = groups[g];
+        printf("  %-8s: %.1f leituras/cliente, latência média %.0f ms (máx %u), "
+               "%u/%u alertas, fila máx %zu B, %u fechados\n",
+               names[g], (double)group.samples / group.n,
+               group.samples ? (double)group.latencySum / group.samples : 0.0,
+               group.latencyMax, group.alerts / group.n, alertCount, group.maxQueued, group.closed);
+    }
+    printf("  memória: %zu B/cliente no hub + fila limitada a %u mensagens (<= %zu B); "
+           "%u adiamentos por fila cheia, %u desconectados\n",
+           sizeof(LiveClient), LIVE_CLIENT_QUEUE, groups[0].maxQueued > groups[1].maxQueued ?
+           groups[0].maxQueued : groups[1].maxQueued, stats.coalesced, stats.evicted);
+    
+    // Rápidos recebem no próprio intervalo com atraso de no máximo um pump;
+    // lentos recebem todas as transições; parados são desconectados
+    const Group& fast = groups[0];
+    const Group& slow = groups[1];
+    const Group& stalled = groups[2];
+    bool ok = overflowRejected &&
+              fast.latencyMax <= pumpMs && fast.alerts == fast.n * alertCount &&
+              slow.alerts == slow.n * alertCount && slow.closed == 0 &&
+              stalled.closed == stalled.n && stats.evicted == stalledClients &&
+              fast.maxQueued <= LIVE_CLIENT_QUEUE * 256;
+    printf("%s\n", ok ? "OK" : "FALHA: distribuição fora do esperado");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// Escolha do nível de amostragem (power.h) com entradas sintéticas, em
+// tempo virtual na cadência do nível atual:
+//   - descida ativo -> steady -> idle com leituras calmas e o ruído de
+//     quantização do DHT22, sem voltas falsas ao nível ativo;
+//   - subida imediata com leitura perto do limiar, variação rápida e alerta;
+//   - piso em steady com clientes no WebSocket e perto da faixa de atenção;
+//   - light sleep e modem sleep pedidos à HAL em cada nível;
+//   - custo por avaliação.
+
+#include "native/bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#include "native/hal_native.h"
+#include "power.h"
+
+namespace {
+
+const uint32_t HOUR_MS = 3600UL * 1000;
+
+// Máquina parada longe dos limiares, com a resolução do DHT22 (0,1)
+PowerInputs calm(uint32_t t) {
+    PowerInputs in;
+    in.temperature = roundf((24.0f + 0.1f * sinf(t * 0.0007f)) * 10) / 10;
+    in.humidity = roundf((55.0f + 0.4f * sinf(t * 0.0003f)) * 10) / 10;
+    in.envFresh = true;
+    in.vibrationRms = 0.03f + 0.005f * sinf(t * 0.01f);
+    in.peakMagnitude = 1.02f;
+    in.level = AlertLevel::Normal;
+    in.watched = false;
+    return in;
+}
+
+struct Run {
+    uint32_t t = 0;
+    uint32_t raises = 0;        // Voltas ao nível ativo
+    uint32_t evaluations = 0;
+};
+
+// Avalia na cadência da tarefa rápida do nível atual até untilMs
+template <typename Inputs>
+void advance(PowerManager& power, Run& run, uint32_t untilMs, Inputs inputs) {
+    while (run.t < untilMs) {
+        bool wasActive = &power.tier() == &SAMPLING_TIERS[0];
+        power.update(run.t, inputs(run.t));
+        run.evaluations++;
+        if (!wasActive && &power.tier() == &SAMPLING_TIERS[0]) {
+            run.raises++;
+        }
+        run.t += power.tier().fastMs;
+    }
+}
+
+uint32_t tierOf(const PowerManager& power) {
+    return (uint32_t)(&power.tier() - SAMPLING_TIERS);
+}
+
+} // namespace
+
+int benchPower() {
+    bool ok = true;
+    PowerManager power;
+    power.begin(0, true);
+    Run run;
+
+    // Descida: calmMs de cada nível contado desde o último gatilho
+    advance(power, run, SAMPLING_TIERS[1].calmMs - 100, calm);
+    bool stillActive = tierOf(power) == 0;
+    advance(power, run, SAMPLING_TIERS[1].calmMs + 200, calm);
+    bool steady = tierOf(power) == 1;
+    advance(power, run, SAMPLING_TIERS[2].calmMs + 200, calm);
+    bool idle = tierOf(power) == 2;
+    NativeHalCounters hal = nativeHalCounters();
+    bool sleeping = hal.lightSleep && hal.modemSleep;
+    printf("power: ativo até %u s, steady em %u s, idle em %u s: %s; light sleep %s, modem sleep %s\n",
+           SAMPLING_TIERS[1].calmMs / 1000, SAMPLING_TIERS[1].calmMs / 1000,
+           SAMPLING_TIERS[2].calmMs / 1000, stillActive && steady && idle ? "sim" : "não",
+           hal.lightSleep ? "sim" : "não", hal.modemSleep ? "sim" : "não");
+    ok &= stillActive && steady && idle && sleeping;
+
+    // Uma hora calma com ruído: nenhuma volta ao nível ativo
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    uint32_t evaluations = run.evaluations;
+    advance(power, run, run.t + HOUR_MS, calm);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+                (run.evaluations - evaluations);
+    PowerSnapshot s = power.snapshot(run.t);
+    printf("power: 1 h calma em idle: %u voltas ao ativo, %.1f%% do tempo em idle\n", run.raises,
+           100.0 * s.tierMs[2] / s.elapsedMs);
+    ok &= run.raises == 0 && tierOf(power) == 2;
+
+    // Gatilhos: cada um sobe direto do idle para o ativo, na avaliação seguinte
+    struct Trigger {
+        const char* name;
+        PowerReason reason;
+        void (*apply)(PowerInputs&);
+    };
+    const Trigger triggers[] = {
+        {"temperatura perto do amarelo", PowerReason::Threshold,
+         [](PowerInputs& in) { in.temperature = TEMP_YELLOW - 0.5f * POWER_NEAR_TEMPERATURE; }},
+        {"pico de vibração perto do amarelo", PowerReason::Threshold,
+         [](PowerInputs& in) { in.peakMagnitude = ACCEL_YELLOW - 0.5f * POWER_NEAR_ACCEL; }},
+        {"subida rápida de temperatura", PowerReason::Trend,
+         [](PowerInputs& in) { in.temperature += 2 * POWER_TREND_TEMPERATURE; }},
+        {"alerta amarelo", PowerReason::Alert,
+         [](PowerInputs& in) { in.level = AlertLevel::Yellow; }},
+    };
+    for (const Trigger& trigger : triggers) {
+        power.begin(0, true);
+        Run r;
+        advance(power, r, SAMPLING_TIERS[2].calmMs + 1000, calm);
+        bool wasIdle = tierOf(power) == 2;
+        PowerInputs in = calm(r.t);
+        trigger.apply(in);
+        power.update(r.t, in);
+        PowerSnapshot t = power.snapshot(r.t);
+        bool raised = wasIdle && t.tier == 0 && t.reason == trigger.reason;
+        printf("power: %-34s -> %s (%s)\n", trigger.name, SAMPLING_TIERS[t.tier].name,
+               POWER_REASON_NAMES[(size_t)t.reason]);
+        ok &= raised;
+    }
+
+    // Pisos: clientes no WebSocket e leitura a menos de duas faixas do limiar
+    power.begin(0, true);
+    Run watched;
+    advance(power, watched, SAMPLING_TIERS[2].calmMs * 2, [](uint32_t t) {
+        PowerInputs in = calm(t);
+        in.watched = true;
+        return in;
+    });
+    uint32_t watchedTier = tierOf(power);
+    power.begin(0, true);
+    Run warm;
+    advance(power, warm, SAMPLING_TIERS[2].calmMs * 2, [](uint32_t t) {
+        PowerInputs in = calm(t);
+        in.temperature = TEMP_YELLOW - 1.5f * POWER_NEAR_TEMPERATURE;
+        return in;
+    });
+    uint32_t warmTier = tierOf(power);
+    printf("power: piso com cliente no WebSocket %s, a %.1f C do amarelo %s\n",
+           SAMPLING_TIERS[watchedTier].name, 1.5f * POWER_NEAR_TEMPERATURE,
+           SAMPLING_TIERS[warmTier].name);
+    ok &= watchedTier == 1 && warmTier == 1;
+
+    // Sem adaptação: nível ativo, sem light sleep nem modem sleep
+    power.setAdaptive(false);
+    power.update(warm.t, calm(warm.t));
+    hal = nativeHalCounters();
+    bool fixed = tierOf(power) == 0 && !hal.lightSleep && !hal.modemSleep;
+    printf("power: amostragem fixa no nível ativo: %s\n", fixed ? "sim" : "não");
+    ok &= fixed;
+
+    printf("power: %.0f ns por avaliação, gerenciador com %u bytes\n", ns, (unsigned)sizeof(PowerManager));
+    printf("%s\n", ok ? "OK" : "FALHA: escolha do nível de amostragem fora do esperado");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// Teste de estresse do estado publicado por versões: escritores e leitores
+// em threads concorrentes sobre Seqlock<SensorOverrides>, como a API (write),
+// a linha do tempo (update) e as tarefas de aquisição (read). Cada versão
+// gravada deriva todos os campos de um único contador, então qualquer mistura
+// de duas versões numa leitura é detectada. A mesma verificação sobre uma
+// cópia campo a campo sem sequência mostra que o teste enxerga rasgos.
+
+#include "native/bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "seqlock.h"
+#include "system_state.h"
+
+namespace {
+
+const uint32_t COUNTER_MASK = (1u << 20) - 1;   // Exato em float
+
+SensorOverrides overridesFor(uint32_t k) {
+    k &= COUNTER_MASK;
+    SensorOverrides o;
+    bool on = k & 1;
+    o.dht22_override = on;
+    o.ldr_override = on;
+    o.mpu6050_override = on;
+    o.temperature_override = (float)k;
+    o.humidity_override = k + 0.5f;
+    o.ldr_raw_override = (int)k;
+    o.accel_x_override = (float)k * 2;
+    o.accel_y_override = -(float)k;
+    o.accel_z_override = k + 0.25f;
+    return o;
+}
+
+bool consistent(const SensorOverrides& o) {
+    SensorOverrides e = overridesFor((uint32_t)o.ldr_raw_override);
+    return o.dht22_override == e.dht22_override && o.ldr_override == e.ldr_override &&
+           o.mpu6050_override == e.mpu6050_override &&
+           o.temperature_override == e.temperature_override &&
+           o.humidity_override == e.humidity_override && o.ldr_raw_override == e.ldr_raw_override &&
+           o.accel_x_override == e.accel_x_override && o.accel_y_override == e.accel_y_override &&
+           o.accel_z_override == e.accel_z_override;
+}
+
+// Controle: as mesmas palavras atômicas, sem número de sequência
+struct UnversionedBox {
+    static const size_t WORDS = (sizeof(SensorOverrides) + 3) / 4;
+    std::atomic<uint32_t> data[WORDS] = {};
+
+    void write(const SensorOverrides& value) {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(value));
+        for (size_t i = 0; i < WORDS; i++) data[i].store(words[i], std::memory_order_relaxed);
+    }
+    SensorOverrides read() const {
+        uint32_t words[WORDS];
+        for (size_t i = 0; i < WORDS; i++) words[i] = data[i].load(std::memory_order_relaxed);
+        SensorOverrides value;
+        memcpy((void*)&value, words, sizeof(value));
+        return value;
+    }
+};
+
+struct ReaderStats {
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t versionRegressions = 0;
+};
+
+typedef std::chrono::steady_clock StressClock;
+
+template <typename Box, typename Write, typename Read>
+void runStress(Box& box, Write write, Read read, double seconds,
+               uint64_t& writes, std::vector<ReaderStats>& readers) {
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> counter(1);
+    std::atomic<uint64_t> writeCount(0);
+    std::vector<std::thread> threads;
+    
+    for (int w = 0; w < 2; w++) {
+        threads.emplace_back([&, w] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                write(box, w, counter.fetch_add(1, std::memory_order_relaxed));
+                writeCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (ReaderStats& stats : readers) {
+        threads.emplace_back([&] {
+            uint32_t lastVersion = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                SensorOverrides o;
+                uint32_t version = read(box, o);
+                stats.reads++;
+                if (!consistent(o)) stats.torn++;
+                if (version < lastVersion) stats.versionRegressions++;
+                lastVersion = version;
+            }
+        });
+    }
+    
+    StressClock::time_point end = StressClock::now() +
+        std::chrono::duration_cast<StressClock::duration>(std::chrono::duration<double>(seconds));
+    while (StressClock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    stop = true;
+    for (std::thread& t : threads) t.join();
+    writes = writeCount;
+}
+
+}  // namespace
+
+int benchSeqlock() {
+    const double seconds = 1.0;
+    const int readerCount = 2;
+    
+    // Um escritor grava o valor inteiro (API), o outro altera o valor atual
+    // (linha do tempo); os dois produzem versões coerentes
+    Seqlock<SensorOverrides> overrides(overridesFor(0));
+    overrides.begin();
+    std::vector<ReaderStats> versioned(readerCount);
+    uint64_t versionedWrites;
+    runStress(overrides,
+              [](Seqlock<SensorOverrides>& box, int writer, uint32_t k) {
+                  if (writer == 0) {
+                      box.write(overridesFor(k));
+                  } else {
+                      box.update([k](SensorOverrides& o) {
+                          o = overridesFor(k);
+                          return true;
+                      });
+                  }
+              },
+              [](Seqlock<SensorOverrides>& box, SensorOverrides& o) { return box.read(o); },
+              seconds, versionedWrites, versioned);
+    
+    UnversionedBox unversioned;
+    unversioned.write(overridesFor(0));
+    std::vector<ReaderStats> control(readerCount);
+    uint64_t controlWrites;
+    runStress(unversioned,
+              [](UnversionedBox& box, int, uint32_t k) { box.write(overridesFor(k)); },
+              [](UnversionedBox& box, SensorOverrides& o) { o = box.read(); return 0u; },
+              seconds, controlWrites, control);
+    
+    uint64_t reads = 0, torn = 0, regressions = 0;
+    for (const ReaderStats& s : versioned) {
+        reads += s.reads;
+        torn += s.torn;
+        regressions += s.versionRegressions;
+    }
+    uint64_t controlReads = 0, controlTorn = 0;
+    for (const ReaderStats& s : control) {
+        controlReads += s.reads;
+        controlTorn += s.torn;
+    }
+    
+    printf("seqlock: %d escritores, %d leitores, %.1f s (%u núcleos)\n", 2, readerCount, seconds,
+           std::thread::hardware_concurrency());
+    printf("  com versão : %llu gravações, %llu leituras, %llu rasgadas, %llu versões fora de ordem\n",
+           (unsigned long long)versionedWrites, (unsigned long long)reads,
+           (unsigned long long)torn, (unsigned long long)regressions);
+    printf("  sem versão : %llu gravações, %llu leituras, %llu rasgadas (controle)\n",
+           (unsigned long long)controlWrites, (unsigned long long)controlReads,
+           (unsigned long long)controlTorn);
+    if (controlTorn == 0) {
+        printf("  aviso: o controle não rasgou nenhuma leitura; o teste só é conclusivo com mais de um núcleo\n");
+    }
+    
+    bool ok = reads > 0 && versionedWrites > 0 && torn == 0 && regressions == 0;
+    printf("%s\n", ok ? "OK" : "FALHA: leitura inconsistente do estado publicado");
+    return ok ? 0 : 1;
+}
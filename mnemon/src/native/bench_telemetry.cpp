@@ -0,0 +1,155 @@
+// Benchmark e verificação de compatibilidade do codificador de telemetria
+// contra o caminho anterior baseado em ArduinoJson (DOM + serializeJson)
+
+#include <ArduinoJson.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "native/alloc_counter.h"
+#include "native/bench.h"
+#include "system_state.h"
+#include "telemetry.h"
+
+// Reprodução fiel do sendJSONData() anterior, escrevendo em buffer
+static size_t legacyTelemetry(const Snapshot& snapshot, uint32_t nowMs, char* output, size_t capacity) {
+    JsonDocument doc;
+    
+    char timestamp[32];
+    formatTimestamp(nowMs, timestamp, sizeof(timestamp));
+    
+    doc["timestamp"] = timestamp;
+    doc["scenario"] = scenarioName(currentScenario);
+    doc["step"] = (int)testStep;
+    doc["elapsed_seconds"] = (unsigned long)(nowMs / 1000);
+    
+    JsonObject sensors = doc["sensors"].to<JsonObject>();
+    
+    JsonObject dht22 = sensors["dht22"].to<JsonObject>();
+    dht22["temperature"] = round(snapshot.temperature * 10) / 10.0;
+    dht22["humidity"] = round(snapshot.humidity * 10) / 10.0;
+    
+    JsonObject ldr = sensors["ldr"].to<JsonObject>();
+    ldr["raw"] = snapshot.ldrRaw;
+    ldr["lux"] = round(snapshot.lux);
+    
+    JsonObject mpu6050 = sensors["mpu6050"].to<JsonObject>();
+    mpu6050["accelX"] = round(snapshot.accelX * 100) / 100.0;
+    mpu6050["accelY"] = round(snapshot.accelY * 100) / 100.0;
+    mpu6050["accelZ"] = round(snapshot.accelZ * 100) / 100.0;
+    
+    const VibrationFeatures& features = snapshot.vibration;
+    JsonObject vibration = mpu6050["vibration"].to<JsonObject>();
+    vibration["rms"] = round(features.rmsTotal * 1000) / 1000.0;
+    vibration["peak"] = round(features.peakMagnitude * 100) / 100.0;
+    vibration["p2p"] = round(features.magnitude.peakToPeak * 1000) / 1000.0;
+    vibration["crest"] = round(features.magnitude.crestFactor * 100) / 100.0;
+    vibration["kurtosis"] = round(features.magnitude.kurtosis * 100) / 100.0;
+    
+    const SpectralResult& spectrum = snapshot.spectrum;
+    JsonObject spectral = mpu6050["spectrum"].to<JsonObject>();
+    JsonArray dominantHz = spectral["dominant_hz"].to<JsonArray>();
+    JsonArray dominantG = spectral["dominant_g"].to<JsonArray>();
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) {
+        dominantHz.add(round(spectrum.peaks[p].frequencyHz * 10) / 10.0);
+        dominantG.add(round(spectrum.peaks[p].amplitude * 1000) / 1000.0);
+    }
+    JsonObject bands = spectral["bands"].to<JsonObject>();
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        bands[SPECTRAL_BANDS[b].name] = round(spectrum.bandRms[b] * 1000) / 1000.0;
+    }
+    
+    JsonObject actuators = doc["actuators"].to<JsonObject>();
+    const AlertLevelInfo& level = alertLevelInfo(snapshot.alertLevel);
+    actuators["rgb_led"] = ledColorInfo(level.color).name;
+    actuators["buzzer"] = level.buzzer ? "on" : "off";
+    
+    doc["alert_level"] = level.name;
+    
+    return serializeJson(doc, output, capacity);
+}
+
+static Snapshot sampleSnapshot(uint32_t i) {
+    // Valores variados: negativos, meios de arredondamento, zero, NaN e saturação
+    static const float temps[] = {25.0f, 25.05f, -3.25f, 44.95f, NAN};
+    static const float accels[] = {0.0f, -0.005f, 1.0f, 1.755f, -1.999f};
+    static const int ldrs[] = {1001, 0, 4095, 2048, 50};
+    
+    Snapshot s = {};
+    s.temperature = temps[i % 5];
+    s.humidity = 60.0f + (i % 7) * 5.55f;
+    s.ldrRaw = ldrs[i % 5];
+    s.lux = s.ldrRaw == 0 ? INFINITY : 20.0f + i * 13.7f;
+    s.accelX = accels[i % 5];
+    s.accelY = accels[(i + 1) % 5];
+    s.accelZ = accels[(i + 2) % 5];
+    s.vibration.rmsTotal = 0.0123f * (i % 9);
+    s.vibration.peakMagnitude = 1.0f + 0.01f * (i % 50);
+    s.vibration.magnitude.peakToPeak = 0.0005f * i;
+    s.vibration.magnitude.crestFactor = 1.414f;
+    s.vibration.magnitude.kurtosis = 3.0f + 0.1f * (i % 3);
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) {
+        s.spectrum.peaks[p].frequencyHz = 25.0f * (p + 1) + 0.37f * i;
+        s.spectrum.peaks[p].amplitude = 0.05f / (p + 1);
+    }
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        s.spectrum.bandRms[b] = 0.01f * b + 0.0004f * i;
+    }
+    s.alertLevel = (AlertLevel)(i % 3);
+    return s;
+}
+
+int benchTelemetry() {
+    typedef std::chrono::steady_clock Clock;
+    static char fast[TELEMETRY_BUFFER_SIZE];
+    static char legacy[TELEMETRY_BUFFER_SIZE];
+    
+    // Compatibilidade byte a byte com o esquema anterior
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < 500; i++) {
+        Snapshot s = sampleSnapshot(i);
+        uint32_t now = 1000 * i + 17;
+        size_t a = encodeTelemetry(s, now, fast, sizeof(fast));
+        size_t b = legacyTelemetry(s, now, legacy, sizeof(legacy));
+        if (a != b || memcmp(fast, legacy, a) != 0) {
+            if (mismatches++ == 0) {
+                printf("  divergência no registro %u:\n  novo:   %.*s\n  antigo: %.*s\n",
+                       i, (int)a, fast, (int)b, legacy);
+            }
+        }
+    }
+    
+    const uint32_t records = 100000;
+    Snapshot s = sampleSnapshot(3);
+    size_t bytes = 0;
+    
+    uint64_t allocBefore = allocationCount();
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < records; i++) {
+        bytes += encodeTelemetry(s, i * 1000, fast, sizeof(fast));
+    }
+    double fastNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    uint64_t fastAllocs = allocationCount() - allocBefore;
+    
+    allocBefore = allocationCount();
+    start = Clock::now();
+    size_t legacyBytes = 0;
+    for (uint32_t i = 0; i < records; i++) {
+        legacyBytes += legacyTelemetry(s, i * 1000, legacy, sizeof(legacy));
+    }
+    double legacyNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    uint64_t legacyAllocs = allocationCount() - allocBefore;
+    
+    printf("telemetry: %zu bytes/registro\n", bytes / records);
+    printf("  JsonWriter : %7.0f ns/registro, %6.1f MB/s, %.2f alocações/registro\n",
+           fastNs / records, bytes / fastNs * 1e3, (double)fastAllocs / records);
+    printf("  ArduinoJson: %7.0f ns/registro, %6.1f MB/s, %.2f alocações/registro\n",
+           legacyNs / records, legacyBytes / legacyNs * 1e3, (double)legacyAllocs / records);
+    printf("  compatibilidade: %u divergências em 500 registros\n", mismatches);
+    
+    bool ok = mismatches == 0 && fastAllocs == 0;
+    printf("%s\n", ok ? "OK" : "FALHA: saída incompatível ou com alocações");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,620 @@
+// Uplink store-and-forward (uplink.h) contra um collector de mentira num
+// socket local.
+//
+// 1. Fila em flash (BatchSpill) sobre o emulador: ordem FIFO através de
+//    reinícios, anel cheio descartando os mais antigos e cortes de energia
+//    em pontos aleatórios de gravações e confirmações.
+// 2. O Uplink de verdade, com relógio simulado, falando TCP com uma thread
+//    que faz o papel do katabase-ingest (hello, cabeçalho, CRC, gzip,
+//    quadros, ACK, descarte dos repetidos por tempo): enlace normal, queda
+//    de 30 min com a fila indo para a flash, dreno limitado pela taxa, ACK
+//    perdido, queda longa com descarte e reinício com lotes na flash. No
+//    fim todo registro produzido tem de estar no collector ou contado como
+//    descartado.
+
+#include "native/bench.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "crc32.h"
+#include "gzip.h"
+#include "hal.h"
+#include "native/flash_emulator.h"
+#include "telemetry_frame.h"
+#include "uplink.h"
+#include "uplink_batch.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t SPILL_SECTORS = 8;
+const uint32_t STEP_MS = 100;           // loop()
+const uint32_t RECORD_MS = OUTPUT_PERIOD_MS;
+
+// --- 1. BatchSpill ---
+
+// Lote sintético: o id vai em sealMs e determina tamanho e conteúdo
+QueuedBatch makeBatch(uint32_t id, uint8_t* body) {
+    QueuedBatch batch = {};
+    batch.length = (uint16_t)(100 + ((id * 2654435761u) >> 16) % (UPLINK_BODY_MAX - 100));
+    batch.records = (uint16_t)(1 + id % UPLINK_BATCH_RECORDS);
+    batch.sealMs = id;
+    uint32_t x = id * 2654435761u;
+    for (uint32_t i = 0; i < batch.length; i++) {
+        x = x * 1103515245u + 12345u;
+        body[i] = (uint8_t)(x >> 16);
+    }
+    batch.crc = crc32(body, batch.length);
+    return batch;
+}
+
+bool benchSpill() {
+    static uint8_t body[UPLINK_BODY_MAX];
+    static uint8_t expected[UPLINK_BODY_MAX];
+    FlashEmulator& flash = nativeFlash();
+    static BatchSpill spill;
+    uint32_t dropped, droppedRecords;
+    bool ok = true;
+
+    // FIFO com confirmações intercaladas e um reinício no meio
+    flash.open(nullptr, SPILL_SECTORS * FLASH_SECTOR_SIZE);
+    spill.begin(0, SPILL_SECTORS);
+    uint32_t nextPush = 1, nextPop = 1, errors = 0;
+    for (uint32_t round = 0; round < 200; round++) {
+        for (uint32_t i = 0; i < 3; i++, nextPush++) {
+            QueuedBatch batch = makeBatch(nextPush, body);
+            spill.push(batch, body, batch.length, nullptr, 0, dropped, droppedRecords);
+            errors += dropped;
+        }
+        if (round == 60) {
+            spill.begin(0, SPILL_SECTORS);
+            errors += spill.stats().recovered != nextPush - nextPop;
+        }
+        // Enche até ~25 lotes (~5 setores) e depois oscila em torno disso
+        uint32_t pops = round < 25 ? 2 : round % 2 ? 4 : 2;
+        for (uint32_t i = 0; i < pops && spill.count() > 0; i++, nextPop++) {
+            QueuedBatch batch;
+            makeBatch(nextPop, expected);
+            errors += !spill.front(batch, body) || batch.sealMs != nextPop ||
+                      memcmp(body, expected, batch.length) != 0;
+            spill.pop();
+        }
+    }
+    bool fifoOk = errors == 0 && spill.count() == nextPush - nextPop;
+    printf("uplink: fila em flash, %u lotes em %u setores com um reinício: %s\n",
+           nextPush - 1, SPILL_SECTORS, fifoOk ? "ordem e conteúdo conferem" : "FALHA");
+    ok = ok && fifoOk;
+
+    // Anel cheio: entram 500 lotes sem confirmação; sobram os mais novos
+    flash.open(nullptr, SPILL_SECTORS * FLASH_SECTOR_SIZE);
+    spill.begin(0, SPILL_SECTORS);
+    uint32_t lostBatches = 0;
+    for (uint32_t id = 1; id <= 500; id++) {
+        QueuedBatch batch = makeBatch(id, body);
+        // Corpo em duas partes, como quando o anel da RAM dá a volta
+        spill.push(batch, body, batch.length / 2, body + batch.length / 2,
+                   batch.length - batch.length / 2, dropped, droppedRecords);
+        lostBatches += dropped;
+    }
+    QueuedBatch front;
+    bool fullOk = spill.front(front, body) && front.sealMs == lostBatches + 1 &&
+                  lostBatches + spill.count() == 500;
+    uint32_t last = 0;
+    while (spill.count() > 0 && spill.front(front, body)) {
+        fullOk = fullOk && front.sealMs == last + 1 + (last == 0 ? lostBatches : 0);
+        last = front.sealMs;
+        spill.pop();
+    }
+    fullOk = fullOk && last == 500;
+    printf("  anel cheio: 500 lotes, %u descartados do início, %u pendentes até o fim: %s\n",
+           lostBatches, 500 - lostBatches, fullOk ? "OK" : "FALHA");
+    ok = ok && fullOk;
+
+    // Cortes de energia em gravações, apagamentos e confirmações; após cada
+    // reinício a fila é drenada e tem de seguir em ordem, perdendo no
+    // máximo o lote que estava sendo gravado e repetindo no máximo o que
+    // estava sendo confirmado
+    srand(11);
+    flash.open(nullptr, SPILL_SECTORS * FLASH_SECTOR_SIZE);
+    spill.begin(0, SPILL_SECTORS);
+    uint32_t trials = 300, consistent = 0, corrupt = 0, repeated = 0;
+    uint32_t pushed = 0;            // Último id com a gravação concluída
+    uint32_t confirmed = 0;         // Último id com a confirmação concluída
+    nextPush = 1;
+    for (uint32_t t = 0; t < trials; t++) {
+        flash.powerLossAfter(rand() % 8000);
+        bool cutInPop = false;
+        while (!flash.poweredOff()) {
+            if (spill.count() < 20 && rand() % 2 == 0) {
+                QueuedBatch batch = makeBatch(nextPush, body);
+                spill.push(batch, body, batch.length, nullptr, 0, dropped, droppedRecords);
+                if (!flash.poweredOff()) {
+                    pushed = nextPush;
+                }
+                nextPush++;
+            } else if (spill.count() > 0) {
+                QueuedBatch batch;
+                spill.front(batch, nullptr);
+                spill.pop();
+                if (!flash.poweredOff()) {
+                    confirmed = batch.sealMs;
+                } else {
+                    cutInPop = true;
+                }
+            }
+        }
+        flash.powerOn();
+        spill.begin(0, SPILL_SECTORS);
+
+        // Frente: o lote seguinte ao último confirmado, ou o outro depois
+        // dele se o corte pegou a confirmação já pela metade
+        bool trialOk = true;
+        QueuedBatch batch;
+        uint32_t expect = confirmed + 1;
+        if (cutInPop && spill.front(batch, nullptr) && batch.sealMs == confirmed + 2) {
+            expect = confirmed + 2;
+        } else if (cutInPop) {
+            repeated++;
+        }
+        uint32_t lastId = expect - 1;
+        while (spill.count() > 0) {
+            if (!spill.front(batch, body)) {
+                // Corpo rasgado: só pode ser o último, o da gravação cortada
+                trialOk = trialOk && spill.count() == 1;
+                corrupt++;
+                spill.pop();
+                continue;
+            }
+            trialOk = trialOk && batch.sealMs == expect;
+            lastId = batch.sealMs;
+            expect = lastId + 1;
+            spill.pop();
+        }
+        // Tudo o que foi gravado por inteiro voltou (o lote cortado pode ter
+        // chegado ao fim da gravação antes do corte)
+        trialOk = trialOk && lastId >= pushed && lastId < nextPush;
+        consistent += trialOk;
+        confirmed = pushed = nextPush - 1;
+    }
+    printf("  %u cortes de energia: %u recuperações consistentes, %u lotes rasgados descartados, "
+           "%u confirmações cortadas refeitas\n", trials, consistent, corrupt, repeated);
+    ok = ok && consistent == trials;
+
+    flash.close();
+    return ok;
+}
+
+// --- 2. Collector de mentira ---
+
+// Faz o papel do katabase-ingest numa thread: uma conexão por vez, lotes
+// conferidos e decodificados, registros repetidos (tempo não posterior ao
+// último do mesmo boot) descartados e contados. Fora do ar, fecha o socket
+// de escuta e a conexão, e o dispositivo recebe conexão recusada.
+class StandInCollector {
+public:
+    bool start() {
+        listenFd = openListener(0);
+        if (listenFd < 0) {
+            return false;
+        }
+        struct sockaddr_in address;
+        socklen_t length = sizeof(address);
+        getsockname(listenFd, (struct sockaddr*)&address, &length);
+        port = ntohs(address.sin_port);
+        running = true;
+        thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        thread.join();
+        closeClient();
+        if (listenFd >= 0) {
+            close(listenFd);
+        }
+    }
+
+    // Só retorna com a mudança aplicada pela thread: o relógio simulado
+    // corre muito mais rápido que o real
+    void setOnline(bool value) {
+        online = value;
+        while (applied != value) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    uint16_t port = 0;
+    std::atomic<bool> online{true};
+    std::atomic<uint32_t> loseAcks{0};      // ACKs a engolir (lote gravado, resposta perdida)
+    std::atomic<uint32_t> unacked{0};       // Registros dos lotes sem ACK
+    std::atomic<uint32_t> connections{0};
+    std::atomic<uint32_t> batches{0};
+    std::atomic<uint32_t> gzipBatches{0};
+    std::atomic<uint32_t> badBatches{0};
+    std::atomic<uint32_t> records{0};       // Novos
+    std::atomic<uint32_t> duplicates{0};
+    std::atomic<uint32_t> gaps{0};         // Saltos no tempo (lotes descartados)
+
+private:
+    static int openListener(uint16_t listenPort) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(listenPort);
+        if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 4) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void closeClient() {
+        if (clientFd >= 0) {
+            close(clientFd);
+            clientFd = -1;
+        }
+    }
+
+    void run() {
+        static uint8_t buffer[BATCH_HEADER_SIZE + BATCH_MAX_BODY];
+        size_t used = 0;
+        while (running) {
+            if (!online) {
+                closeClient();
+                if (listenFd >= 0) {
+                    close(listenFd);
+                    listenFd = -1;
+                }
+                applied = false;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+            if (listenFd < 0) {
+                listenFd = openListener(port);
+            }
+            applied = listenFd >= 0;
+            if (clientFd < 0) {
+                struct pollfd p = {listenFd, POLLIN, 0};
+                if (poll(&p, 1, 1) == 1) {
+                    clientFd = accept(listenFd, nullptr, nullptr);
+                    used = 0;
+                    helloDone = false;
+                    connections++;
+                }
+                continue;
+            }
+            struct pollfd p = {clientFd, POLLIN, 0};
+            if (poll(&p, 1, 1) != 1) {
+                continue;
+            }
+            ssize_t n = recv(clientFd, buffer + used, sizeof(buffer) - used, 0);
+            if (n <= 0) {
+                closeClient();
+                continue;
+            }
+            used += n;
+            size_t consumed = 0;
+            while (clientFd >= 0 && consume(buffer + consumed, used - consumed, consumed)) {
+            }
+            memmove(buffer, buffer + consumed, used - consumed);
+            used -= consumed;
+        }
+    }
+
+    // Um hello ou um lote completo no início de data; false se faltar dado
+    bool consume(const uint8_t* data, size_t length, size_t& consumed) {
+        if (!helloDone) {
+            const uint8_t* end = (const uint8_t*)memchr(data, '\n', length);
+            if (end == nullptr) {
+                return false;
+            }
+            char line[96];
+            char device[UPLINK_DEVICE_MAX];
+            unsigned long boot = 0;
+            size_t lineLength = std::min((size_t)(end - data), sizeof(line) - 1);
+            memcpy(line, data, lineLength);
+            line[lineLength] = '\0';
+            if (sscanf(line, "KATABASE %31s BATCH %lx", device, &boot) != 2) {
+                closeClient();
+                return false;
+            }
+            if (boot != bootId) {
+                bootId = boot;
+                lastMs = 0;
+                haveLast = false;
+            }
+            helloDone = true;
+            consumed += end - data + 1;
+            return true;
+        }
+        BatchHeader header;
+        if (length < BATCH_HEADER_SIZE) {
+            return false;
+        }
+        if (!decodeBatchHeader(data, header)) {
+            badBatches++;
+            closeClient();
+            return false;
+        }
+        if (length < BATCH_HEADER_SIZE + header.length) {
+            return false;
+        }
+        const uint8_t* body = data + BATCH_HEADER_SIZE;
+        consumed += BATCH_HEADER_SIZE + header.length;
+        if (!store(header, body)) {
+            badBatches++;
+            closeClient();
+            return false;
+        }
+        batches++;
+        if (loseAcks > 0) {
+            loseAcks--;
+            unacked += header.records;
+            return true;
+        }
+        char ack[24];
+        int n = snprintf(ack, sizeof(ack), "ACK %u\n", header.id);
+        send(clientFd, ack, n, MSG_NOSIGNAL);
+        return true;
+    }
+
+    bool store(const BatchHeader& header, const uint8_t* body) {
+        static uint8_t frames[UPLINK_BODY_MAX];
+        static GzipDecoder decoder;
+        if (crc32(body, header.length) != header.crc) {
+            return false;
+        }
+        size_t length = header.length;
+        if (header.encoding == BatchEncoding::Gzip) {
+            gzipBatches++;
+            if (!decoder.decode(body, header.length, frames, sizeof(frames), length)) {
+                return false;
+            }
+        } else {
+            memcpy(frames, body, length);
+        }
+        // Quadros delimitados por zeros
+        uint32_t count = 0;
+        size_t start = 0;
+        for (size_t i = 0; i <= length; i++) {
+            if (i < length && frames[i] != 0) {
+                continue;
+            }
+            if (i > start) {
+                uint8_t payload[FRAME_MAX_PAYLOAD];
+                DecodedFrame frame;
+                size_t n = cobsDecode(frames + start, i - start, payload);
+                if (n == 0 || !decodeFrame(payload, n, frame) || frame.type != FrameType::Environment) {
+                    return false;
+                }
+                count++;
+                if (haveLast && frame.timestampMs <= lastMs) {
+                    duplicates++;
+                } else {
+                    gaps += haveLast && frame.timestampMs != lastMs + RECORD_MS;
+                    lastMs = frame.timestampMs;
+                    haveLast = true;
+                    records++;
+                }
+            }
+            start = i + 1;
+        }
+        return count == header.records;
+    }
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> applied{true};
+    int listenFd = -1;
+    int clientFd = -1;
+    bool helloDone = false;
+    unsigned long bootId = 0;
+    uint32_t lastMs = 0;
+    bool haveLast = false;
+};
+
+}  // namespace
+
+namespace {
+
+EnvironmentRecord makeRecord(uint32_t timeMs) {
+    EnvironmentRecord record = {};
+    uint32_t i = timeMs / RECORD_MS;
+    record.timestampMs = timeMs;
+    record.temperature = 24.0f + 0.1f * (i % 17);
+    record.humidity = 55.0f + 0.3f * (i % 11);
+    record.lux = 300.0f + i % 40;
+    record.ldrRaw = (uint16_t)(1800 + i % 40);
+    record.step = (uint8_t)(i % 5);
+    record.vibrationRms = 0.03f + 0.001f * (i % 9);
+    record.peakMagnitude = 1.05f;
+    return record;
+}
+
+// O loop() com relógio simulado: um registro a cada RECORD_MS e um step a
+// cada STEP_MS. Com um lote em voo, dá até 5 ms reais à thread do collector
+// para responder antes de avançar o relógio.
+struct Device {
+    Uplink* up;
+    StandInCollector* collector;
+    uint32_t nowMs;
+    uint32_t produced;
+
+    void run(uint32_t ms, bool produce) {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += STEP_MS) {
+            nowMs += STEP_MS;
+            if (produce && nowMs % RECORD_MS == 0) {
+                up->record(makeRecord(nowMs));
+                produced++;
+            }
+            up->step(nowMs);
+            Clock::time_point start = Clock::now();
+            while (up->snapshot().inFlight && collector->online &&
+                   Clock::now() - start < std::chrono::milliseconds(5)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+                up->step(nowMs);
+            }
+        }
+    }
+
+    uint32_t queued() const {
+        UplinkSnapshot s = up->snapshot();
+        return s.ramBatches + s.spill.batches;
+    }
+
+    // Até a fila esvaziar (ou maxMs); retorna o tempo gasto
+    uint32_t drain(uint32_t maxMs, bool produce) {
+        uint32_t start = nowMs;
+        while ((queued() > 0 || up->snapshot().inFlight) && nowMs - start < maxMs) {
+            run(STEP_MS, produce);
+        }
+        return nowMs - start;
+    }
+};
+
+}  // namespace
+
+int benchUplink() {
+    bool ok = benchSpill();
+
+    StandInCollector collector;
+    if (!collector.start()) {
+        printf("FALHA: collector local não abriu\n");
+        return 1;
+    }
+    FlashEmulator& flash = nativeFlash();
+    flash.open(nullptr, SPILL_SECTORS * FLASH_SECTOR_SIZE);
+    static Uplink up;
+    up.begin(0, SPILL_SECTORS);
+    up.configure("127.0.0.1", collector.port, "bench");
+    Device device = {&up, &collector, 0, 0};
+
+    // 1. Enlace no ar: cada lote fechado é confirmado
+    device.run(10 * 60 * 1000, true);
+    UplinkSnapshot s = up.snapshot();
+    bool linkOk = s.acked == s.batches && device.queued() == 0 &&
+                  collector.records == s.batches * UPLINK_BATCH_RECORDS;
+    printf("uplink: 10 min no ar: %u registros em %u lotes, %.1f registros e %.0f bytes por lote "
+           "(%.0f%% dos quadros, %u em gzip), %u com ACK\n",
+           s.records, s.batches, (double)s.records / s.batches, (double)s.batchBytes / s.batches,
+           100.0 * s.batchBytes / s.rawBytes, s.gzipBatches, s.acked);
+    ok = ok && linkOk;
+
+    // 2. Queda de 30 min: a fila passa da RAM para a flash, reconexão em backoff
+    collector.setOnline(false);
+    uint32_t failuresBefore = s.connectFailures;
+    device.run(30 * 60 * 1000, true);
+    s = up.snapshot();
+    uint32_t attempts = s.connectFailures - failuresBefore;
+    bool outageOk = s.spill.batches > 0 && s.droppedBatches == 0 && attempts >= 25 && attempts <= 60;
+    printf("  queda de 30 min: fila com %u lotes na RAM (%u bytes) e %u na flash, "
+           "%u tentativas de conexão em backoff\n",
+           s.ramBatches, s.ramBytes, s.spill.batches, attempts);
+    ok = ok && outageOk;
+
+    // 3. Volta: reconexão no próximo intervalo do backoff e dreno limitado
+    // por UPLINK_DRAIN_BYTES_PER_S, em ordem
+    collector.setOnline(true);
+    uint32_t offlineAt = device.nowMs;
+    while (!up.snapshot().connected && device.nowMs - offlineAt < 2 * UPLINK_RETRY_MAX_MS) {
+        device.run(STEP_MS, true);
+    }
+    uint32_t reconnectMs = device.nowMs - offlineAt;
+    s = up.snapshot();
+    uint64_t bytesBefore = s.sentBytes;
+    uint32_t queuedBefore = device.queued();
+    uint32_t drainMs = device.drain(30 * 60 * 1000, true);
+    s = up.snapshot();
+    double drained = (double)(s.sentBytes - bytesBefore);
+    double seconds = drainMs / 1000.0;
+    // Tolerância: o balde cheio na reconexão e um lote acima do saldo
+    double allowed = UPLINK_DRAIN_BYTES_PER_S * (seconds + 1) + BATCH_HEADER_SIZE + UPLINK_BODY_MAX;
+    bool drainOk = device.queued() == 0 && reconnectMs <= UPLINK_RETRY_MAX_MS * 5 / 4 + STEP_MS &&
+                   drained <= allowed && drained >= 0.8 * UPLINK_DRAIN_BYTES_PER_S * (seconds - 1) &&
+                   collector.duplicates == 0 && collector.gaps == 0;
+    printf("  volta do enlace: reconexão em %.1f s, %u lotes drenados em %.1f s a %.0f bytes/s "
+           "(limite %u), sem repetidos nem saltos: %s; idade no ACK p50 %.0f s, max %.0f s\n",
+           reconnectMs / 1000.0, queuedBefore, seconds, drained / (seconds > 0 ? seconds : 1),
+           UPLINK_DRAIN_BYTES_PER_S, collector.duplicates == 0 && collector.gaps == 0 ? "sim" : "não",
+           s.ageMs.p50Us / 1000.0, s.ageMs.maxUs / 1000.0);
+    ok = ok && drainOk;
+
+    // 4. ACK perdido: o lote é reenviado após UPLINK_ACK_TIMEOUT_MS e o
+    // collector descarta os registros repetidos
+    uint32_t timeoutsBefore = s.ackTimeouts, resentBefore = s.resent;
+    collector.loseAcks = 1;
+    device.run(3 * 60 * 1000, true);
+    s = up.snapshot();
+    bool ackOk = s.ackTimeouts == timeoutsBefore + 1 && s.resent == resentBefore + 1 &&
+                 collector.duplicates == collector.unacked && collector.gaps == 0;
+    printf("  ACK perdido: %u timeout, %u reenvio, %u registros repetidos descartados no collector\n",
+           s.ackTimeouts - timeoutsBefore, s.resent - resentBefore, collector.duplicates.load());
+    ok = ok && ackOk;
+
+    // 5. Queda de 3 h: RAM e flash cheias, os lotes mais antigos são
+    // descartados; depois do dreno, todo registro está no collector ou
+    // contado como descartado
+    collector.setOnline(false);
+    device.run(3 * 3600 * 1000, true);
+    collector.setOnline(true);
+    device.drain(30 * 60 * 1000, true);
+    device.run(UPLINK_BATCH_MAX_AGE_MS + 10 * 1000, false);     // Fecha o lote aberto
+    device.drain(60 * 1000, false);
+    s = up.snapshot();
+    uint32_t accounted = collector.records + s.droppedRecords + s.overruns;
+    bool dropOk = s.droppedBatches > 0 && device.produced == s.records && accounted == device.produced &&
+                  collector.gaps == 1;
+    printf("  queda de 3 h: pico de %u lotes na fila, %u lotes (%u registros) descartados; "
+           "%u produzidos = %u no collector + %u descartados: %s\n",
+           s.peakBatches, s.droppedBatches, s.droppedRecords, device.produced,
+           collector.records.load(), s.droppedRecords, accounted == device.produced ? "sim" : "não");
+    ok = ok && dropOk;
+
+    // 6. Reinício com lotes na flash: a RAM se perde, a flash é enviada pela
+    // nova instância (outro boot id, o collector reinicia a deduplicação)
+    collector.setOnline(false);
+    uint32_t producedBefore = device.produced;
+    device.run(40 * 60 * 1000, true);
+    uint32_t flashBatches = up.snapshot().spill.batches;
+    static Uplink rebooted;
+    rebooted.begin(0, SPILL_SECTORS);
+    rebooted.configure("127.0.0.1", collector.port, "bench");
+    device.up = &rebooted;
+    uint32_t recordsBefore = collector.records, batchesBefore = collector.batches;
+    collector.setOnline(true);
+    device.drain(30 * 60 * 1000, false);
+    s = rebooted.snapshot();
+    uint32_t delivered = collector.records - recordsBefore;
+    bool rebootOk = flashBatches > 0 && s.spill.recovered == flashBatches &&
+                    collector.batches - batchesBefore == flashBatches && delivered > 0 &&
+                    collector.badBatches == 0 && device.queued() == 0;
+    printf("  reinício: %u lotes recuperados da flash e entregues (%u registros); "
+           "%u registros só na RAM perdidos\n",
+           s.spill.recovered, delivered, device.produced - producedBefore - delivered);
+    ok = ok && rebootOk;
+
+    collector.stop();
+    halUplinkClose();
+    flash.close();
+    printf("%s\n", ok ? "OK" : "FALHA: uplink perdeu, repetiu ou não drenou registros");
+    return ok ? 0 : 1;
+}
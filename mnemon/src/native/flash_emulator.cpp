@@ -0,0 +1,156 @@
+#include "native/flash_emulator.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "hal.h"
+
+static FlashEmulator flash;
+
+FlashEmulator& nativeFlash() {
+    return flash;
+}
+
+FlashEmulator::~FlashEmulator() {
+    close();
+}
+
+bool FlashEmulator::open(const char* path, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    size -= size % FLASH_SECTOR_SIZE;
+    image.assign(size, 0xFF);
+    erases.assign(size / FLASH_SECTOR_SIZE, 0);
+    armed = false;
+    powerLost = false;
+    readBytes = 0;
+    
+    if (path == nullptr || path[0] == '\0') {
+        return true;
+    }
+    fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    // Imagem existente de outro tamanho é descartada (chip "novo")
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (uint64_t)st.st_size == size &&
+        pread(fd, image.data(), size, 0) == (ssize_t)size) {
+        return true;
+    }
+    image.assign(size, 0xFF);
+    return ftruncate(fd, size) == 0 && pwrite(fd, image.data(), size, 0) == (ssize_t)size;
+}
+
+void FlashEmulator::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    image.clear();
+    erases.clear();
+}
+
+void FlashEmulator::persist(uint32_t offset, size_t len) {
+    if (fd >= 0 && len > 0) {
+        (void)!pwrite(fd, image.data() + offset, len, offset);
+    }
+}
+
+// Quantos bytes da operação chegam à flash antes do corte de energia
+size_t FlashEmulator::budget(size_t len) {
+    if (powerLost) {
+        return 0;
+    }
+    if (!armed) {
+        return len;
+    }
+    if (remaining >= len) {
+        remaining -= len;
+        return len;
+    }
+    size_t allowed = remaining;
+    remaining = 0;
+    armed = false;
+    powerLost = true;
+    return allowed;
+}
+
+bool FlashEmulator::read(uint32_t offset, void* data, size_t len) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if ((uint64_t)offset + len > image.size()) {
+        return false;
+    }
+    memcpy(data, image.data() + offset, len);
+    readBytes += len;
+    return true;
+}
+
+bool FlashEmulator::write(uint32_t offset, const void* data, size_t len) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if ((uint64_t)offset + len > image.size()) {
+        return false;
+    }
+    size_t allowed = budget(len);
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < allowed; i++) {
+        image[offset + i] &= bytes[i];
+    }
+    persist(offset, allowed);
+    return allowed == len;
+}
+
+bool FlashEmulator::eraseSector(uint32_t offset) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (offset % FLASH_SECTOR_SIZE != 0 || offset >= image.size()) {
+        return false;
+    }
+    size_t allowed = budget(FLASH_SECTOR_SIZE);
+    if (allowed > 0) {
+        erases[offset / FLASH_SECTOR_SIZE]++;
+    }
+    memset(image.data() + offset, 0xFF, allowed);
+    persist(offset, allowed);
+    return allowed == FLASH_SECTOR_SIZE;
+}
+
+void FlashEmulator::powerLossAfter(uint32_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    armed = true;
+    remaining = bytes;
+}
+
+void FlashEmulator::powerOn() {
+    std::lock_guard<std::mutex> lock(mutex);
+    armed = false;
+    powerLost = false;
+}
+
+void FlashEmulator::resetCounters() {
+    std::lock_guard<std::mutex> lock(mutex);
+    readBytes = 0;
+    erases.assign(erases.size(), 0);
+}
+
+uint32_t halFlashSize() {
+    return flash.size();
+}
+
+bool halFlashRead(uint32_t offset, void* data, size_t len) {
+    return flash.read(offset, data, len);
+}
+
+bool halFlashWrite(uint32_t offset, const void* data, size_t len) {
+    return flash.write(offset, data, len);
+}
+
+bool halFlashEraseSector(uint32_t offset) {
+    return flash.eraseSector(offset);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <vector>
+
+// Flash NOR emulada sobre um arquivo: apagar deixa 0xFF, escrever faz AND
+// com o conteúdo atual, e cada operação é gravada no arquivo antes de
+// retornar (matar o processo equivale a cortar a energia).
+//
+// Para testar recuperação, powerLossAfter(n) deixa passar só mais n bytes
+// de escrita (ou de apagamento) e então "corta a energia": a operação em
+// curso fica pela metade e as seguintes falham até powerOn().
+class FlashEmulator {
+public:
+    ~FlashEmulator();
+
+    // Abre (ou cria, apagada) a imagem com o tamanho dado; path vazio = só RAM
+    bool open(const char* path, uint32_t size);
+    void close();
+
+    uint32_t size() const { return (uint32_t)image.size(); }
+
+    bool read(uint32_t offset, void* data, size_t len);
+    bool write(uint32_t offset, const void* data, size_t len);
+    bool eraseSector(uint32_t offset);
+
+    void powerLossAfter(uint32_t bytes);
+    void powerOn();
+    bool poweredOff() const { return powerLost; }
+
+    // Contadores para verificar o rodízio de desgaste e o custo do boot
+    uint32_t eraseCount(uint32_t sector) const { return erases[sector]; }
+    uint64_t bytesRead() const { return readBytes; }
+    void resetCounters();
+
+private:
+    size_t budget(size_t len);
+    void persist(uint32_t offset, size_t len);
+
+    std::mutex mutex;
+    std::vector<uint8_t> image;
+    std::vector<uint32_t> erases;
+    int fd = -1;
+    bool armed = false;
+    bool powerLost = false;
+    uint32_t remaining = 0;
+    uint64_t readBytes = 0;
+};
+
+// Instância usada pelas funções halFlash* do build nativo
+FlashEmulator& nativeFlash();
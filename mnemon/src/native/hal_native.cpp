@@ -0,0 +1,331 @@
+#include "hal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "config.h"
+#include "dht22.h"
+#include "native/hal_native.h"
+
+NativeHalConfig nativeHal;
+
+static std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+static std::atomic<uint32_t> lcdClears(0);
+static std::atomic<uint32_t> lcdChars(0);
+static std::atomic<uint32_t> serialBytes(0);
+static std::atomic<uint32_t> fifoBursts(0);
+static std::atomic<uint64_t> virtualUs(0);
+
+// LCD simulado: mantém o conteúdo do vidro e conta os bytes enviados ao
+// HD44780 (comandos e caracteres)
+static char lcdGlass[LCD_ROWS][LCD_COLS];
+static std::atomic<uint32_t> lcdCommands(0);
+
+static void clearGlass() {
+    memset(lcdGlass, ' ', sizeof(lcdGlass));
+}
+
+static void simulateLatency(std::chrono::microseconds duration) {
+    if (!nativeHal.virtualClock) {
+        std::this_thread::sleep_for(duration);
+    }
+}
+
+static uint64_t elapsedMicros() {
+    if (nativeHal.virtualClock) {
+        return virtualUs;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void nativeClockAdvance(uint32_t us) {
+    virtualUs += us;
+}
+
+void halInit() {
+    bootTime = std::chrono::steady_clock::now();
+    virtualUs = 0;
+    clearGlass();   // Como o lcd.clear() do ESP32
+}
+
+uint32_t halMillis() {
+    return (uint32_t)(elapsedMicros() / 1000);
+}
+
+uint32_t halCycles() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+uint32_t halCyclesPerMicro() {
+    return 1000;
+}
+
+// DHT22 simulado no nível do fio: o quadro é codificado nas temporizações
+// nominais e passa pela mesma decodificação do ESP32
+bool halDhtCapture(Dht22PulseTrain& train) {
+    simulateLatency(std::chrono::milliseconds(nativeHal.dhtReadMs));
+    Dht22Frame frame;
+    if (nativeHal.scripted) {
+        frame.temperature = nativeHal.temperature;
+        frame.humidity = nativeHal.humidity;
+    } else {
+        float t = halMillis() / 1000.0f;
+        frame.temperature = 25.0f + 2.0f * sinf(t / 60.0f);
+        frame.humidity = 60.0f + 5.0f * cosf(t / 90.0f);
+    }
+    Dht22Pulse pulses[DHT22_MAX_PULSES];
+    size_t count = dht22Encode(frame, pulses, DHT22_MAX_PULSES);
+    for (size_t i = 0; i < count; i++) {
+        train.add(false, pulses[i].lowUs);
+        if (pulses[i].highUs > 0) {
+            train.add(true, pulses[i].highUs);
+        }
+    }
+    return true;
+}
+
+int halReadLDR() {
+    if (nativeHal.scripted) {
+        return nativeHal.ldrRaw;
+    }
+    return 2000 + (int)(100.0f * sinf(halMillis() / 5000.0f));
+}
+
+// FIFO simulado do MPU6050: gera amostras no ritmo configurado conforme o
+// relógio avança e reproduz o limite de 1024 bytes e o flag de overflow
+static std::mutex fifoMutex;
+static uint8_t fifo[MPU_FIFO_SIZE];
+static uint16_t fifoHead = 0;
+static uint16_t fifoCount = 0;
+static bool fifoOverflow = false;
+static uint16_t fifoRateHz = 0;
+static uint64_t fifoGenerated = 0;
+static uint64_t fifoStartUs = 0;
+
+static void fifoPushByte(uint8_t value) {
+    if (fifoCount == MPU_FIFO_SIZE) {
+        fifoOverflow = true;
+        fifoHead = (fifoHead + 1) % MPU_FIFO_SIZE;
+        fifoCount--;
+    }
+    fifo[(fifoHead + fifoCount) % MPU_FIFO_SIZE] = value;
+    fifoCount++;
+}
+
+static void fifoFill() {
+    if (fifoRateHz == 0) return;
+    uint64_t due = (elapsedMicros() - fifoStartUs) * fifoRateHz / 1000000;
+    for (; fifoGenerated < due; fifoGenerated++) {
+        // 1g em Z com vibração de 25 Hz em X (fase dentro do segundo, para
+        // não perder precisão em simulações longas)
+        float t = (float)(fifoGenerated % fifoRateHz) / fifoRateHz;
+        int16_t axis[3];
+        axis[0] = (int16_t)(nativeHal.vibrationG * 16384 * sinf(2 * M_PI * 25 * t));
+        axis[1] = 0;
+        axis[2] = 16384;
+        for (int i = 0; i < 3; i++) {
+            fifoPushByte((uint8_t)(axis[i] >> 8));
+            fifoPushByte((uint8_t)(axis[i] & 0xFF));
+        }
+    }
+}
+
+bool halAccelFifoBegin(uint16_t sampleRateHz) {
+    if (sampleRateHz < MPU_MIN_RATE_HZ || sampleRateHz > MPU_MAX_RATE_HZ) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(fifoMutex);
+    fifoRateHz = sampleRateHz;
+    fifoHead = 0;
+    fifoCount = 0;
+    fifoGenerated = 0;
+    fifoStartUs = elapsedMicros();
+    return true;
+}
+
+uint16_t halAccelFifoCount() {
+    std::lock_guard<std::mutex> lock(fifoMutex);
+    fifoFill();
+    return fifoCount;
+}
+
+void halAccelFifoRead(uint8_t* data, uint8_t len) {
+    std::lock_guard<std::mutex> lock(fifoMutex);
+    fifoBursts++;
+    simulateLatency(std::chrono::microseconds(nativeHal.i2cByteUs * len));
+    for (uint8_t i = 0; i < len; i++) {
+        data[i] = fifoCount > 0 ? fifo[fifoHead] : 0;
+        if (fifoCount > 0) {
+            fifoHead = (fifoHead + 1) % MPU_FIFO_SIZE;
+            fifoCount--;
+        }
+    }
+}
+
+bool halAccelFifoOverflowed() {
+    std::lock_guard<std::mutex> lock(fifoMutex);
+    fifoFill();
+    bool overflow = fifoOverflow;
+    fifoOverflow = false;
+    return overflow;
+}
+
+void halAccelFifoReset() {
+    std::lock_guard<std::mutex> lock(fifoMutex);
+    fifoFill();
+    fifoHead = 0;
+    fifoCount = 0;
+}
+
+void halSetRGB(bool red, bool green, bool blue) {
+    (void)red;
+    (void)green;
+    (void)blue;
+}
+
+void halSetBuzzer(bool on) {
+    (void)on;
+}
+
+void halLcdClear() {
+    lcdClears++;
+    lcdCommands++;
+    clearGlass();
+    simulateLatency(std::chrono::milliseconds(nativeHal.lcdClearMs));
+}
+
+void halLcdPrint(uint8_t col, uint8_t row, const char* text) {
+    size_t len = strlen(text);
+    lcdCommands++;   // setCursor
+    lcdChars += len;
+    for (size_t i = 0; i < len && col + i < LCD_COLS && row < LCD_ROWS; i++) {
+        lcdGlass[row][col + i] = text[i];
+    }
+    simulateLatency(std::chrono::microseconds(nativeHal.lcdCharUs * (len + 1)));
+}
+
+void nativeLcdGlass(char rows[LCD_ROWS][LCD_COLS]) {
+    memcpy(rows, lcdGlass, sizeof(lcdGlass));
+}
+
+void halSerialWrite(const char* data, size_t len) {
+    serialBytes += len;
+    if (nativeHal.serialEcho) {
+        fwrite(data, 1, len, stdout);
+    }
+}
+
+static std::atomic<uint32_t> powerModeChanges(0);
+static std::atomic<bool> lightSleepOn(false);
+static std::atomic<bool> modemSleepOn(false);
+
+bool halPowerBegin() {
+    return nativeHal.lightSleep;
+}
+
+void halPowerSetMode(bool lightSleep, bool modemSleep) {
+    powerModeChanges++;
+    lightSleepOn = lightSleep;
+    modemSleepOn = modemSleep;
+}
+
+// Uplink sobre um socket TCP do host; só o loop usa a conexão
+static int uplinkFd = -1;
+
+bool halUplinkConnect(const char* host, uint16_t port, uint32_t timeoutMs) {
+    halUplinkClose();
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addresses = nullptr;
+    if (getaddrinfo(host, service, &hints, &addresses) != 0) {
+        return false;
+    }
+    for (struct addrinfo* a = addresses; a != nullptr && uplinkFd < 0; a = a->ai_next) {
+        int fd = socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int error = connect(fd, a->ai_addr, a->ai_addrlen) == 0 ? 0 : errno;
+        if (error == EINPROGRESS) {
+            struct pollfd p = {fd, POLLOUT, 0};
+            socklen_t length = sizeof(error);
+            error = poll(&p, 1, (int)timeoutMs) == 1 &&
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 ? error : ETIMEDOUT;
+        }
+        if (error == 0) {
+            uplinkFd = fd;
+        } else {
+            close(fd);
+        }
+    }
+    freeaddrinfo(addresses);
+    return uplinkFd >= 0;
+}
+
+int halUplinkWrite(const uint8_t* data, size_t len) {
+    if (uplinkFd < 0) {
+        return -1;
+    }
+    ssize_t n = send(uplinkFd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    return (int)n;
+}
+
+int halUplinkRead(uint8_t* data, size_t len) {
+    if (uplinkFd < 0) {
+        return -1;
+    }
+    ssize_t n = recv(uplinkFd, data, len, MSG_DONTWAIT);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    return n == 0 ? -1 : (int)n;
+}
+
+void halUplinkClose() {
+    if (uplinkFd >= 0) {
+        close(uplinkFd);
+        uplinkFd = -1;
+    }
+}
+
+uint32_t halRandom() {
+    static std::random_device device;
+    return device();
+}
+
+NativeHalCounters nativeHalCounters() {
+    NativeHalCounters counters;
+    counters.lcdClears = lcdClears;
+    counters.lcdChars = lcdChars;
+    counters.lcdCommands = lcdCommands;
+    // PCF8574 em modo de 4 bits: cada byte são dois nibbles de três escritas
+    // no expansor (dado, EN alto, EN baixo)
+    counters.lcdI2cWrites = 6 * (lcdCommands + lcdChars);
+    counters.serialBytes = serialBytes;
+    counters.fifoBursts = fifoBursts;
+    counters.powerModeChanges = powerModeChanges;
+    counters.lightSleep = lightSleepOn;
+    counters.modemSleep = modemSleepOn;
+    return counters;
+}
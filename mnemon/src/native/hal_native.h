@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "config.h"
+
+// Parâmetros dos drivers simulados do build nativo
+struct NativeHalConfig {
+    uint32_t dhtReadMs = 7;      // Pulso de início + quadro do DHT22
+    uint32_t lcdClearMs = 2;     // lcd.clear() no HD44780
+    uint32_t lcdCharUs = 200;    // Custo por caractere via I2C
+    uint32_t i2cByteUs = 25;     // ~400 kHz: 9 bits por byte
+    float vibrationG = 0.05f;    // Amplitude da vibração simulada em X
+    bool serialEcho = true;      // Repassar a saída serial para stdout
+    bool lightSleep = true;      // halPowerBegin: build com light sleep automático
+    
+    // Relógio virtual: halMillis() só avança por nativeClockAdvance() e as
+    // latências simuladas não dormem (execução síncrona, mais rápida que o real)
+    bool virtualClock = false;
+    
+    // Sensores roteirizados pelo motor de cenários (senão, formas de onda fixas)
+    bool scripted = false;
+    float temperature = 25.0f;
+    float humidity = 60.0f;
+    int ldrRaw = 2000;
+};
+
+extern NativeHalConfig nativeHal;
+
+struct NativeHalCounters {
+    uint32_t lcdClears;
+    uint32_t lcdChars;
+    uint32_t lcdCommands;    // clear + posicionamentos de cursor
+    uint32_t lcdI2cWrites;   // Transações I2C no expansor do LCD
+    uint32_t serialBytes;
+    uint32_t fifoBursts;
+    uint32_t powerModeChanges;  // Chamadas de halPowerSetMode
+    bool lightSleep;            // Modo atual
+    bool modemSleep;
+};
+
+NativeHalCounters nativeHalCounters();
+
+// Conteúdo atual do LCD simulado
+void nativeLcdGlass(char rows[LCD_ROWS][LCD_COLS]);
+
+// Avança o relógio virtual (só com nativeHal.virtualClock)
+void nativeClockAdvance(uint32_t us);
@@ -0,0 +1,246 @@
+// Build nativo (Linux): executa o pipeline de tarefas com drivers simulados
+// e verifica que a amostragem rápida não é afetada por uma saída lenta.
+//
+//   pio run -e native && .pio/build/native/program --seconds 10 --lcd-clear-ms 500
+//   .pio/build/native/program --bench all
+//   .pio/build/native/program --check-alloc
+//   .pio/build/native/program --binary --seconds 10 | katabase-decode --format csv
+//   .pio/build/native/program --flash /tmp/mnemon_flash.bin --seconds 120
+//   .pio/build/native/program --flash /tmp/mnemon_flash.bin --uplink 127.0.0.1:7878 --seconds 300 --quiet
+//   .pio/build/native/program --replay all --quiet
+//   .pio/build/native/program --replay realistic_conditions --sim-seconds 36000 --quiet
+//   .pio/build/native/program --replay trace.csv --quiet
+//   .pio/build/native/program --power all --quiet
+//   .pio/build/native/program --power realistic_conditions --step-seconds 30 --quiet
+//   .pio/build/native/program --seconds 10 --quiet --metrics
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accel_capture.h"
+#include "config.h"
+#include "hal.h"
+#include "metrics.h"
+#include "display.h"
+#include "flash_log.h"
+#include "native/alloc_counter.h"
+#include "native/bench.h"
+#include "native/flash_emulator.h"
+#include "native/hal_native.h"
+#include "native/scenario_replay.h"
+#include "pipeline.h"
+#include "power.h"
+#include "rtos.h"
+#include "telemetry.h"
+#include "uplink.h"
+
+// Executa os estágios de aquisição -> alerta -> atuadores/LCD -> JSON/binário de
+// forma síncrona e verifica que nenhum ciclo aloca memória após o aquecimento
+static int checkAllocations(uint32_t cycles) {
+    nativeHal.serialEcho = false;
+    halInit();
+    if (!pipelineBegin()) {
+        fprintf(stderr, "falha ao iniciar pipeline\n");
+        return 1;
+    }
+    // Cobre record(); step() fica de fora porque a conexão resolve nomes
+    uplink().configure("127.0.0.1", UPLINK_DEFAULT_PORT, "check-alloc");
+    
+    Snapshot snapshot = {};
+    uint64_t before = 0;
+    for (uint32_t cycle = 0; cycle < cycles + 10; cycle++) {
+        if (cycle == 10) {
+            before = allocationCount(); // Após aquecimento (estáticos locais etc.)
+        }
+        fastSensorStep();
+        if (cycle % 100 == 0) {
+            slowSensorStep();
+        }
+        // Alterna os formatos para cobrir os dois codificadores
+        setTelemetryFormat(cycle % 2 ? TelemetryFormat::Binary : TelemetryFormat::Json);
+        alertStep(0);
+        updateLCDDisplay(snapshot);
+        displayStep();
+        sendJSONData(snapshot);
+        recordHistory(snapshot);
+        taskDelay(2);
+    }
+    uint64_t allocated = allocationCount() - before;
+    
+    fprintf(stderr, "alocações em %u ciclos: %llu (%.3f por ciclo)\n",
+            cycles, (unsigned long long)allocated, (double)allocated / cycles);
+    fprintf(stderr, "%s\n", allocated == 0 ? "OK" : "FALHA: o caminho de aquisição aloca memória");
+    return allocated == 0 ? 0 : 1;
+}
+
+// Mesma informação de GET /api/metrics, em tabela
+static void printStageMetrics() {
+    fprintf(stderr, "%-13s %8s %10s %10s %10s %10s %10s\n",
+            "estágio (us)", "n", "min", "média", "p50", "p99", "max");
+    for (size_t i = 0; i < (size_t)MetricStage::Count; i++) {
+        StageSummary s = metrics().summary((MetricStage)i);
+        fprintf(stderr, "%-13s %8u %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                METRIC_STAGE_NAMES[i], s.count, s.minUs, s.meanUs, s.p50Us, s.p99Us, s.maxUs);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t seconds = 10;
+    uint32_t simSeconds = 0;
+    uint32_t stepSeconds = 0;
+    const char* replay = nullptr;
+    const char* powerScenario = nullptr;
+    bool showMetrics = false;
+    char uplinkHost[UPLINK_HOST_MAX] = "";
+    uint16_t uplinkPort = UPLINK_DEFAULT_PORT;
+    const char* uplinkDevice = "mnemon-native";
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--lcd-clear-ms") == 0 && i + 1 < argc) {
+            nativeHal.lcdClearMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dht-ms") == 0 && i + 1 < argc) {
+            nativeHal.dhtReadMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--vibration-g") == 0 && i + 1 < argc) {
+            nativeHal.vibrationG = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            return runBenchmark(argv[++i]);
+        } else if (strcmp(argv[i], "--check-alloc") == 0) {
+            return checkAllocations(500);
+        } else if (strcmp(argv[i], "--metrics") == 0) {
+            showMetrics = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            nativeHal.serialEcho = false;
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            setTelemetryFormat(TelemetryFormat::Binary);
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay = argv[++i];
+        } else if (strcmp(argv[i], "--power") == 0 && i + 1 < argc) {
+            powerScenario = argv[++i];
+        } else if (strcmp(argv[i], "--fixed-rate") == 0) {
+            powerManager().setAdaptive(false);
+        } else if (strcmp(argv[i], "--step-seconds") == 0 && i + 1 < argc) {
+            stepSeconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sim-seconds") == 0 && i + 1 < argc) {
+            simSeconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--flash") == 0 && i + 1 < argc) {
+            // Imagem da partição do log (mesmo tamanho da do ESP32); persiste entre execuções
+            if (!nativeFlash().open(argv[++i], 0x170000)) {
+                fprintf(stderr, "falha ao abrir a imagem da flash: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--uplink") == 0 && i + 1 < argc) {
+            // HOST:PORTA do collector (katabase-ingest)
+            const char* colon = strrchr(argv[++i], ':');
+            size_t length = colon != nullptr ? (size_t)(colon - argv[i]) : strlen(argv[i]);
+            if (length == 0 || length >= sizeof(uplinkHost)) {
+                fprintf(stderr, "collector inválido: %s\n", argv[i]);
+                return 2;
+            }
+            memcpy(uplinkHost, argv[i], length);
+            uplinkHost[length] = '\0';
+            if (colon != nullptr) {
+                uplinkPort = (uint16_t)atoi(colon + 1);
+            }
+        } else if (strcmp(argv[i], "--uplink-device") == 0 && i + 1 < argc) {
+            uplinkDevice = argv[++i];
+        } else {
+            fprintf(stderr, "uso: %s [--seconds N] [--lcd-clear-ms N] [--dht-ms N] [--vibration-g G] [--quiet] [--metrics] [--binary] [--flash IMAGEM] [--uplink HOST:PORTA [--uplink-device NOME]] [--fixed-rate] [--replay CENÁRIO|all|TRACE.csv [--sim-seconds N]] | --power CENÁRIO|all [--sim-seconds N] [--step-seconds N] | --bench <nome> | --check-alloc\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    if (powerScenario != nullptr) {
+        return runPowerEstimate(powerScenario, simSeconds, stepSeconds);
+    }
+    if (replay != nullptr) {
+        int result = runReplay(replay, simSeconds);
+        if (showMetrics) {
+            printStageMetrics();
+        }
+        return result;
+    }
+    
+    halInit();
+    if (!startPipeline()) {
+        fprintf(stderr, "falha ao iniciar pipeline\n");
+        return 1;
+    }
+    if (uplinkHost[0] != '\0') {
+        // Enviado pela tarefa do uplink
+        uplink().configure(uplinkHost, uplinkPort, uplinkDevice);
+    }
+    taskDelay(seconds * 1000);
+    
+    PipelineStats stats = pipelineStats();
+    NativeHalCounters hal = nativeHalCounters();
+    AccelCaptureStats capture = accelCaptureStats();
+    PowerSnapshot power = powerManager().snapshot(halMillis());
+    // Leituras rápidas esperadas no período de cada nível visitado
+    uint32_t expectedFast = 0;
+    uint32_t slowestFastMs = FAST_SENSOR_PERIOD_MS;
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        expectedFast += power.tierMs[i] / SAMPLING_TIERS[i].fastMs;
+        if (power.tierMs[i] > 0 && SAMPLING_TIERS[i].fastMs > slowestFastMs) {
+            slowestFastMs = SAMPLING_TIERS[i].fastMs;
+        }
+    }
+    uint32_t expectedAccel = seconds * ACCEL_SAMPLE_RATE_HZ;
+    
+    fprintf(stderr, "\n--- pipeline (%us) ---\n", seconds);
+    fprintf(stderr, "fast samples : %u (esperado ~%u), maior intervalo %u ms\n",
+            stats.fastSamples, expectedFast, stats.maxFastGapMs);
+    fprintf(stderr, "accel capture: %u amostras (esperado ~%u) em %u rajadas\n",
+            capture.samples, expectedAccel, capture.bursts);
+    fprintf(stderr, "accel perdas : fifo overflow %u, ring overflow %u\n",
+            capture.fifoOverflows, capture.ringOverflows);
+    fprintf(stderr, "env samples  : %u\n", stats.envSamples);
+    fprintf(stderr, "snapshots    : %u, saídas %u\n", stats.snapshots, stats.outputs);
+    fprintf(stderr, "descartes    : fast %u, env %u, output %u, raw %u\n",
+            stats.fastDropped, stats.envDropped, stats.outputDropped, stats.rawDropped);
+    uint32_t wakes = 0;
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        wakes += power.wakes[i];
+    }
+    fprintf(stderr, "energia      : nível %s (%s), %u trocas, %.1f despertares/s\n",
+            SAMPLING_TIERS[power.tier].name, POWER_REASON_NAMES[(size_t)power.reason],
+            power.tierChanges, wakes * 1000.0 / (power.elapsedMs ? power.elapsedMs : 1));
+    fprintf(stderr, "lcd          : %u clears, %u chars, %u transações I2C; serial %u bytes\n",
+            hal.lcdClears, hal.lcdChars, hal.lcdI2cWrites, hal.serialBytes);
+    if (flashLog().enabled()) {
+        FlashLogStats log = flashLog().stats();
+        fprintf(stderr, "flash log    : segmento %u/%u (seq %u), relógio em %u ms, %u registros, "
+                "%u gravações, %u apagamentos, %u rasgados no boot\n",
+                log.headSegment, log.segments, log.headSeq, flashLog().clock(halMillis()),
+                log.records, log.flushes, log.erases, log.tornRecords);
+    }
+    if (uplinkHost[0] != '\0') {
+        UplinkSnapshot up = uplink().snapshot();
+        fprintf(stderr, "uplink       : %u registros em %u lotes (%u gzip, %.0f bytes/lote), %u com ACK, "
+                "%u reenviados; fila %u na RAM + %u na flash, %u descartados; %u conexões, %u falhas; "
+                "upload p50 %.0f ms, idade p99 %.0f ms\n",
+                up.records, up.batches, up.gzipBatches,
+                up.batches ? (double)up.batchBytes / up.batches : 0.0, up.acked, up.resent,
+                up.ramBatches, up.spill.batches, up.droppedBatches, up.connects, up.connectFailures,
+                up.uploadMs.p50Us, up.ageMs.p99Us);
+    }
+    
+    if (showMetrics) {
+        printStageMetrics();
+    }
+    
+    // A amostragem rápida não pode sofrer atrasos da saída
+    bool ok = stats.maxFastGapMs <= 3 * slowestFastMs &&
+              stats.fastSamples >= expectedFast * 9 / 10 &&
+              capture.fifoOverflows == 0 && capture.ringOverflows == 0 &&
+              stats.rawDropped == 0 &&
+              capture.samples >= expectedAccel * 9 / 10;
+    fprintf(stderr, "%s\n", ok ? "OK" : "FALHA: amostragem rápida atrasada ou com perdas");
+    fflush(stdout);
+    fflush(stderr);
+    
+    // As tarefas continuam rodando; encerrar sem destruir estado global
+    _Exit(ok ? 0 : 1);
+}
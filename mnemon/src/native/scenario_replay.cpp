@@ -0,0 +1,563 @@
+#include "native/scenario_replay.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "accel_capture.h"
+#include "config.h"
+#include "hal.h"
+#include "native/hal_native.h"
+#include "pipeline.h"
+#include "power.h"
+#include "system_state.h"
+
+namespace {
+
+// Entradas dos sensores simulados durante um step e o nível de alerta
+// esperado ao fim dele (com o DHT22 e a janela de vibração já assentados)
+struct ReplayStep {
+    float temperature;
+    float humidity;
+    int ldrRaw;
+    float vibrationG;       // Amplitude da senoide de 25 Hz em X
+    AlertLevel expected;
+};
+
+const ReplayStep SENSOR_VALIDATION[] = {
+    {25.0, 60.0, 2000, 0.05, AlertLevel::Normal},    // Linha de base
+    {36.0, 60.0, 2000, 0.05, AlertLevel::Yellow},    // Temperatura acima de TEMP_YELLOW
+    {46.0, 60.0, 2000, 0.05, AlertLevel::Red},       // Temperatura acima de TEMP_RED
+    {25.0, 85.0, 2000, 0.05, AlertLevel::Yellow},    // Umidade acima de HUMIDITY_YELLOW
+    {25.0, 92.0, 2000, 0.05, AlertLevel::Red},       // Umidade acima de HUMIDITY_RED
+    {25.0, 60.0, 100, 0.05, AlertLevel::Normal},     // Escuro: LDR não gera alerta
+    {25.0, 60.0, 2000, 0.35, AlertLevel::Yellow},    // Vibração sustentada moderada
+    {25.0, 60.0, 2000, 0.90, AlertLevel::Red},       // Vibração forte
+};
+
+const ReplayStep REALISTIC_CONDITIONS[] = {
+    {22.0, 70.0, 300, 0.05, AlertLevel::Normal},     // Madrugada
+    {24.0, 65.0, 1500, 0.08, AlertLevel::Normal},    // Início do turno
+    {27.0, 58.0, 2800, 0.10, AlertLevel::Normal},
+    {30.0, 52.0, 3500, 0.12, AlertLevel::Normal},
+    {33.0, 48.0, 3800, 0.15, AlertLevel::Normal},
+    {34.5, 45.0, 3900, 0.18, AlertLevel::Normal},    // Carga máxima, ainda dentro da faixa
+    {36.0, 44.0, 3700, 0.15, AlertLevel::Yellow},    // Pico de calor da tarde
+    {33.0, 50.0, 2500, 0.12, AlertLevel::Normal},
+    {28.0, 60.0, 900, 0.08, AlertLevel::Normal},
+    {24.0, 68.0, 200, 0.05, AlertLevel::Normal},     // Noite
+};
+
+const ReplayStep EXTREME_CONDITIONS[] = {
+    {48.0, 30.0, 3900, 0.05, AlertLevel::Red},       // Calor extremo
+    {30.0, 95.0, 1500, 0.05, AlertLevel::Red},       // Condensação
+    {25.0, 60.0, 2000, 1.00, AlertLevel::Red},       // Impactos / desbalanceamento severo
+    {30.0, 55.0, 2000, 0.05, AlertLevel::Normal},    // Recuperação
+    {40.0, 85.0, 2000, 0.30, AlertLevel::Yellow},    // Várias condições de atenção juntas
+    {50.0, 95.0, 4000, 1.20, AlertLevel::Red},       // Tudo no limite
+};
+
+struct ScenarioScript {
+    ScenarioId id;
+    const ReplayStep* steps;
+    uint32_t stepCount;
+};
+
+const ScenarioScript SCRIPTS[] = {
+    {ScenarioId::SensorValidation, SENSOR_VALIDATION,
+     sizeof(SENSOR_VALIDATION) / sizeof(SENSOR_VALIDATION[0])},
+    {ScenarioId::RealisticConditions, REALISTIC_CONDITIONS,
+     sizeof(REALISTIC_CONDITIONS) / sizeof(REALISTIC_CONDITIONS[0])},
+    {ScenarioId::ExtremeConditions, EXTREME_CONDITIONS,
+     sizeof(EXTREME_CONDITIONS) / sizeof(EXTREME_CONDITIONS[0])},
+};
+
+// Ponto de um trace gravado (mantido até o próximo)
+struct TracePoint {
+    uint32_t timeMs;
+    float temperature;
+    float humidity;
+    int ldrRaw;
+    float vibrationG;
+};
+
+typedef void (*ReplayTick)(uint32_t elapsedMs, void* context);
+
+struct ReplayTotals {
+    uint32_t levelMs[3] = {0, 0, 0};
+    uint32_t transitions = 0;
+};
+
+void applyInputs(float temperature, float humidity, int ldrRaw, float vibrationG) {
+    nativeHal.temperature = temperature;
+    nativeHal.humidity = humidity;
+    nativeHal.ldrRaw = ldrRaw;
+    nativeHal.vibrationG = vibrationG;
+}
+
+// Escalonador síncrono: cada tarefa roda quando vence o período do nível
+// de amostragem atual (power.h), os alertas consomem a fila rápida inteira
+// e a saída acorda no seu intervalo de espera; o relógio salta direto para
+// o próximo vencimento
+void simulate(uint32_t durationMs, ReplayTick tick, void* context, ReplayTotals& totals) {
+    AlertLevel last = alertLevel;
+    uint32_t nextFast = 0;
+    uint32_t nextEnv = 0;
+    uint32_t nextOutput = 0;
+    uint32_t nextDisplay = 0;
+    uint32_t nextLoop = 0;
+    uint32_t elapsed = 0;
+    while (elapsed < durationMs) {
+        tick(elapsed, context);
+        bool fast = elapsed >= nextFast;
+        bool env = elapsed >= nextEnv;
+        if (fast) {
+            fastSensorStep();
+        }
+        if (env) {
+            slowSensorStep();
+        }
+        while (alertStep(0)) {}
+
+        // Períodos do nível escolhido nesta avaliação
+        const SamplingTier& tier = powerManager().tier();
+        if (fast) {
+            nextFast += tier.fastMs;
+        }
+        if (env) {
+            nextEnv += tier.envMs;
+        }
+        if (elapsed >= nextOutput) {
+            while (outputStep(0)) {}
+            nextOutput += tier.outputPollMs;
+        }
+        if (elapsed >= nextDisplay) {
+            displayStep();
+            nextDisplay += tier.displayMs;
+        }
+        if (elapsed >= nextLoop) {
+            {
+                TaskActivity activity(PowerTask::Loop);
+            }
+            uplinkStep();       // Tarefa própria, no mesmo período
+            nextLoop += tier.loopMs;
+        }
+
+        uint32_t next = durationMs;
+        for (uint32_t due : {nextFast, nextEnv, nextOutput, nextDisplay, nextLoop}) {
+            next = due < next ? due : next;
+        }
+        AlertLevel level = alertLevel;
+        totals.levelMs[(int)level] += next - elapsed;
+        if (level != last) {
+            totals.transitions++;
+            last = level;
+        }
+        nativeClockAdvance((next - elapsed) * 1000);
+        elapsed = next;
+    }
+}
+
+struct ScenarioRun {
+    const ScenarioScript* script;
+    uint32_t stepMs;
+    int32_t step = -1;
+    uint32_t checked = 0;
+    uint32_t mismatches = 0;
+};
+
+void checkStep(ScenarioRun& run) {
+    if (run.step < 0) {
+        return;
+    }
+    AlertLevel expected = run.script->steps[run.step].expected;
+    AlertLevel level = alertLevel;
+    run.checked++;
+    if (level != expected) {
+        run.mismatches++;
+        fprintf(stderr, "  %s step %d: esperado %s, obtido %s\n",
+                scenarioName(run.script->id), run.step + 1,
+                alertLevelName(expected), alertLevelName(level));
+    }
+}
+
+// Mesma progressão da linha do tempo do cenário: steps de stepSeconds em ciclo
+void scenarioTick(uint32_t elapsedMs, void* context) {
+    ScenarioRun& run = *(ScenarioRun*)context;
+    int32_t step = (int32_t)(elapsedMs / run.stepMs % run.script->stepCount);
+    if (step == run.step) {
+        return;
+    }
+    checkStep(run);
+    run.step = step;
+    const ReplayStep& s = run.script->steps[step];
+    applyInputs(s.temperature, s.humidity, s.ldrRaw, s.vibrationG);
+}
+
+struct TraceRun {
+    const std::vector<TracePoint>* points;
+    size_t next = 0;
+};
+
+void traceTick(uint32_t elapsedMs, void* context) {
+    TraceRun& run = *(TraceRun*)context;
+    const std::vector<TracePoint>& points = *run.points;
+    while (run.next < points.size() && points[run.next].timeMs <= elapsedMs) {
+        const TracePoint& p = points[run.next++];
+        applyInputs(p.temperature, p.humidity, p.ldrRaw, p.vibrationG);
+    }
+}
+
+uint32_t totalWakes(const PowerSnapshot& power) {
+    uint32_t wakes = 0;
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        wakes += power.wakes[i];
+    }
+    return wakes;
+}
+
+void printTotals(const ReplayTotals& totals, uint32_t durationMs) {
+    fprintf(stderr, "  tempo por nível: normal %.1f%%, yellow %.1f%%, red %.1f%%; %u transições\n",
+            100.0 * totals.levelMs[0] / durationMs, 100.0 * totals.levelMs[1] / durationMs,
+            100.0 * totals.levelMs[2] / durationMs, totals.transitions);
+    PowerSnapshot power = powerManager().snapshot(halMillis());
+    fprintf(stderr, "  amostragem:");
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        fprintf(stderr, " %s %.1f%%%s", SAMPLING_TIERS[i].name, 100.0 * power.tierMs[i] / durationMs,
+                i + 1 < SAMPLING_TIER_COUNT ? "," : ";");
+    }
+    fprintf(stderr, " %.1f despertares/s, %u trocas\n", totalWakes(power) * 1000.0 / durationMs,
+            power.tierChanges);
+}
+
+// Divide uma linha CSV no lugar (sem aspas: a saída do decodificador não usa)
+size_t splitCsv(char* line, char** fields, size_t capacity) {
+    size_t count = 0;
+    char* p = line;
+    while (count < capacity) {
+        fields[count++] = p;
+        p = strchr(p, ',');
+        if (p == nullptr) break;
+        *p++ = '\0';
+    }
+    for (size_t i = 0; i < count; i++) {
+        fields[i][strcspn(fields[i], "\r\n")] = '\0';
+    }
+    return count;
+}
+
+int findColumn(char** fields, size_t count, const char* a, const char* b = nullptr) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(fields[i], a) == 0 || (b && strcmp(fields[i], b) == 0)) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Colunas reconhecidas: device_ms|t_ms, temperature, humidity, ldr_raw e,
+// opcionalmente, vib_rms (convertido para amplitude) ou vibration_g; com
+// uma coluna type, só as linhas "environment" são usadas
+bool loadTrace(const char* path, std::vector<TracePoint>& points) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    char line[512];
+    char* fields[32];
+    if (fgets(line, sizeof(line), file) == nullptr) {
+        fclose(file);
+        return false;
+    }
+    size_t columns = splitCsv(line, fields, 32);
+    int type = findColumn(fields, columns, "type");
+    int time = findColumn(fields, columns, "device_ms", "t_ms");
+    int temperature = findColumn(fields, columns, "temperature");
+    int humidity = findColumn(fields, columns, "humidity");
+    int ldr = findColumn(fields, columns, "ldr_raw");
+    int rms = findColumn(fields, columns, "vib_rms");
+    int amplitude = findColumn(fields, columns, "vibration_g");
+    if (time < 0 || temperature < 0 || humidity < 0 || ldr < 0) {
+        fprintf(stderr, "%s: colunas device_ms/t_ms, temperature, humidity e ldr_raw são obrigatórias\n",
+                path);
+        fclose(file);
+        return false;
+    }
+
+    uint32_t firstMs = 0;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        size_t count = splitCsv(line, fields, 32);
+        if (count < columns || (type >= 0 && strcmp(fields[type], "environment") != 0)) {
+            continue;
+        }
+        TracePoint p;
+        uint32_t t = strtoul(fields[time], nullptr, 10);
+        if (points.empty()) {
+            firstMs = t;
+        }
+        p.timeMs = t - firstMs;
+        p.temperature = strtof(fields[temperature], nullptr);
+        p.humidity = strtof(fields[humidity], nullptr);
+        p.ldrRaw = atoi(fields[ldr]);
+        p.vibrationG = amplitude >= 0 ? strtof(fields[amplitude], nullptr)
+                     : rms >= 0 ? strtof(fields[rms], nullptr) * sqrtf(2.0f)
+                     : 0.05f;
+        points.push_back(p);
+    }
+    fclose(file);
+    return !points.empty();
+}
+
+// Modelo de consumo do ESP32-WROOM-32 a 3,3 V (datasheet, modos de
+// energia) e custo por despertar do firmware no ESP32 a 240 MHz: o tempo
+// de CPU do host não serve de referência, então a estimativa usa os
+// despertares e o tempo em cada nível contados pela simulação
+const float CPU_ACTIVE_MA = 50.0f;          // CPU a 240 MHz (modem sleep: 30-68 mA)
+const float CPU_IDLE_MA = 27.0f;            // Idle do FreeRTOS sem light sleep (WFI)
+const float LIGHT_SLEEP_MA = 0.8f;
+const float RADIO_LISTEN_MA = 95.0f;        // WiFi sem economia: receptor sempre ligado
+const float RADIO_MODEM_SLEEP_MA = 4.0f;    // Média com DTIM 1 (~3 ms ligado a cada 102 ms)
+const float PERIPHERALS_MA = 4.5f;          // MPU6050 a 1 kHz, DHT22, LDR, PCF8574 (sem backlight)
+const float SUPPLY_V = 3.3f;
+
+const float WAKE_US = 400.0f;               // Entrada e saída do light sleep
+const float ACCEL_BUS_US = 135.0f;          // 6 bytes a 400 kHz: CPU parada, sem light sleep
+const float ACCEL_CPU_US = 5.0f;            // Características e FFT por amostra
+const float SNAPSHOT_US = 8000.0f;          // LCD, JSON serial, histórico e log
+const float TASK_WAKE_US[] = {
+    250.0f,     // fast_sensor: contagem do FIFO, ADC do LDR, fila
+    7000.0f,    // env_sensor: pulso de início + quadro pelo RMT (sem light sleep)
+    150.0f,     // alert: avaliação e publicação
+    60.0f,      // output: blocos brutos e WebSocket
+    120.0f,     // display: comparação do framebuffer
+    40.0f,      // uplink: lote aberto e socket (sem fechar nem enviar lotes)
+    80.0f,      // loop: WiFi e limpeza do WebSocket
+};
+
+static_assert(sizeof(TASK_WAKE_US) / sizeof(TASK_WAKE_US[0]) == (size_t)PowerTask::Count,
+              "TASK_WAKE_US deve cobrir todas as tarefas");
+
+struct EnergyEstimate {
+    float dutyCycle;        // Fração do tempo com a CPU acordada
+    float wakesPerSecond;
+    float currentMa;        // Média; igual a mAh por hora
+    float mwhPerHour;
+};
+
+// accelSamples e snapshots: contados no mesmo intervalo do snapshot
+EnergyEstimate estimateEnergy(const PowerSnapshot& power, uint32_t accelSamples, uint32_t snapshots,
+                              bool lightSleep) {
+    double elapsedUs = power.elapsedMs > 0 ? power.elapsedMs * 1000.0 : 1.0;
+    double sleepShare = 0;
+    double radioMa = 0;
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        double share = power.tierMs[i] * 1000.0 / elapsedUs;
+        if (lightSleep && SAMPLING_TIERS[i].lightSleep) {
+            sleepShare += share;
+        }
+        radioMa += share * (SAMPLING_TIERS[i].modemSleep ? RADIO_MODEM_SLEEP_MA : RADIO_LISTEN_MA);
+    }
+
+    // Cada despertar num nível com light sleep paga a entrada e a saída; nas
+    // leituras do FIFO a CPU espera o I2C, acordada mas ociosa
+    uint32_t wakes = totalWakes(power);
+    double cpuUs = (double)accelSamples * ACCEL_CPU_US + (double)snapshots * SNAPSHOT_US +
+                   wakes * sleepShare * WAKE_US;
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        cpuUs += (double)power.wakes[i] * TASK_WAKE_US[i];
+    }
+    double busUs = (double)accelSamples * ACCEL_BUS_US;
+    double cpu = cpuUs / elapsedUs < 1.0 ? cpuUs / elapsedUs : 1.0;
+    double bus = busUs / elapsedUs < 1.0 - cpu ? busUs / elapsedUs : 1.0 - cpu;
+    double idleMa = sleepShare * LIGHT_SLEEP_MA + (1.0 - sleepShare) * CPU_IDLE_MA;
+
+    EnergyEstimate e;
+    e.dutyCycle = (float)(cpu + bus);
+    e.wakesPerSecond = (float)(wakes * 1e6 / elapsedUs);
+    e.currentMa = (float)(cpu * CPU_ACTIVE_MA + bus * CPU_IDLE_MA + (1.0 - cpu - bus) * idleMa +
+                          radioMa + PERIPHERALS_MA);
+    e.mwhPerHour = e.currentMa * SUPPLY_V;
+    return e;
+}
+
+void printEstimate(const char* scenario, const char* mode, const EnergyEstimate& e,
+                   const PowerSnapshot& power, uint32_t durationMs) {
+    fprintf(stderr, "%-22s %-22s %6.1f%% %8.1f %9.1f %9.1f   ", scenario, mode, 100.0f * e.dutyCycle,
+            e.wakesPerSecond, e.currentMa, e.mwhPerHour);
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        fprintf(stderr, "%s%3.0f%%", i ? "/" : "", 100.0 * power.tierMs[i] / durationMs);
+    }
+    fprintf(stderr, "\n");
+}
+
+} // namespace
+
+int runReplay(const char* source, uint32_t simSeconds) {
+    nativeHal.virtualClock = true;
+    nativeHal.scripted = true;
+    halInit();
+    if (!pipelineBegin()) {
+        fprintf(stderr, "falha ao iniciar pipeline\n");
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    uint32_t simulatedMs = 0;
+    uint32_t mismatches = 0;
+    bool found = false;
+
+    ScenarioId id;
+    bool all = strcmp(source, "all") == 0;
+    if (all || findScenario(source, id)) {
+        for (const ScenarioScript& script : SCRIPTS) {
+            if (!all && script.id != id) {
+                continue;
+            }
+            found = true;
+            const ScenarioInfo& info = scenarioInfo(script.id);
+            ScenarioRun run;
+            run.script = &script;
+            run.stepMs = info.stepSeconds * 1000;
+            uint32_t durationMs = simSeconds > 0 ? simSeconds * 1000 : run.stepMs * script.stepCount;
+
+            setScenario(script.id);
+            powerManager().reset(halMillis());
+            ReplayTotals totals;
+            simulate(durationMs, scenarioTick, &run, totals);
+            checkStep(run);
+            simulatedMs += durationMs;
+            mismatches += run.mismatches;
+
+            fprintf(stderr, "replay %s: %u s simulados, %u steps verificados, %u divergências\n",
+                    info.name, durationMs / 1000, run.checked, run.mismatches);
+            printTotals(totals, durationMs);
+        }
+    } else if (strstr(source, ".csv") != nullptr) {
+        std::vector<TracePoint> points;
+        if (!loadTrace(source, points)) {
+            fprintf(stderr, "trace vazio ou inválido: %s\n", source);
+            return 1;
+        }
+        found = true;
+        TraceRun run;
+        run.points = &points;
+        uint32_t durationMs = simSeconds > 0 ? simSeconds * 1000
+                                             : points.back().timeMs + FAST_SENSOR_PERIOD_MS;
+        powerManager().reset(halMillis());
+        ReplayTotals totals;
+        simulate(durationMs, traceTick, &run, totals);
+        simulatedMs += durationMs;
+        fprintf(stderr, "replay %s: %zu pontos, %u s simulados\n", source, points.size(),
+                durationMs / 1000);
+        printTotals(totals, durationMs);
+    }
+    if (!found) {
+        fprintf(stderr, "cenário desconhecido: %s (sensor_validation, realistic_conditions, "
+                "extreme_conditions, all ou arquivo .csv)\n", source);
+        return 2;
+    }
+
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    PipelineStats stats = pipelineStats();
+    fprintf(stderr, "%.1f s simulados em %.2f s (%.0fx), %u saídas; descartes: fast %u, "
+            "env %u, output %u, raw %u\n",
+            simulatedMs / 1000.0, wallSeconds, simulatedMs / 1000.0 / wallSeconds, stats.outputs,
+            stats.fastDropped, stats.envDropped, stats.outputDropped, stats.rawDropped);
+
+    bool ok = mismatches == 0 && stats.fastDropped == 0 && stats.envDropped == 0 &&
+              stats.outputDropped == 0 && stats.rawDropped == 0;
+    fprintf(stderr, "%s\n", ok ? "OK" : "FALHA: alertas divergentes ou descartes no pipeline");
+    fflush(stdout);
+    return ok ? 0 : 1;
+}
+
+int runPowerEstimate(const char* source, uint32_t simSeconds, uint32_t stepSeconds) {
+    nativeHal.virtualClock = true;
+    nativeHal.scripted = true;
+    halInit();
+    if (!pipelineBegin()) {
+        fprintf(stderr, "falha ao iniciar pipeline\n");
+        return 1;
+    }
+
+    uint32_t durationMs = (simSeconds > 0 ? simSeconds : 3600) * 1000;
+    uint32_t mismatches = 0;
+    bool cheaper = true;
+    bool found = false;
+    bool all = strcmp(source, "all") == 0;
+    ScenarioId id;
+    if (!all && !findScenario(source, id)) {
+        fprintf(stderr, "cenário desconhecido: %s (sensor_validation, realistic_conditions, "
+                "extreme_conditions ou all)\n", source);
+        return 2;
+    }
+
+    char steps[32];
+    if (stepSeconds > 0) {
+        snprintf(steps, sizeof(steps), "steps de %u s", stepSeconds);
+    } else {
+        snprintf(steps, sizeof(steps), "um ciclo de steps");
+    }
+    fprintf(stderr, "estimativa por hora (%u s simulados por modo, %s, %.1f V); tempo por nível:",
+            durationMs / 1000, steps, SUPPLY_V);
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        fprintf(stderr, "%s%s", i ? "/" : " ", SAMPLING_TIERS[i].name);
+    }
+    fprintf(stderr, "\n%-22s %-22s %7s %8s %9s %9s   %s\n", "cenário", "modo", "duty", "desp/s",
+            "mAh/h", "mWh/h", "níveis");
+    for (const ScenarioScript& script : SCRIPTS) {
+        if (!all && script.id != id) {
+            continue;
+        }
+        found = true;
+        const ScenarioInfo& info = scenarioInfo(script.id);
+        float fixedMa = 0;
+        for (bool adaptive : {false, true}) {
+            powerManager().setAdaptive(adaptive);
+            setScenario(script.id);
+            ScenarioRun run;
+            run.script = &script;
+            run.stepMs = stepSeconds > 0 ? stepSeconds * 1000 : durationMs / script.stepCount;
+
+            uint32_t accelBefore = accelCaptureStats().samples;
+            uint32_t outputsBefore = pipelineStats().outputs;
+            powerManager().reset(halMillis());
+            ReplayTotals totals;
+            simulate(durationMs, scenarioTick, &run, totals);
+            checkStep(run);
+            mismatches += run.mismatches;
+
+            PowerSnapshot power = powerManager().snapshot(halMillis());
+            uint32_t accel = accelCaptureStats().samples - accelBefore;
+            uint32_t outputs = pipelineStats().outputs - outputsBefore;
+            if (!adaptive) {
+                // Firmware anterior: nível ativo, sem light sleep nem modem sleep
+                EnergyEstimate e = estimateEnergy(power, accel, outputs, false);
+                printEstimate(info.name, "fixo", e, power, durationMs);
+                fixedMa = e.currentMa;
+                continue;
+            }
+            EnergyEstimate modem = estimateEnergy(power, accel, outputs, false);
+            EnergyEstimate sleep = estimateEnergy(power, accel, outputs, true);
+            printEstimate("", "adaptativo", modem, power, durationMs);
+            printEstimate("", "adaptativo+light sleep", sleep, power, durationMs);
+            if (run.mismatches > 0) {
+                fprintf(stderr, "  %u steps com alerta divergente na amostragem adaptativa\n",
+                        run.mismatches);
+            }
+            cheaper &= modem.currentMa <= fixedMa && sleep.currentMa <= modem.currentMa;
+        }
+    }
+    powerManager().setAdaptive(true);
+
+    bool ok = found && mismatches == 0 && cheaper;
+    fprintf(stderr, "%s\n", ok ? "OK" : "FALHA: alertas divergentes ou adaptação sem economia");
+    fflush(stdout);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+// Replay de cenários no relógio virtual: executa os estágios do pipeline de
+// forma síncrona, com os sensores simulados seguindo os steps de
+// sensor_validation, realistic_conditions e extreme_conditions (ou um trace
+// gravado), muito mais rápido que o tempo real.
+//
+//   source: nome do cenário, "all" ou um CSV (por exemplo, a saída do
+//           katabase-decode --format csv)
+//   simSeconds: duração simulada de cada cenário (0 = um ciclo completo de
+//               steps, ou o trace inteiro)
+//
+// Nos cenários, o nível de alerta no fim de cada step é comparado com o
+// esperado. Retorna o código de saída do programa.
+int runReplay(const char* source, uint32_t simSeconds);
+
+// Estimativa de energia por hora nos mesmos cenários: cada um roda com a
+// amostragem fixa (nível ativo, como antes de power.h) e com a adaptativa,
+// e os despertares e o tempo em cada nível passam por um modelo de consumo
+// do ESP32 (com e sem light sleep). Os alertas da amostragem adaptativa são
+// verificados como no replay. simSeconds: duração por modo (0 = uma hora);
+// stepSeconds: duração de cada step (0 = um ciclo de steps na duração, com
+// condições que duram minutos como numa instalação; a do cenário, por
+// exemplo 30 em realistic_conditions, reproduz a progressão acelerada).
+int runPowerEstimate(const char* source, uint32_t simSeconds, uint32_t stepSeconds);
@@ -0,0 +1,423 @@
+#include "pipeline.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "accel_capture.h"
+#include "alerts.h"
+#include "anomaly.h"
+#include "config.h"
+#include "display.h"
+#include "flash_log.h"
+#include "hal.h"
+#include "history.h"
+#include "live.h"
+#include "metrics.h"
+#include "power.h"
+#include "rtos.h"
+#include "sensors.h"
+#include "spectrum.h"
+#include "system_state.h"
+#include "telemetry.h"
+#include "timeline.h"
+#include "uplink.h"
+#include "vibration_features.h"
+
+static FixedQueue<FastSample, FAST_QUEUE_DEPTH> fastQueue;
+static FixedQueue<EnvSample, SLOW_QUEUE_DEPTH> envQueue;
+static FixedQueue<Snapshot, OUTPUT_QUEUE_DEPTH> outputQueue;
+static FixedQueue<AccelBlock, RAW_QUEUE_DEPTH> rawQueue;
+
+static volatile uint32_t fastSamples = 0;
+static volatile uint32_t envSamples = 0;
+static volatile uint32_t snapshots = 0;
+static volatile uint32_t outputs = 0;
+static volatile uint32_t maxFastGapMs = 0;
+static uint32_t lastLiveMs = 0;
+
+// Estado da tarefa de alertas
+static EnvSample latestEnv = {0, NAN, NAN};
+static uint32_t lastSnapshotMs = 0;
+static VibrationFeatureEngine featureEngine;
+static AlertEvaluator alertEvaluator(anomalyEngine());
+static SpectrumAnalyzer spectrumAnalyzer;
+static AccelBlock rawBlock;
+static uint32_t rawSampleIndex = 0;
+
+// Agrupa amostras brutas para o modo binário; o índice corre sempre, para
+// que o receptor detecte lacunas mesmo após alternar o modo
+static void collectRawSample(const AccelRaw& raw, uint32_t nowMs) {
+    uint32_t index = rawSampleIndex++;
+    if (telemetryFormat() != TelemetryFormat::Binary) {
+        rawBlock.count = 0;
+        return;
+    }
+    if (rawBlock.count == 0) {
+        rawBlock.firstIndex = index;
+    }
+    rawBlock.samples[rawBlock.count++] = raw;
+    if (rawBlock.count == ACCEL_BLOCK_SAMPLES) {
+        rawBlock.timestampMs = nowMs;
+        rawBlock.sampleRateHz = ACCEL_SAMPLE_RATE_HZ;
+        rawQueue.send(rawBlock, 0);
+        rawBlock.count = 0;
+    }
+}
+
+void fastSensorStep() {
+    TaskActivity activity(PowerTask::FastSensor);
+    StageTimer timer(MetricStage::FastSensor);
+    static uint32_t lastSampleMs = 0;
+    // Passos da linha do tempo vencidos entram já nesta leitura
+    timeline().tick(halMillis(), sensorOverrides);
+    FastSample sample;
+    readFastSample(sample);
+    
+    if (fastSamples > 0) {
+        uint32_t gap = sample.timestampMs - lastSampleMs;
+        if (gap > maxFastGapMs) maxFastGapMs = gap;
+    }
+    lastSampleMs = sample.timestampMs;
+    fastSamples++;
+    
+    fastQueue.send(sample, 0);
+}
+
+void slowSensorStep() {
+    TaskActivity activity(PowerTask::EnvSensor);
+    EnvSample sample;
+    {
+        StageTimer timer(MetricStage::DhtRead);
+        readEnvSample(sample);
+    }
+    envSamples++;
+    envQueue.send(sample, 0);
+}
+
+bool alertStep(uint32_t timeoutMs) {
+    FastSample sample;
+    if (!fastQueue.receive(sample, timeoutMs)) {
+        return false;
+    }
+    TaskActivity activity(PowerTask::Alert);
+    StageTimer timer(MetricStage::Alert);
+    
+    EnvSample env;
+    bool envFresh = false;
+    while (envQueue.receive(env, 0)) {
+        latestEnv = env;
+        envFresh = true;
+    }
+    
+    // Consumir todo o bloco de vibração capturado desde o último tick
+    AccelRaw block[64];
+    size_t n;
+    while ((n = accelRing().pop(block, 64)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            featureEngine.addSample(block[i]);
+            collectRawSample(block[i], sample.timestampMs);
+            
+            float x = block[i].x / 16384.0f;
+            float y = block[i].y / 16384.0f;
+            float z = block[i].z / 16384.0f;
+            spectrumAnalyzer.addSample(sqrtf(x * x + y * y + z * z));
+        }
+    }
+    const VibrationFeatures& vibration = featureEngine.features();
+    const SpectralResult& spectrum = spectrumAnalyzer.result();
+    
+    // Calcular nível de alerta (limiares fixos ou linha de base, com histerese)
+    SensorOverrides overrides = sensorOverrides.read();
+    AlertInputs inputs;
+    inputs.temperature = latestEnv.temperature;
+    inputs.humidity = latestEnv.humidity;
+    inputs.envFresh = envFresh;
+    inputs.vibration = &vibration;
+    inputs.spectrum = &spectrum;
+    inputs.synthetic = overrides.dht22_override || overrides.ldr_override ||
+                       overrides.mpu6050_override || currentScenario != ScenarioId::ApiControl;
+    AlertLevel level = alertEvaluator.evaluate(sample.timestampMs, inputs);
+    AlertLevel previous = alertLevel;
+    bool changed = level != previous;
+    if (changed) {
+        alertLevel = level;
+        updateActuators(level);
+    }
+    
+    // Nível de amostragem das próximas voltas (power.h)
+    PowerInputs power;
+    power.temperature = latestEnv.temperature;
+    power.humidity = latestEnv.humidity;
+    power.envFresh = envFresh;
+    power.vibrationRms = vibration.rmsTotal;
+    power.peakMagnitude = vibration.peakMagnitude;
+    power.level = level;
+    power.watched = liveHub().clientCount() > 0;
+    powerManager().update(sample.timestampMs, power);
+    
+    // Canal de push (e leitura atual de /api/status): leitura no intervalo
+    // mínimo dos clientes e transições na hora
+    if (changed) {
+        liveHub().publishAlert(previous, level, flashLog().clock(sample.timestampMs));
+    }
+    if (changed || sample.timestampMs - lastLiveMs >= LIVE_MIN_INTERVAL_MS) {
+        lastLiveMs = sample.timestampMs;
+        LiveSample live;
+        live.timestampMs = flashLog().clock(sample.timestampMs);
+        live.temperature = latestEnv.temperature;
+        live.humidity = latestEnv.humidity;
+        live.ldrRaw = sample.ldrRaw;
+        live.accelX = sample.accelX;
+        live.accelY = sample.accelY;
+        live.accelZ = sample.accelZ;
+        live.vibrationRms = vibration.rmsTotal;
+        live.peakMagnitude = vibration.peakMagnitude;
+        live.alertLevel = level;
+        liveHub().publish(live);
+        currentReading.write(live);
+    }
+    
+    // Publicar para a saída no período do nível ou imediatamente em transições
+    if (changed || sample.timestampMs - lastSnapshotMs >= powerManager().tier().outputMs) {
+        lastSnapshotMs = sample.timestampMs;
+        
+        Snapshot snapshot;
+        snapshot.timestampMs = sample.timestampMs;
+        snapshot.temperature = latestEnv.temperature;
+        snapshot.humidity = latestEnv.humidity;
+        snapshot.ldrRaw = sample.ldrRaw;
+        snapshot.lux = calculateLux(sample.ldrRaw);
+        snapshot.accelX = sample.accelX;
+        snapshot.accelY = sample.accelY;
+        snapshot.accelZ = sample.accelZ;
+        snapshot.vibration = vibration;
+        snapshot.spectrum = spectrum;
+        snapshot.alertLevel = level;
+        
+        snapshots++;
+        outputQueue.send(snapshot, 0);
+    }
+    return true;
+}
+
+// Histórico em RAM + log em flash, no relógio persistente
+void recordHistory(const Snapshot& snapshot) {
+    float values[HISTORY_METRIC_COUNT];
+    HistoryStore::values(snapshot, values);
+    uint32_t timeMs = flashLog().clock(snapshot.timestampMs);
+    history().record(timeMs, values);
+    flashLog().append(LogRecordType::History, timeMs, values, sizeof(values));
+}
+
+// Linha de base das anomalias no log, depois do aprendizado e a cada
+// ANOMALY_PERSIST_MS
+static void persistBaseline(uint32_t nowMs) {
+    static uint32_t lastPersistMs = 0;
+    static bool persisted = false;
+    if (persisted && nowMs - lastPersistMs < ANOMALY_PERSIST_MS) {
+        return;
+    }
+    AnomalySnapshot snapshot = anomalyEngine().snapshot();
+    if (snapshot.learning) {
+        return;
+    }
+    AnomalyBaseline baseline;
+    AnomalyEngine::baseline(snapshot, baseline);
+    flashLog().append(LogRecordType::Baseline, flashLog().clock(nowMs), &baseline, sizeof(baseline));
+    lastPersistMs = nowMs;
+    persisted = true;
+}
+
+// Replay do log no boot: histórico e a linha de base mais recente
+struct LogReplay {
+    AnomalyBaseline baseline;
+    bool hasBaseline;
+};
+
+static void replayLog(LogRecordType type, uint32_t timeMs, const uint8_t* payload,
+                      size_t length, void* context) {
+    LogReplay& replay = *(LogReplay*)context;
+    float values[HISTORY_METRIC_COUNT];
+    if (type == LogRecordType::History && length == sizeof(values)) {
+        memcpy(values, payload, sizeof(values));
+        history().record(timeMs, values);
+    } else if (type == LogRecordType::Baseline && length == sizeof(replay.baseline)) {
+        memcpy(&replay.baseline, payload, sizeof(replay.baseline));
+        replay.hasBaseline = true;
+    }
+}
+
+bool outputStep(uint32_t timeoutMs) {
+    TaskActivity activity(PowerTask::Output);
+    bool messageShown = renderLcdMessage();
+    
+    // Blocos brutos primeiro: chegam a ~16/s e a fila cobre só ~1 s
+    AccelBlock block;
+    while (rawQueue.receive(block, 0)) {
+        sendAccelBlock(block);
+    }
+    
+    Snapshot snapshot;
+    activity.pause();
+    if (!outputQueue.receive(snapshot, timeoutMs)) {
+        return false;
+    }
+    activity.resume();
+    StageTimer cycle(MetricStage::OutputCycle);
+    
+    // Debug ocasional para verificação (texto avulso não é emitido no modo binário)
+    if (telemetryFormat() == TelemetryFormat::Json && halMillis() % 10000 < 100) { // A cada 10s por 100ms
+        char debug[64];
+        int len = snprintf(debug, sizeof(debug), "MPU6050 Debug: X=%.2fg Y=%.2fg Z=%.2fg\r\n",
+                           snapshot.accelX, snapshot.accelY, snapshot.accelZ);
+        halSerialWrite(debug, len);
+    }
+    
+    if (!messageShown) {
+        updateLCDDisplay(snapshot);
+    }
+    {
+        StageTimer timer(MetricStage::Telemetry);
+        sendJSONData(snapshot);
+    }
+    {
+        StageTimer timer(MetricStage::History);
+        recordHistory(snapshot);
+        persistBaseline(snapshot.timestampMs);
+    }
+    outputs++;
+    return true;
+}
+
+// Só conta na métrica quando algo foi enviado ao LCD
+void displayStep() {
+    TaskActivity activity(PowerTask::Display);
+    uint32_t start = halCycles();
+    if (displayFlush() > 0) {
+        metrics().record(MetricStage::Lcd, halCycles() - start);
+    }
+}
+
+// Fecha e envia os lotes do uplink; a conexão ao collector bloqueia esta
+// tarefa (até UPLINK_CONNECT_TIMEOUT_MS), não o loop()
+void uplinkStep() {
+    TaskActivity activity(PowerTask::Uplink);
+    uplink().step(halMillis());
+}
+
+static void fastSensorTask(void*) {
+    TaskWake lastWake = taskWakeNow();
+    for (;;) {
+        fastSensorStep();
+        taskDelayUntil(lastWake, powerManager().tier().fastMs);
+    }
+}
+
+static void slowSensorTask(void*) {
+    TaskWake lastWake = taskWakeNow();
+    for (;;) {
+        slowSensorStep();
+        taskDelayUntil(lastWake, powerManager().tier().envMs);
+    }
+}
+
+static void alertTask(void*) {
+    for (;;) {
+        alertStep(1000);
+    }
+}
+
+static void outputTask(void*) {
+    for (;;) {
+        outputStep(powerManager().tier().outputPollMs);
+    }
+}
+
+static void displayTask(void*) {
+    TaskWake lastWake = taskWakeNow();
+    for (;;) {
+        displayStep();
+        taskDelayUntil(lastWake, powerManager().tier().displayMs);
+    }
+}
+
+static void uplinkTask(void*) {
+    for (;;) {
+        uplinkStep();
+        taskDelay(powerManager().tier().loopMs);
+    }
+}
+
+bool pipelineBegin() {
+    displayBegin();
+    history().begin();
+    liveHub().begin();
+    metrics().begin();
+    sensorOverrides.begin();
+    currentReading.begin();
+    timeline().begin();
+    
+    anomalyEngine().begin(halMillis());
+    alertEvaluator.begin(halMillis());
+    powerManager().begin(halMillis(), halPowerBegin());
+    
+    // Os últimos setores da partição ficam com a fila do uplink (se ela
+    // for grande o bastante); o log usa o resto
+    uint32_t sectors = halFlashSize() / FLASH_SECTOR_SIZE;
+    uint32_t spillSectors = sectors >= 4 * UPLINK_SPILL_SECTORS ? UPLINK_SPILL_SECTORS : 0;
+    uplink().begin((sectors - spillSectors) * FLASH_SECTOR_SIZE, spillSectors);
+    
+    // Recupera as últimas horas do log antes de a saída começar a gravar
+    if (flashLog().begin(spillSectors)) {
+        uint32_t now = flashLog().clock(halMillis());
+        LogReplay replay = {};
+        flashLog().replay(now > LOG_REPLAY_MS ? now - LOG_REPLAY_MS : 0, replayLog, &replay);
+        if (replay.hasBaseline) {
+            anomalyEngine().restore(replay.baseline);
+        }
+    }
+    if (!fastQueue.begin() || !envQueue.begin() || !outputQueue.begin() ||
+        !rawQueue.begin()) {
+        return false;
+    }
+    spectrumAnalyzer.begin(ACCEL_SAMPLE_RATE_HZ);
+    if (!accelCaptureBegin(ACCEL_SAMPLE_RATE_HZ)) {
+        return false;
+    }
+    lastSnapshotMs = halMillis();
+    return true;
+}
+
+bool startPipeline() {
+    if (!pipelineBegin()) {
+        return false;
+    }
+    
+    return startTask(fastSensorTask, "fast_sensors", FAST_SENSOR_STACK,
+                     FAST_SENSOR_PRIORITY, ACQUISITION_CORE) &&
+           startTask(slowSensorTask, "slow_sensors", SLOW_SENSOR_STACK,
+                     SLOW_SENSOR_PRIORITY, ACQUISITION_CORE) &&
+           startTask(alertTask, "alerts", ALERT_STACK,
+                     ALERT_PRIORITY, ACQUISITION_CORE) &&
+           startTask(outputTask, "output", OUTPUT_STACK,
+                     OUTPUT_PRIORITY, OUTPUT_CORE) &&
+           startTask(displayTask, "display", DISPLAY_STACK,
+                     DISPLAY_PRIORITY, OUTPUT_CORE) &&
+           startTask(uplinkTask, "uplink", UPLINK_STACK,
+                     UPLINK_PRIORITY, OUTPUT_CORE);
+}
+
+PipelineStats pipelineStats() {
+    PipelineStats stats;
+    stats.fastSamples = fastSamples;
+    stats.envSamples = envSamples;
+    stats.snapshots = snapshots;
+    stats.outputs = outputs;
+    stats.maxFastGapMs = maxFastGapMs;
+    stats.fastDropped = fastQueue.dropped();
+    stats.envDropped = envQueue.dropped();
+    stats.outputDropped = outputQueue.dropped();
+    stats.rawDropped = rawQueue.dropped();
+    return stats;
+}
@@ -0,0 +1,227 @@
+#include "power.h"
+
+#include <math.h>
+
+#include "json_writer.h"
+
+// Entre duas drenagens o FIFO do MPU6050 guarda as amostras de um período
+// da tarefa rápida, com folga de 1/4 para pausas (apagamento da flash, ~45 ms)
+static constexpr bool tiersFitFifo() {
+    for (const SamplingTier& tier : SAMPLING_TIERS) {
+        if (tier.fastMs * ACCEL_SAMPLE_RATE_HZ / 1000 * 6 > MPU_FIFO_SIZE * 3 / 4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static constexpr bool tiersOrdered() {
+    for (uint32_t i = 1; i < SAMPLING_TIER_COUNT; i++) {
+        if (SAMPLING_TIERS[i].calmMs <= SAMPLING_TIERS[i - 1].calmMs ||
+            SAMPLING_TIERS[i].fastMs < SAMPLING_TIERS[i - 1].fastMs ||
+            SAMPLING_TIERS[i].envMs < DHT22_MIN_INTERVAL_MS) {
+            return false;
+        }
+    }
+    return SAMPLING_TIERS[0].calmMs == 0;
+}
+
+static_assert(tiersFitFifo(), "período da tarefa rápida maior que o FIFO do MPU6050 comporta");
+static_assert(tiersOrdered(), "SAMPLING_TIERS deve ir do nível ativo ao mais econômico");
+static_assert(SAMPLING_TIER_COUNT >= 2, "a adaptação precisa de pelo menos dois níveis");
+
+static PowerManager power;
+
+PowerManager& powerManager() {
+    return power;
+}
+
+void PowerManager::begin(uint32_t nowMs, bool lightSleep) {
+    lightSleepAvailable = lightSleep;
+    cyclesPerMicro = halCyclesPerMicro();
+    reset(nowMs);
+    calmSinceMs = nowMs;
+    trendTemperature = NAN;
+    trendHumidity = NAN;
+    trendVibRms = NAN;
+    current = 0;
+    reason = PowerReason::Boot;
+    halPowerSetMode(false, SAMPLING_TIERS[0].modemSleep);
+}
+
+// Só com as tarefas paradas (simulação): os contadores têm outros escritores
+void PowerManager::reset(uint32_t nowMs) {
+    sinceMs = nowMs;
+    lastUpdateMs = nowMs;
+    tierChanges = 0;
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        tierMs[i] = 0;
+    }
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        wakes[i] = 0;
+        busyCycles[i] = 0;
+    }
+}
+
+void PowerManager::recordWake(PowerTask task, uint32_t cycles) {
+    wakes[(size_t)task]++;
+    busyCycles[(size_t)task] += cycles;
+}
+
+// Leitura a menos de bands faixas de aproximação do limiar amarelo
+static bool approaching(const PowerInputs& in, float bands) {
+    auto near = [bands](float value, float yellow, float band) {
+        return !isnan(value) && value >= yellow - bands * band;
+    };
+    return near(in.temperature, TEMP_YELLOW, POWER_NEAR_TEMPERATURE) ||
+           near(in.humidity, HUMIDITY_YELLOW, POWER_NEAR_HUMIDITY) ||
+           near(in.peakMagnitude, ACCEL_YELLOW, POWER_NEAR_ACCEL) ||
+           near(in.vibrationRms, VIB_RMS_YELLOW, POWER_NEAR_VIB_RMS);
+}
+
+static bool moved(float value, float& reference, float delta) {
+    return !isnan(value) && !isnan(reference) && fabsf(value - reference) >= delta;
+}
+
+bool PowerManager::triggered(uint32_t nowMs, const PowerInputs& in, PowerReason& why) {
+    // Variação desde o início da janela; a referência avança a cada janela
+    bool trend = moved(in.temperature, trendTemperature, POWER_TREND_TEMPERATURE) ||
+                 moved(in.humidity, trendHumidity, POWER_TREND_HUMIDITY) ||
+                 moved(in.vibrationRms, trendVibRms, POWER_TREND_VIB_RMS);
+    if (trend || isnan(trendTemperature) || nowMs - trendSinceMs >= POWER_TREND_WINDOW_MS) {
+        trendSinceMs = nowMs;
+        trendTemperature = in.temperature;
+        trendHumidity = in.humidity;
+        trendVibRms = in.vibrationRms;
+    }
+
+    if (in.level != AlertLevel::Normal) {
+        why = PowerReason::Alert;
+        return true;
+    }
+    if (approaching(in, 1.0f)) {
+        why = PowerReason::Threshold;
+        return true;
+    }
+    if (trend) {
+        why = PowerReason::Trend;
+        return true;
+    }
+    return false;
+}
+
+void PowerManager::enter(uint8_t next, PowerReason why) {
+    reason = why;
+    if (next == current) {
+        return;
+    }
+    current = next;
+    tierChanges++;
+    const SamplingTier& t = SAMPLING_TIERS[next];
+    halPowerSetMode(t.lightSleep && lightSleepAvailable, t.modemSleep);
+}
+
+void PowerManager::update(uint32_t nowMs, const PowerInputs& in) {
+    tierMs[current] += nowMs - lastUpdateMs;
+    lastUpdateMs = nowMs;
+
+    if (!adaptive) {
+        enter(0, PowerReason::Fixed);
+        calmSinceMs = nowMs;
+        return;
+    }
+    PowerReason why;
+    if (triggered(nowMs, in, why)) {
+        calmSinceMs = nowMs;
+        enter(0, why);
+        return;
+    }
+
+    // Perto da faixa de atenção, ou com alguém acompanhando pelo WebSocket,
+    // o nível mais econômico fica de fora
+    uint8_t floor = SAMPLING_TIER_COUNT - 1;
+    if (in.watched || approaching(in, 2.0f)) {
+        floor = 1;
+    }
+    if (current > floor) {
+        enter(floor, PowerReason::Threshold);
+    } else if (current < floor && nowMs - calmSinceMs >= SAMPLING_TIERS[current + 1].calmMs) {
+        enter(current + 1, PowerReason::Calm);
+    }
+}
+
+PowerSnapshot PowerManager::snapshot(uint32_t nowMs) const {
+    PowerSnapshot s;
+    s.tier = current;
+    s.reason = reason;
+    s.adaptive = adaptive;
+    s.lightSleepAvailable = lightSleepAvailable;
+    s.elapsedMs = nowMs - sinceMs;
+    s.tierChanges = tierChanges;
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        s.tierMs[i] = tierMs[i];
+    }
+    // Inclui o trecho desde a última avaliação
+    s.tierMs[s.tier] += nowMs - lastUpdateMs;
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        s.wakes[i] = wakes[i];
+        s.busyUs[i] = busyCycles[i] / cyclesPerMicro;
+    }
+    return s;
+}
+
+void PowerManager::write(const PowerSnapshot& s, JsonWriter& json) {
+    const SamplingTier& tier = SAMPLING_TIERS[s.tier];
+    double elapsedUs = s.elapsedMs > 0 ? s.elapsedMs * 1000.0 : 1.0;
+    uint64_t busyUs = 0;
+    unsigned long wakes = 0;
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        busyUs += s.busyUs[i];
+        wakes += s.wakes[i];
+    }
+
+    json.beginObject();
+    json.field("tier", tier.name);
+    json.field("reason", POWER_REASON_NAMES[(size_t)s.reason]);
+    json.field("adaptive", s.adaptive);
+    json.field("light_sleep_available", s.lightSleepAvailable);
+    json.field("light_sleep", s.lightSleepAvailable && tier.lightSleep);
+    json.field("modem_sleep", tier.modemSleep);
+    json.field("elapsed_seconds", (unsigned long)(s.elapsedMs / 1000));
+    json.field("tier_changes", (unsigned long)s.tierChanges);
+    json.field("duty_cycle", (float)(busyUs / elapsedUs), 4);
+    json.field("wakes", wakes);
+    json.field("wakes_per_second", (float)(wakes * 1e6 / elapsedUs), 2);
+
+    json.key("periods_ms");
+    json.beginObject();
+    json.field("fast", (unsigned long)tier.fastMs);
+    json.field("env", (unsigned long)tier.envMs);
+    json.field("output", (unsigned long)tier.outputMs);
+    json.field("display", (unsigned long)tier.displayMs);
+    json.endObject();
+
+    json.key("tiers");
+    json.beginObject();
+    for (uint32_t i = 0; i < SAMPLING_TIER_COUNT; i++) {
+        json.key(SAMPLING_TIERS[i].name);
+        json.beginObject();
+        json.field("seconds", (unsigned long)(s.tierMs[i] / 1000));
+        json.field("share", (float)(s.tierMs[i] * 1000.0 / elapsedUs), 3);
+        json.endObject();
+    }
+    json.endObject();
+
+    json.key("tasks");
+    json.beginObject();
+    for (size_t i = 0; i < (size_t)PowerTask::Count; i++) {
+        json.key(POWER_TASK_NAMES[i]);
+        json.beginObject();
+        json.field("wakes", (unsigned long)s.wakes[i]);
+        json.field("busy_ms", (float)(s.busyUs[i] / 1000.0), 1);
+        json.field("duty", (float)(s.busyUs[i] / elapsedUs), 4);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+}
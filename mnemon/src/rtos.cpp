@@ -0,0 +1,55 @@
+#include "rtos.h"
+
+#if defined(ESP32)
+
+bool startTask(TaskEntry entry, const char* name, uint32_t stackBytes,
+               uint32_t priority, int core, void* arg) {
+    // No ESP-IDF o tamanho da stack é dado em bytes
+    return xTaskCreatePinnedToCore(entry, name, stackBytes, arg, priority,
+                                   nullptr, core) == pdPASS;
+}
+
+TaskWake taskWakeNow() {
+    return TaskWake{xTaskGetTickCount()};
+}
+
+void taskDelayUntil(TaskWake& lastWake, uint32_t periodMs) {
+    vTaskDelayUntil(&lastWake.tick, pdMS_TO_TICKS(periodMs));
+}
+
+void taskDelay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+#else
+
+#include "hal.h"
+
+bool startTask(TaskEntry entry, const char* name, uint32_t stackBytes,
+               uint32_t priority, int core, void* arg) {
+    // Prioridade e núcleo são ignorados no host: cada tarefa vira uma thread
+    (void)name;
+    (void)stackBytes;
+    (void)priority;
+    (void)core;
+    std::thread(entry, arg).detach();
+    return true;
+}
+
+TaskWake taskWakeNow() {
+    return TaskWake{halMillis()};
+}
+
+void taskDelayUntil(TaskWake& lastWake, uint32_t periodMs) {
+    lastWake.ms += periodMs;
+    int32_t remaining = (int32_t)(lastWake.ms - halMillis());
+    if (remaining > 0) {
+        taskDelay(remaining);
+    }
+}
+
+void taskDelay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "sensors.h"
+
+#include <math.h>
+
+#include "accel_capture.h"
+#include "dht22.h"
+#include "hal.h"
+#include "lux_table.h"
+#include "system_state.h"
+
+// Tabela em flash (16 KB), verificada em tempo de compilação
+static constexpr LuxTable LUX_TABLE = makeLuxTable();
+
+static_assert(LUX_TABLE.lux[0] == 0.0f, "ADC em 0 deve dar 0 lux");
+static_assert(LUX_TABLE.lux[LDR_ADC_MAX] == LUX_TABLE.lux[LDR_ADC_MAX - 1], "topo deve saturar");
+static_assert(LUX_TABLE.lux[2048] > 95.0f && LUX_TABLE.lux[2048] < 105.0f,
+              "meio da escala (~100 lux) fora do modelo GAMMA/RL10");
+
+float calculateLux(int rawValue) {
+    // Leituras fora da faixa do ADC (overrides via API) saturam nas pontas
+    if (rawValue <= 0) {
+        return LUX_TABLE.lux[0];
+    }
+    if (rawValue > LDR_ADC_MAX) {
+        rawValue = LDR_ADC_MAX;
+    }
+    return LUX_TABLE.lux[rawValue];
+}
+
+// Última aceleração conhecida, caso o FIFO ainda não tenha amostras novas
+static float lastAccel[3] = {0.0, 0.0, 1.0};
+
+void readFastSample(FastSample& sample) {
+    sample.timestampMs = halMillis();
+    SensorOverrides overrides = sensorOverrides.read();
+    
+    if (overrides.ldr_override) {
+        sample.ldrRaw = overrides.ldr_raw_override;
+    } else {
+        sample.ldrRaw = halReadLDR();
+    }
+    
+    // Drenar o FIFO do MPU6050 (o override via API é aplicado na captura)
+    AccelRaw last;
+    sample.accelCount = accelCaptureDrain(overrides, last);
+    if (sample.accelCount > 0) {
+        // Converter para g (16384 LSB/g para escala ±2g)
+        lastAccel[0] = last.x / 16384.0;
+        lastAccel[1] = last.y / 16384.0;
+        lastAccel[2] = last.z / 16384.0;
+    }
+    sample.accelX = lastAccel[0];
+    sample.accelY = lastAccel[1];
+    sample.accelZ = lastAccel[2];
+}
+
+// Último quadro do DHT22; só a tarefa lenta o acessa
+static Dht22Reader dhtReader;
+static Dht22PulseTrain dhtTrain;
+
+void readEnvSample(EnvSample& sample) {
+    sample.timestampMs = halMillis();
+    SensorOverrides overrides = sensorOverrides.read();
+    
+    if (overrides.dht22_override) {
+        sample.temperature = overrides.temperature_override;
+        sample.humidity = overrides.humidity_override;
+        return;
+    }
+    
+    // Chamadas dentro do intervalo mínimo repetem o quadro guardado
+    if (dhtReader.due(sample.timestampMs)) {
+        dhtReader.start(sample.timestampMs);
+        dhtTrain.clear();
+        halDhtCapture(dhtTrain);
+        dhtReader.complete(dhtTrain);
+    }
+    Dht22Frame frame;
+    uint32_t capturedMs;
+    if (dhtReader.frame(frame, capturedMs)) {
+        sample.timestampMs = capturedMs;
+        sample.temperature = frame.temperature;
+        sample.humidity = frame.humidity;
+    } else {
+        sample.temperature = NAN;
+        sample.humidity = NAN;
+    }
+}
+
+Dht22Stats dhtStats() {
+    return dhtReader.stats();
+}
@@ -0,0 +1,182 @@
+#include "spectrum.h"
+
+#include <math.h>
+
+static_assert(FFT_SIZE >= 8 && (FFT_SIZE & (FFT_SIZE - 1)) == 0, "FFT_SIZE deve ser potência de 2");
+
+const uint32_t HALF = FFT_SIZE / 2;
+
+void SpectrumAnalyzer::begin(float sampleRateHz) {
+    sampleRate = sampleRateHz;
+    fill = 0;
+    current = {};
+    
+    // Janela de Hann e seus ganhos para correção de amplitude/potência
+    windowSum = 0;
+    windowPowerSum = 0;
+    for (uint32_t n = 0; n < FFT_SIZE; n++) {
+        window[n] = 0.5f - 0.5f * cosf(2.0f * M_PI * n / FFT_SIZE);
+        windowSum += window[n];
+        windowPowerSum += window[n] * window[n];
+    }
+    
+    for (uint32_t k = 0; k < HALF; k++) {
+        cosTable[k] = cosf(2.0f * M_PI * k / FFT_SIZE);
+        sinTable[k] = sinf(2.0f * M_PI * k / FFT_SIZE);
+    }
+    
+    // Permutação bit-reversal da FFT complexa de N/2 pontos
+    uint32_t bits = 0;
+    while ((1u << bits) < HALF) bits++;
+    for (uint32_t i = 0; i < HALF; i++) {
+        uint32_t reversed = 0;
+        for (uint32_t b = 0; b < bits; b++) {
+            if (i & (1u << b)) reversed |= 1u << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+}
+
+bool SpectrumAnalyzer::addSample(float value) {
+    frame[fill++] = value;
+    if (fill < FFT_SIZE) {
+        return false;
+    }
+    fill = 0;
+    analyze(frame);
+    return true;
+}
+
+// FFT complexa radix-2 (decimação no tempo) de N/2 pontos, in-place sobre
+// pares (re, im) intercalados
+void SpectrumAnalyzer::fft(float* data) {
+    for (uint32_t i = 0; i < HALF; i++) {
+        uint32_t j = bitReverse[i];
+        if (i < j) {
+            float re = data[2 * i];
+            float im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+    
+    for (uint32_t size = 2; size <= HALF; size <<= 1) {
+        uint32_t half = size >> 1;
+        uint32_t stride = FFT_SIZE / size; // passo na tabela de N/2 entradas
+        for (uint32_t start = 0; start < HALF; start += size) {
+            for (uint32_t j = 0; j < half; j++) {
+                float wr = cosTable[j * stride];
+                float wi = -sinTable[j * stride];
+                float* a = data + 2 * (start + j);
+                float* b = data + 2 * (start + j + half);
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::analyze(const float* samples) {
+    // Remover a componente DC (gravidade) e aplicar a janela; as amostras
+    // reais consecutivas formam diretamente os pares (re, im) empacotados
+    float mean = 0;
+    for (uint32_t n = 0; n < FFT_SIZE; n++) mean += samples[n];
+    mean /= FFT_SIZE;
+    for (uint32_t n = 0; n < FFT_SIZE; n++) {
+        work[n] = (samples[n] - mean) * window[n];
+    }
+    
+    fft(work);
+    
+    // Separar o espectro real e converter em potência média (g²) por bin,
+    // unilateral e normalizada pelo ganho de potência da janela
+    float scale = 1.0f / (FFT_SIZE * windowPowerSum);
+    float z0r = work[0];
+    float z0i = work[1];
+    power[0] = (z0r + z0i) * (z0r + z0i) * scale;
+    power[HALF] = (z0r - z0i) * (z0r - z0i) * scale;
+    
+    for (uint32_t k = 1; k < HALF; k++) {
+        float ar = work[2 * k];
+        float ai = work[2 * k + 1];
+        float br = work[2 * (HALF - k)];
+        float bi = work[2 * (HALF - k) + 1];
+        
+        float evenRe = 0.5f * (ar + br);
+        float evenIm = 0.5f * (ai - bi);
+        float oddRe = 0.5f * (ai + bi);
+        float oddIm = -0.5f * (ar - br);
+        
+        float c = cosTable[k];
+        float s = sinTable[k];
+        float xr = evenRe + c * oddRe + s * oddIm;
+        float xi = evenIm + c * oddIm - s * oddRe;
+        power[k] = 2.0f * (xr * xr + xi * xi) * scale;
+    }
+    
+    current.frames++;
+    findPeaks();
+    computeBands();
+}
+
+void SpectrumAnalyzer::findPeaks() {
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) {
+        current.peaks[p].frequencyHz = 0;
+        current.peaks[p].amplitude = 0;
+    }
+    
+    for (uint32_t k = 2; k < HALF - 2; k++) {
+        // Máximo local em ±2 bins: descarta as saias de um pico vizinho
+        if (power[k] <= power[k - 1] || power[k] < power[k + 1] ||
+            power[k] <= power[k - 2] || power[k] < power[k + 2]) continue;
+        
+        // Interpolação gaussiana (parábola sobre log da potência), mais
+        // precisa que a linear para o lóbulo principal da janela de Hann
+        float a = logf(power[k - 1] + 1e-20f);
+        float b = logf(power[k] + 1e-20f);
+        float c = logf(power[k + 1] + 1e-20f);
+        float denominator = a - 2.0f * b + c;
+        float delta = denominator != 0 ? 0.5f * (a - c) / denominator : 0;
+        
+        // Amplitude pela energia do lóbulo principal (±2 bins), imune ao
+        // scalloping: potência média de uma senoide = A² / 2
+        float lobe = power[k - 2] + power[k - 1] + power[k] + power[k + 1] + power[k + 2];
+        float amplitude = sqrtf(2.0f * lobe);
+        
+        // Inserção ordenada entre os maiores picos
+        for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) {
+            if (amplitude > current.peaks[p].amplitude) {
+                for (uint32_t q = SPECTRAL_PEAKS - 1; q > p; q--) {
+                    current.peaks[q] = current.peaks[q - 1];
+                }
+                current.peaks[p].frequencyHz = (k + delta) * binHz();
+                current.peaks[p].amplitude = amplitude;
+                break;
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::computeBands() {
+    float hz = binHz();
+    float total = 0;
+    for (uint32_t k = 1; k <= HALF; k++) total += power[k];
+    current.totalRms = sqrtf(total);
+    
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        uint32_t first = (uint32_t)ceilf(SPECTRAL_BANDS[b].lowHz / hz);
+        uint32_t last = (uint32_t)floorf(SPECTRAL_BANDS[b].highHz / hz);
+        if (first < 1) first = 1;
+        if (last > HALF) last = HALF;
+        
+        float energy = 0;
+        for (uint32_t k = first; k <= last; k++) energy += power[k];
+        current.bandRms[b] = sqrtf(energy);
+    }
+}
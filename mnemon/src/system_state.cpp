@@ -0,0 +1,68 @@
+#include "system_state.h"
+
+#include "hal.h"
+#include "json_writer.h"
+#include "sensors.h"
+#include "timeline.h"
+
+Seqlock<SensorOverrides> sensorOverrides;
+Seqlock<LiveSample> currentReading;
+volatile ScenarioId currentScenario = ScenarioId::ApiControl;
+volatile AlertLevel alertLevel = AlertLevel::Normal;
+volatile int testStep = 0;
+volatile uint32_t scenarioStartTime = 0;
+
+void setScenario(ScenarioId id) {
+    currentScenario = id;
+    testStep = 0;
+    scenarioStartTime = halMillis();
+    if (scenarioInfo(id).stepSeconds > 0) {
+        timeline().loadScenario(id);
+    } else if (id == ScenarioId::ApiControl) {
+        timeline().stop();
+    }
+}
+
+void writeStatus(JsonWriter& json, const char* wifiIp) {
+    json.beginObject();
+    json.field("status", "online");
+    json.field("scenario", scenarioName(currentScenario));
+    json.field("alert_level", alertLevelName(alertLevel));
+    json.field("uptime_seconds", (unsigned long)(halMillis() / 1000));
+    json.field("wifi_ip", wifiIp);
+    
+    SensorOverrides overrides = sensorOverrides.read();
+    json.key("overrides");
+    json.beginObject();
+    json.field("dht22", overrides.dht22_override);
+    json.field("ldr", overrides.ldr_override);
+    json.field("mpu6050", overrides.mpu6050_override);
+    json.endObject();
+    
+    // Capturas do DHT22 por resultado
+    Dht22Stats dht = dhtStats();
+    json.key("dht22");
+    json.beginObject();
+    json.field("reads", (unsigned long)dht.reads);
+    for (size_t i = 0; i < (size_t)Dht22Status::Count; i++) {
+        json.field(DHT22_STATUS_NAMES[i], (unsigned long)dht.results[i]);
+    }
+    json.endObject();
+    
+    // Leitura atual, sempre de um mesmo ciclo da tarefa de alertas
+    LiveSample reading;
+    uint32_t version = currentReading.read(reading);
+    json.key("reading");
+    json.beginObject();
+    json.field("version", (unsigned long)version);
+    json.field("timestamp", (unsigned long)reading.timestampMs);
+    json.field("temperature", reading.temperature, 2);
+    json.field("humidity", reading.humidity, 2);
+    json.field("ldr_raw", reading.ldrRaw);
+    json.field("accel_x", reading.accelX, 3);
+    json.field("accel_y", reading.accelY, 3);
+    json.field("accel_z", reading.accelZ, 3);
+    json.field("vibration_rms", reading.vibrationRms, 3);
+    json.endObject();
+    json.endObject();
+}
@@ -0,0 +1,212 @@
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "hal.h"
+#include "json_writer.h"
+#include "system_state.h"
+#include "uplink.h"
+
+// Dois buffers: a tarefa de saída escreve no inativo e depois o publica, de
+// modo que um leitor HTTP nunca vê um registro pela metade
+static char telemetryBuffers[2][TELEMETRY_BUFFER_SIZE];
+static size_t telemetryLengths[2] = {0, 0};
+static volatile uint8_t publishedBuffer = 0;
+static std::atomic<uint32_t> publishedSeq(0);   // Publicações desde o boot
+
+static volatile TelemetryFormat format = TelemetryFormat::Json;
+static uint16_t frameSeq = 0;               // Só a tarefa de saída escreve quadros
+static uint8_t frameBuffer[FRAME_MAX_ENCODED];
+
+void setTelemetryFormat(TelemetryFormat newFormat) {
+    format = newFormat;
+}
+
+TelemetryFormat telemetryFormat() {
+    return format;
+}
+
+void formatTimestamp(uint32_t nowMs, char* buffer, size_t capacity) {
+    unsigned long elapsed = nowMs / 1000;
+    // Timestamp mais realístico baseado no tempo atual (13 de junho de 2025 como base)
+    unsigned long totalSeconds = elapsed + 1734120000; // Offset para 13/06/2025 00:00:00 UTC
+    unsigned long days = totalSeconds / 86400;
+    unsigned long daySeconds = totalSeconds % 86400;
+    unsigned long hours = daySeconds / 3600;
+    unsigned long minutes = (daySeconds % 3600) / 60;
+    unsigned long seconds = daySeconds % 60;
+    
+    // Ajustar para 13 de junho de 2025 como data base
+    int day = 13 + (days % 30); // Simular progressão de dias
+    int month = 6;
+    int year = 2025;
+    
+    if (day > 30) {
+        day = day - 30;
+        month++;
+        if (month > 12) {
+            month = 1;
+            year++;
+        }
+    }
+    
+    snprintf(buffer, capacity, "%04d-%02d-%02dT%02d:%02d:%02dZ", 
+             year, month, day, (int)hours, (int)minutes, (int)seconds);
+}
+
+size_t encodeTelemetry(const Snapshot& snapshot, uint32_t nowMs, char* buffer, size_t capacity) {
+    char timestamp[32];
+    formatTimestamp(nowMs, timestamp, sizeof(timestamp));
+    
+    JsonWriter json(buffer, capacity);
+    json.beginObject();
+    json.field("timestamp", timestamp);
+    json.field("scenario", scenarioName(currentScenario));
+    json.field("step", (int)testStep);
+    json.field("elapsed_seconds", (unsigned long)(nowMs / 1000));
+    
+    // Dados dos sensores
+    json.key("sensors");
+    json.beginObject();
+    
+    json.key("dht22");
+    json.beginObject();
+    json.field("temperature", snapshot.temperature, 1);
+    json.field("humidity", snapshot.humidity, 1);
+    json.endObject();
+    
+    json.key("ldr");
+    json.beginObject();
+    json.field("raw", snapshot.ldrRaw);
+    json.field("lux", snapshot.lux, 0);
+    json.endObject();
+    
+    json.key("mpu6050");
+    json.beginObject();
+    json.field("accelX", snapshot.accelX, 2);
+    json.field("accelY", snapshot.accelY, 2);
+    json.field("accelZ", snapshot.accelZ, 2);
+    
+    // Características da janela de vibração
+    const VibrationFeatures& features = snapshot.vibration;
+    json.key("vibration");
+    json.beginObject();
+    json.field("rms", features.rmsTotal, 3);
+    json.field("peak", features.peakMagnitude, 2);
+    json.field("p2p", features.magnitude.peakToPeak, 3);
+    json.field("crest", features.magnitude.crestFactor, 2);
+    json.field("kurtosis", features.magnitude.kurtosis, 2);
+    json.endObject();
+    
+    // Frequências dominantes e RMS por banda do último quadro da FFT
+    const SpectralResult& spectrum = snapshot.spectrum;
+    json.key("spectrum");
+    json.beginObject();
+    json.key("dominant_hz");
+    json.beginArray();
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) json.fixed(spectrum.peaks[p].frequencyHz, 1);
+    json.endArray();
+    json.key("dominant_g");
+    json.beginArray();
+    for (uint32_t p = 0; p < SPECTRAL_PEAKS; p++) json.fixed(spectrum.peaks[p].amplitude, 3);
+    json.endArray();
+    json.key("bands");
+    json.beginObject();
+    for (uint32_t b = 0; b < SPECTRAL_BAND_COUNT; b++) {
+        json.field(SPECTRAL_BANDS[b].name, spectrum.bandRms[b], 3);
+    }
+    json.endObject();
+    json.endObject();
+    
+    json.endObject(); // mpu6050
+    json.endObject(); // sensors
+    
+    // Status dos atuadores
+    const AlertLevelInfo& level = alertLevelInfo(snapshot.alertLevel);
+    json.key("actuators");
+    json.beginObject();
+    json.field("rgb_led", ledColorInfo(level.color).name);
+    json.field("buzzer", level.buzzer ? "on" : "off");
+    json.endObject();
+    
+    json.field("alert_level", level.name);
+    json.endObject();
+    
+    return json.overflowed() ? 0 : json.length();
+}
+
+void sendJSONData(const Snapshot& snapshot) {
+    // Codificado direto no buffer estático e entregue à serial sem cópias
+    uint8_t target = publishedBuffer ^ 1;
+    char* buffer = telemetryBuffers[target];
+    size_t len = encodeTelemetry(snapshot, halMillis(), buffer, TELEMETRY_BUFFER_SIZE - 2);
+    if (len == 0) {
+        return;
+    }
+    
+    EnvironmentRecord record;
+    record.timestampMs = snapshot.timestampMs;
+    record.temperature = snapshot.temperature;
+    record.humidity = snapshot.humidity;
+    record.lux = snapshot.lux;
+    record.ldrRaw = snapshot.ldrRaw;
+    record.alertLevel = (uint8_t)snapshot.alertLevel;
+    record.scenario = (uint8_t)currentScenario;
+    record.step = testStep;
+    record.vibrationRms = snapshot.vibration.rmsTotal;
+    record.peakMagnitude = snapshot.vibration.peakMagnitude;
+    if (format == TelemetryFormat::Binary) {
+        size_t frameLen = encodeEnvironmentFrame(frameSeq++, record, frameBuffer);
+        halSerialWrite((const char*)frameBuffer, frameLen);
+    } else {
+        buffer[len] = '\r';
+        buffer[len + 1] = '\n';
+        halSerialWrite(buffer, len + 2);
+    }
+    // O mesmo registro segue para o collector, se houver (uplink.h)
+    uplink().record(record);
+    
+    telemetryLengths[target] = len;
+    publishedBuffer = target;
+    publishedSeq.fetch_add(1, std::memory_order_release);
+}
+
+void sendAccelBlock(const AccelBlock& block) {
+    if (format != TelemetryFormat::Binary) {
+        return;
+    }
+    size_t frameLen = encodeAccelFrame(frameSeq++, block, frameBuffer);
+    halSerialWrite((const char*)frameBuffer, frameLen);
+}
+
+const char* lastTelemetry(size_t& length) {
+    uint8_t index = publishedBuffer;
+    length = telemetryLengths[index];
+    return telemetryBuffers[index];
+}
+
+uint32_t telemetrySequence() {
+    return publishedSeq.load(std::memory_order_acquire);
+}
+
+// O buffer publicado só volta a ser escrito depois da publicação seguinte:
+// com a sequência igual antes e depois da cópia, o registro está inteiro
+size_t copyTelemetry(char* out, size_t capacity, uint32_t& sequence) {
+    for (;;) {
+        uint32_t before = publishedSeq.load(std::memory_order_acquire);
+        size_t length;
+        const char* body = lastTelemetry(length);
+        if (length > capacity) {
+            return 0;
+        }
+        memcpy(out, body, length);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (publishedSeq.load(std::memory_order_relaxed) == before) {
+            sequence = before;
+            return length;
+        }
+    }
+}
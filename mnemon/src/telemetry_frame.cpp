@@ -0,0 +1,186 @@
+#include "telemetry_frame.h"
+
+#include <string.h>
+
+size_t cobsEncode(const uint8_t* input, size_t len, uint8_t* output) {
+    size_t out = 1;
+    size_t codeIndex = 0;
+    uint8_t code = 1;
+    
+    for (size_t i = 0; i < len; i++) {
+        if (input[i] == 0) {
+            output[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+            continue;
+        }
+        output[out++] = input[i];
+        if (++code == 0xFF) {
+            output[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        }
+    }
+    output[codeIndex] = code;
+    return out;
+}
+
+size_t cobsDecode(const uint8_t* input, size_t len, uint8_t* output) {
+    size_t in = 0;
+    size_t out = 0;
+    
+    while (in < len) {
+        uint8_t code = input[in++];
+        if (code == 0 || in + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (input[in] == 0) return 0;
+            output[out++] = input[in++];
+        }
+        if (code != 0xFF && in < len) {
+            output[out++] = 0;
+        }
+    }
+    return out;
+}
+
+// Escrita/leitura little-endian independente do alinhamento
+static uint8_t* put16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+static uint8_t* put32(uint8_t* p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+static uint8_t* putFloat(uint8_t* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return put32(p, bits);
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float getFloat(const uint8_t* p) {
+    uint32_t bits = get32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static uint8_t* putHeader(uint8_t* p, FrameType type, uint16_t seq, uint32_t timestampMs) {
+    *p++ = (uint8_t)type;
+    *p++ = FRAME_VERSION;
+    p = put16(p, seq);
+    return put32(p, timestampMs);
+}
+
+// Acrescenta o CRC, aplica COBS e os delimitadores
+static size_t finishFrame(uint8_t* payload, uint8_t* end, uint8_t* output) {
+    size_t len = end - payload;
+    put32(end, crc32(payload, len));
+    output[0] = 0;
+    size_t encoded = cobsEncode(payload, len + FRAME_CRC_SIZE, output + 1);
+    output[encoded + 1] = 0;
+    return encoded + 2;
+}
+
+size_t encodeAccelFrame(uint16_t seq, const AccelBlock& block, uint8_t* output) {
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint16_t count = block.count <= ACCEL_BLOCK_SAMPLES ? block.count : ACCEL_BLOCK_SAMPLES;
+    
+    uint8_t* p = putHeader(payload, FrameType::AccelBlock, seq, block.timestampMs);
+    p = put16(p, block.sampleRateHz);
+    p = put16(p, count);
+    p = put32(p, block.firstIndex);
+    for (uint16_t i = 0; i < count; i++) {
+        p = put16(p, block.samples[i].x);
+        p = put16(p, block.samples[i].y);
+        p = put16(p, block.samples[i].z);
+    }
+    return finishFrame(payload, p, output);
+}
+
+size_t encodeEnvironmentFrame(uint16_t seq, const EnvironmentRecord& record, uint8_t* output) {
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    
+    uint8_t* p = putHeader(payload, FrameType::Environment, seq, record.timestampMs);
+    p = putFloat(p, record.temperature);
+    p = putFloat(p, record.humidity);
+    p = putFloat(p, record.lux);
+    p = put16(p, record.ldrRaw);
+    *p++ = record.alertLevel;
+    *p++ = record.scenario;
+    *p++ = record.step;
+    *p++ = 0;
+    p = putFloat(p, record.vibrationRms);
+    p = putFloat(p, record.peakMagnitude);
+    return finishFrame(payload, p, output);
+}
+
+bool decodeFrame(const uint8_t* payload, size_t len, DecodedFrame& frame) {
+    if (len < FRAME_HEADER_SIZE + FRAME_CRC_SIZE) {
+        return false;
+    }
+    size_t bodyEnd = len - FRAME_CRC_SIZE;
+    if (crc32(payload, bodyEnd) != get32(payload + bodyEnd)) {
+        return false;
+    }
+    if (payload[1] != FRAME_VERSION) {
+        return false;
+    }
+    
+    frame.type = (FrameType)payload[0];
+    frame.seq = get16(payload + 2);
+    frame.timestampMs = get32(payload + 4);
+    const uint8_t* p = payload + FRAME_HEADER_SIZE;
+    size_t bodyLen = bodyEnd - FRAME_HEADER_SIZE;
+    
+    switch (frame.type) {
+        case FrameType::AccelBlock: {
+            if (bodyLen < 8) return false;
+            AccelBlock& block = frame.accel;
+            block.timestampMs = frame.timestampMs;
+            block.sampleRateHz = get16(p);
+            block.count = get16(p + 2);
+            block.firstIndex = get32(p + 4);
+            if (block.count > ACCEL_BLOCK_SAMPLES || bodyLen != 8 + block.count * 6u) return false;
+            p += 8;
+            for (uint16_t i = 0; i < block.count; i++, p += 6) {
+                block.samples[i].x = (int16_t)get16(p);
+                block.samples[i].y = (int16_t)get16(p + 2);
+                block.samples[i].z = (int16_t)get16(p + 4);
+            }
+            return true;
+        }
+        case FrameType::Environment: {
+            if (bodyLen != ENVIRONMENT_BODY_SIZE) return false;
+            EnvironmentRecord& record = frame.environment;
+            record.timestampMs = frame.timestampMs;
+            record.temperature = getFloat(p);
+            record.humidity = getFloat(p + 4);
+            record.lux = getFloat(p + 8);
+            record.ldrRaw = get16(p + 12);
+            record.alertLevel = p[14];
+            record.scenario = p[15];
+            record.step = p[16];
+            record.vibrationRms = getFloat(p + 18);
+            record.peakMagnitude = getFloat(p + 22);
+            return true;
+        }
+    }
+    return false;
+}
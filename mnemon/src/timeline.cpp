@@ -0,0 +1,276 @@
+#include "timeline.h"
+
+#include <math.h>
+#include <string.h>
+
+static TimelinePlayer player;
+
+TimelinePlayer& timeline() {
+    return player;
+}
+
+bool findTimelineSensor(const char* name, TimelineSensor& sensor) {
+    for (size_t i = 0; i < sizeof(TIMELINE_SENSOR_NAMES) / sizeof(TIMELINE_SENSOR_NAMES[0]); i++) {
+        if (strcmp(TIMELINE_SENSOR_NAMES[i], name) == 0) {
+            sensor = (TimelineSensor)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void scenarioTimeline(ScenarioId id, Timeline& timeline) {
+    const ScenarioInfo& info = scenarioInfo(id);
+    memset(&timeline, 0, sizeof(timeline));
+    strncpy(timeline.name, info.name, sizeof(timeline.name) - 1);
+    timeline.count = info.stepCount;
+    timeline.loopMs = (uint32_t)info.stepSeconds * info.stepCount * 1000;
+    for (uint8_t i = 0; i < info.stepCount; i++) {
+        TimelineStep& step = timeline.steps[i];
+        step.atMs = (uint32_t)i * info.stepSeconds * 1000;
+        step.sensor = TimelineSensor::None;
+        step.step = i + 1;
+    }
+}
+
+// Primeiro canal e número de valores de cada sensor
+static void sensorChannels(TimelineSensor sensor, uint8_t& first, uint8_t& count) {
+    switch (sensor) {
+        case TimelineSensor::Dht22: first = 0; count = 2; break;
+        case TimelineSensor::Ldr: first = 2; count = 1; break;
+        case TimelineSensor::Mpu6050: first = 3; count = 3; break;
+        case TimelineSensor::All: first = 0; count = 6; break;
+        default: first = 0; count = 0; break;
+    }
+}
+
+bool prepareTimeline(Timeline& timeline, const char*& error) {
+    if (timeline.count > TIMELINE_MAX_STEPS) {
+        error = "Too many steps";
+        return false;
+    }
+
+    // Inserção estável: passos no mesmo instante mantêm a ordem do pedido
+    for (uint16_t i = 1; i < timeline.count; i++) {
+        TimelineStep step = timeline.steps[i];
+        uint16_t j = i;
+        while (j > 0 && timeline.steps[j - 1].atMs > step.atMs) {
+            timeline.steps[j] = timeline.steps[j - 1];
+            j--;
+        }
+        timeline.steps[j] = step;
+    }
+
+    for (uint16_t i = 0; i < timeline.count; i++) {
+        const TimelineStep& step = timeline.steps[i];
+        uint8_t first, count;
+        sensorChannels(step.sensor, first, count);
+        bool disable = step.fields & TIMELINE_DISABLE;
+        uint8_t values = step.fields & ~TIMELINE_DISABLE;
+        if (step.sensor == TimelineSensor::None && step.step == 0) {
+            error = "Step without sensor or step label";
+            return false;
+        }
+        if (step.sensor == TimelineSensor::All && !disable) {
+            error = "Sensor 'all' only supports disable";
+            return false;
+        }
+        if (step.sensor != TimelineSensor::None && !disable && values == 0) {
+            error = "Step without values";
+            return false;
+        }
+        if (disable && (values != 0 || step.rampMs > 0)) {
+            error = "Disable cannot be combined with values or ramp";
+            return false;
+        }
+        if (step.sensor != TimelineSensor::All && (values >> count) != 0) {
+            error = "Value not supported by sensor";
+            return false;
+        }
+    }
+    if (timeline.loopMs > 0 && timeline.count > 0 &&
+        timeline.steps[timeline.count - 1].atMs >= timeline.loopMs) {
+        error = "loop_ms must be greater than the last at_ms";
+        return false;
+    }
+    return true;
+}
+
+static float channelValue(const SensorOverrides& o, uint8_t channel) {
+    switch (channel) {
+        case 0: return o.temperature_override;
+        case 1: return o.humidity_override;
+        case 2: return (float)o.ldr_raw_override;
+        case 3: return o.accel_x_override;
+        case 4: return o.accel_y_override;
+        default: return o.accel_z_override;
+    }
+}
+
+static void setChannel(SensorOverrides& o, uint8_t channel, float value) {
+    switch (channel) {
+        case 0: o.temperature_override = value; break;
+        case 1: o.humidity_override = value; break;
+        case 2: o.ldr_raw_override = (int)lroundf(value); break;
+        case 3: o.accel_x_override = value; break;
+        case 4: o.accel_y_override = value; break;
+        default: o.accel_z_override = value; break;
+    }
+}
+
+static void setEnabled(SensorOverrides& o, TimelineSensor sensor, bool enabled) {
+    if (sensor == TimelineSensor::Dht22 || sensor == TimelineSensor::All) o.dht22_override = enabled;
+    if (sensor == TimelineSensor::Ldr || sensor == TimelineSensor::All) o.ldr_override = enabled;
+    if (sensor == TimelineSensor::Mpu6050 || sensor == TimelineSensor::All) o.mpu6050_override = enabled;
+}
+
+void TimelinePlayer::begin() {
+    mutex.begin();
+}
+
+void TimelinePlayer::load(const Timeline& timeline) {
+    ScopedLock lock(mutex);
+    pending = timeline;
+    pendingStop = false;
+    pendingLoad = true;
+}
+
+void TimelinePlayer::loadScenario(ScenarioId id) {
+    ScopedLock lock(mutex);
+    scenarioTimeline(id, pending);
+    pendingStop = false;
+    pendingLoad = true;
+}
+
+void TimelinePlayer::stop() {
+    ScopedLock lock(mutex);
+    pendingLoad = false;
+    pendingStop = true;
+}
+
+void TimelinePlayer::apply(const TimelineStep& step, uint32_t scheduledMs, SensorOverrides& overrides) {
+    if (step.step > 0) {
+        testStep = step.step;
+    }
+    uint8_t first, count;
+    sensorChannels(step.sensor, first, count);
+    if (step.fields & TIMELINE_DISABLE) {
+        setEnabled(overrides, step.sensor, false);
+        for (uint8_t c = first; c < first + count; c++) {
+            ramps[c].active = false;
+        }
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (!(step.fields & (1 << i))) {
+            continue;
+        }
+        uint8_t channel = first + i;
+        Ramp& ramp = ramps[channel];
+        if (step.rampMs > 0) {
+            ramp.from = channelValue(overrides, channel);
+            ramp.to = step.values[i];
+            ramp.startMs = scheduledMs;
+            ramp.durationMs = step.rampMs;
+            ramp.active = true;
+        } else {
+            ramp.active = false;
+            setChannel(overrides, channel, step.values[i]);
+        }
+    }
+    if (count > 0) {
+        setEnabled(overrides, step.sensor, true);
+    }
+}
+
+bool TimelinePlayer::updateRamps(uint32_t nowMs, SensorOverrides& overrides) {
+    bool changed = false;
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+        Ramp& ramp = ramps[c];
+        if (!ramp.active) {
+            continue;
+        }
+        changed = true;
+        uint32_t elapsed = nowMs - ramp.startMs;
+        if (elapsed >= ramp.durationMs) {
+            setChannel(overrides, c, ramp.to);
+            ramp.active = false;
+        } else {
+            float t = (float)elapsed / ramp.durationMs;
+            setChannel(overrides, c, ramp.from + (ramp.to - ramp.from) * t);
+        }
+    }
+    return changed;
+}
+
+bool TimelinePlayer::tick(uint32_t nowMs, SensorOverrides& overrides) {
+    ScopedLock lock(mutex);
+    if (pendingLoad || pendingStop) {
+        if (pendingLoad) {
+            current = pending;
+            active = true;
+            startMs = nowMs;
+            next = 0;
+            loops = 0;
+            memset(ramps, 0, sizeof(ramps));
+            testStep = 0;
+            scenarioStartTime = nowMs;
+        } else {
+            active = false;
+            memset(ramps, 0, sizeof(ramps));
+        }
+        pendingLoad = false;
+        pendingStop = false;
+    }
+    lastTickMs = nowMs;
+    if (!active) {
+        return false;
+    }
+    bool changed = false;
+
+    // Passos vencidos, inclusive o fim da volta interrompida por um atraso
+    for (;;) {
+        uint32_t elapsed = nowMs - startMs;
+        bool wrapped = current.loopMs > 0 && elapsed >= current.loopMs;
+        uint32_t limit = wrapped ? current.loopMs : elapsed;
+        while (next < current.count && current.steps[next].atMs <= limit) {
+            const TimelineStep& step = current.steps[next++];
+            // Rampas interrompidas por um passo posterior partem do valor
+            // que teriam no instante agendado desse passo
+            updateRamps(startMs + step.atMs, overrides);
+            apply(step, startMs + step.atMs, overrides);
+            changed |= step.sensor != TimelineSensor::None;
+        }
+        if (!wrapped) {
+            break;
+        }
+        // Voltas inteiras perdidas repetiriam o mesmo estado: só são contadas
+        uint32_t skipped = elapsed / current.loopMs - 1;
+        startMs += (skipped + 1) * current.loopMs;
+        loops += skipped + 1;
+        next = 0;
+    }
+    changed |= updateRamps(nowMs, overrides);
+
+    bool rampsActive = false;
+    for (const Ramp& ramp : ramps) rampsActive |= ramp.active;
+    if (current.loopMs == 0 && next == current.count && !rampsActive) {
+        active = false;
+    }
+    return changed;
+}
+
+// Sob o mutex de tick(): passo, voltas e nome da mesma linha do tempo,
+// mesmo durante uma troca
+TimelineStatus TimelinePlayer::status() const {
+    ScopedLock lock(mutex);
+    TimelineStatus s;
+    s.active = active;
+    memcpy(s.name, current.name, sizeof(s.name));
+    s.name[sizeof(s.name) - 1] = '\0';
+    s.elapsedMs = active ? lastTickMs - startMs : 0;
+    s.nextStep = next;
+    s.count = current.count;
+    s.loops = loops;
+    return s;
+}
@@ -0,0 +1,709 @@
+#include "uplink.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "flash_log.h"
+#include "hal.h"
+#include "json_writer.h"
+
+namespace {
+
+const uint32_t SPILL_MAGIC = 0x51504C55;        // "ULPQ"
+
+struct SpillHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t reserved;
+    uint32_t crc;
+};
+
+// Lote na flash: QueuedBatch | u32 estado | corpo, alinhado a 4 bytes
+const uint32_t ENTRY_HEADER_SIZE = sizeof(QueuedBatch) + 4;
+const uint32_t ENTRY_PENDING = 0xFFFFFFFF;
+
+uint32_t entrySize(uint32_t length) {
+    return (ENTRY_HEADER_SIZE + length + 3) & ~3u;
+}
+
+static_assert(sizeof(SpillHeader) + ENTRY_HEADER_SIZE + UPLINK_BODY_MAX <= FLASH_SECTOR_SIZE,
+              "lote do uplink não cabe num setor");
+
+}  // namespace
+
+// --- BatchSpill ---
+
+void BatchSpill::begin(uint32_t offset, uint32_t sectors) {
+    base = offset;
+    sectorCount = sectors;
+    counters = {};
+    counters.sectors = sectors;
+    pending = 0;
+    liveSectors = 0;
+    if (!enabled()) {
+        sectorCount = 0;
+        counters.sectors = 0;
+        return;
+    }
+    scan();
+    counters.recovered = pending;
+}
+
+bool BatchSpill::readSector(uint32_t sector, uint32_t& seq) const {
+    SpillHeader header;
+    if (!halFlashRead(address(sector), &header, sizeof(header))) {
+        return false;
+    }
+    seq = header.seq;
+    return header.magic == SPILL_MAGIC &&
+           header.crc == crc32((const uint8_t*)&header, offsetof(SpillHeader, crc));
+}
+
+// Cabeçalho plausível; o corpo só é conferido na leitura (front)
+bool BatchSpill::readEntry(uint32_t sector, uint32_t offset, QueuedBatch& batch, uint32_t& state) const {
+    if (offset + ENTRY_HEADER_SIZE > FLASH_SECTOR_SIZE) {
+        return false;
+    }
+    uint8_t header[ENTRY_HEADER_SIZE];
+    if (!halFlashRead(address(sector) + offset, header, sizeof(header))) {
+        return false;
+    }
+    memcpy(&batch, header, sizeof(batch));
+    memcpy(&state, header + sizeof(batch), sizeof(state));
+    return batch.length > 0 && batch.length <= UPLINK_BODY_MAX &&
+           batch.records > 0 && batch.records <= UPLINK_BATCH_RECORDS &&
+           offset + entrySize(batch.length) <= FLASH_SECTOR_SIZE;
+}
+
+// Reconstrói cauda, frente e pendentes a partir da flash: a cauda é o setor
+// de maior seq e os setores vivos são os que a antecedem com seq contígua
+void BatchSpill::scan() {
+    bool found = false;
+    for (uint32_t s = 0; s < sectorCount; s++) {
+        uint32_t seq;
+        if (readSector(s, seq) && (!found || seq > tailSeq)) {
+            tail = s;
+            tailSeq = seq;
+            found = true;
+        }
+    }
+    pending = 0;
+    if (!found) {
+        liveSectors = 0;
+        writeOffset = FLASH_SECTOR_SIZE;    // O primeiro push abre um setor
+        tail = sectorCount - 1;
+        tailSeq = 0;
+        return;
+    }
+    liveSectors = 1;
+    while (liveSectors < sectorCount) {
+        uint32_t sector = (tail + sectorCount - liveSectors) % sectorCount;
+        uint32_t seq;
+        if (!readSector(sector, seq) || seq != tailSeq - liveSectors) {
+            break;
+        }
+        liveSectors++;
+    }
+
+    // Do setor vivo mais antigo à cauda; os confirmados vêm sempre antes
+    // dos pendentes
+    for (uint32_t i = liveSectors; i > 0; i--) {
+        uint32_t sector = (tail + sectorCount - (i - 1)) % sectorCount;
+        uint32_t offset = sizeof(SpillHeader);
+        QueuedBatch batch;
+        uint32_t state;
+        while (readEntry(sector, offset, batch, state)) {
+            if (state == ENTRY_PENDING) {
+                if (pending == 0) {
+                    frontSector = sector;
+                    frontOffset = offset;
+                }
+                pending++;
+            }
+            offset += entrySize(batch.length);
+        }
+        if (sector == tail) {
+            // Área não apagada depois do último lote (escrita interrompida):
+            // a cauda é encerrada e o próximo lote abre outro setor
+            uint32_t word = ENTRY_PENDING;
+            bool erased = offset + 4 > FLASH_SECTOR_SIZE ||
+                          (halFlashRead(address(sector) + offset, &word, 4) && word == ENTRY_PENDING);
+            writeOffset = erased ? offset : FLASH_SECTOR_SIZE;
+        }
+    }
+}
+
+void BatchSpill::startSector(uint32_t sector, uint32_t seq) {
+    SpillHeader header = {SPILL_MAGIC, seq, 0xFFFFFFFF, 0};
+    header.crc = crc32((const uint8_t*)&header, offsetof(SpillHeader, crc));
+    counters.erases++;
+    halFlashEraseSector(address(sector));
+    halFlashWrite(address(sector), &header, sizeof(header));
+    tail = sector;
+    tailSeq = seq;
+    writeOffset = sizeof(SpillHeader);
+    if (liveSectors < sectorCount) {
+        liveSectors++;
+    }
+}
+
+void BatchSpill::push(const QueuedBatch& batch, const uint8_t* body, size_t length,
+                      const uint8_t* more, size_t moreLength,
+                      uint32_t& droppedBatches, uint32_t& droppedRecords) {
+    droppedBatches = 0;
+    droppedRecords = 0;
+    uint32_t size = entrySize(batch.length);
+    if (writeOffset + size > FLASH_SECTOR_SIZE) {
+        uint32_t next = (tail + 1) % sectorCount;
+        // Anel cheio: os pendentes do setor mais antigo se perdem e a frente
+        // passa para o setor seguinte, onde todos estão pendentes
+        if (pending > 0 && frontSector == next) {
+            uint32_t offset = frontOffset;
+            QueuedBatch old;
+            uint32_t state;
+            while (pending > 0 && readEntry(next, offset, old, state)) {
+                droppedBatches++;
+                droppedRecords += old.records;
+                pending--;
+                offset += entrySize(old.length);
+            }
+            frontSector = (next + 1) % sectorCount;
+            frontOffset = sizeof(SpillHeader);
+        }
+        startSector(next, tailSeq + 1);
+    }
+    if (pending == 0) {
+        frontSector = tail;
+        frontOffset = writeOffset;
+    }
+
+    // Cabeçalho, depois o corpo: um corte no meio deixa o CRC inválido
+    uint8_t header[ENTRY_HEADER_SIZE];
+    uint32_t state = ENTRY_PENDING;
+    memcpy(header, &batch, sizeof(batch));
+    memcpy(header + sizeof(batch), &state, sizeof(state));
+    uint32_t at = address(tail) + writeOffset;
+    halFlashWrite(at, header, sizeof(header));
+    halFlashWrite(at + sizeof(header), body, length);
+    if (moreLength > 0) {
+        halFlashWrite(at + sizeof(header) + length, more, moreLength);
+    }
+    writeOffset += size;
+    pending++;
+    counters.writes++;
+}
+
+bool BatchSpill::front(QueuedBatch& batch, uint8_t* body) {
+    uint32_t state;
+    if (pending == 0 || !readEntry(frontSector, frontOffset, batch, state)) {
+        return false;
+    }
+    if (body == nullptr) {
+        return true;
+    }
+    uint32_t at = address(frontSector) + frontOffset + ENTRY_HEADER_SIZE;
+    if (!halFlashRead(at, body, batch.length) || crc32(body, batch.length) != batch.crc) {
+        counters.corrupt++;
+        return false;
+    }
+    return true;
+}
+
+void BatchSpill::pop() {
+    QueuedBatch batch;
+    uint32_t state;
+    if (pending == 0) {
+        return;
+    }
+    if (!readEntry(frontSector, frontOffset, batch, state)) {
+        // Cabeçalho ilegível: sem o tamanho não há como seguir no setor
+        scan();
+        return;
+    }
+    uint32_t consumed = 0;
+    halFlashWrite(address(frontSector) + frontOffset + sizeof(QueuedBatch), &consumed, sizeof(consumed));
+    frontOffset += entrySize(batch.length);
+    pending--;
+    if (pending > 0 && !readEntry(frontSector, frontOffset, batch, state)) {
+        frontSector = (frontSector + 1) % sectorCount;
+        frontOffset = sizeof(SpillHeader);
+    }
+}
+
+BatchSpillStats BatchSpill::stats() const {
+    BatchSpillStats s = counters;
+    s.batches = pending;
+    return s;
+}
+
+// --- Uplink ---
+
+static Uplink instance;
+
+Uplink& uplink() {
+    return instance;
+}
+
+void Uplink::begin(uint32_t spillOffset, uint32_t spillSectors) {
+    mutex.begin();
+    open[0].length = open[0].records = 0;
+    open[1].length = open[1].records = 0;
+    ringHead = ringUsed = ringCount = 0;
+    spill.begin(spillOffset, spillSectors);
+    upload.clear();
+    age.clear();
+    bootId = halRandom();
+    configure(UPLINK_DEFAULT_HOST, UPLINK_DEFAULT_PORT, "mnemon");
+}
+
+void Uplink::configure(const char* newHost, uint16_t newPort, const char* newDevice) {
+    ScopedLock lock(mutex);
+    snprintf(nextHost, sizeof(nextHost), "%s", newHost);
+    snprintf(nextDevice, sizeof(nextDevice), "%s", newDevice);
+    nextPort = newPort;
+    reconfigured = true;
+    enabled = nextHost[0] != '\0';
+}
+
+// A conexão é da tarefa do uplink: configure() só deixa o pedido
+void Uplink::applyConfig() {
+    bool changed;
+    {
+        ScopedLock lock(mutex);
+        if (!reconfigured) {
+            return;
+        }
+        reconfigured = false;
+        changed = strcmp(nextHost, host) != 0 || nextPort != port || strcmp(nextDevice, device) != 0;
+        memcpy(host, nextHost, sizeof(host));
+        memcpy(device, nextDevice, sizeof(device));
+        port = nextPort;
+    }
+    if (changed) {
+        // Collector novo: tenta já, sem o backoff do anterior
+        attempted = false;
+        retryMs = 0;
+        if (connected) {
+            halUplinkClose();
+            connected = false;
+            inFlight = false;
+            messageLength = messageSent = 0;
+            counters.disconnects++;
+        }
+    }
+}
+
+void Uplink::record(const EnvironmentRecord& record) {
+    if (!enabled) {
+        return;
+    }
+    EnvironmentRecord stamped = record;
+    stamped.timestampMs = flashLog().clock(record.timestampMs);
+    ScopedLock lock(mutex);
+    OpenBatch& batch = open[openIndex];
+    if (batch.records == UPLINK_BATCH_RECORDS) {
+        counters.overruns++;    // Tarefa do uplink parada por mais de um lote
+        return;
+    }
+    if (batch.records == 0) {
+        batch.firstMs = record.timestampMs;
+    }
+    batch.length += encodeEnvironmentFrame(frameSeq++, stamped, batch.frames + batch.length);
+    batch.records++;
+    counters.records++;
+}
+
+void Uplink::seal(uint32_t nowMs) {
+    uint8_t index;
+    {
+        ScopedLock lock(mutex);
+        const OpenBatch& current = open[openIndex];
+        if (current.records == 0 ||
+            (current.records < UPLINK_BATCH_RECORDS && nowMs - current.firstMs < UPLINK_BATCH_MAX_AGE_MS)) {
+            return;
+        }
+        index = openIndex;
+        openIndex ^= 1;
+    }
+    OpenBatch& batch = open[index];
+
+    QueuedBatch queued = {};
+    size_t compressed = encoder.encode(batch.frames, batch.length, sealed, sizeof(sealed));
+    if (compressed > 0 && compressed < batch.length) {
+        queued.encoding = (uint8_t)BatchEncoding::Gzip;
+        queued.length = (uint16_t)compressed;
+        counters.gzipBatches++;
+    } else {
+        queued.encoding = (uint8_t)BatchEncoding::Frames;
+        queued.length = batch.length;
+        memcpy(sealed, batch.frames, batch.length);
+    }
+    queued.records = batch.records;
+    queued.sealMs = flashLog().clock(nowMs);
+    queued.crc = crc32(sealed, queued.length);
+
+    counters.batches++;
+    counters.rawBytes += batch.length;
+    counters.batchBytes += queued.length;
+    counters.lastRecords = queued.records;
+    counters.lastBytes = queued.length;
+    batch.length = 0;
+    batch.records = 0;
+    enqueue(queued, sealed);
+}
+
+void Uplink::enqueue(const QueuedBatch& batch, const uint8_t* body) {
+    size_t size = sizeof(QueuedBatch) + batch.length;
+    while (UPLINK_QUEUE_BYTES - ringUsed < size) {
+        // Sem espaço na RAM: o mais antigo vai para a flash (ou é descartado)
+        QueuedBatch oldest;
+        const uint8_t* part;
+        const uint8_t* more;
+        size_t length, moreLength;
+        ringPeek(oldest, part, length, more, moreLength);
+        if (spill.enabled()) {
+            uint32_t droppedBatches, droppedRecords;
+            spill.push(oldest, part, length, more, moreLength, droppedBatches, droppedRecords);
+            drop(droppedBatches, droppedRecords);
+        } else {
+            drop(1, oldest.records);
+        }
+        ringPop();
+    }
+    ringPush(batch, body);
+    if (queued() > counters.peakBatches) {
+        counters.peakBatches = queued();
+    }
+}
+
+// Descartes saem sempre da frente: se havia um lote em voo, foi ele
+void Uplink::drop(uint32_t batches, uint32_t records) {
+    if (batches == 0) {
+        return;
+    }
+    counters.droppedBatches += batches;
+    counters.droppedRecords += records;
+    if (inFlight) {
+        inFlightDropped = true;
+    }
+    frontSent = false;
+}
+
+void Uplink::ringCopy(uint32_t offset, void* out, size_t length) const {
+    uint32_t start = offset % UPLINK_QUEUE_BYTES;
+    size_t first = UPLINK_QUEUE_BYTES - start < length ? UPLINK_QUEUE_BYTES - start : length;
+    memcpy(out, ring + start, first);
+    memcpy((uint8_t*)out + first, ring, length - first);
+}
+
+void Uplink::ringPeek(QueuedBatch& batch, const uint8_t*& body, size_t& length,
+                      const uint8_t*& more, size_t& moreLength) const {
+    ringCopy(ringHead, &batch, sizeof(batch));
+    uint32_t start = (ringHead + sizeof(batch)) % UPLINK_QUEUE_BYTES;
+    length = UPLINK_QUEUE_BYTES - start < batch.length ? UPLINK_QUEUE_BYTES - start : batch.length;
+    body = ring + start;
+    more = ring;
+    moreLength = batch.length - length;
+}
+
+void Uplink::ringPush(const QueuedBatch& batch, const uint8_t* body) {
+    uint32_t tail = (ringHead + ringUsed) % UPLINK_QUEUE_BYTES;
+    const uint8_t* parts[2] = {(const uint8_t*)&batch, body};
+    size_t lengths[2] = {sizeof(batch), batch.length};
+    for (int p = 0; p < 2; p++) {
+        size_t first = UPLINK_QUEUE_BYTES - tail < lengths[p] ? UPLINK_QUEUE_BYTES - tail : lengths[p];
+        memcpy(ring + tail, parts[p], first);
+        memcpy(ring, parts[p] + first, lengths[p] - first);
+        tail = (tail + lengths[p]) % UPLINK_QUEUE_BYTES;
+    }
+    ringUsed += sizeof(batch) + batch.length;
+    ringCount++;
+}
+
+void Uplink::ringPop() {
+    QueuedBatch batch;
+    ringCopy(ringHead, &batch, sizeof(batch));
+    ringHead = (ringHead + sizeof(batch) + batch.length) % UPLINK_QUEUE_BYTES;
+    ringUsed -= sizeof(batch) + batch.length;
+    ringCount--;
+}
+
+// Frente da fila: a flash tem os lotes mais antigos
+bool Uplink::loadFront(QueuedBatch& batch, uint8_t* body) {
+    if (spill.count() > 0) {
+        if (spill.front(batch, body)) {
+            return true;
+        }
+        // Corpo corrompido na flash: não há o que reenviar
+        QueuedBatch header;
+        uint32_t records = spill.front(header, nullptr) ? header.records : 0;
+        spill.pop();
+        drop(1, records);
+        return false;
+    }
+    if (ringCount == 0) {
+        return false;
+    }
+    ringCopy(ringHead, &batch, sizeof(batch));
+    ringCopy(ringHead + sizeof(batch), body, batch.length);
+    return true;
+}
+
+void Uplink::popFront() {
+    if (spill.count() > 0) {
+        spill.pop();
+    } else if (ringCount > 0) {
+        ringPop();
+    }
+    frontSent = false;
+}
+
+void Uplink::step(uint32_t nowMs) {
+    seal(nowMs);
+    applyConfig();
+    if (!enabled) {
+        if (connected) {
+            disconnect(nowMs);
+        }
+        return;
+    }
+    if (!connected && !connect(nowMs)) {
+        return;
+    }
+    receive(nowMs);
+    if (connected) {
+        transmit(nowMs);
+    }
+}
+
+bool Uplink::connect(uint32_t nowMs) {
+    if (attempted && nowMs - lastAttemptMs < waitMs) {
+        return false;
+    }
+    attempted = true;
+    lastAttemptMs = nowMs;
+    if (!halUplinkConnect(host, port, UPLINK_CONNECT_TIMEOUT_MS)) {
+        counters.connectFailures++;
+        retryMs = retryMs == 0 ? UPLINK_RETRY_MIN_MS
+                : retryMs < UPLINK_RETRY_MAX_MS / 2 ? retryMs * 2 : UPLINK_RETRY_MAX_MS;
+        // Sorteio para a frota não voltar toda no mesmo instante
+        waitMs = retryMs + halRandom() % (retryMs / 4 + 1);
+        return false;
+    }
+    connected = true;
+    counters.connects++;
+    retryMs = 0;
+    nextId = 1;
+    inFlight = false;
+    ackLength = 0;
+    tokens = UPLINK_DRAIN_BYTES_PER_S;
+    refillMs = nowMs;
+    int n = snprintf((char*)message, sizeof(message), "KATABASE %s BATCH %08lx\n",
+                     device, (unsigned long)bootId);
+    messageLength = n > 0 ? (size_t)n : 0;
+    messageSent = 0;
+    return true;
+}
+
+void Uplink::disconnect(uint32_t nowMs) {
+    halUplinkClose();
+    connected = false;
+    counters.disconnects++;
+    inFlight = false;
+    messageLength = messageSent = 0;
+    // Reconexão depois do intervalo mínimo
+    lastAttemptMs = nowMs;
+    waitMs = UPLINK_RETRY_MIN_MS;
+}
+
+void Uplink::receive(uint32_t nowMs) {
+    uint8_t buffer[32];
+    for (;;) {
+        int n = halUplinkRead(buffer, sizeof(buffer));
+        if (n < 0) {
+            disconnect(nowMs);
+            return;
+        }
+        if (n == 0) {
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (buffer[i] != '\n') {
+                if (ackLength < sizeof(ackLine) - 1) {
+                    ackLine[ackLength++] = (char)buffer[i];
+                }
+                continue;
+            }
+            ackLine[ackLength] = '\0';
+            ackLength = 0;
+            char* end;
+            unsigned long id = strncmp(ackLine, "ACK ", 4) == 0 ? strtoul(ackLine + 4, &end, 10) : 0;
+            if (inFlight && id == inFlightId) {
+                acknowledge(nowMs);
+            }
+        }
+    }
+}
+
+void Uplink::acknowledge(uint32_t nowMs) {
+    inFlight = false;
+    counters.acked++;
+    upload.record(nowMs - sentMs);
+    if (inFlightDropped) {
+        inFlightDropped = false;    // Já saiu da fila
+        return;
+    }
+    age.record(flashLog().clock(nowMs) - inFlightSealMs);
+    popFront();
+}
+
+// Monta o próximo lote da fila em message; false se não houver o que
+// enviar agora (fila vazia ou balde do dreno sem bytes)
+bool Uplink::prepare(uint32_t nowMs) {
+    if (queued() == 0) {
+        return false;
+    }
+    // Balde de bytes: no máximo um segundo de dreno acumulado
+    uint32_t refill = (uint32_t)((uint64_t)(nowMs - refillMs) * UPLINK_DRAIN_BYTES_PER_S / 1000);
+    if (refill > 0) {
+        tokens = tokens + refill < UPLINK_DRAIN_BYTES_PER_S ? tokens + refill : UPLINK_DRAIN_BYTES_PER_S;
+        refillMs = nowMs;
+    }
+    QueuedBatch batch;
+    if (!loadFront(batch, message + BATCH_HEADER_SIZE)) {
+        return false;
+    }
+    uint32_t cost = BATCH_HEADER_SIZE + batch.length;
+    if (tokens < cost && tokens < UPLINK_DRAIN_BYTES_PER_S) {
+        return false;
+    }
+    tokens = tokens > cost ? tokens - cost : 0;
+
+    BatchHeader header;
+    header.id = nextId++;
+    header.records = batch.records;
+    header.encoding = (BatchEncoding)batch.encoding;
+    header.length = batch.length;
+    header.crc = batch.crc;
+    encodeBatchHeader(header, message);
+    messageLength = cost;
+    messageSent = 0;
+    inFlight = true;
+    inFlightDropped = false;
+    inFlightId = header.id;
+    inFlightSealMs = batch.sealMs;
+    sentMs = nowMs;
+    counters.sent++;
+    counters.resent += frontSent;
+    counters.sentBytes += cost;
+    frontSent = true;
+    return true;
+}
+
+// Termina o que estava em envio (a linha de identificação logo após
+// conectar) e, livre, manda o lote seguinte
+void Uplink::transmit(uint32_t nowMs) {
+    if (inFlight && nowMs - sentMs >= UPLINK_ACK_TIMEOUT_MS) {
+        counters.ackTimeouts++;
+        disconnect(nowMs);
+        return;
+    }
+    for (int round = 0; round < 2; round++) {
+        if (messageSent == messageLength && (inFlight || !prepare(nowMs))) {
+            return;
+        }
+        int n = halUplinkWrite(message + messageSent, messageLength - messageSent);
+        if (n < 0) {
+            disconnect(nowMs);
+            return;
+        }
+        messageSent += n;
+        if (messageSent < messageLength) {
+            return;
+        }
+    }
+}
+
+UplinkSnapshot Uplink::snapshot() const {
+    UplinkSnapshot s = counters;
+    s.enabled = enabled;
+    s.connected = connected;
+    s.inFlight = inFlight;
+    {
+        ScopedLock lock(mutex);
+        memcpy(s.host, nextHost, sizeof(s.host));
+        s.port = nextPort;
+        memcpy(s.device, nextDevice, sizeof(s.device));
+    }
+    s.ramBatches = ringCount;
+    s.ramBytes = ringUsed;
+    s.spill = spill.stats();
+    s.uploadMs = upload.summary(1);
+    s.ageMs = age.summary(1);
+    return s;
+}
+
+static void writeLatency(JsonWriter& json, const char* name, const StageSummary& s) {
+    json.key(name);
+    json.beginObject();
+    json.field("count", (unsigned long)s.count);
+    json.field("p50", (unsigned long)s.p50Us);
+    json.field("p99", (unsigned long)s.p99Us);
+    json.field("max", (unsigned long)s.maxUs);
+    json.endObject();
+}
+
+void Uplink::write(const UplinkSnapshot& s, JsonWriter& json) {
+    json.beginObject();
+    json.field("enabled", s.enabled);
+    json.field("connected", s.connected);
+    char collector[UPLINK_HOST_MAX + 8];
+    snprintf(collector, sizeof(collector), "%s:%u", s.host, s.port);
+    json.field("collector", s.enabled ? collector : "");
+    json.field("device", s.device);
+    json.field("records", (unsigned long)s.records);
+    json.field("overruns", (unsigned long)s.overruns);
+
+    json.key("batches");
+    json.beginObject();
+    json.field("sealed", (unsigned long)s.batches);
+    json.field("gzip", (unsigned long)s.gzipBatches);
+    json.field("records_avg", s.batches > 0 ? (float)s.records / s.batches : 0.0f, 1);
+    json.field("bytes_avg", s.batches > 0 ? (float)s.batchBytes / s.batches : 0.0f, 0);
+    json.field("ratio", s.rawBytes > 0 ? (float)s.batchBytes / s.rawBytes : 0.0f, 3);
+    json.field("last_records", (unsigned long)s.lastRecords);
+    json.field("last_bytes", (unsigned long)s.lastBytes);
+    json.endObject();
+
+    json.key("queue");
+    json.beginObject();
+    json.field("ram_batches", (unsigned long)s.ramBatches);
+    json.field("ram_bytes", (unsigned long)s.ramBytes);
+    json.field("ram_capacity", (unsigned long)UPLINK_QUEUE_BYTES);
+    json.field("flash_batches", (unsigned long)s.spill.batches);
+    json.field("flash_sectors", (unsigned long)s.spill.sectors);
+    json.field("flash_recovered", (unsigned long)s.spill.recovered);
+    json.field("peak_batches", (unsigned long)s.peakBatches);
+    json.field("dropped_batches", (unsigned long)s.droppedBatches);
+    json.field("dropped_records", (unsigned long)s.droppedRecords);
+    json.endObject();
+
+    json.key("link");
+    json.beginObject();
+    json.field("connects", (unsigned long)s.connects);
+    json.field("connect_failures", (unsigned long)s.connectFailures);
+    json.field("disconnects", (unsigned long)s.disconnects);
+    json.field("ack_timeouts", (unsigned long)s.ackTimeouts);
+    json.field("sent", (unsigned long)s.sent);
+    json.field("resent", (unsigned long)s.resent);
+    json.field("acked", (unsigned long)s.acked);
+    json.field("sent_bytes", (unsigned long)s.sentBytes);
+    json.field("drain_bytes_per_s", (unsigned long)UPLINK_DRAIN_BYTES_PER_S);
+    json.endObject();
+
+    writeLatency(json, "upload_ms", s.uploadMs);
+    writeLatency(json, "age_ms", s.ageMs);
+    json.endObject();
+}
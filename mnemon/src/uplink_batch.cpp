@@ -0,0 +1,32 @@
+#include "uplink_batch.h"
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void encodeBatchHeader(const BatchHeader& header, uint8_t* output) {
+    put32(output, header.id);
+    output[4] = (uint8_t)header.records;
+    output[5] = (uint8_t)(header.records >> 8);
+    output[6] = (uint8_t)header.encoding;
+    output[7] = 0;
+    put32(output + 8, header.length);
+    put32(output + 12, header.crc);
+}
+
+bool decodeBatchHeader(const uint8_t* input, BatchHeader& header) {
+    header.id = get32(input);
+    header.records = input[4] | (input[5] << 8);
+    header.encoding = (BatchEncoding)input[6];
+    header.length = get32(input + 8);
+    header.crc = get32(input + 12);
+    return (header.encoding == BatchEncoding::Frames || header.encoding == BatchEncoding::Gzip) &&
+           header.length <= BATCH_MAX_BODY;
+}
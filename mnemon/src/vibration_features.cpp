@@ -0,0 +1,141 @@
+#include "vibration_features.h"
+
+#include <math.h>
+#include <string.h>
+
+const float LSB_TO_G = 1.0f / 16384.0f;
+
+VibrationFeatureEngine::VibrationFeatureEngine() {
+    reset();
+}
+
+void VibrationFeatureEngine::reset() {
+    memset(acc, 0, sizeof(acc));
+    memset(blocks, 0, sizeof(blocks));
+    memset(blockPeaks, 0, sizeof(blockPeaks));
+    memset(&current, 0, sizeof(current));
+    blockCount = 0;
+    blockPeakMagnitude = 0;
+    nextBlock = 0;
+    filledBlocks = 0;
+}
+
+bool VibrationFeatureEngine::addSample(const AccelRaw& sample) {
+    float value[CHANNELS];
+    value[0] = sample.x * LSB_TO_G;
+    value[1] = sample.y * LSB_TO_G;
+    value[2] = sample.z * LSB_TO_G;
+    value[3] = sqrtf(value[0] * value[0] + value[1] * value[1] + value[2] * value[2]);
+    
+    if (blockCount == 0) {
+        for (int c = 0; c < CHANNELS; c++) {
+            acc[c].shift = value[c];
+            acc[c].s1 = acc[c].s2 = acc[c].s3 = acc[c].s4 = 0;
+            acc[c].min = acc[c].max = value[c];
+        }
+        blockPeakMagnitude = value[3];
+    }
+    
+    for (int c = 0; c < CHANNELS; c++) {
+        Accumulator& a = acc[c];
+        float d = value[c] - a.shift;
+        float d2 = d * d;
+        a.s1 += d;
+        a.s2 += d2;
+        a.s3 += d2 * d;
+        a.s4 += d2 * d2;
+        if (value[c] < a.min) a.min = value[c];
+        if (value[c] > a.max) a.max = value[c];
+    }
+    if (value[3] > blockPeakMagnitude) blockPeakMagnitude = value[3];
+    
+    if (++blockCount < FEATURE_HOP_SAMPLES) {
+        return false;
+    }
+    closeBlock();
+    return true;
+}
+
+// Combina dois conjuntos de momentos centrais (Pébay, 2008)
+void VibrationFeatureEngine::merge(Moments& a, const Moments& b) {
+    if (b.n == 0) return;
+    if (a.n == 0) {
+        a = b;
+        return;
+    }
+    
+    float na = a.n;
+    float nb = b.n;
+    float n = na + nb;
+    float delta = b.mean - a.mean;
+    float delta2 = delta * delta;
+    float nanb = na * nb;
+    
+    float m4 = a.m4 + b.m4
+             + delta2 * delta2 * nanb * (na * na - nanb + nb * nb) / (n * n * n)
+             + 6.0f * delta2 * (na * na * b.m2 + nb * nb * a.m2) / (n * n)
+             + 4.0f * delta * (na * b.m3 - nb * a.m3) / n;
+    float m3 = a.m3 + b.m3
+             + delta2 * delta * nanb * (na - nb) / (n * n)
+             + 3.0f * delta * (na * b.m2 - nb * a.m2) / n;
+    float m2 = a.m2 + b.m2 + delta2 * nanb / n;
+    
+    a.n += b.n;
+    a.mean += delta * nb / n;
+    a.m2 = m2;
+    a.m3 = m3;
+    a.m4 = m4;
+    if (b.min < a.min) a.min = b.min;
+    if (b.max > a.max) a.max = b.max;
+}
+
+static void toFeatures(const Moments& m, AxisFeatures& f) {
+    f.mean = m.mean;
+    f.peakToPeak = m.max - m.min;
+    f.peak = fmaxf(m.max - m.mean, m.mean - m.min);
+    
+    float variance = m.n > 0 ? m.m2 / m.n : 0;
+    f.rms = variance > 0 ? sqrtf(variance) : 0;
+    f.crestFactor = f.rms > 0 ? f.peak / f.rms : 0;
+    f.kurtosis = m.m2 > 0 ? m.n * m.m4 / (m.m2 * m.m2) : 0;
+}
+
+void VibrationFeatureEngine::closeBlock() {
+    // Converter as somas deslocadas do bloco em momentos centrais
+    float n = blockCount;
+    for (int c = 0; c < CHANNELS; c++) {
+        const Accumulator& a = acc[c];
+        float m = a.s1 / n;
+        float m2 = m * m;
+        Moments& out = blocks[nextBlock][c];
+        out.n = blockCount;
+        out.mean = a.shift + m;
+        out.m2 = fmaxf(a.s2 - n * m2, 0);
+        out.m3 = a.s3 - 3.0f * m * a.s2 + 2.0f * n * m2 * m;
+        out.m4 = fmaxf(a.s4 - 4.0f * m * a.s3 + 6.0f * m2 * a.s2 - 3.0f * n * m2 * m2, 0);
+        out.min = a.min;
+        out.max = a.max;
+    }
+    blockPeaks[nextBlock] = blockPeakMagnitude;
+    nextBlock = (nextBlock + 1) % FEATURE_WINDOW_BLOCKS;
+    if (filledBlocks < FEATURE_WINDOW_BLOCKS) filledBlocks++;
+    blockCount = 0;
+    
+    // Recombinar a janela a partir dos blocos guardados
+    float peak = 0;
+    for (int c = 0; c < CHANNELS; c++) {
+        Moments window = {0, 0, 0, 0, 0, 0, 0};
+        for (uint32_t b = 0; b < filledBlocks; b++) {
+            merge(window, blocks[b][c]);
+        }
+        toFeatures(window, c < 3 ? current.axis[c] : current.magnitude);
+        current.samples = window.n;
+    }
+    for (uint32_t b = 0; b < filledBlocks; b++) {
+        if (blockPeaks[b] > peak) peak = blockPeaks[b];
+    }
+    current.peakMagnitude = peak;
+    current.rmsTotal = sqrtf(current.axis[0].rms * current.axis[0].rms +
+                             current.axis[1].rms * current.axis[1].rms +
+                             current.axis[2].rms * current.axis[2].rms);
+}